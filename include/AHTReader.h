@@ -46,7 +46,8 @@ class AHTReader {
   static const uint16_t MIN_READ_INTERVAL_MS = 2000;
 
   AHT20& mAht;
-  uint32_t mLastReadTime{-MIN_READ_INTERVAL_MS};
+  // Read at the first call, -MIN_READ_INTERVAL_MS without a narrowing warning
+  uint32_t mLastReadTime{UINT32_MAX - MIN_READ_INTERVAL_MS + 1};
   float mLastTemperature{0.0f};
   float mLastHumidity{0.0f};
   bool mReadSuccessful{false};
@@ -1,32 +1,218 @@
 #pragma once
 
+#include <Arduino.h>
+#include <assert.h>
 #include <stdint.h>
 
-#include "RingBuffer.h"
 #include "Util.h"
 
+/**
+ * @brief Accumulated airtime over the last hour.
+ *
+ * The hour is divided in buckets of bucket_ms. Only buckets with airtime are
+ * stored, as (bucket number, time) entries in a ring ordered by age, next to a
+ * rolling sum of all entries. Moving the window costs one division no matter
+ * how long the gap since the last update was. When all entries are older than
+ * an hour they are cleared at once, otherwise the expired ones are dropped one
+ * by one. Each entry is dropped once, so that is constant time per
+ * transmission.
+ *
+ * RAM use depends on N only, not on the bucket size. If more than N buckets
+ * with airtime fall within the hour, the oldest entry is merged into the next
+ * oldest. The merged time then leaves the window later than it should, so the
+ * airtime is overestimated rather than underestimated.
+ *
+ * @tparam N Max number of buckets with airtime to keep track of.
+ */
+template <uint8_t N>
 class AirTime {
  public:
-  explicit AirTime(uint16_t limit_ppm) : mLimit_ppm{limit_ppm} {
-    mBuf.fill(0);
-    // Initial push for first minute to be at pos zero in buf.
-    mBuf.push_front(0);
+  static_assert(N >= 2, "AirTime<N>: N must be at least 2");
+
+  /**
+   * @param limit_ppm Airtime limit for last hour, 10000 ppm = 1 %.
+   * @param bucket_ms Bucket size, must divide an hour evenly.
+   */
+  explicit AirTime(uint16_t limit_ppm, uint16_t bucket_ms = Util::MS_PER_MINUTE)
+      : mLimit_ppm{limit_ppm},
+        mBucket_ms{bucket_ms},
+        mWindowBuckets{static_cast<uint16_t>(Util::MS_PER_HOUR / bucket_ms)} {
+    assert(Util::MS_PER_HOUR % bucket_ms == 0);
   }
 
-  uint32_t getTime_ms();   // For last hour
+  uint32_t getTime_ms() { return getTime_ms(millis()); }  // For last hour
   uint16_t getTime_ppm();  // For last hour, 10000 ppm = 1 %
 
+  /**
+   * @brief Airtime for the hour before time.
+   *
+   * @param time Current time in ms.
+   * @return uint32_t airtime in ms.
+   */
+  uint32_t getTime_ms(uint32_t time) {
+    update(time);
+    return mTime_ms;
+  }
+
   bool isLimitReached() { return getTime_ppm() >= mLimit_ppm; };
 
-  void update();
+  /**
+   * @brief Checks if a transmission fits in what is left of the limit.
+   *
+   * @param time_ms Time on air of the transmission.
+   * @return true if the airtime for last hour stays within the limit.
+   */
+  bool isRoomFor(uint32_t time_ms) {
+    return getTime_ms() + time_ms <= getLimit_ms();
+  }
+
+  // For last hour, 1 ppm = 3.6 ms
+  uint32_t getLimit_ms() const { return mLimit_ppm * 36UL / 10; }
+
+  uint16_t getBucket_ms() const { return mBucket_ms; }
+
+  // Number of buckets with airtime currently kept track of.
+  uint8_t getEntries() const { return mCount; }
+
+  void update() { update(millis()); }
+
+  /**
+   * @brief Moves the window to time, dropping airtime older than an hour.
+   *
+   * @param time Current time in ms.
+   */
+  void update(uint32_t time);
+
+  /**
+   * @brief Adds a transmission, split over the buckets it spans.
+   *
+   * @param start Start time of transmission in ms.
+   * @param end End time of transmission in ms.
+   */
   void update(uint32_t start, uint32_t end);
 
  private:
-  void update(uint32_t time);
-  void addToCurrentMinute(uint32_t t);
+  struct EntryT {
+    uint16_t bucket;  // Bucket number, wraps around
+    uint16_t time_ms;
+  };
+
+  EntryT& entry(uint8_t i) { return mEntries[(mTail + i) % N]; }
+
+  void clear() {
+    mCount = 0;
+    mTime_ms = 0;
+  }
+
+  // Time within the hour before the current bucket started.
+  bool isBeforeCurrentBucket(uint32_t time) const {
+    return time != mBucketStart_ms &&
+           mBucketStart_ms - time < Util::MS_PER_HOUR;
+  }
+
+  bool isExpired(const EntryT& e) const {
+    return static_cast<uint16_t>(mBucket - e.bucket) >= mWindowBuckets;
+  }
 
-  RingBuffer<uint16_t, Util::MINUTES_PER_HOUR> mBuf;
-  uint32_t mLastUpdate_ms{};
+  void addToCurrentBucket(uint16_t t);
+
+  EntryT mEntries[N]{};
+  uint8_t mTail{};  // Oldest entry
+  uint8_t mCount{};
+  uint16_t mBucket{};          // Current bucket number
+  uint32_t mBucketStart_ms{};  // Start of current bucket
+  uint32_t mTime_ms{};         // Sum of all entries
   const uint16_t mLimit_ppm;
-  uint32_t mTime_ms{};
+  const uint16_t mBucket_ms;
+  const uint16_t mWindowBuckets;
 };
+
+template <uint8_t N>
+void AirTime<N>::update(uint32_t time) {
+  const uint32_t elapsed = time - mBucketStart_ms;
+  if (elapsed < mBucket_ms || isBeforeCurrentBucket(time)) {
+    return;
+  }
+
+  const uint32_t buckets = elapsed / mBucket_ms;
+  mBucket += static_cast<uint16_t>(buckets);
+  mBucketStart_ms += buckets * mBucket_ms;
+
+  if (buckets >= mWindowBuckets ||
+      (mCount > 0 && isExpired(entry(mCount - 1)))) {
+    // Everything is older than an hour.
+    clear();
+    return;
+  }
+
+  while (mCount > 0 && isExpired(entry(0))) {
+    mTime_ms -= entry(0).time_ms;
+    mTail = (mTail + 1) % N;
+    mCount--;
+  }
+}
+
+template <uint8_t N>
+void AirTime<N>::addToCurrentBucket(uint16_t t) {
+  assert(t <= mBucket_ms);
+  mTime_ms += t;
+
+  if (mCount > 0 && entry(mCount - 1).bucket == mBucket) {
+    assert(entry(mCount - 1).time_ms + t <= UINT16_MAX);
+    entry(mCount - 1).time_ms += t;
+    return;
+  }
+
+  if (mCount == N) {
+    // Merge oldest into next oldest, it will expire later than it should.
+    uint32_t merged =
+        static_cast<uint32_t>(entry(0).time_ms) + entry(1).time_ms;
+    if (merged > UINT16_MAX) {
+      // Only with more than 65 s airtime per hour, far above any limit.
+      mTime_ms -= merged - UINT16_MAX;
+      merged = UINT16_MAX;
+    }
+    entry(1).time_ms = static_cast<uint16_t>(merged);
+    mTail = (mTail + 1) % N;
+    mCount--;
+  }
+
+  EntryT& e = entry(mCount);
+  e.bucket = mBucket;
+  e.time_ms = t;
+  mCount++;
+}
+
+template <uint8_t N>
+void AirTime<N>::update(uint32_t start, uint32_t end) {
+  uint32_t t1 = start;
+
+  while (t1 != end) {
+    update(t1);
+    uint32_t t2 = mBucketStart_ms + mBucket_ms;  // Bucket boundary
+    if (isBeforeCurrentBucket(t1)) {
+      // The window has moved on since the transmission started. Put the
+      // early part in the current bucket, it expires a bit late.
+      t2 = isBeforeCurrentBucket(t1 + mBucket_ms) ? t1 + mBucket_ms
+                                                    : mBucketStart_ms;
+    }
+    if (end - t1 < t2 - t1) {
+      t2 = end;
+    }
+
+    addToCurrentBucket(static_cast<uint16_t>(t2 - t1));
+    t1 = t2;
+  }
+}
+
+template <uint8_t N>
+uint16_t AirTime<N>::getTime_ppm() {
+  // Convert ms to ppm and round it.
+  uint32_t time_ppm = (getTime_ms() * 10 + 18) / 36;
+
+  if (time_ppm > UINT16_MAX) {
+    time_ppm = UINT16_MAX;
+  }
+
+  return static_cast<uint16_t>(time_ppm);
+}
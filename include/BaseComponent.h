@@ -3,6 +3,8 @@
 #include <Arduino.h>
 #include <stdint.h>
 
+#include "Types.h"
+#include "Unit.h"
 #include "Util.h"
 
 class BaseComponent {
@@ -37,16 +39,37 @@ class BaseComponent {
 
   BaseComponent() = delete;
 
-  explicit BaseComponent(uint8_t entityId) : mEntityId{entityId} {}
-
-  BaseComponent(uint8_t entityId, const char* name)
-      : mName{name}, mEntityId{entityId} {}
-
-  BaseComponent(uint8_t entityId, const char* name, Category category)
-      : mName{name}, mEntityId{entityId}, mCategory{category} {}
-
-  BaseComponent(uint8_t entityId, Category category)
-      : mEntityId{entityId}, mCategory{category} {}
+  /**
+   * @param entity Metadata of the entity, in flash (PROGMEM), see makeEntity().
+   */
+  explicit BaseComponent(const DiscoveryEntityT& entity) : mEntity{&entity} {}
+
+  /**
+   * @brief Metadata of an entity, evaluated at compile time.
+   * Put the result in flash and pass it to the component, e.g.
+   *   const DiscoveryEntityT fooEntity PROGMEM = Foo::makeEntity(3, fooName);
+   * @tparam T Value type, gives size and signedness.
+   * @param name Name in flash.
+   * @param precision Number of decimals, 0-3.
+   */
+  template <class T>
+  static constexpr DiscoveryEntityT makeEntity(
+      uint8_t entityId, const char* name, Type type, uint8_t deviceClass,
+      Category category, Unit::Type unitType = Unit::Type::none,
+      uint8_t precision = 0, T min_value = T{}, T max_value = T{}) {
+    return DiscoveryEntityT{entityId,
+                            static_cast<uint8_t>(type),
+                            deviceClass,
+                            static_cast<uint8_t>(category),
+                            static_cast<uint8_t>(unitType),
+                            static_cast<uint8_t>(precision > 3 ? 3 : precision),
+                            static_cast<uint8_t>(sizeof(T) / 2),
+                            IS_SIGNED_TYPE(T),
+                            0,
+                            static_cast<uint32_t>(min_value),
+                            static_cast<uint32_t>(max_value),
+                            name};
+  }
 
   bool isReportDue() const { return mIsReportDue; }
 
@@ -59,22 +82,40 @@ class BaseComponent {
 
   uint32_t timeSinceLastReport() const { return millis() - mLastReportTime; }
 
-  uint8_t getEntityId() const { return mEntityId; }
+  uint8_t getEntityId() const { return pgm_read_byte(&mEntity->entityId); }
 
-  Category getCategory() const { return mCategory; }
+  Category getCategory() const {
+    return static_cast<Category>(pgm_read_byte(&mEntity->category));
+  }
 
-  const char* getName() const { return mName; }
+  uint8_t getDeviceClass() const {
+    return pgm_read_byte(&mEntity->deviceClass);
+  }
+
+  const char* getName() const {
+    return static_cast<const char*>(pgm_read_ptr(&mEntity->name));
+  }
+
+  /**
+   * @brief Metadata of the entity, in flash.
+   */
+  const DiscoveryEntityT& getEntity() const { return *mEntity; }
+
+  void getDiscoveryEntity(DiscoveryEntityT& item) const {
+    memcpy_P(&item, mEntity, sizeof(item));
+  }
 
   size_t printTo(Print& p) const {
     size_t n = 0;
-    n += p.print(reinterpret_cast<const __FlashStringHelper*>(mName));
+    const char* name = getName();
+    if (name != nullptr) {
+      n += p.print(reinterpret_cast<const __FlashStringHelper*>(name));
+    }
     return n;
   }
 
  private:
   uint32_t mLastReportTime{};  // ms
-  const char* mName{nullptr};
-  const uint8_t mEntityId{};
-  const Category mCategory{Category::NONE};
+  const DiscoveryEntityT* const mEntity;  // In flash
   bool mIsReportDue{true};
 };
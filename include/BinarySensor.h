@@ -1,6 +1,5 @@
 #pragma once
 
-#include <Printable.h>
 #include <WString.h>
 
 #include "BaseComponent.h"
@@ -38,24 +37,34 @@ enum class BinarySensorDeviceClass : uint8_t {
   WINDOW
 };
 
-class BinarySensor : public Printable {
+class BinarySensor {
  public:
   BinarySensor() = delete;
 
-  BinarySensor(
+  /**
+   * @param entity Metadata of the entity, in flash (PROGMEM), see makeEntity().
+   */
+  explicit BinarySensor(const DiscoveryEntityT& entity)
+      : mBaseComponent{BaseComponent(entity)} {}
+
+  static constexpr DiscoveryEntityT makeEntity(
       uint8_t entityId, const char* name,
       BinarySensorDeviceClass deviceClass = BinarySensorDeviceClass::NONE,
-      Unit::Type unitType = Unit::Type::none)
-      : mBaseComponent{
-            BaseComponent(entityId, name, BaseComponent::Category::DIAGNOSTIC)},
-        mDeviceClass{deviceClass},
-        mUnit{Unit(unitType)} {}
+      Unit::Type unitType = Unit::Type::none) {
+    return BaseComponent::makeEntity<bool>(
+        entityId, name, BaseComponent::Type::BINARY_SENSOR,
+        static_cast<uint8_t>(deviceClass), BaseComponent::Category::DIAGNOSTIC,
+        unitType, 0, false, true);
+  }
 
   BaseComponent::Type getComponentType() const {
     return BaseComponent::Type::BINARY_SENSOR;
   }
 
-  BinarySensorDeviceClass getDeviceClass() const { return mDeviceClass; }
+  BinarySensorDeviceClass getDeviceClass() const {
+    return static_cast<BinarySensorDeviceClass>(
+        mBaseComponent.getDeviceClass());
+  }
 
   BaseComponent::Category getCategory() const {
     return mBaseComponent.getCategory();
@@ -75,7 +84,7 @@ class BinarySensor : public Printable {
 
   bool isReportDue() const { return mBaseComponent.isReportDue(); }
 
-  size_t printTo(Print& p) const final;
+  size_t printTo(Print& p) const;
 
   void setIsReportDue(bool isDue) { mBaseComponent.setIsReportDue(isDue); }
 
@@ -92,8 +101,6 @@ class BinarySensor : public Printable {
 
  private:
   BaseComponent mBaseComponent;
-  const BinarySensorDeviceClass mDeviceClass;
-  const Unit mUnit;
   bool mState{};
   bool mLastReportedState{};
 };
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <Arduino.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Types.h"
+
+// clang-format off
+/*
+ * Compact discovery entity:
+ *   Byte 0-13:  As in a discovery message, see LoRaHandler.h
+ *   Byte 14-m:  Entity Name as zero-terminated string of name bytes
+ *
+ *   Name byte:
+ *     0x01-0x7E: ASCII character
+ *     0x7F:      Escape, next byte is a character as is
+ *     0x80-0xFE: Word from the name dictionary, index = byte & 0x7F
+ *
+ *   Words of a name are separated by single spaces. Before a dictionary word
+ *   the decoder adds a space unless it is first in the name, so spaces are
+ *   only sent before words spelled out in characters.
+ *
+ * The name dictionary is part of the protocol, the gateway has the same list.
+ * Words may only be added last.
+ *
+ * The discovery schema hash is a 32 bit FNV-1a hash over all entities of the
+ * node in plain discovery message format, in component order. The gateway can
+ * calculate it from the entities it has got and compare.
+ */
+// clang-format on
+
+namespace CompactDiscovery {
+
+constexpr uint8_t ESCAPE = 0x7F;
+constexpr uint8_t WORD_FLAG = 0x80;
+constexpr uint8_t WORD_SIZE = 12;  // Longest word + 1
+
+static const char Words[][WORD_SIZE] PROGMEM = {
+    "Car",      "Cover",    "Distance", "High",        "Height", "Humidity",
+    "Interval", "Limit",    "Low",      "Max",         "Min",    "Port",
+    "Presence", "Report",   "Stable",   "Temperature", "Time",   "Value",
+    "Zero",     "Door",     "Battery",  "Voltage",     "Signal", "Strength"};
+
+constexpr uint8_t WORD_COUNT = sizeof(Words) / sizeof(Words[0]);
+
+constexpr uint32_t FNV_OFFSET_BASIS = 2166136261UL;
+constexpr uint32_t FNV_PRIME = 16777619UL;
+
+constexpr uint32_t fnv1a(uint32_t hash, uint8_t b) {
+  return (hash ^ b) * FNV_PRIME;
+}
+
+/**
+ * @brief Find a word of a name in the dictionary.
+ * @param word Start of word in PROGMEM.
+ * @param length Length of word.
+ * @return Index of word, -1 if not found.
+ */
+inline int8_t findWord(const char* word, uint8_t length) {
+  if (length >= WORD_SIZE) {
+    return -1;
+  }
+
+  for (uint8_t i = 0; i < WORD_COUNT; i++) {
+    uint8_t j = 0;
+    while (j < length &&
+           pgm_read_byte(&Words[i][j]) == pgm_read_byte(&word[j])) {
+      j++;
+    }
+    if (j == length && pgm_read_byte(&Words[i][j]) == '\0') {
+      return static_cast<int8_t>(i);
+    }
+  }
+  return -1;
+}
+
+/**
+ * @brief Encode a name with dictionary words.
+ * @param name Zero-terminated name in PROGMEM.
+ * @return Number of bytes written, terminator included. 0 if it doesn't fit
+ * in length.
+ */
+inline size_t encodeName(const char* name, uint8_t* buf, size_t length) {
+  size_t n = 0;
+  uint8_t i = 0;
+
+  while (true) {
+    char c = pgm_read_byte(&name[i]);
+    if (c == '\0') {
+      break;
+    }
+    if (c == ' ') {
+      i++;
+      continue;
+    }
+
+    uint8_t wordLength = 0;
+    while (c != '\0' && c != ' ') {
+      c = pgm_read_byte(&name[i + ++wordLength]);
+    }
+
+    const int8_t index = findWord(&name[i], wordLength);
+    if (index >= 0) {
+      if (length < n + 1) {
+        return 0;
+      }
+      buf[n++] = WORD_FLAG | index;
+    } else {
+      if (n > 0) {
+        if (length < n + 1) {
+          return 0;
+        }
+        buf[n++] = ' ';
+      }
+      for (uint8_t j = 0; j < wordLength; j++) {
+        const uint8_t b = pgm_read_byte(&name[i + j]);
+        const uint8_t m = b >= ESCAPE ? 2 : 1;
+        if (length < n + m) {
+          return 0;
+        }
+        if (m == 2) {
+          buf[n++] = ESCAPE;
+        }
+        buf[n++] = b;
+      }
+    }
+    i += wordLength;
+  }
+
+  if (length < n + 1) {
+    return 0;
+  }
+  buf[n++] = '\0';
+  return n;
+}
+
+/**
+ * @brief Decode a name encoded with dictionary words.
+ * @param[out] name Decoded zero-terminated name.
+ * @param size Size of name buffer.
+ * @return Number of bytes read, terminator included. 0 on error.
+ */
+inline size_t decodeName(const uint8_t* buf, size_t length, char* name,
+                         size_t size) {
+  size_t n = 0;
+  size_t m = 0;
+
+  while (n < length) {
+    uint8_t b = buf[n++];
+
+    if (b == '\0') {
+      if (m >= size) {
+        return 0;
+      }
+      name[m] = '\0';
+      return n;
+    }
+
+    if (b >= WORD_FLAG) {
+      const uint8_t index = b & ~WORD_FLAG;
+      if (index >= WORD_COUNT) {
+        return 0;
+      }
+      const size_t wordLength = strlen_P(Words[index]);
+      const size_t space = m > 0 ? 1 : 0;
+      if (m + space + wordLength >= size) {
+        return 0;
+      }
+      if (space) {
+        name[m++] = ' ';
+      }
+      strcpy_P(&name[m], Words[index]);
+      m += wordLength;
+      continue;
+    }
+
+    if (b == ESCAPE) {
+      if (n == length) {
+        return 0;
+      }
+      b = buf[n++];
+    }
+    if (m + 1 >= size) {
+      return 0;
+    }
+    name[m++] = static_cast<char>(b);
+  }
+
+  return 0;  // No terminator
+}
+
+/**
+ * @brief Write an entity in compact discovery format.
+ * @return Number of bytes written, 0 if it doesn't fit in length.
+ */
+inline size_t entityToByteArray(const DiscoveryEntityT& entity, uint8_t* buf,
+                                size_t length) {
+  if (length < DiscoveryEntityT::HEADER_SIZE) {
+    return 0;
+  }
+
+  const size_t m =
+      encodeName(entity.name, &buf[DiscoveryEntityT::HEADER_SIZE],
+                 length - DiscoveryEntityT::HEADER_SIZE);
+  if (m == 0) {
+    return 0;
+  }
+
+  return entity.headerToByteArray(buf) + m;
+}
+
+/**
+ * @brief Add an entity to a discovery schema hash.
+ * @param hash FNV_OFFSET_BASIS for the first entity, then the previous hash.
+ */
+inline uint32_t hashEntity(uint32_t hash, const DiscoveryEntityT& entity) {
+  uint8_t header[DiscoveryEntityT::HEADER_SIZE];
+  entity.headerToByteArray(header);
+  for (uint8_t i = 0; i < sizeof(header); i++) {
+    hash = fnv1a(hash, header[i]);
+  }
+
+  uint8_t i = 0;
+  uint8_t c;
+  do {
+    c = pgm_read_byte(&entity.name[i++]);
+    hash = fnv1a(hash, c);
+  } while (c != '\0');
+
+  return hash;
+}
+
+}  // namespace CompactDiscovery
@@ -0,0 +1,321 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "Types.h"
+
+// clang-format off
+/*
+ * Compact value item:
+ *   Byte 0:     Bit 7-6: Mode
+ *                 0: absolute - varint, zig-zag encoded if entity is signed
+ *                 1: delta    - zig-zag varint of difference to last
+ *                               confirmed value of entity
+ *                 2: raw      - 4 bytes big endian, as in a plain value item
+ *               Bit 5-0: Entity Id (0-62), 63 means Entity Id in next byte
+ *   Byte 1-n:   Value
+ *
+ * Varints are little endian base 128, bit 7 set in all bytes but the last.
+ * Whether an entity is signed and the value size is known from its discovery
+ * message, the decoder sign extends or truncates the value to that size.
+ */
+// clang-format on
+
+namespace CompactValue {
+
+enum class Mode : uint8_t { absolute, delta, raw };
+
+constexpr uint8_t MODE_SHIFT = 6;
+constexpr uint8_t MODE_BITS = 2;
+constexpr uint8_t MODES_PER_BYTE = 8 / MODE_BITS;
+constexpr uint8_t ENTITY_ID_MASK = 0x3F;
+constexpr uint8_t ENTITY_ID_ESCAPE = 0x3F;
+constexpr uint8_t MAX_VALUE_SIZE = 5;  // Longest varint
+constexpr uint8_t MAX_ITEM_SIZE = 2 + MAX_VALUE_SIZE;  // With escaped id
+
+inline uint32_t zigzag(int32_t v) {
+  return (static_cast<uint32_t>(v) << 1) ^ static_cast<uint32_t>(v >> 31);
+}
+
+inline int32_t unzigzag(uint32_t v) {
+  return static_cast<int32_t>(v >> 1) ^ -static_cast<int32_t>(v & 1);
+}
+
+inline uint8_t varintSize(uint32_t v) {
+  uint8_t n = 1;
+  while (v >= 0x80) {
+    v >>= 7;
+    n++;
+  }
+  return n;
+}
+
+/**
+ * @brief Write a varint.
+ * @return Number of bytes written, 0 if it doesn't fit in length.
+ */
+inline uint8_t writeVarint(uint8_t* buf, size_t length, uint32_t v) {
+  if (length < varintSize(v)) {
+    return 0;
+  }
+
+  uint8_t n = 0;
+  while (v >= 0x80) {
+    buf[n++] = static_cast<uint8_t>(v) | 0x80;
+    v >>= 7;
+  }
+  buf[n++] = static_cast<uint8_t>(v);
+  return n;
+}
+
+/**
+ * @brief Read a varint.
+ * @return Number of bytes read, 0 if truncated or too long.
+ */
+inline uint8_t readVarint(const uint8_t* buf, size_t length, uint32_t& v) {
+  v = 0;
+  for (uint8_t n = 0; n < length && n < 5; n++) {
+    v |= static_cast<uint32_t>(buf[n] & 0x7F) << (7 * n);
+    if ((buf[n] & 0x80) == 0) {
+      return n + 1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * @brief Write the mode and entity id byte(s) of an item.
+ * @return Number of bytes written, 0 if it doesn't fit in length.
+ */
+inline uint8_t writeItemHeader(uint8_t* buf, size_t length, Mode mode,
+                               uint8_t entityId) {
+  const uint8_t modeBits = static_cast<uint8_t>(mode) << MODE_SHIFT;
+
+  if (entityId < ENTITY_ID_ESCAPE) {
+    if (length < 1) {
+      return 0;
+    }
+    buf[0] = modeBits | entityId;
+    return 1;
+  }
+
+  if (length < 2) {
+    return 0;
+  }
+  buf[0] = modeBits | ENTITY_ID_ESCAPE;
+  buf[1] = entityId;
+  return 2;
+}
+
+/**
+ * @brief Read an item without resolving deltas.
+ * @param[out] mode How value is encoded.
+ * @param[out] item Entity id and value. Absolute values of signed entities and
+ * deltas are still zig-zag encoded.
+ * @return Number of bytes read, 0 on error.
+ */
+inline uint8_t readItem(const uint8_t* buf, size_t length, Mode& mode,
+                        ValueItemT& item) {
+  if (length < 1) {
+    return 0;
+  }
+
+  mode = static_cast<Mode>(buf[0] >> MODE_SHIFT);
+  item.entityId = buf[0] & ENTITY_ID_MASK;
+  uint8_t n = 1;
+
+  if (item.entityId == ENTITY_ID_ESCAPE) {
+    if (length < 2) {
+      return 0;
+    }
+    item.entityId = buf[1];
+    n = 2;
+  }
+
+  if (mode == Mode::raw) {
+    if (length < n + sizeof(item.value)) {
+      return 0;
+    }
+    item.value = 0;
+    for (uint8_t i = 0; i < sizeof(item.value); i++) {
+      item.value = (item.value << 8) | buf[n + i];
+    }
+    return n + sizeof(item.value);
+  }
+
+  uint8_t m = readVarint(&buf[n], length - n, item.value);
+  return m == 0 ? 0 : n + m;
+}
+
+}  // namespace CompactValue
+
+/**
+ * @brief Encoder of compact value items.
+ *
+ * Keeps track of which entities are signed and the last value of each entity
+ * that the gateway has confirmed with an ACK. An item is delta encoded when
+ * that is shorter, and only against a confirmed value that is not followed by
+ * an unconfirmed one. The gateway may or may not have got an unconfirmed value,
+ * so such an entity is sent absolute until a frame with it is confirmed.
+ *
+ * Entities that aren't registered are sent raw, so they can always be decoded.
+ *
+ * @tparam N Max number of registered entities.
+ */
+template <uint8_t N>
+class CompactValueEncoder {
+ public:
+  /**
+   * @brief Register an entity.
+   * @return false if there is no room left.
+   */
+  bool addEntity(uint8_t entityId, bool isSigned) {
+    EntryT* e = find(entityId);
+    if (e == nullptr) {
+      if (mSize == N) {
+        return false;
+      }
+      e = &mEntries[mSize++];
+      e->entityId = entityId;
+    }
+    e->flags = isSigned ? FLAG_SIGNED : 0;
+    return true;
+  }
+
+  /**
+   * @brief Encode an item.
+   * @return Number of bytes written, 0 if it doesn't fit in length.
+   */
+  size_t encode(const ValueItemT& item, uint8_t* buf, size_t length) const {
+    uint8_t value[CompactValue::MAX_VALUE_SIZE];
+    CompactValue::Mode mode;
+    const uint8_t m = encodeValue(item, value, sizeof(value), mode);
+
+    const uint8_t n =
+        CompactValue::writeItemHeader(buf, length, mode, item.entityId);
+    if (n == 0 || length < n + m) {
+      return 0;
+    }
+    memcpy(&buf[n], value, m);
+    return n + m;
+  }
+
+  /**
+   * @brief Encode the value of an item, without mode and entity id.
+   * @param[out] mode How the value was encoded.
+   * @return Number of bytes written, 0 if it doesn't fit in length.
+   */
+  uint8_t encodeValue(const ValueItemT& item, uint8_t* buf, size_t length,
+                      CompactValue::Mode& mode) const {
+    using namespace CompactValue;
+
+    const EntryT* e = find(item.entityId);
+    if (e == nullptr) {
+      mode = Mode::raw;
+      if (length < sizeof(item.value)) {
+        return 0;
+      }
+      for (uint8_t i = 0; i < sizeof(item.value); i++) {
+        buf[i] = static_cast<uint8_t>(item.value >> (24 - 8 * i));
+      }
+      return sizeof(item.value);
+    }
+
+    mode = Mode::absolute;
+    uint32_t v = (e->flags & FLAG_SIGNED)
+                     ? zigzag(static_cast<int32_t>(item.value))
+                     : item.value;
+
+    if ((e->flags & (FLAG_CONFIRMED | FLAG_PENDING)) == FLAG_CONFIRMED) {
+      uint32_t d = zigzag(static_cast<int32_t>(item.value - e->confirmed));
+      if (varintSize(d) < varintSize(v)) {
+        mode = Mode::delta;
+        v = d;
+      }
+    }
+
+    return writeVarint(buf, length, v);
+  }
+
+  /**
+   * @brief Record that an item was sent in the message with msgId.
+   */
+  void setSent(const ValueItemT& item, uint8_t msgId) {
+    EntryT* e = find(item.entityId);
+    if (e == nullptr) {
+      return;
+    }
+
+    e->flags |= FLAG_PENDING;
+    e->pending = item.value;
+    e->pendingMsgId = msgId;
+  }
+
+  /**
+   * @brief Forget pending values of an old message with msgId. Call before a
+   * new message gets the same id, so an ACK of it isn't taken for the old one.
+   */
+  void expire(uint8_t msgId) {
+    for (uint8_t i = 0; i < mSize; i++) {
+      EntryT& e = mEntries[i];
+      if ((e.flags & FLAG_PENDING) && e.pendingMsgId == msgId) {
+        e.flags &= ~FLAG_PENDING;
+        e.flags &= ~FLAG_CONFIRMED;
+      }
+    }
+  }
+
+  /**
+   * @brief The gateway confirmed the message with msgId.
+   */
+  void confirm(uint8_t msgId) {
+    for (uint8_t i = 0; i < mSize; i++) {
+      EntryT& e = mEntries[i];
+      if ((e.flags & FLAG_PENDING) && e.pendingMsgId == msgId) {
+        e.flags &= ~FLAG_PENDING;
+        e.flags |= FLAG_CONFIRMED;
+        e.confirmed = e.pending;
+      }
+    }
+  }
+
+  /**
+   * @brief Forget all confirmed values, next items are sent absolute.
+   */
+  void invalidate() {
+    for (uint8_t i = 0; i < mSize; i++) {
+      mEntries[i].flags &= FLAG_SIGNED;
+    }
+  }
+
+ private:
+  static constexpr uint8_t FLAG_SIGNED = 0x01;
+  static constexpr uint8_t FLAG_CONFIRMED = 0x02;
+  static constexpr uint8_t FLAG_PENDING = 0x04;
+
+  struct EntryT {
+    uint8_t entityId;
+    uint8_t flags;
+    uint8_t pendingMsgId;
+    uint32_t confirmed;
+    uint32_t pending;
+  };
+
+  EntryT* find(uint8_t entityId) {
+    for (uint8_t i = 0; i < mSize; i++) {
+      if (mEntries[i].entityId == entityId) {
+        return &mEntries[i];
+      }
+    }
+    return nullptr;
+  }
+
+  const EntryT* find(uint8_t entityId) const {
+    return const_cast<CompactValueEncoder*>(this)->find(entityId);
+  }
+
+  EntryT mEntries[N]{};
+  uint8_t mSize{};
+};
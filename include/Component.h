@@ -6,8 +6,18 @@
 
 #include "Types.h"
 
+/**
+ * @brief Why a value was reported, see IComponent::setReported().
+ */
+enum class ReportReason : uint8_t {
+  due,      // Due for reporting, see IComponent::isReportDue()
+  request,  // Asked for, e.g. all values on a value request
+};
+
 class IComponent : public Printable {
  public:
+  static constexpr uint32_t UPDATE_INTERVAL_DEFAULT_MS = 1000;
+
   /**
    * @brief Call a service.
    * If component has no service it will return immediately.
@@ -70,12 +80,34 @@ class IComponent : public Printable {
   /**
    * @brief Mark the current state as reported, so that it won't be reported
    * again until it changes.
+   * @param reason Why it was reported, only reports that were due count
+   * against a rate limit, see ReportPolicy.
    */
-  virtual void setReported() = 0;
+  virtual void setReported(ReportReason reason) = 0;
 
   /**
    * @brief Update the component's state.
    * @return true if the state was updated successfully, false otherwise.
    */
   virtual bool update() = 0;
+
+  /**
+   * @brief Get the time between updates, see Device::update().
+   * @return Update interval in ms, less than 2^31.
+   */
+  virtual uint32_t getUpdateInterval() const {
+    return UPDATE_INTERVAL_DEFAULT_MS;
+  }
+
+  /**
+   * @brief Get a component that this component's state is calculated from.
+   * Upstream components are updated first, and this component is also updated
+   * when an upstream value changes, see Device::update().
+   * @param idx Index of the upstream component, from 0.
+   * @return The upstream component, nullptr when there are no more.
+   */
+  virtual const IComponent* getUpstream(uint8_t idx) const {
+    (void)idx;
+    return nullptr;
+  }
 };
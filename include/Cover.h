@@ -1,7 +1,5 @@
 #pragma once
 
-#include <Printable.h>
-
 #include "BaseComponent.h"
 #include "Types.h"
 #include "Util.h"
@@ -25,20 +23,31 @@ enum class CoverState : uint8_t { CLOSED, OPEN, OPENING, CLOSING };
 
 enum class CoverService : uint8_t { OPEN, CLOSE, STOP, TOGGLE, UNKNOWN };
 
-class Cover : public Printable {
+class Cover {
  public:
   Cover() = delete;
 
-  Cover(uint8_t entityId, const char* name,
-        CoverDeviceClass deviceClass = CoverDeviceClass::NONE)
-      : mBaseComponent{BaseComponent(entityId, name)},
-        mDeviceClass{deviceClass} {}
+  /**
+   * @param entity Metadata of the entity, in flash (PROGMEM), see makeEntity().
+   */
+  explicit Cover(const DiscoveryEntityT& entity)
+      : mBaseComponent{BaseComponent(entity)} {}
+
+  static constexpr DiscoveryEntityT makeEntity(
+      uint8_t entityId, const char* name,
+      CoverDeviceClass deviceClass = CoverDeviceClass::NONE) {
+    return BaseComponent::makeEntity<uint8_t>(
+        entityId, name, BaseComponent::Type::COVER,
+        static_cast<uint8_t>(deviceClass), BaseComponent::Category::NONE);
+  }
 
   BaseComponent::Type getComponentType() const {
     return BaseComponent::Type::COVER;
   }
 
-  CoverDeviceClass getDeviceClass() const { return mDeviceClass; }
+  CoverDeviceClass getDeviceClass() const {
+    return static_cast<CoverDeviceClass>(mBaseComponent.getDeviceClass());
+  }
 
   void getDiscoveryEntity(DiscoveryEntityT& item) const;
 
@@ -52,7 +61,7 @@ class Cover : public Printable {
 
   bool isReportDue() const { return mBaseComponent.isReportDue(); }
 
-  size_t printTo(Print& p) const final;
+  size_t printTo(Print& p) const;
 
   size_t printTo(Print& p, uint8_t service) const;
 
@@ -77,7 +86,6 @@ class Cover : public Printable {
 
  private:
   BaseComponent mBaseComponent;
-  const CoverDeviceClass mDeviceClass;
   CoverState mState{CoverState::CLOSED};
   CoverState mLastReportedState{CoverState::CLOSED};
 };
@@ -1,25 +1,141 @@
 #pragma once
 
+#include <Arduino.h>
 #include <Printable.h>
+#include <assert.h>
 #include <stdint.h>
 
 #include "Component.h"
 
+#define DEVICE_MAX_COMPONENTS 40  // The components of main.cpp
+#define DEVICE_MAX_ENTITY_ID 47
+#define DEVICE_MAX_UPSTREAMS 8    // Components that others depend on
+#define DEVICE_MAX_DOWNSTREAMS 4  // Components that depend on others
+
 class Device : Printable {
  public:
+  using QueueValueFunc = bool (*)(const ValueItemT& item);
+
   Device() = delete;
 
-  Device(IComponent** components, uint8_t size)
-      : mComponents{components}, mSize{size} {}
+  /**
+   * @param components Array of the components, in flash (PROGMEM).
+   * @param size Number of components.
+   */
+  Device(IComponent* const* components, uint8_t size)
+      : mComponents{components}, mSize{size} {
+    assert(size <= DEVICE_MAX_COMPONENTS);
+    buildIndex();
+  }
 
   IComponent* getComponent(uint8_t idx);
   IComponent* getComponentByEntityId(uint8_t entityId);
 
   uint8_t getSize() const { return mSize; }
 
+  /**
+   * @brief Check the entity ids of the components, done at construction.
+   * @return true if all are unique and at most DEVICE_MAX_ENTITY_ID.
+   */
+  bool isEntityIdsValid() const { return mIsEntityIdsValid; }
+
+  /**
+   * @brief First entity id that is a duplicate or out of range.
+   * Only valid if isEntityIdsValid() is false. A duplicate is shadowed by the
+   * first component with the id.
+   */
+  uint8_t getInvalidEntityId() const { return mInvalidEntityId; }
+
+  /**
+   * @brief Discovery schema hash over all components, see CompactDiscovery.h.
+   * Changes when any discovery entity changes, e.g. after a firmware update.
+   */
+  uint32_t getDiscoveryHash() const;
+
+  /**
+   * @brief Update the components that are due.
+   * Each component is updated at its own interval, see
+   * IComponent::getUpdateInterval(). A component with upstream components is
+   * also updated when an upstream value has changed, see
+   * IComponent::getUpstream(). Components are updated in dependency order, so
+   * upstream values are fresh. All components are due at the first call.
+   * Updated components that are due for reporting are added to the report
+   * set, see report().
+   * @param now Current time in ms.
+   * @return Number of components updated.
+   */
+  uint8_t update(uint32_t now);
+
+  /**
+   * @brief Check if the report set has components.
+   */
+  bool isReportDue() const { return mReportDue != 0; }
+
+  /**
+   * @brief Queue the values of the report set and mark them reported.
+   * A component that fails to queue stays in the set for the next call, one
+   * that has been reported since it was added, e.g. by a request for all
+   * values, is dropped.
+   * @param queue Function that queues a value, false if it could not.
+   * @return Number of values queued.
+   */
+  uint8_t report(QueueValueFunc queue);
+
+  /**
+   * @brief Make a component due for update at the next update(), e.g. after
+   * a wake up by one of its pins.
+   * @param component The component, ignored if not in the device.
+   */
+  void setUpdateDue(const IComponent* component);
+
+  /**
+   * @brief Time until the next component is due for update.
+   * @param now Current time in ms.
+   * @return Time in ms, 0 if a component is due now.
+   */
+  uint32_t getTimeToNextUpdate(uint32_t now) const;
+
   size_t printTo(Print& p) const final;
 
  private:
-  IComponent** mComponents;
+  using MaskT = uint64_t;  // One bit per component index
+
+  static_assert(DEVICE_MAX_COMPONENTS <= sizeof(MaskT) * 8,
+                "MaskT too small for DEVICE_MAX_COMPONENTS");
+
+  IComponent* at(uint8_t idx) const {
+    return static_cast<IComponent*>(pgm_read_ptr(&mComponents[idx]));
+  }
+
+  static constexpr uint8_t NO_INDEX = UINT8_MAX;
+
+  void buildIndex();
+  int8_t getIndex(const IComponent* component) const;
+  void sortComponents();
+  MaskT getUpstream(uint8_t idx) const;
+
+  // Number of components in mask below idx, the slot of idx in arrays that
+  // only hold the components in mask.
+  static uint8_t slot(MaskT mask, uint8_t idx) {
+    uint8_t n = 0;
+    for (mask &= (MaskT{1} << idx) - 1; mask; mask &= mask - 1) {
+      n++;
+    }
+    return n;
+  }
+
+  IComponent* const* mComponents;  // In flash
   const uint8_t mSize;
+  uint32_t mNextUpdateTime[DEVICE_MAX_COMPONENTS]{};  // ms
+  uint32_t mLastValue[DEVICE_MAX_UPSTREAMS]{};  // By slot in mIsUpstream
+  MaskT mUpstream[DEVICE_MAX_DOWNSTREAMS]{};    // By slot in mIsDownstream
+  MaskT mIsUpstream{};    // Components that others depend on
+  MaskT mIsDownstream{};  // Components that depend on others
+  MaskT mIsDue{};       // Components due regardless of time
+  MaskT mReportDue{};   // Report set, components due for reporting
+  uint8_t mOrder[DEVICE_MAX_COMPONENTS]{};  // Update order, component indexes
+  uint8_t mIndexById[DEVICE_MAX_ENTITY_ID + 1];  // Component index by entityId
+  uint8_t mInvalidEntityId{};
+  bool mIsEntityIdsValid{true};
+  bool mIsUpdated{false};  // update() has been called
 };
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "Component.h"
+#include "Sensor.h"
+#include "Unit.h"
+#include "Util.h"
+
+namespace DiagnosticSensorConstants {
+constexpr uint16_t CONFIG_REPORT_INTERVAL_DEFAULT = 900;
+}  // namespace DiagnosticSensorConstants
+
+/**
+ * @brief Sensor of the node itself, e.g. time spent in a power state.
+ * The value is read with a function and reported at each update, once per
+ * report interval.
+ * @tparam T Value type.
+ */
+template <class T>
+class DiagnosticSensor : public IComponent {
+ public:
+  using GetValueFunc = T (*)();
+
+  DiagnosticSensor() = delete;
+
+  DiagnosticSensor(const DiscoveryEntityT& entity, GetValueFunc getValueFunc)
+      : mSensor{Sensor<T>(entity)}, mGetValueFunc{getValueFunc} {}
+
+  static constexpr DiscoveryEntityT makeEntity(
+      uint8_t entityId, const char* name,
+      SensorDeviceClass deviceClass = SensorDeviceClass::NONE,
+      Unit::Type unitType = Unit::Type::none) {
+    return Sensor<T>::makeEntity(entityId, name, deviceClass, unitType);
+  }
+
+  void callService(uint8_t service) final { (void)service; }
+
+  void loadConfigValues() final {};
+
+  bool getDiscoveryEntity(DiscoveryEntityT& item) const final {
+    mSensor.getDiscoveryEntity(item);
+    return true;
+  }
+
+  uint8_t getEntityId() const final { return mSensor.getEntityId(); }
+
+  void getValueItem(ValueItemT& item) const final {
+    return mSensor.getValueItem(item);
+  }
+
+  bool setValueItem(const ValueItemT& item) final {
+    (void)item;
+    return false;
+  }
+
+  bool isReportDue() const final { return mSensor.isReportDue(); }
+
+  size_t printTo(Print& p) const final { return mSensor.printTo(p); };
+
+  size_t printTo(Print& p, uint8_t service) const final {
+    (void)p;
+    (void)service;
+    return 0;
+  };
+
+  void setReported(ReportReason reason) final {
+    (void)reason;
+    mSensor.setReported();
+  }
+
+  bool update() final {
+    mSensor.setValue(mGetValueFunc());
+    mSensor.setIsReportDue(true);
+    return true;
+  }
+
+  uint32_t getUpdateInterval() const final {
+    return DiagnosticSensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT * 1000UL;
+  }
+
+ private:
+  Sensor<T> mSensor;
+  const GetValueFunc mGetValueFunc;
+};
@@ -4,6 +4,7 @@
 
 #include "Component.h"
 #include "Number.h"
+#include "ReportPolicy.h"
 #include "Sensor.h"
 #include "Util.h"
 
@@ -12,17 +13,23 @@ using DistanceT = int16_t;  // cm
 namespace DistanceSensorConstants {
 constexpr int16_t CONFIG_REPORT_HYSTERESIS_DEFAULT = 10;
 constexpr uint16_t CONFIG_MEASURE_INTERVAL_DEFAULT = 60;
-constexpr uint16_t CONFIG_REPORT_INTERVAL_DEFAULT = 300;
 }  // namespace DistanceSensorConstants
 
 class DistanceSensor : public IComponent {
  public:
   DistanceSensor() = delete;
 
-  DistanceSensor(uint8_t entityId, const char* name, NewPing& sonar)
-      : mSensor{Sensor<DistanceT>(entityId, name, SensorDeviceClass::DISTANCE,
-                                  Unit::Type::cm)},
-        mSonar{sonar} {}
+  DistanceSensor(const DiscoveryEntityT& entity, NewPing& sonar,
+                 const ReportConfig& reportConfig)
+      : mSensor{Sensor<DistanceT>(entity)},
+        mSonar{sonar},
+        mReportPolicy{ReportPolicy<DistanceT>(reportConfig)} {}
+
+  static constexpr DiscoveryEntityT makeEntity(uint8_t entityId,
+                                               const char* name) {
+    return Sensor<DistanceT>::makeEntity(
+        entityId, name, SensorDeviceClass::DISTANCE, Unit::Type::cm);
+  }
 
   void callService(uint8_t service) final { (void)service; }
 
@@ -50,11 +57,19 @@ class DistanceSensor : public IComponent {
     return 0;
   };
 
-  void setReported() final { mSensor.setReported(); }
+  void setReported(ReportReason reason) final {
+    mReportPolicy.setReported(reason, mSensor.timeSinceLastReport());
+    mSensor.setReported();
+  }
 
   bool update() final;
 
+  uint32_t getUpdateInterval() const final {
+    return DistanceSensorConstants::CONFIG_MEASURE_INTERVAL_DEFAULT * 1000UL;
+  }
+
  private:
   Sensor<DistanceT> mSensor;
   NewPing& mSonar;
+  ReportPolicy<DistanceT> mReportPolicy;
 };
@@ -14,36 +14,6 @@ static constexpr uint16_t VALUE_SIZE = sizeof(uint32_t);       // 4 bytes
 static constexpr uint16_t CRC_SIZE = 1;                        // 1 byte
 static constexpr uint16_t TOTAL_SIZE = VALUE_SIZE + CRC_SIZE;  // 5 bytes total
 
-/**
- * @brief Helper template to get maximum value for a type without <limits>
- *
- * Used for truncation detection during type casting.
- * Specializations for common Arduino integer types.
- */
-template <typename T>
-inline constexpr uint32_t getMaxValue() {
-  // Default implementation - works for most types
-  return static_cast<uint32_t>(~static_cast<T>(0));
-}
-
-// Specializations for common types
-template <>
-inline constexpr uint32_t getMaxValue<uint8_t>() {
-  return UINT8_MAX;
-}
-template <>
-inline constexpr uint32_t getMaxValue<uint16_t>() {
-  return UINT16_MAX;
-}
-template <>
-inline constexpr uint32_t getMaxValue<int8_t>() {
-  return INT8_MAX;
-}
-template <>
-inline constexpr uint32_t getMaxValue<int16_t>() {
-  return INT16_MAX;
-}
-
 /**
  * @brief Status codes for EEPROM load operations
  *
@@ -118,15 +88,13 @@ LoadStatus loadValue(uint16_t eeAddress, Number<T>& number, T defaultValue) {
 
   uint32_t storedValue = 0;
   if (load(eeAddress, storedValue)) {
-    // Check for potential data loss due to type narrowing (for types smaller
-    // than uint32_t) Only needed when sizeof(T) < sizeof(uint32_t)
-    if (sizeof(T) < sizeof(uint32_t)) {
-      if (storedValue > getMaxValue<T>()) {
-        // Value would be truncated - use default instead
-        number.setValue(defaultValue);
-        (void)save(eeAddress, static_cast<uint32_t>(defaultValue));
-        return LoadStatus::CAST_TRUNCATED;
-      }
+    // Check for potential data loss due to type narrowing. A signed value is
+    // saved sign extended, so it shall survive the cast back unchanged.
+    if (static_cast<uint32_t>(static_cast<T>(storedValue)) != storedValue) {
+      // Value would be truncated - use default instead
+      number.setValue(defaultValue);
+      (void)save(eeAddress, static_cast<uint32_t>(defaultValue));
+      return LoadStatus::CAST_TRUNCATED;
     }
 
     // Safe to cast and set value
@@ -8,6 +8,10 @@
 
 #define EE_ADDRESS_HEIGHT_SENSOR (0x0040)
 #define EE_ADDRESS_PRESENCE_BINARY_SENSOR (0x0060)
+#define EE_ADDRESS_REPORT_TEMPERATURE (0x0080)  // See ReportConfig
+#define EE_ADDRESS_REPORT_HUMIDITY (0x00A0)
+#define EE_ADDRESS_REPORT_DISTANCE (0x00C0)
+#define EE_ADDRESS_REPORT_HEIGHT (0x00E0)
 
 /**
  * @brief Detailed EEPROM address map for HeightSensor.
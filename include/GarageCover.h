@@ -13,10 +13,9 @@ class GarageCover final : public IComponent {
  public:
   GarageCover() = delete;
 
-  GarageCover(uint8_t entityId, const char* name, uint8_t pinClosed,
+  GarageCover(const DiscoveryEntityT& entity, uint8_t pinClosed,
               uint8_t pinOpen, uint8_t pinRelay)
-      : mCover{Cover(entityId, name, CoverDeviceClass::GARAGE)},
-
+      : mCover{Cover(entity)},
         mPinClosed{pinClosed},
         mPinOpen{pinOpen},
         mPinRelay{pinRelay} {
@@ -26,6 +25,11 @@ class GarageCover final : public IComponent {
     digitalWrite(pinRelay, LOW);
   }
 
+  static constexpr DiscoveryEntityT makeEntity(uint8_t entityId,
+                                               const char* name) {
+    return Cover::makeEntity(entityId, name, CoverDeviceClass::GARAGE);
+  }
+
   void callService(uint8_t service) final;
 
   void loadConfigValues() final {};
@@ -48,7 +52,10 @@ class GarageCover final : public IComponent {
     return mCover.printTo(p, service);
   };
 
-  void setReported() final { mCover.setReported(); }
+  void setReported(ReportReason reason) final {
+    (void)reason;
+    mCover.setReported();
+  }
 
   bool update() final;
 
@@ -7,6 +7,7 @@
 #include "EeAdressMap.h"
 #include "NewPing.h"
 #include "PersistentNumberComponent.h"
+#include "ReportPolicy.h"
 #include "Sensor.h"
 #include "Unit.h"
 #include "Util.h"
@@ -22,15 +23,21 @@ class HeightSensor : public IComponent {
  public:
   HeightSensor() = delete;
 
-  HeightSensor(uint8_t entityId, const char* name,
-               Sensor<DistanceT>& distanceSensor,
+  HeightSensor(const DiscoveryEntityT& entity, DistanceSensor& distanceSensor,
                PersistentNumberComponent<uint16_t>& stableTime,
-               PersistentNumberComponent<HeightT>& zeroValue)
-      : mSensor{Sensor<HeightT>(entityId, name, SensorDeviceClass::DISTANCE,
-                                Unit::Type::cm)},
+               PersistentNumberComponent<HeightT>& zeroValue,
+               const ReportConfig& reportConfig)
+      : mSensor{Sensor<HeightT>(entity)},
         mDistanceSensor{distanceSensor},
         mStableTime{stableTime},
-        mZeroValue{zeroValue} {}
+        mZeroValue{zeroValue},
+        mReportPolicy{ReportPolicy<HeightT>(reportConfig)} {}
+
+  static constexpr DiscoveryEntityT makeEntity(uint8_t entityId,
+                                               const char* name) {
+    return Sensor<HeightT>::makeEntity(
+        entityId, name, SensorDeviceClass::DISTANCE, Unit::Type::cm);
+  }
 
   void callService(uint8_t service) final { (void)service; }
 
@@ -60,13 +67,34 @@ class HeightSensor : public IComponent {
     return 0;
   };
 
-  void setReported() final { mSensor.setReported(); }
+  void setReported(ReportReason reason) final {
+    mReportPolicy.setReported(reason, mSensor.timeSinceLastReport());
+    mSensor.setReported();
+  }
 
   bool update() final;
 
+  // Recalculated when the distance or zero value changes, otherwise only to
+  // check if the periodic report is due, or a change held back by the report
+  // policy may be reported.
+  uint32_t getUpdateInterval() const final {
+    const uint32_t heldBackTime = mReportPolicy.getHeldBackTime();
+    if (heldBackTime != 0) {
+      return heldBackTime;
+    }
+
+    const uint32_t maxInterval = mReportPolicy.getMaxInterval();
+    return maxInterval != 0
+               ? maxInterval
+               : HeightSensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT * 1000UL;
+  }
+
+  const IComponent* getUpstream(uint8_t idx) const final;
+
  private:
   Sensor<HeightT> mSensor;
-  Sensor<DistanceT>& mDistanceSensor;
+  DistanceSensor& mDistanceSensor;
   PersistentNumberComponent<uint16_t>& mStableTime;
   PersistentNumberComponent<HeightT>& mZeroValue;
+  ReportPolicy<HeightT> mReportPolicy;
 };
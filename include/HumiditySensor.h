@@ -5,6 +5,7 @@
 #include "AHTReader.h"
 #include "Component.h"
 #include "Number.h"
+#include "ReportPolicy.h"
 #include "Sensor.h"
 #include "Util.h"
 
@@ -13,7 +14,6 @@ using HumidityT = uint8_t;  // %
 namespace HumiditySensorConstants {
 static const HumidityT CONFIG_REPORT_HYSTERESIS_DEFAULT = 10;
 static const uint16_t CONFIG_MEASURE_INTERVAL_DEFAULT = 60;
-static const uint16_t CONFIG_REPORT_INTERVAL_DEFAULT = 300;
 static const int8_t CONFIG_COMPENSATION_DEFAULT = 0;
 }  // namespace HumiditySensorConstants
 
@@ -21,10 +21,18 @@ class HumiditySensor : public IComponent {
  public:
   HumiditySensor() = delete;
 
-  HumiditySensor(uint8_t entityId, const char* name, AHTReader& ahtReader)
-      : mSensor{Sensor<HumidityT>(entityId, name, SensorDeviceClass::HUMIDITY,
-                                  Unit::Type::percent, 0, 0, 0, 100)},
-        mAhtReader{ahtReader} {}
+  HumiditySensor(const DiscoveryEntityT& entity, AHTReader& ahtReader,
+                 const ReportConfig& reportConfig)
+      : mSensor{Sensor<HumidityT>(entity)},
+        mAhtReader{ahtReader},
+        mReportPolicy{ReportPolicy<HumidityT>(reportConfig)} {}
+
+  static constexpr DiscoveryEntityT makeEntity(uint8_t entityId,
+                                               const char* name) {
+    return Sensor<HumidityT>::makeEntity(entityId, name,
+                                         SensorDeviceClass::HUMIDITY,
+                                         Unit::Type::percent, 0, 0, 100);
+  }
 
   void callService(uint8_t service) final { (void)service; }
 
@@ -50,11 +58,19 @@ class HumiditySensor : public IComponent {
     return 0;
   };
 
-  void setReported() final { mSensor.setReported(); }
+  void setReported(ReportReason reason) final {
+    mReportPolicy.setReported(reason, mSensor.timeSinceLastReport());
+    mSensor.setReported();
+  }
 
   bool update() final;
 
+  uint32_t getUpdateInterval() const final {
+    return HumiditySensorConstants::CONFIG_MEASURE_INTERVAL_DEFAULT * 1000UL;
+  }
+
  private:
   Sensor<HumidityT> mSensor;
   AHTReader& mAhtReader;
+  ReportPolicy<HumidityT> mReportPolicy;
 };
@@ -7,8 +7,8 @@
  *   Byte 3:    flags
  *     Bit 7:     Acknowledge response
  *     Bit 6:     Acknowledge request
- *     Bit 5:     Reserved for future use
- *     Bit 4:     Reserved for future use
+ *     Bit 5:     Compact values, see value message
+ *     Bit 4:     Bitmap values, see value message
  *     Bit 3-0:   Message type
  *       0:     ping_req
  *       1:     ping_msg
@@ -18,7 +18,9 @@
  *       5:     value_msg
  *       6:     valueSet_req
  *       7:     service_req
- *       8-15:  Reserved for future message types
+ *       8:     discovery_batch_msg
+ *       9:     announce_msg
+ *       10-15: Reserved for future message types
  *
  * Payloads:
  *   Ping request:
@@ -29,6 +31,8 @@
  *
  *   Discovery request:
  *     Byte 0:     EntityId (0-254, 255 means all entities)
+ *     Byte 1-4:   Optional, discovery schema hash cached by the gateway in big
+ *                 endian (4 bytes). Nothing is sent if it matches the node's.
  *
  *   Discovery message:
  *     Byte 0:      Entity Id (0-254)
@@ -48,6 +52,23 @@
  *       Bit 3-2:  Size (0=1 byte, 1=2 bytes or 2=4 bytes)
  *       Bit 1-0:  Precision (Number of decimals 0-3)
  *
+ *   Discovery batch message:
+ *     Byte 0-3:    Discovery schema hash in big endian (4 bytes)
+ *     Byte 4:      Total number of entities of the node
+ *     Byte 5:      Number of entities in this message
+ *     Byte 6-m:    Array of compact discovery entities, see CompactDiscovery.h
+ *
+ *     As many entities as fit are sent in each message, in component order.
+ *
+ *   Announce message:
+ *     Byte 0-3:    Discovery schema hash in big endian (4 bytes)
+ *     Byte 4:      Total number of entities of the node
+ *     Byte 5-6:    RX window period in s in big endian (2 bytes), 0 means
+ *                  continuous receive
+ *
+ *     Sent at startup instead of discovery. A gateway that has no entities
+ *     cached for the node, or a different hash, sends a discovery request.
+ *
  *   Value request:
  *     Byte 0:    Entity Id (0-254, 255 means all entities)
  *
@@ -59,6 +80,26 @@
  *       Byte 1:    Entity Id (0-254)
  *       Byte 2-5:  Value in big endian (4 bytes)
  *
+ *     With the compact values flag set, the value items are compact value
+ *     items instead, see CompactValue.h. The gateway sets the flag in its
+ *     requests when it can decode them, the node then sends compact values
+ *     until a request comes without the flag.
+ *
+ *     With the bitmap values flag set, which entities follow is given by a
+ *     bitmap instead of an entity id in each item. The gateway sets the flag
+ *     the same way as the compact values flag. The node uses it when it makes
+ *     the message shorter, e.g. when most entities are reported at once.
+ *       Byte 0:      First Entity Id
+ *       Byte 1:      Bitmap length n in bytes (1-32)
+ *       Byte 2-n+1:  Bitmap, bit i%8 of byte i/8 set if Entity Id first+i
+ *                    follows
+ *       Byte n+2-m:  Values in Entity Id order, 4 bytes big endian each
+ *
+ *     With both flags set, the values are compact values without the mode
+ *     and entity id byte. A mode byte comes before each group of four values,
+ *     bit 1-0 is the mode of the first value in the group, bit 3-2 of the
+ *     second and so on.
+ *
  *   Value set request:
  *     Byte 0:    Number of entities
  *     Byte 1-m:  Array of value items
@@ -71,6 +112,13 @@
  *     Byte 0:    EntityId (0-254)
  *     Byte 1:    Service
  *
+ * RX windows:
+ *   With an RX window period the node only receives in RX windows of
+ *   LORA_RX_WINDOW_MS. One opens when an uplink has been sent and then once
+ *   per period, counted from the end of the last uplink. The gateway holds
+ *   downlinks until the next window. A received frame keeps the window open
+ *   for another LORA_RX_WINDOW_MS.
+ *
  * For encrypted messages, header byte 0-2 (dst, src and id) are sent in plain text
  * while byte 3-5 and whole payload is encrypted.
  */
@@ -83,27 +131,61 @@
 #include <Stream.h>
 
 #include "AirTime.h"
+#include "CompactDiscovery.h"
+#include "CompactValue.h"
+#include "Log.h"
+#include "LoRaRxQueue.h"
+#include "TimeOnAir.h"
 #include "Types.h"
 #include "Util.h"
+#include "ValueItemQueue.h"
 
-#define DEBUG_LORA_MESSAGE
 // #define LORA_DRY_RUN
 
 #define LORA_FREQUENCY 868e6
+#define LORA_SPREADING_FACTOR 7
+#define LORA_SIGNAL_BANDWIDTH 125000UL
+#define LORA_CODING_RATE4 5  // Coding rate 4/5
+#define LORA_PREAMBLE_LENGTH 8
+#define LORA_CRC_ENABLED 0
 #define LORA_MAX_MESSAGE_LENGTH 150
 
+#define LORA_RX_QUEUE_SLOTS 2  // Power of two
+#define LORA_VALUE_QUEUE_SIZE 40  // A value of each component, see Device.h
+#define LORA_COMPACT_VALUE_ENTITIES 40  // Each component, see Device.h
+
 #define LORA_HEADER_LENGTH 4
 #define LORA_MAX_PAYLOAD_LENGTH (LORA_MAX_MESSAGE_LENGTH - LORA_HEADER_LENGTH)
 
+// Longest downlink payload, a service request as the gateway sends it. A
+// discovery request with hash and a value set request take 5. RX slots are
+// sized to it, so the RX queue takes LORA_RX_QUEUE_SLOTS * (3 + 10) + 2 = 28
+// bytes of RAM on AVR. Longer frames, e.g. uplinks of other nodes, are
+// dropped.
+#define LORA_MAX_RX_PAYLOAD_LENGTH 6
+#define LORA_MAX_RX_MESSAGE_LENGTH \
+  (LORA_HEADER_LENGTH + LORA_MAX_RX_PAYLOAD_LENGTH)
+
 #define FLAGS_ACK_MASK 0x80
 #define FLAGS_ACK_SHIFT 7
 #define FLAGS_REQ_ACK_MASK 0x40
 #define FLAGS_REQ_ACK_SHIFT 6
+#define FLAGS_COMPACT_VALUES_MASK 0x20
+#define FLAGS_COMPACT_VALUES_SHIFT 5
+#define FLAGS_BITMAP_VALUES_MASK 0x10
+#define FLAGS_BITMAP_VALUES_SHIFT 4
 #define FLAGS_MSG_TYPE_MASK 0x0F
 #define FLAGS_MSG_TYPE_SHIFT 0
 
+// Longest time to wait for the TX done interrupt before giving up on it.
+#define LORA_TX_TIMEOUT_MS 6000
+
+#define LORA_RX_WINDOW_MS 1000  // Length of RX windows, see setRxPeriod()
+
 #define AIRTIME_LIMIT_PERCENT 1
 #define AIRTIME_LIMIT_PPM (AIRTIME_LIMIT_PERCENT * 10000)
+#define AIRTIME_BUCKET_MS 10000  // Must divide an hour evenly
+#define AIRTIME_BUCKETS 32       // Max buckets with airtime within an hour
 
 enum class LoRaMsgType : uint8_t {
   ping_req,
@@ -113,17 +195,27 @@ enum class LoRaMsgType : uint8_t {
   value_req,
   value_msg,
   valueSet_req,
-  service_req
+  service_req,
+  discovery_batch_msg,
+  announce_msg
 };
 
+enum class LoRaTxState : uint8_t { idle, queued, transmitting, done };
+
+enum class LoRaRadioState : uint8_t { sleep, standby, rx };
+
 struct LoRaHeaderFlagsT {
   bool ack_response{false};
   bool ack_request{false};
+  bool compact_values{false};
+  bool bitmap_values{false};
   LoRaMsgType msgType{LoRaMsgType::ping_req};
 
   uint8_t fromByte(const uint8_t b) {
     ack_response = (b & FLAGS_ACK_MASK) != 0;
     ack_request = (b & FLAGS_REQ_ACK_MASK) != 0;
+    compact_values = (b & FLAGS_COMPACT_VALUES_MASK) != 0;
+    bitmap_values = (b & FLAGS_BITMAP_VALUES_MASK) != 0;
     msgType = static_cast<LoRaMsgType>(b & FLAGS_MSG_TYPE_MASK);
     return 1;
   }
@@ -131,6 +223,8 @@ struct LoRaHeaderFlagsT {
   uint8_t toByte(uint8_t* b) const {
     uint8_t lb = (ack_response << FLAGS_ACK_SHIFT);
     lb |= (ack_request << FLAGS_REQ_ACK_SHIFT);
+    lb |= (compact_values << FLAGS_COMPACT_VALUES_SHIFT);
+    lb |= (bitmap_values << FLAGS_BITMAP_VALUES_SHIFT);
     lb |= (static_cast<uint8_t>(msgType) << FLAGS_MSG_TYPE_SHIFT);
     *b = lb;
     return 1;
@@ -181,11 +275,22 @@ struct LoRaValuePayloadT {
   ValueItemT valueItems[(LORA_MAX_PAYLOAD_LENGTH - sizeof(numberOfEntities)) /
                         ValueItemT::size()];
 
+  static constexpr uint8_t BITMAP_HEADER_LENGTH = 2;  // First id and length
+
   size_t size() const {
     return sizeof(numberOfEntities) + ValueItemT::size() * numberOfEntities;
   }
 
-  size_t toByteArray(uint8_t* buf, size_t length) const {
+  /**
+   * @param bitmap Bitmap addressed values, items must be in ascending entity
+   * id order.
+   * @return Number of bytes written, 0 if it doesn't fit in length.
+   */
+  size_t toByteArray(uint8_t* buf, size_t length, bool bitmap = false) const {
+    if (bitmap) {
+      return toBitmapByteArray(buf, length);
+    }
+
     if (length < size()) {
       return 0;
     }
@@ -200,7 +305,16 @@ struct LoRaValuePayloadT {
     return n;
   }
 
-  uint8_t fromByteArray(const uint8_t* buf, size_t length) {
+  /**
+   * @param bitmap Bitmap addressed values.
+   * @return Number of bytes read, 0 on error.
+   */
+  uint8_t fromByteArray(const uint8_t* buf, size_t length,
+                        bool bitmap = false) {
+    if (bitmap) {
+      return fromBitmapByteArray(buf, length);
+    }
+
     if (length < 1 + buf[0] * ValueItemT::size()) {
       return 0;
     }
@@ -213,6 +327,76 @@ struct LoRaValuePayloadT {
     }
     return n;
   }
+
+ private:
+  size_t toBitmapByteArray(uint8_t* buf, size_t length) const {
+    const uint8_t first = numberOfEntities > 0 ? valueItems[0].entityId : 0;
+    const uint8_t last =
+        numberOfEntities > 0 ? valueItems[numberOfEntities - 1].entityId : 0;
+    const uint8_t bitmapLength = (last - first) / 8 + 1;
+
+    size_t n = BITMAP_HEADER_LENGTH + bitmapLength;
+    if (length < n + numberOfEntities * sizeof(uint32_t)) {
+      return 0;
+    }
+
+    buf[0] = first;
+    buf[1] = bitmapLength;
+    memset(&buf[BITMAP_HEADER_LENGTH], 0, bitmapLength);
+
+    for (uint8_t i = 0; i < numberOfEntities; i++) {
+      const ValueItemT& item = valueItems[i];
+      if (item.entityId < first || item.entityId > last ||
+          (i > 0 && item.entityId <= valueItems[i - 1].entityId)) {
+        return 0;
+      }
+
+      const uint8_t bit = item.entityId - first;
+      buf[BITMAP_HEADER_LENGTH + bit / 8] |= 1 << (bit % 8);
+      *(reinterpret_cast<uint32_t*>(&buf[n])) = hton(item.value);
+      n += sizeof(uint32_t);
+    }
+
+    return n;
+  }
+
+  uint8_t fromBitmapByteArray(const uint8_t* buf, size_t length) {
+    if (length < BITMAP_HEADER_LENGTH) {
+      return 0;
+    }
+
+    const uint8_t first = buf[0];
+    const uint8_t bitmapLength = buf[1];
+    if (bitmapLength == 0 ||
+        length < static_cast<size_t>(BITMAP_HEADER_LENGTH + bitmapLength)) {
+      return 0;
+    }
+
+    const uint8_t maxItems = sizeof(valueItems) / sizeof(valueItems[0]);
+    size_t n = BITMAP_HEADER_LENGTH + bitmapLength;
+    uint8_t count = 0;
+
+    for (uint16_t bit = 0; bit < 8U * bitmapLength; bit++) {
+      if ((buf[BITMAP_HEADER_LENGTH + bit / 8] & (1 << (bit % 8))) == 0) {
+        continue;
+      }
+
+      // Entity Id 255 means all entities and is never sent.
+      if (first + bit >= UINT8_MAX || count == maxItems ||
+          length < n + sizeof(uint32_t)) {
+        return 0;
+      }
+
+      valueItems[count].entityId = static_cast<uint8_t>(first + bit);
+      valueItems[count].value =
+          ntoh(*(reinterpret_cast<const uint32_t*>(&buf[n])));
+      n += sizeof(uint32_t);
+      count++;
+    }
+
+    numberOfEntities = count;
+    return n;
+  }
 };
 
 struct LoRaServiceItemT {
@@ -249,20 +433,208 @@ class LoRaHandler {
                 OnValueSetReqMsgFunc onValueSetReqMsgFunc = nullptr,
                 OnServiceReqMsgFunc onServiceReqMsgFunc = nullptr);
 
+  /**
+   * @brief Switch to interrupt driven receive.
+   * The radio is put in continuous receive mode and each frame is copied into
+   * a free slot of the RX queue from the DIO0 interrupt. loraRx() then only
+   * has work to do when a complete frame has been queued.
+   */
+  void enableRxInterrupt();
+
+  /**
+   * @brief Handle one received frame, if any.
+   * In interrupt mode the oldest queued frame is handled, otherwise the radio
+   * is polled.
+   * @return Size of handled frame, 0 if there was none or -1 on error.
+   */
   int16_t loraRx();
 
+  /**
+   * @brief Copy a received frame from the radio into the RX queue.
+   * Called from the DIO0 interrupt. Frames longer than
+   * LORA_MAX_RX_MESSAGE_LENGTH are dropped.
+   * @param packetSize Size of the received frame.
+   */
+  void handleRxIrq(int packetSize);
+
+  uint8_t getRxDropCount() const { return mRxDropCount; }
+
+  /**
+   * @brief Drive the transmit state machine, call from loop().
+   * idle -> queued -> transmitting -> done -> idle. A queued frame is handed
+   * to the radio without waiting for it to go out. Completion is signalled by
+   * the TX done interrupt and the airtime is accounted for here.
+   */
+  void updateTx();
+
+  /**
+   * @brief Block until all frames have been transmitted.
+   */
+  void flushTx();
+
+  /**
+   * @brief Record the end of a transmission.
+   * Called from the DIO0 interrupt.
+   */
+  void handleTxDoneIrq();
+
+  LoRaTxState getTxState() const { return mTxState; }
+
+  /**
+   * @brief Set the state of the radio when it is not transmitting.
+   * Applied now if the radio is idle, otherwise when the transmission is done.
+   * A sleeping radio is woken up to transmit.
+   * @param state sleep, standby or rx (continuous receive).
+   */
+  void setRadioState(LoRaRadioState state);
+
+  LoRaRadioState getRadioState() const { return mRadioState; }
+
+  /**
+   * @brief Check if there is radio work in progress.
+   * @return true if transmitting, or a frame is waiting to be sent or handled.
+   */
+  bool isBusy() const {
+    return mTxState != LoRaTxState::idle || mTxLength != 0 ||
+           !mRxQueue.isEmpty();
+  }
+
+  /**
+   * @brief Receive in RX windows only, see the protocol description.
+   * Needs interrupt driven receive. The radio sleeps between the windows and
+   * the period is sent to the gateway in the announce message.
+   * @param period_s RX window period in s, 0 for continuous receive.
+   */
+  void setRxPeriod(uint16_t period_s);
+
+  uint16_t getRxPeriod() const { return mRxPeriod_s; }
+
+  /**
+   * @brief Open and close RX windows when due, call from loop().
+   */
+  void updateRxWindow();
+
+  /**
+   * @brief Time until an RX window opens or closes.
+   * @param now Current time in ms.
+   * @return Time in ms, UINT32_MAX with continuous receive.
+   */
+  uint32_t getTimeToNextRxEvent(uint32_t now) const;
+
+  bool isRxWindowOpen() const { return mRxWindowOpen; }
+
+  /**
+   * @brief Queue a value item to be sent in a value message.
+   * A queued value of the same entity is replaced by the newer one. The queue
+   * is sent from updateTx() in as few messages as possible when the radio is
+   * idle and the airtime limit allows it.
+   * @param item Value item to send.
+   * @return true if queued, false if the queue is full.
+   */
+  bool queueValueItem(const ValueItemT& item);
+
+  uint8_t getValueQueueSize() const { return mValueQueue.size(); }
+
+  /**
+   * @brief Register the value format of an entity for compact values.
+   * Entities that aren't registered are sent with their full 4 byte value.
+   * @param entity Discovery entity, isSigned is used.
+   * @return false if there is no room for more entities.
+   */
+  bool registerValueEntity(const DiscoveryEntityT& entity);
+
+  bool isCompactValues() const { return mCompactValues; }
+
+  bool isBitmapValues() const { return mBitmapValues; }
+
   void beginDiscoveryMsg();
   void addDiscoveryEntity(const DiscoveryEntityT& item);
 
+  /**
+   * @brief Set the discovery schema sent in announce and discovery batch
+   * messages.
+   * @param schemaHash Discovery schema hash of all entities of the node.
+   * @param entityCount Total number of entities of the node.
+   */
+  void setDiscoverySchema(uint32_t schemaHash, uint8_t entityCount) {
+    mDiscoveryHash = schemaHash;
+    mDiscoveryEntityCount = entityCount;
+  }
+
+  /**
+   * @brief Announce the discovery schema hash to the gateway.
+   * The gateway requests discovery if it doesn't have the schema cached.
+   */
+  void sendAnnounceMsg();
+
+  void beginDiscoveryBatchMsg();
+
+  /**
+   * @brief Add an entity to the discovery batch message.
+   * @return false if it doesn't fit, send the message and begin a new one.
+   */
+  bool addDiscoveryBatchEntity(const DiscoveryEntityT& entity);
+
   void beginValueMsg();
-  void addValueItem(const ValueItemT& item);
 
-  void endMsg();
+  /**
+   * @brief Begin a value message with bitmap addressed values.
+   * Items must then be added in ascending entity id order and within the
+   * range. Unused bitmap bytes at the end are removed by endMsg().
+   * @param firstEntityId Lowest entity id in the message.
+   * @param lastEntityId Highest entity id in the message.
+   */
+  void beginBitmapValueMsg(uint8_t firstEntityId, uint8_t lastEntityId);
+
+  /**
+   * @brief Add a value item to the value message.
+   * @return false if it doesn't fit, or for a bitmap value message, if it is
+   * out of range or order.
+   */
+  bool addValueItem(const ValueItemT& item);
+
+  /**
+   * @brief Check if the message built since the last begin...Msg() fits in
+   * what is left of the airtime budget.
+   */
+  bool isRoomForMsg() {
+    return mAirTime.isRoomFor(
+        getTimeOnAir_ms(LORA_HEADER_LENGTH + mTxPayloadLength));
+  }
+
+  /**
+   * @brief Send the message built since the last begin...Msg().
+   * @return false if it was dropped, the airtime budget has no room for it.
+   */
+  bool endMsg();
 
   void setDefaultHeader(LoRaHeaderT& header);
 
+  /**
+   * @brief Time on air of a frame with the configured radio settings.
+   * @param length Frame length in bytes, header included.
+   * @return Time on air in µs.
+   */
+  static constexpr uint32_t getTimeOnAir_us(uint8_t length) {
+    return TimeOnAir::getTime_us(length, LORA_SPREADING_FACTOR,
+                                 LORA_SIGNAL_BANDWIDTH, LORA_CODING_RATE4,
+                                 LORA_PREAMBLE_LENGTH, LORA_CRC_ENABLED);
+  }
+
+  static constexpr uint32_t getTimeOnAir_ms(uint8_t length) {
+    return TimeOnAir::toMs(getTimeOnAir_us(length));
+  }
+
  private:
-  void printMessage(const LoRaTxMessageT& msg);
+#if LOG_ENABLED(LORA, DEBUG)
+  void printMessage();
+#endif
+
+  static void onReceiveIsr(int packetSize);
+  static void onTxDoneIsr();
+
+  int16_t readPacket(int16_t packetSize);
+  int16_t handleFrame(uint8_t* buf, uint8_t length, int16_t rssi);
 
   int8_t parseMsg(const LoRaRxMessageT& rxMsg, uint8_t* payload);
 
@@ -274,8 +646,32 @@ class LoRaHandler {
     return rxHeader.flags.ack_response != 0;
   }
 
+  /**
+   * @brief Start building a frame in place in mBuffer.
+   * A frame still waiting for the radio there is transmitted first.
+   */
+  void beginFrame();
+
+  uint8_t* getTxPayload() { return &mBuffer[LORA_HEADER_LENGTH]; }
+
   void sendAck(const LoRaHeaderT& rx_header);
-  void sendMsg(const LoRaTxMessageT& msg);
+
+  /**
+   * @brief Send the frame built in mBuffer, with mTxHeader as header.
+   * The header is written and the frame encrypted in place.
+   * @return false if it was dropped, the airtime budget has no room for it.
+   */
+  bool sendMsg();
+  void startTx();
+  void finishTx();
+  void applyRadioState();
+  void openRxWindow(uint32_t now);
+  void sendValueQueue();
+  bool isBitmapShorter(uint8_t firstEntityId, uint8_t lastEntityId,
+                       uint8_t count) const;
+  size_t addBitmapValue(const ValueItemT& item, uint8_t* buf, size_t length);
+  void trimValueBitmap();
+  void setCompactValues(bool compactValues);
   void sendPing(const uint8_t toAddr, int16_t rssi);
 
   LoRaClass& mLoRa;
@@ -284,9 +680,36 @@ class LoRaHandler {
   Cipher* mCipher;
   uint8_t mMsgIdUp{};
   uint8_t mMsgIdDown{};
-  LoRaTxMessageT mMsgTx{};
-  uint8_t mBuffer[LORA_MAX_MESSAGE_LENGTH]{};  // Shared buffer for RX and TX
-  AirTime mAirTime{AirTime(AIRTIME_LIMIT_PPM)};
+  LoRaHeaderT mTxHeader{};      // Of the frame being built
+  uint8_t mTxPayloadLength{};  // Of the frame being built
+  uint8_t mBuffer[LORA_MAX_MESSAGE_LENGTH]{};  // The only TX frame buffer
+  AirTime<AIRTIME_BUCKETS> mAirTime{AIRTIME_LIMIT_PPM, AIRTIME_BUCKET_MS};
+  LoRaRxQueue<LORA_RX_QUEUE_SLOTS, LORA_MAX_RX_MESSAGE_LENGTH> mRxQueue;
+  volatile uint8_t mRxDropCount{};
+  uint8_t mRxDropCountLogged{};  // mRxDropCount when last logged
+  bool mRxIrqEnabled{false};
+  LoRaRadioState mRadioState{LoRaRadioState::standby};
+  uint16_t mRxPeriod_s{};  // 0 for continuous receive
+  bool mRxWindowOpen{false};
+  uint32_t mRxWindowEnd{};  // ms
+  uint32_t mNextRxWindow{};  // ms
+  LoRaTxState mTxState{LoRaTxState::idle};
+  uint8_t mTxLength{};  // Length of frame waiting in mBuffer, 0 if none
+  uint32_t mTxStartTime{};
+  uint16_t mTxTimeOnAir_ms{};  // Estimated time on air of current frame
+  volatile uint32_t mTxEndTime{};
+  volatile bool mTxDone{false};
+  ValueItemQueue<LORA_VALUE_QUEUE_SIZE> mValueQueue;
+  CompactValueEncoder<LORA_COMPACT_VALUE_ENTITIES> mValueEncoder;
+  bool mCompactValues{false};  // Negotiated with gateway
+  bool mBitmapValues{false};   // Negotiated with gateway
+  uint32_t mDiscoveryHash{};
+  uint8_t mDiscoveryEntityCount{};
+  uint8_t mBitmapCount{};      // Values in bitmap value message
+  uint8_t mBitmapLastId{};     // Entity id of last value in bitmap message
+  uint8_t mBitmapModeIndex{};  // Payload index of current compact mode byte
+
+  static LoRaHandler* sInstance;  // Target of the static interrupt handlers
 
   OnDiscoveryReqMsgFunc mOnDiscoveryReqMsgFunc{nullptr};
   OnValueReqMsgFunc mOnValueReqMsgFunc{nullptr};
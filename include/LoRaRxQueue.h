@@ -0,0 +1,121 @@
+#pragma once
+
+#include <stdint.h>
+
+// Compiler barrier, keeps slot contents and index updates in program order.
+#define LORA_RX_QUEUE_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+/**
+ * @brief A fixed-size slot holding one received LoRa frame.
+ * @tparam SlotSize Maximum frame length in bytes.
+ */
+template <uint8_t SlotSize>
+struct LoRaRxSlotT {
+  uint8_t length;
+  int16_t rssi;
+  uint8_t buf[SlotSize];
+};
+
+/**
+ * @brief Single-producer/single-consumer queue of received LoRa frames.
+ *
+ * The producer is the DIO0 receive interrupt. It claims a free slot with
+ * getWriteSlot(), fills it and hands it over with commit(). The consumer is the
+ * main loop. It gets the oldest frame with getReadSlot() and frees the slot
+ * with release(). Head and tail are single bytes which are read and written
+ * atomically on AVR, so no interrupt locking is needed.
+ *
+ * RAM use is N * (SlotSize + 3) + 2 bytes on AVR, size the slots to the
+ * longest frame that is accepted.
+ *
+ * @tparam N Number of slots, must be a power of two.
+ * @tparam SlotSize Maximum frame length in bytes.
+ */
+template <uint8_t N, uint8_t SlotSize>
+class LoRaRxQueue {
+ public:
+  static_assert(N > 0 && (N & (N - 1)) == 0,
+                "LoRaRxQueue<N>: N must be a power of two");
+
+  using Slot = LoRaRxSlotT<SlotSize>;
+
+  /**
+   * @brief Checks the capacity of the queue.
+   *
+   * @return uint8_t max number of frames the queue can hold.
+   */
+  constexpr uint8_t capacity() const { return N; }
+
+  /**
+   * @brief Checks the number of frames in the queue.
+   *
+   * @return uint8_t number of frames in the queue.
+   */
+  uint8_t size() const { return static_cast<uint8_t>(mHead - mTail); }
+
+  /**
+   * @brief Checks if the queue is empty.
+   *
+   * @return true if queue is empty.
+   * @return false if queue isn't empty.
+   */
+  bool isEmpty() const { return mHead == mTail; }
+
+  /**
+   * @brief Checks if the queue is full.
+   *
+   * @return true if queue is full.
+   * @return false if queue isn't full.
+   */
+  bool isFull() const { return size() == N; }
+
+  /**
+   * @brief Gets the slot to fill with the next received frame.
+   * Only to be called by the producer.
+   *
+   * @return Slot* free slot or nullptr if the queue is full.
+   */
+  Slot* getWriteSlot() {
+    if (isFull()) {
+      return nullptr;
+    }
+    return &mSlots[mHead & (N - 1)];
+  }
+
+  /**
+   * @brief Hands over the slot from getWriteSlot() to the consumer.
+   * Only to be called by the producer.
+   */
+  void commit() {
+    LORA_RX_QUEUE_BARRIER();
+    mHead = mHead + 1;
+  }
+
+  /**
+   * @brief Gets the oldest received frame.
+   * Only to be called by the consumer.
+   *
+   * @return Slot* oldest frame or nullptr if the queue is empty.
+   */
+  Slot* getReadSlot() {
+    if (isEmpty()) {
+      return nullptr;
+    }
+    LORA_RX_QUEUE_BARRIER();
+    return &mSlots[mTail & (N - 1)];
+  }
+
+  /**
+   * @brief Frees the slot from getReadSlot() for the producer to reuse.
+   * Only to be called by the consumer.
+   */
+  void release() {
+    LORA_RX_QUEUE_BARRIER();
+    mTail = mTail + 1;
+  }
+
+ private:
+  Slot mSlots[N]{};
+  volatile uint8_t mHead{};
+  volatile uint8_t mTail{};
+};
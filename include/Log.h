@@ -0,0 +1,72 @@
+#pragma once
+
+#include <Print.h>
+#include <stdint.h>
+
+/*
+ * Log levels. A module logs the messages at or below its level, the others
+ * are removed by the preprocessor and cost no flash and no cycles.
+ *
+ * LOG_LEVEL is the level of all modules, LOG_LEVEL_<MODULE> overrides it for
+ * one module, e.g. -D LOG_LEVEL=LOG_LEVEL_WARN -D LOG_LEVEL_LORA=LOG_LEVEL_DEBUG
+ * The default is LOG_LEVEL_INFO, the native test and sim builds log at
+ * LOG_LEVEL_DEBUG.
+ *
+ * Usage:
+ *   #if LOG_ENABLED(LORA, DEBUG)
+ *     printMillis(Log);
+ *     Log.println(F("..."));
+ *   #endif
+ */
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// Modules
+#ifndef LOG_LEVEL_LORA  // LoRaHandler
+#define LOG_LEVEL_LORA LOG_LEVEL
+#endif
+
+#ifndef LOG_LEVEL_MAIN  // main.cpp
+#define LOG_LEVEL_MAIN LOG_LEVEL
+#endif
+
+#define LOG_ENABLED(module, level) (LOG_LEVEL_##module >= LOG_LEVEL_##level)
+
+/**
+ * @brief Print for log messages, Log, writes to Serial.
+ *
+ * With -D LOG_NON_BLOCKING a byte is only written when there is room for it
+ * in the TX ring buffer of Serial, which the UART interrupt drains in the
+ * background. Logging then never waits for the UART. When the buffer is full
+ * the rest of the line is dropped, a "~" ends it when there is room again.
+ * The TX buffer is 64 bytes, -D SERIAL_TX_BUFFER_SIZE=128 drops less.
+ *
+ * Without it writes wait for room like Serial does.
+ */
+class Logger : public Print {
+ public:
+  explicit Logger(Print& out) : mOut{out} {}
+
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+
+  /**
+   * @brief Number of lines cut short since start, wraps around.
+   */
+  uint16_t getDropCount() const { return mDropCount; }
+
+ private:
+  Print& mOut;
+  bool mIsDropping{};
+  bool mIsDropped{};  // Last line cut short, not marked yet
+  uint16_t mDropCount{};
+};
+
+extern Logger Log;
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief Free RAM and stack high water mark of the MCU.
+ *
+ * begin() paints the free RAM between the heap and the stack with a pattern.
+ * The stack overwrites the pattern as it grows down, so the painted bytes left
+ * at the bottom of the region are the least free RAM there has been since.
+ * The firmware doesn't use the heap, an allocation would also overwrite the
+ * pattern and count as used.
+ *
+ * On the host there is no stack to watch, the region is a buffer given to
+ * begin() by tests.
+ */
+class MemoryMonitor {
+ public:
+  static constexpr uint8_t PAINT = 0xC5;
+  static constexpr uint8_t STACK_MARGIN = 32;  // Left below the stack pointer
+
+  /**
+   * @brief Paint the free RAM, call first in setup().
+   */
+  void begin();
+
+  /**
+   * @brief Paint a region instead of the free RAM.
+   * @param start Lowest address, where the stack would end.
+   * @param end One past the highest address.
+   */
+  void begin(uint8_t* start, uint8_t* end);
+
+  /**
+   * @brief Free RAM now, between the heap and the stack pointer.
+   * @return Bytes, the region size on the host.
+   */
+  uint16_t getFreeRam() const;
+
+  /**
+   * @brief Least free RAM since begin(), painted bytes left.
+   * Scans the bytes that were painted at the last call.
+   * @return Bytes.
+   */
+  uint16_t getMinFreeRam();
+
+ private:
+  uint8_t* mStart{};
+  uint8_t* mEnd{};
+  uint16_t mMinFree{};
+};
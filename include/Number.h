@@ -1,7 +1,5 @@
 #pragma once
 
-#include <Printable.h>
-
 #include "BaseComponent.h"
 #include "Types.h"
 #include "Unit.h"
@@ -87,40 +85,39 @@ enum class NumberDeviceClass : uint8_t {
 };
 
 template <class T>
-class Number : public Printable {
+class Number {
  public:
   Number() = delete;
 
-  explicit Number(uint8_t entityId) : mBaseComponent{BaseComponent(entityId)} {}
-
-  Number(uint8_t entityId, const char* name,
-         NumberDeviceClass deviceClass = NumberDeviceClass::NONE,
-         Unit::Type unitType = Unit::Type::none, uint8_t precision = 0,
-         BaseComponent::Category category = BaseComponent::Category::NONE,
-         T value = T{}, T min_value = T{}, T max_value = T{})
-      : mBaseComponent{BaseComponent(entityId, name, category)},
-        mDeviceClass{deviceClass},
-        mValueItem{
-            ValueItem<T>(unitType, precision, value, min_value, max_value)} {}
+  /**
+   * @param entity Metadata of the entity, in flash (PROGMEM), see makeEntity().
+   */
+  explicit Number(const DiscoveryEntityT& entity, T value = T{})
+      : mBaseComponent{BaseComponent(entity)},
+        mValueItem{ValueItem<T>(entity, value)} {}
+
+  static constexpr DiscoveryEntityT makeEntity(
+      uint8_t entityId, const char* name,
+      NumberDeviceClass deviceClass = NumberDeviceClass::NONE,
+      Unit::Type unitType = Unit::Type::none, uint8_t precision = 0,
+      BaseComponent::Category category = BaseComponent::Category::NONE,
+      T min_value = T{}, T max_value = T{}) {
+    return BaseComponent::makeEntity<T>(
+        entityId, name, BaseComponent::Type::NUMBER,
+        static_cast<uint8_t>(deviceClass), category, unitType, precision,
+        min_value, max_value);
+  }
 
   BaseComponent::Type getComponentType() const {
     return BaseComponent::Type::NUMBER;
   }
 
-  NumberDeviceClass getDeviceClass() const { return mDeviceClass; }
+  NumberDeviceClass getDeviceClass() const {
+    return static_cast<NumberDeviceClass>(mBaseComponent.getDeviceClass());
+  }
 
   void getDiscoveryEntity(DiscoveryEntityT& item) const {
-    item.entityId = mBaseComponent.getEntityId();
-    item.componentType = static_cast<uint8_t>(getComponentType());
-    item.deviceClass = static_cast<uint8_t>(getDeviceClass());
-    item.category = static_cast<uint8_t>(mBaseComponent.getCategory());
-    item.unit = static_cast<uint8_t>(mValueItem.getUnit().type());
-    item.precision = mValueItem.getPrecision();
-    item.sizeCode = static_cast<uint8_t>(mValueItem.getValueSize()) / 2;
-    item.isSigned = mValueItem.isSigned();
-    item.minValue = static_cast<uint32_t>(mValueItem.getMinValue());
-    item.maxValue = static_cast<uint32_t>(mValueItem.getMaxValue());
-    item.name = mBaseComponent.getName();
+    mBaseComponent.getDiscoveryEntity(item);
   }
 
   uint8_t getEntityId() const { return mBaseComponent.getEntityId(); }
@@ -140,7 +137,7 @@ class Number : public Printable {
 
   bool isReportDue() const { return mBaseComponent.isReportDue(); }
 
-  size_t printTo(Print& p) const final {
+  size_t printTo(Print& p) const {
     size_t n = 0;
     n += mBaseComponent.printTo(p);
     n += p.print('=');
@@ -160,6 +157,5 @@ class Number : public Printable {
 
  private:
   BaseComponent mBaseComponent;
-  const NumberDeviceClass mDeviceClass{NumberDeviceClass::NONE};
   ValueItem<T> mValueItem;
 };
@@ -11,12 +11,17 @@
  * when values are set, plus manual loading from EEPROM during setup.
  *
  * Usage:
- *   // Create a persistent number with EEPROM address
- *   PersistentNumber<uint16_t> myNumber(0x10, 5, "My Value",
- * NumberDeviceClass::NONE, Unit::Type::none, 0, 0, 1000, 500);
+ *   // Metadata in flash, see Number<T>::makeEntity()
+ *   const DiscoveryEntityT myNumberEntity PROGMEM =
+ *       Number<uint16_t>::makeEntity(5, myNumberName, NumberDeviceClass::NONE,
+ *                                    Unit::Type::none, 0,
+ *                                    BaseComponent::Category::CONFIG, 0, 1000);
+ *
+ *   // Create a persistent number with EEPROM address and default value
+ *   PersistentNumber<uint16_t> myNumber(0x10, myNumberEntity, 500);
  *
  *   // In setup(): load value from EEPROM or use default
- *   myNumber.loadFromEeprom(500);  // default value if not in EEPROM
+ *   myNumber.loadFromEeprom();  // 500 if not in EEPROM
  *
  *   // In main loop: setValue() automatically saves to EEPROM
  *   myNumber.setValue(750);
@@ -29,46 +34,27 @@ class PersistentNumber {
                 "PersistentNumber<T>: T must fit in uint32_t");
 
   /**
-   * @brief Construct persistent number with full parameters
+   * @brief Construct persistent number
    * @param eeAddress EEPROM address where value will be stored
-   * @param entityId Unique entity identifier
-   * @param name Human-readable name
-   * @param deviceClass Number device class (optional)
-   * @param unitType Unit type (optional)
-   * @param precision Decimal precision (0-3)
-   * @param category Component category (optional)
-   * @param value Initial value
-   * @param min_value Minimum allowed value
-   * @param max_value Maximum allowed value
+   * @param entity Metadata of the entity, in flash (PROGMEM), see
+   * Number<T>::makeEntity()
+   * @param value Initial value, also the default if EEPROM load fails
    */
-  PersistentNumber(
-      uint16_t eeAddress, uint8_t entityId, const char* name,
-      NumberDeviceClass deviceClass = NumberDeviceClass::NONE,
-      Unit::Type unitType = Unit::Type::none, uint8_t precision = 0,
-      BaseComponent::Category category = BaseComponent::Category::NONE,
-      T value = T{}, T min_value = T{}, T max_value = T{})
+  PersistentNumber(uint16_t eeAddress, const DiscoveryEntityT& entity,
+                   T value = T{})
       : mEeAddress{eeAddress},
-        mNumber{Number<T>(entityId, name, deviceClass, unitType, precision,
-                          category, value, min_value, max_value)},
+        mNumber{Number<T>(entity, value)},
         mDefaultValue{value} {}
 
-  /**
-   * @brief Construct persistent number with minimal parameters
-   * @param eeAddress EEPROM address where value will be stored
-   * @param entityId Unique entity identifier
-   */
-  PersistentNumber(uint16_t eeAddress, uint8_t entityId)
-      : mEeAddress{eeAddress}, mNumber{Number<T>(entityId)} {}
-
   // ========== EEPROM Operations ==========
 
   /**
    * @brief Load value from EEPROM during setup
-   * @param defaultValue Value to use if EEPROM load fails or CRC mismatch
    * @return LoadStatus indicating success or reason for failure
    *
    * Call this once in setup() to restore persisted values.
-   * If the value in EEPROM is invalid (CRC mismatch), uses defaultValue.
+   * If the value in EEPROM is invalid (CRC mismatch), uses the initial value
+   * given to the constructor and saves it.
    * Returns status information useful for debugging.
    */
   Ee::LoadStatus loadFromEeprom() {
@@ -43,12 +43,18 @@ class PersistentNumberComponent : public IComponent {
     return 0;
   };
 
-  void setReported() final { mPersistentNumber.setReported(); }
+  void setReported(ReportReason reason) final {
+    (void)reason;
+    mPersistentNumber.setReported();
+  }
 
   void setValue(T value) { mPersistentNumber.setValue(value); }
 
   bool update() final { return false; };
 
+  // Nothing to update, the value only changes when set.
+  uint32_t getUpdateInterval() const final { return Util::MS_PER_HOUR; }
+
  private:
   PersistentNumber<T>& mPersistentNumber;
 };
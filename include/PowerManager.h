@@ -0,0 +1,81 @@
+#pragma once
+
+#include <stdint.h>
+
+enum class PowerState : uint8_t { active, idle, powerDown };
+
+/**
+ * @brief Puts the MCU to sleep between scheduled events.
+ *
+ * Idle stops the CPU only. Timers and the DIO0 interrupt keep running and the
+ * next interrupt, at the latest the 1 ms timer tick, wakes it up again. Use it
+ * while the radio is transmitting or receiving, as the edge triggered DIO0
+ * interrupt can't wake up from power-down.
+ *
+ * Power-down stops all clocks. The watchdog timer wakes it up after the sleep
+ * time, in steps of 16 ms to 8 s, and millis() is moved forward by the time
+ * asleep. A change on a wake pin wakes it up early. The time asleep before such
+ * a wake up is unknown, so then millis() falls behind by up to one step.
+ *
+ * The time spent in each state is accounted for, to be reported as diagnostic
+ * entities.
+ */
+class PowerManager {
+ public:
+  static constexpr uint8_t STATE_COUNT = 3;
+  static constexpr uint8_t MIN_POWER_DOWN_MS = 16;  // Shortest watchdog step
+
+  using AddMillisFunc = void (*)(uint32_t ms);
+
+  /**
+   * @brief Enable wake up from power-down on a change of pins.
+   * Uses the pin change interrupts, no other code may use them.
+   * @param pins Digital pin numbers.
+   * @param count Number of pins.
+   */
+  void begin(const uint8_t* pins, uint8_t count);
+
+  /**
+   * @brief Sleep until the next event.
+   * Serial output is flushed before power-down, the UART is stopped.
+   * @param duration_ms Time until the next scheduled event.
+   * @param deepest Deepest state allowed. Power-down falls back to idle when
+   * duration_ms is shorter than a watchdog step.
+   * @return true if woken up by a wake pin, also since the last call.
+   */
+  bool sleep(uint32_t duration_ms, PowerState deepest);
+
+  /**
+   * @brief Get the time spent in a power state since start.
+   * @return Time in s.
+   */
+  uint32_t getTime_s(PowerState state) const {
+    return mTime_s[static_cast<uint8_t>(state)];
+  }
+
+  /**
+   * @brief Record a change of a wake pin.
+   * Called from the pin change interrupts.
+   */
+  static void onWakePinIsr() { sWakePinChanged = true; }
+
+  /**
+   * @brief Set the function that moves millis() forward after a power-down
+   * step. It moves the Arduino core timer on AVR. Native builds have none,
+   * the test or simulator that runs the clock sets it.
+   */
+  static void setAddMillisFunc(AddMillisFunc addMillisFunc) {
+    sAddMillisFunc = addMillisFunc;
+  }
+
+ private:
+  void addTime(PowerState state, uint32_t time_ms);
+  bool takeWakePinChanged();
+
+  uint32_t mLastTime{};  // End of last accounted time, ms
+  uint32_t mTime_s[STATE_COUNT]{};
+  uint16_t mTimeRest_ms[STATE_COUNT]{};  // Not yet a whole second
+
+  static volatile bool sWakePinChanged;
+  static AddMillisFunc sAddMillisFunc;
+};
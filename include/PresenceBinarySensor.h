@@ -16,18 +16,23 @@ class PresenceBinarySensor : public IComponent {
  public:
   PresenceBinarySensor() = delete;
 
-  PresenceBinarySensor(uint8_t entityId, const char* name,
-                       Sensor<HeightT>& heightSensor,
+  PresenceBinarySensor(const DiscoveryEntityT& entity,
+                       HeightSensor& heightSensor,
                        PersistentNumberComponent<HeightT>& lowLimit,
                        PersistentNumberComponent<HeightT>& highLimit,
                        PersistentNumberComponent<uint16_t>& minStableTime)
-      : mBinarySensor{
-            BinarySensor(entityId, name, BinarySensorDeviceClass::PRESENCE)},
+      : mBinarySensor{BinarySensor(entity)},
         mHeightSensor{heightSensor},
         mLowLimit{lowLimit},
         mHighLimit{highLimit},
         mMinStableTime{minStableTime} {}
 
+  static constexpr DiscoveryEntityT makeEntity(uint8_t entityId,
+                                               const char* name) {
+    return BinarySensor::makeEntity(entityId, name,
+                                    BinarySensorDeviceClass::PRESENCE);
+  }
+
   void callService(uint8_t service) final { (void)service; }
 
   void loadConfigValues() final {};
@@ -52,13 +57,27 @@ class PresenceBinarySensor : public IComponent {
     return 0;
   };
 
-  void setReported() final { mBinarySensor.setReported(); }
+  void setReported(ReportReason reason) final {
+    (void)reason;
+    mBinarySensor.setReported();
+  }
 
   bool update() final;
 
+  // Recalculated when the height or a limit changes. Polled while waiting for
+  // a new state to become stable, otherwise only to check if the periodic
+  // report is due.
+  uint32_t getUpdateInterval() const final {
+    using namespace PresenceBinarySensorConstants;
+    return mStableState ? CONFIG_REPORT_INTERVAL_DEFAULT * 1000UL
+                        : UPDATE_INTERVAL_DEFAULT_MS;
+  }
+
+  const IComponent* getUpstream(uint8_t idx) const final;
+
  private:
   BinarySensor mBinarySensor;
-  Sensor<HeightT>& mHeightSensor;
+  HeightSensor& mHeightSensor;
   PersistentNumberComponent<HeightT>& mLowLimit;
   PersistentNumberComponent<HeightT>& mHighLimit;
   PersistentNumberComponent<uint16_t>& mMinStableTime;
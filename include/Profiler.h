@@ -0,0 +1,93 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Print.h>
+#include <stdint.h>
+
+// Components timed one by one, by index in Device, see DEVICE_MAX_COMPONENTS
+#define PROFILER_MAX_COMPONENTS 40
+
+/**
+ * @brief Timed sections of the hot path.
+ * Component updates follow after component0, one per component index.
+ */
+enum class ProfileSection : uint8_t {
+  loop,          // All of loop() but sleep
+  deviceUpdate,  // Device::update(), all component updates
+  ahtUpdate,     // AHTReader::update() when reading the sensor
+  loraRx,        // LoRaHandler::loraRx()
+  sendMsg,       // LoRaHandler::sendMsg(), encryption included
+  encrypt,
+  decrypt,
+  component0,
+};
+
+/**
+ * @brief Min, mean and max execution time per section.
+ */
+struct ProfileStatsT {
+  uint32_t min_us;
+  uint32_t max_us;
+  uint32_t total_us;
+  uint16_t count;
+
+  uint32_t getMean_us() const { return count == 0 ? 0 : total_us / count; }
+};
+
+/**
+ * @brief Execution time of the hot path, aggregated per section.
+ *
+ * Sections are timed with micros() by PROFILE_SCOPE(), from there to the end
+ * of the enclosing block. micros() has a resolution of 8 us at 8 MHz, so short
+ * sections show up as 0 or 8 us, the mean is still right over many calls.
+ *
+ * Only built with -D PROFILER_ENABLED, otherwise PROFILE_SCOPE() expands to
+ * nothing and the profiler takes no flash or RAM.
+ */
+class Profiler {
+ public:
+  static constexpr uint8_t SECTIONS =
+      static_cast<uint8_t>(ProfileSection::component0) +
+      PROFILER_MAX_COMPONENTS;
+
+  static constexpr ProfileSection component(uint8_t index) {
+    return static_cast<ProfileSection>(
+        static_cast<uint8_t>(ProfileSection::component0) + index);
+  }
+
+  /**
+   * @brief Add a time to a section.
+   * When the sum or count would overflow, both are halved to keep the mean.
+   */
+  static void add(ProfileSection section, uint32_t duration_us);
+
+  static const ProfileStatsT& getStats(ProfileSection section);
+
+  static void reset();
+
+  /**
+   * @brief Print min, mean and max of each section that has run.
+   */
+  static size_t printTo(Print& p);
+
+ private:
+  static ProfileStatsT sStats[SECTIONS];
+};
+
+class ProfileScope {
+ public:
+  explicit ProfileScope(ProfileSection section)
+      : mSection{section}, mStart_us{static_cast<uint32_t>(micros())} {}
+
+  ~ProfileScope() { Profiler::add(mSection, micros() - mStart_us); }
+
+ private:
+  const ProfileSection mSection;
+  const uint32_t mStart_us;
+};
+
+#ifdef PROFILER_ENABLED
+#define PROFILE_SCOPE(section) ProfileScope profileScope_(section)
+#else
+#define PROFILE_SCOPE(section)
+#endif
@@ -0,0 +1,314 @@
+#pragma once
+
+#include <Arduino.h>
+#include <stdint.h>
+
+#include "Component.h"
+#include "EeAdressMap.h"
+#include "Number.h"
+#include "PersistentNumberComponent.h"
+#include "Util.h"
+
+/**
+ * @brief Defaults of the report config of a sensor, used until set remotely.
+ */
+struct ReportDefaultsT {
+  uint16_t hysteresis;
+  uint8_t hysteresis_pct;
+  uint16_t minInterval_s;
+  uint16_t maxInterval_s;
+  uint8_t burst;
+  uint16_t refillTime_s;
+};
+
+/**
+ * @brief Report config of one sensor, see ReportPolicy.
+ *
+ * The parameters are config entities, so they can be tuned remotely per
+ * sensor and are kept in EEPROM, one item after the other from the address
+ * given:
+ *  - hysteresis: Change of the value needed for a report on change, in the
+ *    unit and precision of the value. A change is needed even if it is 0.
+ *  - hysteresisPct: Change needed relative to the last reported value, in
+ *    percent, 0 for none. The larger of the two hysteresis applies.
+ *  - minInterval: Min time between two reports, 0 for none.
+ *  - maxInterval: Max time between two reports, a report is due when it has
+ *    passed even without a change. 0 for no periodic reports.
+ *  - burst: Max number of reports on change in a row, the size of the token
+ *    bucket. 0 for no rate limit.
+ *  - refillTime: Time to get one more report on change (token).
+ *
+ * The components are public so they can be listed in the PROGMEM components
+ * array of the device.
+ */
+struct ReportConfig {
+  enum Item : uint8_t {
+    HYSTERESIS,
+    MIN_INTERVAL,
+    MAX_INTERVAL,
+    BURST,
+    REFILL_TIME,
+    HYSTERESIS_PCT,
+    ITEM_COUNT
+  };
+
+  static_assert(ITEM_COUNT * EE_ADDRESS_ITEM_SIZE <=
+                    EE_ADDRESS_REPORT_HUMIDITY - EE_ADDRESS_REPORT_TEMPERATURE,
+                "ReportConfig: items don't fit in the EEPROM block");
+
+  ReportConfig() = delete;
+
+  /**
+   * @param eeAddress EEPROM address of the first item.
+   * @param entities Metadata of the items, ITEM_COUNT in Item order, in flash
+   * (PROGMEM).
+   * @param defaults Values until set remotely.
+   */
+  ReportConfig(uint16_t eeAddress, const DiscoveryEntityT* entities,
+               const ReportDefaultsT& defaults)
+      : hysteresisNumber{address(eeAddress, HYSTERESIS), entities[HYSTERESIS],
+                         defaults.hysteresis},
+        minIntervalNumber{address(eeAddress, MIN_INTERVAL),
+                          entities[MIN_INTERVAL], defaults.minInterval_s},
+        maxIntervalNumber{address(eeAddress, MAX_INTERVAL),
+                          entities[MAX_INTERVAL], defaults.maxInterval_s},
+        burstNumber{address(eeAddress, BURST), entities[BURST],
+                    defaults.burst},
+        refillTimeNumber{address(eeAddress, REFILL_TIME),
+                         entities[REFILL_TIME], defaults.refillTime_s},
+        hysteresisPctNumber{address(eeAddress, HYSTERESIS_PCT),
+                            entities[HYSTERESIS_PCT], defaults.hysteresis_pct},
+        hysteresis{hysteresisNumber},
+        minInterval{minIntervalNumber},
+        maxInterval{maxIntervalNumber},
+        burst{burstNumber},
+        refillTime{refillTimeNumber},
+        hysteresisPct{hysteresisPctNumber} {}
+
+  // The components refer to the numbers of this object.
+  ReportConfig(const ReportConfig&) = delete;
+  ReportConfig& operator=(const ReportConfig&) = delete;
+
+  static constexpr DiscoveryEntityT makeHysteresisEntity(
+      uint8_t entityId, const char* name, NumberDeviceClass deviceClass,
+      Unit::Type unitType, uint8_t precision, uint16_t max_value) {
+    return Number<uint16_t>::makeEntity(entityId, name, deviceClass, unitType,
+                                        precision,
+                                        BaseComponent::Category::CONFIG, 0,
+                                        max_value);
+  }
+
+  static constexpr DiscoveryEntityT makeHysteresisPctEntity(uint8_t entityId,
+                                                            const char* name) {
+    return Number<uint8_t>::makeEntity(entityId, name, NumberDeviceClass::NONE,
+                                       Unit::Type::percent, 0,
+                                       BaseComponent::Category::CONFIG, 0, 100);
+  }
+
+  static constexpr DiscoveryEntityT makeMinIntervalEntity(uint8_t entityId,
+                                                          const char* name) {
+    return Number<uint16_t>::makeEntity(
+        entityId, name, NumberDeviceClass::DURATION, Unit::Type::s, 0,
+        BaseComponent::Category::CONFIG, 0, Util::SECONDS_PER_HOUR);
+  }
+
+  static constexpr DiscoveryEntityT makeMaxIntervalEntity(uint8_t entityId,
+                                                          const char* name) {
+    return Number<uint16_t>::makeEntity(
+        entityId, name, NumberDeviceClass::DURATION, Unit::Type::s, 0,
+        BaseComponent::Category::CONFIG, 0, Util::SECONDS_PER_TWELVE_HOURS);
+  }
+
+  static constexpr DiscoveryEntityT makeBurstEntity(uint8_t entityId,
+                                                    const char* name) {
+    return Number<uint8_t>::makeEntity(entityId, name, NumberDeviceClass::NONE,
+                                       Unit::Type::none, 0,
+                                       BaseComponent::Category::CONFIG, 0, 20);
+  }
+
+  static constexpr DiscoveryEntityT makeRefillTimeEntity(uint8_t entityId,
+                                                         const char* name) {
+    return Number<uint16_t>::makeEntity(
+        entityId, name, NumberDeviceClass::DURATION, Unit::Type::s, 0,
+        BaseComponent::Category::CONFIG, 0, Util::SECONDS_PER_HOUR);
+  }
+
+  uint16_t getHysteresis() const { return hysteresis.getValue(); }
+
+  uint8_t getHysteresisPct() const { return hysteresisPct.getValue(); }
+
+  uint32_t getMinInterval() const { return minInterval.getValue() * 1000UL; }
+
+  uint32_t getMaxInterval() const { return maxInterval.getValue() * 1000UL; }
+
+  uint8_t getBurst() const { return burst.getValue(); }
+
+  uint32_t getRefillTime() const { return refillTime.getValue() * 1000UL; }
+
+  static uint16_t address(uint16_t eeAddress, Item item) {
+    return static_cast<uint16_t>(eeAddress + item * EE_ADDRESS_ITEM_SIZE);
+  }
+
+  PersistentNumber<uint16_t> hysteresisNumber;
+  PersistentNumber<uint16_t> minIntervalNumber;
+  PersistentNumber<uint16_t> maxIntervalNumber;
+  PersistentNumber<uint8_t> burstNumber;
+  PersistentNumber<uint16_t> refillTimeNumber;
+  PersistentNumber<uint8_t> hysteresisPctNumber;
+
+  PersistentNumberComponent<uint16_t> hysteresis;
+  PersistentNumberComponent<uint16_t> minInterval;
+  PersistentNumberComponent<uint16_t> maxInterval;
+  PersistentNumberComponent<uint8_t> burst;
+  PersistentNumberComponent<uint16_t> refillTime;
+  PersistentNumberComponent<uint8_t> hysteresisPct;
+};
+
+/**
+ * @brief Decides when a sensor value is due for reporting.
+ *
+ * A report is due when:
+ *  - the max interval has passed since the last report, or
+ *  - the value has changed by at least the hysteresis, absolute and relative
+ *    to the last reported value, and a token is left in the bucket,
+ * but never before the min interval has passed. Reports on change take a
+ * token, one is added per refill time up to burst. Periodic reports are not
+ * rate limited.
+ *
+ * The parameters are in the ReportConfig of the sensor.
+ *
+ * Usage, in a sensor component:
+ *   bool update() {
+ *     ...
+ *     return mSensor.updateIsReportDue(mReportPolicy);
+ *   }
+ *
+ *   void setReported(ReportReason reason) {
+ *     mReportPolicy.setReported(reason, mSensor.timeSinceLastReport());
+ *     mSensor.setReported();
+ *   }
+ *
+ * @tparam T Value type of the sensor.
+ */
+template <class T>
+class ReportPolicy {
+ public:
+  static_assert(sizeof(T) <= sizeof(int16_t),
+                "ReportPolicy<T>: T must fit in int16_t or uint16_t");
+
+  ReportPolicy() = delete;
+
+  explicit ReportPolicy(const ReportConfig& config) : mConfig{config} {}
+
+  /**
+   * @param value Current value.
+   * @param lastReportedValue Value at the last report.
+   * @param timeSinceLastReport Time in ms.
+   * @param now Current time in ms, for the token bucket.
+   */
+  bool isReportDue(T value, T lastReportedValue, uint32_t timeSinceLastReport,
+                   uint32_t now) {
+    mHeldBackTime = 0;
+
+    const uint32_t minInterval = mConfig.getMinInterval();
+    if (timeSinceLastReport < minInterval) {
+      if (isLargeChange(value, lastReportedValue)) {
+        mHeldBackTime = minInterval - timeSinceLastReport;
+      }
+      return false;
+    }
+
+    if (isPeriodic(timeSinceLastReport)) {
+      return true;
+    }
+
+    if (!isLargeChange(value, lastReportedValue)) {
+      return false;
+    }
+
+    refill(now);
+    if (mConfig.getBurst() == 0 || mTokens > 0) {
+      return true;
+    }
+
+    mHeldBackTime = mConfig.getRefillTime() - (now - mLastRefill);
+    return false;
+  }
+
+  /**
+   * @brief Take a token if the report was due on change.
+   * Periodic reports and reports on request are free.
+   * @param reason Why the value was reported.
+   * @param timeSinceLastReport Time in ms, up to this report.
+   */
+  void setReported(ReportReason reason, uint32_t timeSinceLastReport) {
+    if (reason != ReportReason::due || isPeriodic(timeSinceLastReport)) {
+      return;
+    }
+
+    refill(millis());
+    if (mTokens > 0) {
+      mTokens--;
+    }
+  }
+
+  uint32_t getMaxInterval() const { return mConfig.getMaxInterval(); }
+
+  /**
+   * @brief Time until a change held back by the last isReportDue() may be
+   * reported, by the min interval or the rate limit.
+   * @return Time in ms, 0 if no change is held back.
+   */
+  uint32_t getHeldBackTime() const { return mHeldBackTime; }
+
+  uint8_t getTokens() const { return mTokens; }
+
+ private:
+  bool isPeriodic(uint32_t timeSinceLastReport) const {
+    const uint32_t maxInterval = mConfig.getMaxInterval();
+    return maxInterval != 0 && timeSinceLastReport >= maxInterval;
+  }
+
+  bool isLargeChange(T value, T lastReportedValue) const {
+    const uint32_t diff = absValue(static_cast<int32_t>(value) -
+                                   static_cast<int32_t>(lastReportedValue));
+    if (diff == 0) {
+      return false;
+    }
+
+    const uint32_t relative =
+        absValue(lastReportedValue) * mConfig.getHysteresisPct() / 100;
+
+    return diff >= mConfig.getHysteresis() && diff >= relative;
+  }
+
+  static uint32_t absValue(int32_t value) {
+    return static_cast<uint32_t>(value < 0 ? -value : value);
+  }
+
+  void refill(uint32_t now) {
+    const uint8_t burst = mConfig.getBurst();
+    const uint32_t refillTime = mConfig.getRefillTime();
+
+    if (mTokens >= burst || refillTime == 0) {
+      // Full, time only counts from the next token taken.
+      mTokens = burst;
+      mLastRefill = now;
+      return;
+    }
+
+    const uint32_t tokens = (now - mLastRefill) / refillTime;
+    if (tokens >= static_cast<uint32_t>(burst - mTokens)) {
+      mTokens = burst;
+      mLastRefill = now;
+    } else if (tokens > 0) {
+      mTokens = static_cast<uint8_t>(mTokens + tokens);
+      mLastRefill += tokens * refillTime;  // Keep the part of the next token
+    }
+  }
+
+  const ReportConfig& mConfig;
+  uint32_t mLastRefill{};      // ms
+  uint32_t mHeldBackTime{};    // ms
+  uint8_t mTokens{UINT8_MAX};  // Full
+};
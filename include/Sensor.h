@@ -1,7 +1,5 @@
 #pragma once
 
-#include <Printable.h>
-
 #include "BaseComponent.h"
 #include "Types.h"
 #include "Unit.h"
@@ -60,40 +58,41 @@ enum class SensorDeviceClass : uint8_t {
 };
 
 template <class T>
-class Sensor : public Printable {
+class ReportPolicy;
+
+template <class T>
+class Sensor {
  public:
   Sensor() = delete;
 
-  explicit Sensor(uint8_t entityId) : mBaseComponent{BaseComponent(entityId)} {}
-
-  Sensor(uint8_t entityId, const char* name,
-         SensorDeviceClass deviceClass = SensorDeviceClass::NONE,
-         Unit::Type unitType = Unit::Type::none, uint8_t precision = 0,
-         T value = 0, T min_value = MIN_OF(T), T max_value = MAX_OF(T))
-      : mBaseComponent{
-            BaseComponent(entityId, name, BaseComponent::Category::DIAGNOSTIC)},
-        mDeviceClass{deviceClass},
-        mValueItem{
-            ValueItem<T>(unitType, precision, value, min_value, max_value)} {}
+  /**
+   * @param entity Metadata of the entity, in flash (PROGMEM), see makeEntity().
+   */
+  explicit Sensor(const DiscoveryEntityT& entity, T value = 0)
+      : mBaseComponent{BaseComponent(entity)},
+        mValueItem{ValueItem<T>(entity, value)} {}
+
+  static constexpr DiscoveryEntityT makeEntity(
+      uint8_t entityId, const char* name,
+      SensorDeviceClass deviceClass = SensorDeviceClass::NONE,
+      Unit::Type unitType = Unit::Type::none, uint8_t precision = 0,
+      T min_value = MIN_OF(T), T max_value = MAX_OF(T)) {
+    return BaseComponent::makeEntity<T>(
+        entityId, name, BaseComponent::Type::SENSOR,
+        static_cast<uint8_t>(deviceClass), BaseComponent::Category::DIAGNOSTIC,
+        unitType, precision, min_value, max_value);
+  }
 
   BaseComponent::Type getComponentType() const {
     return BaseComponent::Type::SENSOR;
   }
 
-  SensorDeviceClass getDeviceClass() const { return mDeviceClass; }
+  SensorDeviceClass getDeviceClass() const {
+    return static_cast<SensorDeviceClass>(mBaseComponent.getDeviceClass());
+  }
 
   void getDiscoveryEntity(DiscoveryEntityT& item) const {
-    item.entityId = mBaseComponent.getEntityId();
-    item.componentType = static_cast<uint8_t>(getComponentType());
-    item.deviceClass = static_cast<uint8_t>(getDeviceClass());
-    item.category = static_cast<uint8_t>(mBaseComponent.getCategory());
-    item.unit = static_cast<uint8_t>(mValueItem.getUnit().type());
-    item.precision = mValueItem.getPrecision();
-    item.sizeCode = static_cast<uint8_t>(mValueItem.getValueSize()) / 2;
-    item.isSigned = mValueItem.isSigned();
-    item.minValue = static_cast<uint32_t>(mValueItem.getMinValue());
-    item.maxValue = static_cast<uint32_t>(mValueItem.getMaxValue());
-    item.name = mBaseComponent.getName();
+    mBaseComponent.getDiscoveryEntity(item);
   }
 
   uint8_t getEntityId() const { return mBaseComponent.getEntityId(); }
@@ -113,7 +112,7 @@ class Sensor : public Printable {
 
   bool isReportDue() const { return mBaseComponent.isReportDue(); }
 
-  size_t printTo(Print& p) const final {
+  size_t printTo(Print& p) const {
     size_t n = 0;
     n += mBaseComponent.printTo(p);
     n += p.print('=');
@@ -123,6 +122,18 @@ class Sensor : public Printable {
 
   void setIsReportDue(bool isDue) { mBaseComponent.setIsReportDue(isDue); }
 
+  /**
+   * @brief Set isReportDue as decided by a report policy.
+   * @return isReportDue.
+   */
+  bool updateIsReportDue(ReportPolicy<T>& policy) {
+    const bool isDue =
+        policy.isReportDue(mValueItem.getValue(), mLastReportedValue,
+                           timeSinceLastReport(), millis());
+    setIsReportDue(isDue);
+    return isDue;
+  }
+
   void setReported() {
     mBaseComponent.setReported();
     mLastReportedValue = mValueItem.getValue();
@@ -136,7 +147,6 @@ class Sensor : public Printable {
 
  private:
   BaseComponent mBaseComponent;
-  const SensorDeviceClass mDeviceClass{SensorDeviceClass::NONE};
   ValueItem<T> mValueItem;
   T mLastReportedValue{};
 };
@@ -5,6 +5,7 @@
 #include "AHTReader.h"
 #include "Component.h"
 #include "Number.h"
+#include "ReportPolicy.h"
 #include "Sensor.h"
 #include "Util.h"
 
@@ -13,7 +14,6 @@ using TemperatureT = int16_t;  // Degree C
 namespace TemperatureSensorConstants {
 static const TemperatureT CONFIG_REPORT_HYSTERESIS_DEFAULT = 50;
 static const uint16_t CONFIG_MEASURE_INTERVAL_DEFAULT = 60;
-static const uint16_t CONFIG_REPORT_INTERVAL_DEFAULT = 300;
 static const TemperatureT CONFIG_COMPENSATION_DEFAULT = 0;
 }  // namespace TemperatureSensorConstants
 
@@ -21,10 +21,17 @@ class TemperatureSensor : public IComponent {
  public:
   TemperatureSensor() = delete;
 
-  TemperatureSensor(uint8_t entityId, const char *name, AHTReader &ahtReader)
-      : mSensor{Sensor<TemperatureT>(
-            entityId, name, SensorDeviceClass::TEMPERATURE, Unit::Type::C, 1)},
-        mAhtReader{ahtReader} {}
+  TemperatureSensor(const DiscoveryEntityT &entity, AHTReader &ahtReader,
+                    const ReportConfig &reportConfig)
+      : mSensor{Sensor<TemperatureT>(entity)},
+        mAhtReader{ahtReader},
+        mReportPolicy{ReportPolicy<TemperatureT>(reportConfig)} {}
+
+  static constexpr DiscoveryEntityT makeEntity(uint8_t entityId,
+                                               const char *name) {
+    return Sensor<TemperatureT>::makeEntity(
+        entityId, name, SensorDeviceClass::TEMPERATURE, Unit::Type::C, 1);
+  }
 
   void callService(uint8_t service) final { (void)service; }
 
@@ -50,11 +57,19 @@ class TemperatureSensor : public IComponent {
     return 0;
   };
 
-  void setReported() final { mSensor.setReported(); }
+  void setReported(ReportReason reason) final {
+    mReportPolicy.setReported(reason, mSensor.timeSinceLastReport());
+    mSensor.setReported();
+  }
 
   bool update() final;
 
+  uint32_t getUpdateInterval() const final {
+    return TemperatureSensorConstants::CONFIG_MEASURE_INTERVAL_DEFAULT * 1000UL;
+  }
+
  private:
   Sensor<TemperatureT> mSensor;
   AHTReader &mAhtReader;
+  ReportPolicy<TemperatureT> mReportPolicy;
 };
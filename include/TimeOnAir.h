@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @brief Time on air of a LoRa frame, calculated from the radio settings.
+ *
+ * Implements the formula from Semtech AN1200.13 "LoRa Modem Designer's Guide".
+ * All functions are constexpr, so for fixed radio settings and a fixed frame
+ * length the time is calculated at compile time.
+ *
+ * Parameters use the same units as the LoRa library setters:
+ *   sf          Spreading factor, 6-12.
+ *   bw_Hz       Signal bandwidth in Hz, e.g. 125000.
+ *   codingRate4 Denominator of the coding rate 4/x, 5-8.
+ *   preamble    Preamble length in symbols, the radio adds 4.25 symbols.
+ *   crc         Payload CRC enabled.
+ *   implicitHeader Implicit header mode, no header sent.
+ */
+namespace TimeOnAir {
+
+/**
+ * @brief Time of one symbol.
+ *
+ * @return uint32_t symbol time in µs.
+ */
+constexpr uint32_t getSymbolTime_us(uint8_t sf, uint32_t bw_Hz) {
+  return (1UL << sf) * 1000000UL / bw_Hz;
+}
+
+/**
+ * @brief Low data rate optimization is used when a symbol is longer than
+ * 16 ms, same rule as the LoRa library.
+ */
+constexpr bool isLowDataRateOptimized(uint8_t sf, uint32_t bw_Hz) {
+  return getSymbolTime_us(sf, bw_Hz) > 16000UL;
+}
+
+/**
+ * @brief Ceiling of n / d, negative n gives 0.
+ */
+constexpr uint16_t ceilDivPositive(int16_t n, int16_t d) {
+  return n <= 0 ? 0 : static_cast<uint16_t>((n + d - 1) / d);
+}
+
+/**
+ * @brief Number of symbols after the preamble, i.e. header and payload.
+ *
+ * @param length Payload length in bytes, the whole LoRa frame.
+ */
+constexpr uint16_t getPayloadSymbols(uint8_t length, uint8_t sf,
+                                     uint32_t bw_Hz, uint8_t codingRate4,
+                                     bool crc = true,
+                                     bool implicitHeader = false) {
+  return 8 + ceilDivPositive(8 * length - 4 * sf + 28 + 16 * crc -
+                                 20 * implicitHeader,
+                             4 * (sf - 2 * isLowDataRateOptimized(sf, bw_Hz))) *
+                 codingRate4;
+}
+
+/**
+ * @brief Time on air of a frame.
+ *
+ * @param length Payload length in bytes, the whole LoRa frame.
+ * @return uint32_t time on air in µs.
+ */
+constexpr uint32_t getTime_us(uint8_t length, uint8_t sf, uint32_t bw_Hz,
+                              uint8_t codingRate4, uint16_t preamble = 8,
+                              bool crc = true, bool implicitHeader = false) {
+  // Counted in quarter symbols to keep the 4.25 preamble symbols exact.
+  return (4UL * preamble + 17 +
+          4UL * getPayloadSymbols(length, sf, bw_Hz, codingRate4, crc,
+                                  implicitHeader)) *
+         getSymbolTime_us(sf, bw_Hz) / 4;
+}
+
+/**
+ * @brief Converts µs to ms, rounded up.
+ */
+constexpr uint32_t toMs(uint32_t time_us) { return (time_us + 999) / 1000; }
+
+}  // namespace TimeOnAir
@@ -24,7 +24,9 @@ struct DiscoveryEntityT {
                       // be interpreted as signed if isSigned is true
   const char* name;   // Null-terminated string
 
-  size_t size() const { return 14 + strlen_P(name) + 1; }
+  static constexpr size_t HEADER_SIZE = 14;  // All but the name
+
+  size_t size() const { return HEADER_SIZE + strlen_P(name) + 1; }
 
   size_t toByteArray(uint8_t* buf, size_t length) const {
     size_t actualSize = size();
@@ -33,6 +35,14 @@ struct DiscoveryEntityT {
       return 0;
     }
 
+    headerToByteArray(buf);
+    strcpy_P((char*)&buf[HEADER_SIZE], name);
+
+    return actualSize;
+  }
+
+  // Writes HEADER_SIZE bytes.
+  size_t headerToByteArray(uint8_t* buf) const {
     buf[0] = entityId;
     buf[1] = componentType;
     buf[2] = deviceClass;
@@ -41,9 +51,8 @@ struct DiscoveryEntityT {
     buf[5] = (isSigned << 4) | (sizeCode << 2) | precision;
     *(reinterpret_cast<uint32_t*>(&buf[6])) = hton(minValue);
     *(reinterpret_cast<uint32_t*>(&buf[10])) = hton(maxValue);
-    strcpy_P((char*)&buf[14], name);
 
-    return actualSize;
+    return HEADER_SIZE;
   }
 };
 
@@ -6,7 +6,8 @@
 
 namespace UnitConstants {
 static const char UnitName[][4] PROGMEM = {
-    "", "°C", "°F", "K", "%", "km", "m", "dm", "cm", "mm", "μm", "s", "ms"};
+    "", "°C", "°F", "K", "%", "km", "m", "dm", "cm", "mm", "μm", "s", "ms",
+    "B", "μs"};
 }
 
 class Unit {
@@ -25,6 +26,8 @@ class Unit {
     um,
     s,
     ms,
+    B,
+    us,
   };
 
   explicit Unit(Type type) : mType{type} {}
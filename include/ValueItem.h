@@ -1,10 +1,10 @@
 #pragma once
 
 #include <Arduino.h>
-#include <Printable.h>
 #include <assert.h>
 #include <stdint.h>
 
+#include "Types.h"
 #include "Unit.h"
 
 #define IS_SIGNED_TYPE(type) (type(-1) < type(0))
@@ -26,31 +26,33 @@ static const uint16_t factors[4] = {1, 10, 100, 1000};
 
 /**
  * @brief A class of value item which has value, unit, precision, min and max.
+ * Only the value is in RAM, the rest is read from the entity in flash.
  * @tparam T of type int8_t, uint8_t, int16_t, uint16_t, int32_t or uint32_t
  */
 template <class T>
-class ValueItem : public Printable {
+class ValueItem {
  public:
-  ValueItem(Unit::Type unitType = Unit::Type::none, uint8_t precision = 0,
-            T value = 0, T min_value = MIN_OF(T), T max_value = MAX_OF(T))
-      : mValue{value},
-        mMin{min_value},
-        mMax{max_value},
-        mUnit{Unit(unitType)},
-        mPrecision{precision > 3 ? static_cast<uint8_t>(3) : precision} {
-    assert(mValue >= mMin);
-    assert(mValue <= mMax);
+  /**
+   * @param entity Metadata of the entity, in flash (PROGMEM).
+   */
+  explicit ValueItem(const DiscoveryEntityT& entity, T value = 0)
+      : mEntity{&entity}, mValue{value} {
+    assert(mValue >= getMinValue());
+    assert(mValue <= getMaxValue());
   }
 
   T getValue() const { return mValue; }
 
   void setValue(T value = {}) {
-    if (value < mMin) {
-      mValue = mMin;
+    const T minValue = getMinValue();
+    const T maxValue = getMaxValue();
+
+    if (value < minValue) {
+      mValue = minValue;
     }
 
-    else if (value > mMax) {
-      mValue = mMax;
+    else if (value > maxValue) {
+      mValue = maxValue;
     }
 
     else {
@@ -77,15 +79,16 @@ class ValueItem : public Printable {
    *
    * For negative values, returns negated value.
    * For positive/unsigned values, returns the value itself.
+   * Returned as uint32_t so that the minimum of a signed type fits.
    */
-  T getAbsoluteValue() const {
+  uint32_t getAbsoluteValue() const {
     if (isNegative()) {
-      return -mValue;
+      return 0u - static_cast<uint32_t>(mValue);
     }
-    return mValue;
+    return static_cast<uint32_t>(mValue);
   }
 
-  size_t printTo(Print& p) const final {
+  size_t printTo(Print& p) const {
     size_t n = 0;
 
     const uint16_t scaleFactor = getScaleFactor();
@@ -96,7 +99,7 @@ class ValueItem : public Printable {
     }
 
     // Get absolute value and calculate integer part
-    T absValue = getAbsoluteValue();
+    uint32_t absValue = getAbsoluteValue();
     uint32_t integer = absValue / scaleFactor;
     n += p.print(integer);
 
@@ -116,28 +119,36 @@ class ValueItem : public Printable {
       n += p.print(fractional);
     }
 
-    n += mUnit.print(p);
+    n += getUnit().print(p);
     return n;
   }
 
-  const Unit& getUnit() const { return mUnit; }
+  Unit getUnit() const {
+    return Unit(static_cast<Unit::Type>(pgm_read_byte(&mEntity->unit)));
+  }
 
-  uint8_t getPrecision() const { return mPrecision; }
+  uint8_t getPrecision() const {
+    // A bitfield has no address, read the byte after the unit that holds it.
+    // GCC allocates bitfields from the least significant bit.
+    const uint8_t bits = pgm_read_byte(&mEntity->unit + 1);
+    return bits & 0x03;
+  }
 
   static constexpr size_t getValueSize() { return sizeof(T); }
 
   int16_t getScaleFactor() const {
-    return ValueItemConstants::factors[mPrecision];
+    return ValueItemConstants::factors[getPrecision()];
   }
 
-  T getMinValue() const { return mMin; }
+  T getMinValue() const {
+    return static_cast<T>(pgm_read_dword(&mEntity->minValue));
+  }
 
-  T getMaxValue() const { return mMax; }
+  T getMaxValue() const {
+    return static_cast<T>(pgm_read_dword(&mEntity->maxValue));
+  }
 
  private:
+  const DiscoveryEntityT* const mEntity;  // In flash
   T mValue;
-  const T mMin;
-  const T mMax;
-  const Unit mUnit;
-  const uint8_t mPrecision;
 };
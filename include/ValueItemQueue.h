@@ -0,0 +1,126 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "Types.h"
+
+/**
+ * @brief Fixed-capacity queue of value items waiting to be sent.
+ *
+ * Items are kept in insertion order until sorted. Only the latest value of an
+ * entity is of interest to the gateway, so pushing an item for an entity which
+ * is already queued replaces the queued value in place instead of taking a new
+ * slot.
+ *
+ * @tparam N Max number of items (entities) in the queue.
+ */
+template <uint8_t N>
+class ValueItemQueue {
+ public:
+  static_assert(N > 0, "ValueItemQueue<N>: N must be larger than 0");
+
+  /**
+   * @brief Checks the capacity of the queue.
+   *
+   * @return uint8_t max number of items the queue can hold.
+   */
+  constexpr uint8_t capacity() const { return N; }
+
+  /**
+   * @brief Checks the number of items in the queue.
+   *
+   * @return uint8_t number of items in the queue.
+   */
+  uint8_t size() const { return mSize; }
+
+  /**
+   * @brief Checks if the queue is empty.
+   *
+   * @return true if queue is empty.
+   * @return false if queue isn't empty.
+   */
+  bool isEmpty() const { return mSize == 0; }
+
+  /**
+   * @brief Checks if the queue is full.
+   *
+   * @return true if queue is full.
+   * @return false if queue isn't full.
+   */
+  bool isFull() const { return mSize == N; }
+
+  /**
+   * @brief Adds an item last in the queue, or replaces the value of the queued
+   * item with the same entity id.
+   *
+   * @param item Item to add.
+   * @return true if the item was added or replaced a queued item.
+   * @return false if the queue is full and the item was dropped.
+   */
+  bool push(const ValueItemT& item) {
+    for (uint8_t i = 0; i < mSize; i++) {
+      if (mItems[i].entityId == item.entityId) {
+        mItems[i].value = item.value;
+        return true;
+      }
+    }
+
+    if (isFull()) {
+      return false;
+    }
+
+    mItems[mSize++] = item;
+    return true;
+  }
+
+  /**
+   * @brief Gets an item, 0 is the oldest one.
+   *
+   * @param index Index of item, must be less than size().
+   * @return const ValueItemT& the item.
+   */
+  const ValueItemT& operator[](uint8_t index) const { return mItems[index]; }
+
+  /**
+   * @brief Removes the oldest items from the queue.
+   *
+   * @param count Number of items to remove.
+   */
+  void pop(uint8_t count = 1) {
+    if (count >= mSize) {
+      mSize = 0;
+      return;
+    }
+
+    mSize -= count;
+    for (uint8_t i = 0; i < mSize; i++) {
+      mItems[i] = mItems[i + count];
+    }
+  }
+
+  /**
+   * @brief Sorts the queue in ascending entity id order.
+   *
+   * Insertion sort, the queue is small and often already sorted.
+   */
+  void sortByEntityId() {
+    for (uint8_t i = 1; i < mSize; i++) {
+      const ValueItemT item = mItems[i];
+      uint8_t j = i;
+      while (j > 0 && mItems[j - 1].entityId > item.entityId) {
+        mItems[j] = mItems[j - 1];
+        j--;
+      }
+      mItems[j] = item;
+    }
+  }
+
+  /**
+   * @brief Removes all items from the queue.
+   */
+  void clear() { mSize = 0; }
+
+ private:
+  ValueItemT mItems[N];
+  uint8_t mSize{};
+};
@@ -0,0 +1,742 @@
+#include "LoRaFrame.h"
+
+#include <string.h>
+
+namespace LoRaFrame {
+
+namespace {
+
+constexpr uint8_t VALUE_ITEM_SIZE = 5;  // Entity id and 4 bytes value
+constexpr uint8_t BITMAP_HEADER_LENGTH = 2;  // First id and bitmap length
+constexpr uint8_t MAX_BITMAP_LENGTH = 32;
+
+// Compact values, see CompactValue.h
+constexpr uint8_t MODE_SHIFT = 6;
+constexpr uint8_t MODE_BITS = 2;
+constexpr uint8_t MODE_MASK = 0x03;
+constexpr uint8_t MODES_PER_BYTE = 8 / MODE_BITS;
+constexpr uint8_t ENTITY_ID_MASK = 0x3F;
+constexpr uint8_t ENTITY_ID_ESCAPE = 0x3F;
+constexpr uint8_t MAX_VARINT_SIZE = 5;
+
+// Compact discovery, see CompactDiscovery.h
+constexpr uint8_t ESCAPE = 0x7F;
+constexpr uint8_t WORD_FLAG = 0x80;
+constexpr uint32_t FNV_PRIME = 16777619UL;
+
+// Part of the protocol, the same list as CompactDiscovery::Words.
+const char* const WORDS[] = {
+    "Car",      "Cover",    "Distance", "High",        "Height", "Humidity",
+    "Interval", "Limit",    "Low",      "Max",         "Min",    "Port",
+    "Presence", "Report",   "Stable",   "Temperature", "Time",   "Value",
+    "Zero",     "Door",     "Battery",  "Voltage",     "Signal", "Strength"};
+constexpr uint8_t WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+
+void putU16(uint8_t* buf, uint16_t v) {
+  buf[0] = static_cast<uint8_t>(v >> 8);
+  buf[1] = static_cast<uint8_t>(v);
+}
+
+void putU32(uint8_t* buf, uint32_t v) {
+  buf[0] = static_cast<uint8_t>(v >> 24);
+  buf[1] = static_cast<uint8_t>(v >> 16);
+  buf[2] = static_cast<uint8_t>(v >> 8);
+  buf[3] = static_cast<uint8_t>(v);
+}
+
+uint32_t fnv1a(uint32_t hash, uint8_t b) { return (hash ^ b) * FNV_PRIME; }
+
+int32_t unzigzag(uint32_t v) {
+  return static_cast<int32_t>(v >> 1) ^ -static_cast<int32_t>(v & 1);
+}
+
+uint8_t readVarint(Span bytes, uint32_t& v) {
+  v = 0;
+  for (uint8_t n = 0; n < bytes.size && n < MAX_VARINT_SIZE; n++) {
+    v |= static_cast<uint32_t>(bytes[n] & 0x7F) << (7 * n);
+    if ((bytes[n] & 0x80) == 0) {
+      return n + 1;
+    }
+  }
+  return 0;
+}
+
+uint8_t writeVarint(uint8_t* buf, size_t length, uint32_t v) {
+  uint8_t n = 0;
+  do {
+    if (n == length) {
+      return 0;
+    }
+    buf[n] = static_cast<uint8_t>(v & 0x7F);
+    v >>= 7;
+    if (v != 0) {
+      buf[n] |= 0x80;
+    }
+    n++;
+  } while (v != 0);
+  return n;
+}
+
+// Value of mode, raw values are 4 bytes big endian, others varints.
+uint8_t readCompactValue(Span bytes, ValueMode mode, uint32_t& v) {
+  if (mode == ValueMode::raw) {
+    if (bytes.size < sizeof(v)) {
+      return 0;
+    }
+    v = bytes.getU32(0);
+    return sizeof(v);
+  }
+  return readVarint(bytes, v);
+}
+
+uint8_t writeCompactValue(uint8_t* buf, size_t length, ValueMode mode,
+                          uint32_t v) {
+  if (mode == ValueMode::raw) {
+    if (length < sizeof(v)) {
+      return 0;
+    }
+    putU32(buf, v);
+    return sizeof(v);
+  }
+  return writeVarint(buf, length, v);
+}
+
+// Word of the dictionary with length characters at word, -1 if none.
+int findWord(const char* word, size_t length) {
+  for (uint8_t i = 0; i < WORD_COUNT; i++) {
+    if (strncmp(WORDS[i], word, length) == 0 && WORDS[i][length] == '\0') {
+      return i;
+    }
+  }
+  return -1;
+}
+
+}  // namespace
+
+size_t Header::decode(Span bytes) {
+  if (bytes.size < HEADER_LENGTH) {
+    return 0;
+  }
+  dst = bytes[0];
+  src = bytes[1];
+  id = bytes[2];
+  flags = bytes[3];
+  return HEADER_LENGTH;
+}
+
+size_t Header::encode(uint8_t* buf, size_t length) const {
+  if (length < HEADER_LENGTH) {
+    return 0;
+  }
+  buf[0] = dst;
+  buf[1] = src;
+  buf[2] = id;
+  buf[3] = flags;
+  return HEADER_LENGTH;
+}
+
+size_t Frame::decode(Span bytes) {
+  if (header.decode(bytes) == 0) {
+    return 0;
+  }
+  payload = bytes.subspan(HEADER_LENGTH);
+  return bytes.size;
+}
+
+size_t PingMsg::decode(Span payload) {
+  if (payload.size < 2) {
+    return 0;
+  }
+  rssi = static_cast<int16_t>(payload.getU16(0));
+  return 2;
+}
+
+size_t PingMsg::encode(uint8_t* buf, size_t length) const {
+  if (length < 2) {
+    return 0;
+  }
+  putU16(buf, static_cast<uint16_t>(rssi));
+  return 2;
+}
+
+size_t DiscoveryReq::decode(Span payload) {
+  if (payload.size < 1) {
+    return 0;
+  }
+  entityId = payload[0];
+  hasHash = payload.size >= 5;
+  hash = hasHash ? payload.getU32(1) : 0;
+  return hasHash ? 5 : 1;
+}
+
+size_t DiscoveryReq::encode(uint8_t* buf, size_t length) const {
+  const size_t n = hasHash ? 5 : 1;
+  if (length < n) {
+    return 0;
+  }
+  buf[0] = entityId;
+  if (hasHash) {
+    putU32(&buf[1], hash);
+  }
+  return n;
+}
+
+size_t DiscoveryEntity::getName(char* buf, size_t size) const {
+  size_t m = 0;
+
+  for (size_t n = 0; n < name.size; n++) {
+    uint8_t b = name[n];
+
+    if (b == '\0') {
+      if (m >= size) {
+        return 0;
+      }
+      buf[m] = '\0';
+      return m;
+    }
+
+    if (isCompactName && b >= WORD_FLAG) {
+      const uint8_t index = b & ~WORD_FLAG;
+      if (index >= WORD_COUNT) {
+        return 0;
+      }
+      const size_t wordLength = strlen(WORDS[index]);
+      const size_t space = m > 0 ? 1 : 0;
+      if (m + space + wordLength >= size) {
+        return 0;
+      }
+      if (space) {
+        buf[m++] = ' ';
+      }
+      memcpy(&buf[m], WORDS[index], wordLength);
+      m += wordLength;
+      continue;
+    }
+
+    if (isCompactName && b == ESCAPE) {
+      if (++n == name.size) {
+        return 0;
+      }
+      b = name[n];
+    }
+    if (m + 1 >= size) {
+      return 0;
+    }
+    buf[m++] = static_cast<char>(b);
+  }
+
+  return 0;  // No terminator
+}
+
+uint32_t DiscoveryEntity::hash(uint32_t hash) const {
+  // Over the plain discovery format, the name as plain text
+  uint8_t header[HEADER_SIZE];
+  DiscoveryEntity plain = *this;
+  plain.name = Span();
+  (void)plain.encode(header, sizeof(header));
+  for (uint8_t b : header) {
+    hash = fnv1a(hash, b);
+  }
+
+  char text[MAX_NAME_SIZE] = "";
+  const size_t length = getName(text, sizeof(text));
+  for (size_t i = 0; i <= length; i++) {
+    hash = fnv1a(hash, static_cast<uint8_t>(text[i]));
+  }
+  return hash;
+}
+
+size_t DiscoveryEntity::decode(Span bytes, bool compactName) {
+  if (bytes.size <= HEADER_SIZE) {
+    return 0;
+  }
+
+  // The name ends at the first zero byte, which can't be escaped.
+  const void* end = memchr(&bytes.data[HEADER_SIZE], '\0',
+                           bytes.size - HEADER_SIZE);
+  if (end == nullptr) {
+    return 0;
+  }
+
+  entityId = bytes[0];
+  componentType = bytes[1];
+  deviceClass = bytes[2];
+  category = bytes[3];
+  unit = bytes[4];
+  format = bytes[5];
+  minValue = bytes.getU32(6);
+  maxValue = bytes.getU32(10);
+  const size_t n = static_cast<const uint8_t*>(end) - bytes.data + 1;
+  name = Span(&bytes.data[HEADER_SIZE], n - HEADER_SIZE);
+  isCompactName = compactName;
+  return n;
+}
+
+size_t DiscoveryEntity::encode(uint8_t* buf, size_t length) const {
+  if (length < HEADER_SIZE + name.size) {
+    return 0;
+  }
+  buf[0] = entityId;
+  buf[1] = componentType;
+  buf[2] = deviceClass;
+  buf[3] = category;
+  buf[4] = unit;
+  buf[5] = format;
+  putU32(&buf[6], minValue);
+  putU32(&buf[10], maxValue);
+  if (name.size > 0) {
+    memcpy(&buf[HEADER_SIZE], name.data, name.size);
+  }
+  return HEADER_SIZE + name.size;
+}
+
+size_t encodeCompactName(const char* name, uint8_t* buf, size_t length) {
+  size_t n = 0;
+  const char* p = name;
+
+  while (*p != '\0') {
+    if (*p == ' ') {
+      p++;
+      continue;
+    }
+
+    size_t wordLength = 0;
+    while (p[wordLength] != '\0' && p[wordLength] != ' ') {
+      wordLength++;
+    }
+
+    const int index = findWord(p, wordLength);
+    if (index >= 0) {
+      if (length < n + 1) {
+        return 0;
+      }
+      buf[n++] = WORD_FLAG | static_cast<uint8_t>(index);
+    } else {
+      if (n > 0) {
+        if (length < n + 1) {
+          return 0;
+        }
+        buf[n++] = ' ';
+      }
+      for (size_t j = 0; j < wordLength; j++) {
+        const uint8_t b = static_cast<uint8_t>(p[j]);
+        const size_t m = b >= ESCAPE ? 2 : 1;
+        if (length < n + m) {
+          return 0;
+        }
+        if (m == 2) {
+          buf[n++] = ESCAPE;
+        }
+        buf[n++] = b;
+      }
+    }
+    p += wordLength;
+  }
+
+  if (length < n + 1) {
+    return 0;
+  }
+  buf[n++] = '\0';
+  return n;
+}
+
+bool DiscoveryBatchMsg::nextEntity(size_t& offset,
+                                   DiscoveryEntity& entity) const {
+  const size_t n = entity.decode(entities.subspan(offset), true);
+  offset += n;
+  return n != 0;
+}
+
+size_t DiscoveryBatchMsg::decode(Span payload) {
+  if (payload.size < 6) {
+    return 0;
+  }
+  hash = payload.getU32(0);
+  totalCount = payload[4];
+  count = payload[5];
+  entities = payload.subspan(6);
+  return payload.size;
+}
+
+size_t DiscoveryBatchMsg::encode(uint8_t* buf, size_t length) const {
+  if (length < 6 + entities.size) {
+    return 0;
+  }
+  putU32(buf, hash);
+  buf[4] = totalCount;
+  buf[5] = count;
+  if (entities.size > 0) {
+    memcpy(&buf[6], entities.data, entities.size);
+  }
+  return 6 + entities.size;
+}
+
+size_t AnnounceMsg::decode(Span payload) {
+  if (payload.size < 5) {
+    return 0;
+  }
+  hash = payload.getU32(0);
+  entityCount = payload[4];
+  // Nodes before RX windows send no period, they receive continuously.
+  rxPeriod_s = payload.size >= 7 ? payload.getU16(5) : 0;
+  return payload.size >= 7 ? 7 : 5;
+}
+
+size_t AnnounceMsg::encode(uint8_t* buf, size_t length) const {
+  if (length < 7) {
+    return 0;
+  }
+  putU32(buf, hash);
+  buf[4] = entityCount;
+  putU16(&buf[5], rxPeriod_s);
+  return 7;
+}
+
+size_t ValueReq::decode(Span payload) {
+  if (payload.size < 1) {
+    return 0;
+  }
+  entityId = payload[0];
+  return 1;
+}
+
+size_t ValueReq::encode(uint8_t* buf, size_t length) const {
+  if (length < 1) {
+    return 0;
+  }
+  buf[0] = entityId;
+  return 1;
+}
+
+size_t ValueSetReq::decode(Span payload) {
+  if (payload.size < VALUE_ITEM_SIZE) {
+    return 0;
+  }
+  entityId = payload[0];
+  value = payload.getU32(1);
+  return VALUE_ITEM_SIZE;
+}
+
+size_t ValueSetReq::encode(uint8_t* buf, size_t length) const {
+  if (length < VALUE_ITEM_SIZE) {
+    return 0;
+  }
+  buf[0] = entityId;
+  putU32(&buf[1], value);
+  return VALUE_ITEM_SIZE;
+}
+
+size_t ServiceReq::decode(Span payload) {
+  if (payload.size < 2) {
+    return 0;
+  }
+  entityId = payload[0];
+  service = payload[1];
+  return 2;
+}
+
+size_t ServiceReq::encode(uint8_t* buf, size_t length) const {
+  if (length < 2) {
+    return 0;
+  }
+  buf[0] = entityId;
+  buf[1] = service;
+  return 2;
+}
+
+ValueReader::ValueReader(const Header& header, Span payload)
+    : mPayload{payload},
+      mIsCompact{header.isCompactValues()},
+      mIsBitmap{header.isBitmapValues()} {
+  if (mIsBitmap) {
+    if (payload.size < BITMAP_HEADER_LENGTH || payload[1] == 0 ||
+        payload[1] > MAX_BITMAP_LENGTH ||
+        payload.size < static_cast<size_t>(BITMAP_HEADER_LENGTH + payload[1])) {
+      mIsError = true;
+      return;
+    }
+    mOffset = BITMAP_HEADER_LENGTH + payload[1];
+  } else {
+    if (payload.size < 1) {
+      mIsError = true;
+      return;
+    }
+    mRemaining = payload[0];
+    mOffset = 1;
+  }
+}
+
+bool ValueReader::nextBitmapId(uint8_t& entityId) {
+  const uint8_t first = mPayload[0];
+  const uint16_t bits = 8 * mPayload[1];
+
+  for (; mBit < bits; mBit++) {
+    if ((mPayload[BITMAP_HEADER_LENGTH + mBit / 8] & (1 << (mBit % 8))) == 0) {
+      continue;
+    }
+    // Entity Id 255 means all entities and is never sent.
+    if (first + mBit >= ALL_ENTITIES) {
+      mIsError = true;
+      return false;
+    }
+    entityId = static_cast<uint8_t>(first + mBit++);
+    return true;
+  }
+  return false;
+}
+
+bool ValueReader::next(RawValue& value) {
+  if (mIsError) {
+    return false;
+  }
+
+  Span rest = mPayload.subspan(mOffset);
+
+  if (mIsBitmap) {
+    if (!nextBitmapId(value.entityId)) {
+      return false;
+    }
+
+    uint8_t n = 0;
+    if (mIsCompact) {
+      if (mCount % MODES_PER_BYTE == 0) {
+        if (rest.size < 1) {
+          mIsError = true;
+          return false;
+        }
+        mModes = rest[0];
+        rest = rest.subspan(1);
+        n = 1;
+      }
+      const uint8_t shift = MODE_BITS * (mCount % MODES_PER_BYTE);
+      value.mode = static_cast<ValueMode>((mModes >> shift) & MODE_MASK);
+      const uint8_t m = readCompactValue(rest, value.mode, value.value);
+      if (m == 0 || value.mode == ValueMode::plain) {
+        mIsError = true;
+        return false;
+      }
+      n += m;
+    } else {
+      if (rest.size < sizeof(value.value)) {
+        mIsError = true;
+        return false;
+      }
+      value.mode = ValueMode::plain;
+      value.value = rest.getU32(0);
+      n = sizeof(value.value);
+    }
+    mOffset += n;
+    mCount++;
+    return true;
+  }
+
+  if (mRemaining == 0) {
+    return false;
+  }
+
+  if (mIsCompact) {
+    if (rest.size < 1) {
+      mIsError = true;
+      return false;
+    }
+    value.mode = static_cast<ValueMode>(rest[0] >> MODE_SHIFT);
+    value.entityId = rest[0] & ENTITY_ID_MASK;
+    uint8_t n = 1;
+    if (value.entityId == ENTITY_ID_ESCAPE) {
+      if (rest.size < 2) {
+        mIsError = true;
+        return false;
+      }
+      value.entityId = rest[1];
+      n = 2;
+    }
+    const uint8_t m = readCompactValue(rest.subspan(n), value.mode,
+                                       value.value);
+    if (m == 0 || value.mode == ValueMode::plain) {
+      mIsError = true;
+      return false;
+    }
+    mOffset += n + m;
+  } else {
+    if (rest.size < VALUE_ITEM_SIZE) {
+      mIsError = true;
+      return false;
+    }
+    value.entityId = rest[0];
+    value.mode = ValueMode::plain;
+    value.value = rest.getU32(1);
+    mOffset += VALUE_ITEM_SIZE;
+  }
+  mRemaining--;
+  mCount++;
+  return true;
+}
+
+ValueWriter::ValueWriter(const Header& header, uint8_t* buf, size_t length,
+                         uint8_t first, uint8_t last)
+    : mBuf{buf},
+      mSize{length},
+      mIsCompact{header.isCompactValues()},
+      mIsBitmap{header.isBitmapValues()} {
+  if (mIsBitmap) {
+    const uint8_t bitmapLength =
+        last >= first ? static_cast<uint8_t>((last - first) / 8 + 1) : 1;
+    mLength = BITMAP_HEADER_LENGTH + bitmapLength;
+    if (length < mLength) {
+      mIsError = true;
+      return;
+    }
+    buf[0] = first;
+    buf[1] = bitmapLength;
+    memset(&buf[BITMAP_HEADER_LENGTH], 0, bitmapLength);
+  } else {
+    if (length < 1) {
+      mIsError = true;
+      return;
+    }
+    buf[0] = 0;
+    mLength = 1;
+  }
+}
+
+bool ValueWriter::add(const RawValue& value) {
+  if (mIsError || mIsCompact != (value.mode != ValueMode::plain)) {
+    return false;
+  }
+
+  uint8_t* buf = &mBuf[mLength];
+  const size_t length = mSize - mLength;
+  size_t n = 0;
+
+  if (mIsBitmap) {
+    const uint8_t first = mBuf[0];
+    const uint16_t bit = value.entityId - first;
+    if (value.entityId < first || bit >= 8U * mBuf[1] ||
+        (mCount > 0 && value.entityId <= mLastId)) {
+      return false;  // Out of range or order
+    }
+
+    if (mIsCompact) {
+      const uint8_t group = mCount % MODES_PER_BYTE;
+      const uint8_t head = group == 0 ? 1 : 0;
+      if (length <= head) {
+        return false;
+      }
+      const uint8_t m = writeCompactValue(&buf[head], length - head,
+                                          value.mode, value.value);
+      if (m == 0) {
+        return false;
+      }
+      if (head) {
+        buf[0] = 0;
+        mModeIndex = mLength;
+      }
+      mBuf[mModeIndex] |= static_cast<uint8_t>(value.mode)
+                          << (MODE_BITS * group);
+      n = head + m;
+    } else {
+      if (length < sizeof(value.value)) {
+        return false;
+      }
+      putU32(buf, value.value);
+      n = sizeof(value.value);
+    }
+    mBuf[BITMAP_HEADER_LENGTH + bit / 8] |= 1 << (bit % 8);
+    mLastId = value.entityId;
+  } else {
+    if (mCount == UINT8_MAX) {
+      return false;
+    }
+    if (mIsCompact) {
+      const uint8_t modeBits = static_cast<uint8_t>(value.mode) << MODE_SHIFT;
+      const uint8_t head = value.entityId < ENTITY_ID_ESCAPE ? 1 : 2;
+      if (length < head) {
+        return false;
+      }
+      const uint8_t m = writeCompactValue(&buf[head], length - head,
+                                          value.mode, value.value);
+      if (m == 0) {
+        return false;
+      }
+      if (head == 1) {
+        buf[0] = modeBits | value.entityId;
+      } else {
+        buf[0] = modeBits | ENTITY_ID_ESCAPE;
+        buf[1] = value.entityId;
+      }
+      n = head + m;
+    } else {
+      if (length < VALUE_ITEM_SIZE) {
+        return false;
+      }
+      buf[0] = value.entityId;
+      putU32(&buf[1], value.value);
+      n = VALUE_ITEM_SIZE;
+    }
+    mBuf[0]++;
+  }
+
+  mLength += n;
+  mCount++;
+  return true;
+}
+
+void ValueDecoder::addEntity(uint8_t entityId, bool isSigned,
+                             uint8_t sizeCode) {
+  EntityT& e = mEntities[entityId];
+  e.flags = FLAG_KNOWN | (isSigned ? FLAG_SIGNED : 0);
+  e.sizeCode = sizeCode;
+}
+
+bool ValueDecoder::decode(const Header& header, Span payload, Value* values,
+                          size_t maxCount, size_t& count) {
+  ValueReader reader(header, payload);
+  RawValue raw;
+  count = 0;
+
+  while (reader.next(raw)) {
+    if (count == maxCount) {
+      return false;
+    }
+
+    EntityT& e = mEntities[raw.entityId];
+    const bool isSigned = e.flags & FLAG_SIGNED;
+    uint32_t v = raw.value;
+
+    switch (raw.mode) {
+      case ValueMode::absolute:
+        if (isSigned) {
+          v = static_cast<uint32_t>(unzigzag(v));
+        }
+        break;
+
+      case ValueMode::delta:
+        if ((e.flags & FLAG_LAST) == 0) {
+          return false;
+        }
+        v = e.last + static_cast<uint32_t>(unzigzag(v));
+        break;
+
+      default:
+        break;
+    }
+
+    // Sign extend or truncate to the entity size
+    if ((e.flags & FLAG_KNOWN) && e.sizeCode < 2) {
+      const uint8_t bits = 8 << e.sizeCode;
+      const uint32_t mask = (1UL << bits) - 1;
+      v &= mask;
+      if (isSigned && (v >> (bits - 1)) != 0) {
+        v |= ~mask;
+      }
+    }
+
+    e.flags |= FLAG_LAST;
+    e.last = v;
+    values[count++] = Value{raw.entityId, v};
+  }
+
+  return !reader.isError();
+}
+
+}  // namespace LoRaFrame
@@ -0,0 +1,340 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Host side decoder and encoder of the LoRa frames of the node.
+ *
+ * The frame format is described in LoRaHandler.h, compact values in
+ * CompactValue.h and compact discovery in CompactDiscovery.h. This library
+ * has no Arduino dependencies, for gateways and tools.
+ *
+ * Decoding is zero-copy: frames and payloads are read through a Span of the
+ * received bytes, which must outlive what is decoded from them. Like the
+ * node, decode() returns the number of bytes read and encode() the number of
+ * bytes written, 0 on error or if it doesn't fit.
+ */
+namespace LoRaFrame {
+
+constexpr uint8_t HEADER_LENGTH = 4;
+constexpr uint8_t MAX_FRAME_LENGTH = 150;
+constexpr uint8_t MAX_PAYLOAD_LENGTH = MAX_FRAME_LENGTH - HEADER_LENGTH;
+constexpr uint8_t ALL_ENTITIES = 255;
+constexpr uint8_t ACK_PAYLOAD = '!';
+
+constexpr uint8_t FLAG_ACK = 0x80;
+constexpr uint8_t FLAG_ACK_REQUEST = 0x40;
+constexpr uint8_t FLAG_COMPACT_VALUES = 0x20;
+constexpr uint8_t FLAG_BITMAP_VALUES = 0x10;
+constexpr uint8_t MSG_TYPE_MASK = 0x0F;
+
+enum class MsgType : uint8_t {
+  ping_req,
+  ping_msg,
+  discovery_req,
+  discovery_msg,
+  value_req,
+  value_msg,
+  valueSet_req,
+  service_req,
+  discovery_batch_msg,
+  announce_msg
+};
+
+/**
+ * @brief View of bytes, not owning them.
+ */
+struct Span {
+  const uint8_t* data{};
+  size_t size{};
+
+  Span() = default;
+  Span(const uint8_t* d, size_t s) : data{d}, size{s} {}
+
+  uint8_t operator[](size_t i) const { return data[i]; }
+
+  // Bytes from offset, empty if offset is beyond the end.
+  Span subspan(size_t offset) const {
+    return offset < size ? Span(data + offset, size - offset) : Span();
+  }
+
+  // Big endian, i + 2 <= size
+  uint16_t getU16(size_t i) const {
+    return static_cast<uint16_t>(data[i] << 8 | data[i + 1]);
+  }
+
+  // Big endian, i + 4 <= size
+  uint32_t getU32(size_t i) const {
+    return static_cast<uint32_t>(data[i]) << 24 |
+           static_cast<uint32_t>(data[i + 1]) << 16 |
+           static_cast<uint32_t>(data[i + 2]) << 8 | data[i + 3];
+  }
+};
+
+struct Header {
+  uint8_t dst{};
+  uint8_t src{};
+  uint8_t id{};
+  uint8_t flags{};
+
+  MsgType getMsgType() const {
+    return static_cast<MsgType>(flags & MSG_TYPE_MASK);
+  }
+  void setMsgType(MsgType msgType) {
+    flags = (flags & ~MSG_TYPE_MASK) | static_cast<uint8_t>(msgType);
+  }
+
+  bool isAck() const { return flags & FLAG_ACK; }
+  bool isAckRequest() const { return flags & FLAG_ACK_REQUEST; }
+  bool isCompactValues() const { return flags & FLAG_COMPACT_VALUES; }
+  bool isBitmapValues() const { return flags & FLAG_BITMAP_VALUES; }
+
+  size_t decode(Span bytes);
+  size_t encode(uint8_t* buf, size_t length) const;
+};
+
+/**
+ * @brief A received frame, header and a view of the payload.
+ */
+struct Frame {
+  Header header;
+  Span payload;
+
+  // Takes all bytes, header included. 0 if shorter than a header.
+  size_t decode(Span bytes);
+};
+
+struct PingMsg {
+  int16_t rssi{};  // Of the ping request
+
+  size_t decode(Span payload);
+  size_t encode(uint8_t* buf, size_t length) const;
+};
+
+struct DiscoveryReq {
+  uint8_t entityId{ALL_ENTITIES};
+  bool hasHash{};  // Schema hash cached by the gateway
+  uint32_t hash{};
+
+  size_t decode(Span payload);
+  size_t encode(uint8_t* buf, size_t length) const;
+};
+
+/**
+ * @brief Entity of a discovery or discovery batch message. The name is a view
+ * of the bytes as sent, plain or with dictionary words.
+ */
+struct DiscoveryEntity {
+  static constexpr uint8_t HEADER_SIZE = 14;  // All but the name
+  static constexpr size_t MAX_NAME_SIZE = 256;  // Decoded, terminator included
+
+  uint8_t entityId{};
+  uint8_t componentType{};
+  uint8_t deviceClass{};
+  uint8_t category{};
+  uint8_t unit{};
+  uint8_t format{};  // Signed, size code and precision
+  uint32_t minValue{};
+  uint32_t maxValue{};
+  Span name;  // Terminator included
+  bool isCompactName{};
+
+  bool isSigned() const { return format & 0x10; }
+  uint8_t getSizeCode() const { return (format >> 2) & 0x03; }
+  uint8_t getPrecision() const { return format & 0x03; }
+
+  /**
+   * @brief Decoded name.
+   * @return Length of the name, 0 on error or if it doesn't fit in size.
+   */
+  size_t getName(char* buf, size_t size) const;
+
+  /**
+   * @brief Add the entity to a discovery schema hash, see CompactDiscovery.h.
+   * @param hash FNV_OFFSET_BASIS for the first entity, then the previous hash.
+   */
+  uint32_t hash(uint32_t hash) const;
+
+  size_t decode(Span bytes, bool compactName);
+  size_t encode(uint8_t* buf, size_t length) const;
+};
+
+constexpr uint32_t FNV_OFFSET_BASIS = 2166136261UL;
+
+/**
+ * @brief Encode a name with the dictionary words of compact discovery.
+ * @return Number of bytes written, terminator included. 0 if it doesn't fit.
+ */
+size_t encodeCompactName(const char* name, uint8_t* buf, size_t length);
+
+struct DiscoveryBatchMsg {
+  uint32_t hash{};
+  uint8_t totalCount{};  // Entities of the node
+  uint8_t count{};       // Entities in this message
+  Span entities;         // Compact discovery entities
+
+  /**
+   * @brief Read the entity at offset in entities and move offset past it.
+   * @return false at the end or on error.
+   */
+  bool nextEntity(size_t& offset, DiscoveryEntity& entity) const;
+
+  size_t decode(Span payload);
+  size_t encode(uint8_t* buf, size_t length) const;
+};
+
+struct AnnounceMsg {
+  uint32_t hash{};
+  uint8_t entityCount{};
+  uint16_t rxPeriod_s{};  // 0 for continuous receive
+
+  size_t decode(Span payload);
+  size_t encode(uint8_t* buf, size_t length) const;
+};
+
+struct ValueReq {
+  uint8_t entityId{ALL_ENTITIES};
+
+  size_t decode(Span payload);
+  size_t encode(uint8_t* buf, size_t length) const;
+};
+
+// A single value item, which is what the node parses.
+struct ValueSetReq {
+  uint8_t entityId{};
+  uint32_t value{};
+
+  size_t decode(Span payload);
+  size_t encode(uint8_t* buf, size_t length) const;
+};
+
+struct ServiceReq {
+  uint8_t entityId{};
+  uint8_t service{};
+
+  size_t decode(Span payload);
+  size_t encode(uint8_t* buf, size_t length) const;
+};
+
+// How a value is encoded, CompactValue::Mode but for plain
+enum class ValueMode : uint8_t { absolute, delta, raw, plain };
+
+/**
+ * @brief Value as sent. Absolute values of signed entities and deltas are
+ * still zig-zag encoded, see ValueDecoder to resolve them.
+ */
+struct RawValue {
+  uint8_t entityId;
+  ValueMode mode;
+  uint32_t value;
+};
+
+/**
+ * @brief Reads the values of a value message, in all four formats.
+ */
+class ValueReader {
+ public:
+  ValueReader(const Header& header, Span payload);
+
+  /**
+   * @return false at the end or on error, see isError().
+   */
+  bool next(RawValue& value);
+
+  bool isError() const { return mIsError; }
+
+ private:
+  bool nextBitmapId(uint8_t& entityId);
+
+  Span mPayload;
+  size_t mOffset{};
+  uint16_t mRemaining{};  // Items left, counted formats only
+  uint16_t mBit{};        // Next bitmap bit to look at
+  uint8_t mModes{};       // Mode byte of the current group
+  uint8_t mCount{};       // Values read
+  bool mIsCompact;
+  bool mIsBitmap;
+  bool mIsError{};
+};
+
+/**
+ * @brief Writes a value message in the format of the header flags. The inverse
+ * of ValueReader.
+ */
+class ValueWriter {
+ public:
+  /**
+   * @param first, last Entity id range of a bitmap message.
+   */
+  ValueWriter(const Header& header, uint8_t* buf, size_t length,
+              uint8_t first = 0, uint8_t last = 0);
+
+  /**
+   * @brief Add a value. Bitmap values must be in ascending entity id order.
+   * @return false if it doesn't fit.
+   */
+  bool add(const RawValue& value);
+
+  // Payload length so far, 0 on error.
+  size_t getLength() const { return mIsError ? 0 : mLength; }
+
+ private:
+  uint8_t* mBuf;
+  size_t mSize;
+  size_t mLength{};
+  size_t mModeIndex{};  // Of the mode byte of the current group
+  uint8_t mCount{};
+  uint8_t mLastId{};
+  bool mIsCompact;
+  bool mIsBitmap;
+  bool mIsError{};
+};
+
+/**
+ * @brief Value of an entity as on the node.
+ */
+struct Value {
+  uint8_t entityId;
+  uint32_t value;  // Sign extended if the entity is signed
+};
+
+/**
+ * @brief Resolves values of one node: zig-zag and deltas of compact values,
+ * sign extension to the entity size.
+ *
+ * Deltas are to the last value of the entity. The node only sends a delta to
+ * a value that the gateway has ACKed, so all decoded frames are assumed to be
+ * ACKed when they ask for it.
+ */
+class ValueDecoder {
+ public:
+  void addEntity(const DiscoveryEntity& entity) {
+    addEntity(entity.entityId, entity.isSigned(), entity.getSizeCode());
+  }
+  void addEntity(uint8_t entityId, bool isSigned, uint8_t sizeCode);
+
+  /**
+   * @brief Decode the values of a value message.
+   * @param[out] values Room for maxCount values.
+   * @param[out] count Number of values decoded.
+   * @return false on error, e.g. a delta without a value before it.
+   */
+  bool decode(const Header& header, Span payload, Value* values,
+              size_t maxCount, size_t& count);
+
+ private:
+  static constexpr uint8_t FLAG_KNOWN = 0x01;
+  static constexpr uint8_t FLAG_SIGNED = 0x02;
+  static constexpr uint8_t FLAG_LAST = 0x04;
+
+  struct EntityT {
+    uint8_t flags;
+    uint8_t sizeCode;
+    uint32_t last;
+  };
+
+  EntityT mEntities[256]{};
+};
+
+}  // namespace LoRaFrame
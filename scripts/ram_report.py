@@ -0,0 +1,193 @@
+"""Static RAM report of the firmware, .data and .bss per subsystem.
+
+PlatformIO runs it after linking the AVR firmware, see platformio.ini. It can
+also be run by hand on an ELF file:
+
+    python scripts/ram_report.py .pio/build/pro8MHzatmega328/firmware.elf
+
+Symbols are grouped by subsystem with the name patterns in SUBSYSTEMS. The
+members of the objects in EXPAND are listed from the debug info, e.g. the
+AirTime ring buffer and frame buffers of LoRaHandler.
+"""
+
+import argparse
+import re
+import subprocess
+import sys
+
+RAM_SIZE = 2048  # ATmega328P
+STACK_WARNING = 512  # Least RAM left for the stack without a warning
+
+# First match wins, patterns are matched against the whole demangled name.
+SUBSYSTEMS = [
+    ("LoRaHandler", r"lora|LoRa\w*|LoRaHandler::.*|LoRaClass::.*"),
+    ("Components", r"device|components|config\w*|.*Sensor\w*|garageCover|"
+                   r"aht\w*|sonar\w*|Device::.*|ConfigItem.*"),
+    ("PowerManager", r"powerManager|PowerManager::.*"),
+    ("MemoryMonitor", r"memoryMonitor|MemoryMonitor::.*"),
+    ("Serial", r"Serial\w*|HardwareSerial::.*"),
+    ("SPI and Wire", r"SPI\w*|Wire\w*|TwoWire::.*|twi_\w*"),
+    ("Arduino core", r"timer0_\w*|__\w*|_\w*"),
+]
+
+# Objects to break down by member, name: class.
+EXPAND = {"lora": "LoRaHandler"}
+
+RAM_SECTIONS = (".data", ".bss", ".noinit")
+
+
+def run(tool, *args):
+    return subprocess.run([tool, *args], check=True, capture_output=True,
+                          text=True).stdout
+
+
+def section_sizes(prefix, elf):
+    sizes = {}
+    for line in run(prefix + "size", "-A", elf).splitlines():
+        fields = line.split()
+        if len(fields) >= 2 and fields[0] in RAM_SECTIONS:
+            sizes[fields[0]] = int(fields[1])
+    return sizes
+
+
+def ram_symbols(prefix, elf):
+    """Yield (name, size, section) of the named objects in RAM."""
+    for line in run(prefix + "nm", "-C", "-S", "-t", "d", elf).splitlines():
+        fields = line.split(maxsplit=3)
+        if len(fields) != 4 or fields[2] not in "bBdD":
+            continue
+        section = ".bss" if fields[2] in "bB" else ".data"
+        yield fields[3], int(fields[1]), section
+
+
+def subsystem_of(name):
+    for subsystem, pattern in SUBSYSTEMS:
+        if re.fullmatch(pattern, name):
+            return subsystem
+    return "Other"
+
+
+DIE_RE = re.compile(r"^\s*<(\d+)><[0-9a-f]+>: Abbrev Number: \d+ \((\w+)\)")
+ATTR_RE = re.compile(r"^\s*<[0-9a-f]+>\s+(DW_AT_\w+)\s*: (.*)$")
+
+
+def class_members(prefix, elf, class_name):
+    """Return (byte size, [(member, offset, size)]) from DWARF, or None."""
+    proc = subprocess.Popen([prefix + "readelf", "--debug-dump=info", elf],
+                            stdout=subprocess.PIPE, text=True)
+    byte_size = None
+    members = []
+    depth = None  # Depth of the class DIE while inside it
+    die = None
+    for line in proc.stdout:
+        m = DIE_RE.match(line)
+        if m:
+            level, tag = int(m.group(1)), m.group(2)
+            if depth is not None and level <= depth:
+                if byte_size is not None:
+                    break
+                depth = None
+            die = {"level": level, "tag": tag}
+            if depth is not None and level == depth + 1 and tag == "DW_TAG_member":
+                members.append(die)
+            continue
+        m = ATTR_RE.match(line)
+        if not m or die is None:
+            continue
+        attr, value = m.groups()
+        value = value.rsplit(": ", 1)[-1].strip()  # Drop "(indirect string...)"
+        die[attr] = value
+        if (depth is None and attr == "DW_AT_name" and value == class_name
+                and die["tag"] in ("DW_TAG_class_type", "DW_TAG_structure_type")):
+            depth = die["level"]
+            members = []
+            byte_size = None
+        elif depth is not None and die["level"] == depth:
+            if attr == "DW_AT_byte_size":
+                byte_size = int(value)
+            elif attr == "DW_AT_declaration":
+                depth = None  # Only a declaration, look further
+    proc.stdout.close()
+    proc.kill()
+    proc.wait()
+
+    if byte_size is None:
+        return None
+    located = []
+    for member in members:
+        location = member.get("DW_AT_data_member_location")
+        if location is None:
+            continue  # Static member
+        offset = int(re.search(r"(\d+)\)?$", location).group(1))
+        located.append((member.get("DW_AT_name", "?"), offset))
+    located.sort(key=lambda m: m[1])
+    ends = [offset for _, offset in located[1:]] + [byte_size]
+    return byte_size, [(name, offset, end - offset)
+                       for (name, offset), end in zip(located, ends)]
+
+
+def report(elf, prefix="avr-", ram_size=RAM_SIZE, out=sys.stdout):
+    sections = section_sizes(prefix, elf)
+    static = sum(sections.values())
+
+    groups = {}
+    named = 0
+    for name, size, section in ram_symbols(prefix, elf):
+        group = groups.setdefault(subsystem_of(name), {".data": 0, ".bss": 0})
+        group[section] += size
+        named += size
+
+    print("RAM usage by subsystem (bytes)", file=out)
+    print(f"  {'Subsystem':<24}{'.data':>7}{'.bss':>7}{'Total':>7}", file=out)
+    for subsystem, group in sorted(groups.items(),
+                                   key=lambda g: -sum(g[1].values())):
+        print(f"  {subsystem:<24}{group['.data']:>7}{group['.bss']:>7}"
+              f"{sum(group.values()):>7}", file=out)
+    if static > named:
+        # String literals not in PROGMEM and padding have no symbols.
+        print(f"  {'Unnamed, e.g. literals':<24}{'':>14}{static - named:>7}",
+              file=out)
+
+    for obj, class_name in EXPAND.items():
+        layout = class_members(prefix, elf, class_name)
+        if layout is None:
+            print(f"{obj}: no debug info for {class_name}, build with -g",
+                  file=out)
+            continue
+        byte_size, members = layout
+        print(f"{obj} ({class_name}, {byte_size} bytes, members with padding)",
+              file=out)
+        for name, _, size in sorted(members, key=lambda m: -m[2]):
+            print(f"  {name:<24}{size:>21}", file=out)
+
+    free = ram_size - static
+    print(", ".join(f"{s} {n}" for s, n in sections.items()) +
+          f", {free} of {ram_size} bytes left for the stack", file=out)
+    if free < STACK_WARNING:
+        print(f"Warning: less than {STACK_WARNING} bytes left for the stack",
+              file=out)
+    return free
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("elf")
+    parser.add_argument("--tool-prefix", default="avr-",
+                        help="binutils prefix, empty for host tools")
+    parser.add_argument("--ram-size", type=int, default=RAM_SIZE)
+    args = parser.parse_args()
+    report(args.elf, args.tool_prefix, args.ram_size)
+
+
+try:
+    Import("env")  # noqa: F821, run as a PlatformIO extra script
+except NameError:
+    if __name__ == "__main__":
+        main()
+else:
+    def _after_link(target, source, env):
+        cc = env.subst("$CC")
+        report(str(target[0]), cc[: -len("gcc")] if cc.endswith("gcc") else "",
+               int(env.BoardConfig().get("upload.maximum_ram_size", RAM_SIZE)))
+
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", _after_link)  # noqa: F821
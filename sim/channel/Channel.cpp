@@ -0,0 +1,379 @@
+#include "Channel.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <queue>
+#include <random>
+
+#include "../src/Gateway.h"
+#include "AirTime.h"
+#include "LoRaHandler.h"
+
+static constexpr uint64_t US_PER_MS = 1000;
+static constexpr uint8_t GATEWAY_AIRTIME_BUCKETS = 60;
+
+static double toMilliwatt(float dBm) { return pow(10.0, dBm / 10.0); }
+
+static float toDbm(double mW) { return static_cast<float>(10.0 * log10(mW)); }
+
+// splitmix64, a well mixed hash of the seed and an index
+static uint64_t mix(uint64_t x) {
+  x += 0x9E3779B97F4A7C15ULL;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+// Decoded if the signal is above the sensitivity and the capture margin.
+static bool isDecoded(float signal_dBm, double interference_mW) {
+  if (signal_dBm < ChannelConstants::SENSITIVITY_DBM) {
+    return false;
+  }
+  return interference_mW <= 0.0 ||
+         signal_dBm - toDbm(interference_mW) >= ChannelConstants::CAPTURE_DB;
+}
+
+static bool isValueMsg(uint8_t flags) {
+  return (flags & FLAGS_MSG_TYPE_MASK) ==
+         static_cast<uint8_t>(LoRaMsgType::value_msg);
+}
+
+void ChannelResult::merge(const ChannelResult& other) {
+  duration_ms += other.duration_ms;
+  nodeCount += other.nodeCount;
+  generatedCount += other.generatedCount;
+  supersededCount += other.supersededCount;
+  deferredCount += other.deferredCount;
+  sentCount += other.sentCount;
+  sentBytes += other.sentBytes;
+  airTime_us += other.airTime_us;
+  maxNodeAirTime_ms = std::max(maxNodeAirTime_ms, other.maxNodeAirTime_ms);
+  deliveredCount += other.deliveredCount;
+  deliveredBytes += other.deliveredBytes;
+  weakCount += other.weakCount;
+  collisionCount += other.collisionCount;
+  busyCount += other.busyCount;
+  gatewayTxCount += other.gatewayTxCount;
+  ackRequestCount += other.ackRequestCount;
+  ackSkippedCount += other.ackSkippedCount;
+  ackSentCount += other.ackSentCount;
+  ackReceivedCount += other.ackReceivedCount;
+  gatewayAirTime_us += other.gatewayAirTime_us;
+  latencies_ms.insert(latencies_ms.end(), other.latencies_ms.begin(),
+                      other.latencies_ms.end());
+  nodePdrs.insert(nodePdrs.end(), other.nodePdrs.begin(),
+                  other.nodePdrs.end());
+  nodeRssis_dBm.insert(nodeRssis_dBm.end(), other.nodeRssis_dBm.begin(),
+                       other.nodeRssis_dBm.end());
+}
+
+Channel::Channel(const UplinkTrace& trace, const ChannelOptions& options)
+    : mTrace{trace},
+      mOptions{options},
+      mDuration_ms{options.duration_ms != 0 ? options.duration_ms
+                                            : trace.getDuration_ms()} {}
+
+ChannelResult Channel::run() {
+  ChannelResult result;
+  result.duration_ms = mDuration_ms;
+  result.nodeCount = mOptions.nodeCount;
+
+  placeNodes();
+
+  mFrames.clear();
+  for (uint16_t node = 0; node < mOptions.nodeCount; node++) {
+    scheduleNode(node, result);
+  }
+  std::sort(mFrames.begin(), mFrames.end(),
+            [](const Frame& a, const Frame& b) {
+              return a.start_us < b.start_us;
+            });
+
+  runAir(result);
+
+  for (uint16_t node = 0; node < mOptions.nodeCount; node++) {
+    const Node& n = mNodes[node];
+    if (n.sentCount > 0) {
+      result.nodePdrs.push_back(static_cast<float>(n.deliveredCount) /
+                                n.sentCount);
+    }
+    result.nodeRssis_dBm.push_back(n.rssi_dBm);
+  }
+  return result;
+}
+
+void Channel::placeNodes() {
+  std::mt19937 random(static_cast<uint32_t>(mix(mOptions.seed)));
+  std::uniform_real_distribution<float> x(0.0f, mOptions.width_m);
+  std::uniform_real_distribution<float> y(0.0f, mOptions.length_m);
+
+  mNodes.assign(mOptions.nodeCount + 1, Node{});
+  for (uint16_t node = 0; node < mOptions.nodeCount; node++) {
+    mNodes[node].x_m = x(random);
+    mNodes[node].y_m = y(random);
+  }
+
+  const uint16_t gateway = mOptions.nodeCount;
+  mNodes[gateway].x_m = mOptions.width_m / 2;
+  mNodes[gateway].y_m = mOptions.length_m / 2;
+
+  for (uint16_t node = 0; node < mOptions.nodeCount; node++) {
+    mNodes[node].rssi_dBm =
+        mOptions.txPower_dBm - getLinkLoss_dB(node, gateway);
+  }
+}
+
+void Channel::scheduleNode(uint16_t node, ChannelResult& result) {
+  std::mt19937 random(static_cast<uint32_t>(mix(mOptions.seed ^ mix(node))));
+  const uint64_t period_ms = mTrace.getDuration_ms();
+  const uint64_t offset_ms =
+      std::uniform_int_distribution<uint64_t>(0, period_ms - 1)(random);
+  const double skew =
+      1.0 + std::uniform_real_distribution<double>(
+                -1.0, 1.0)(random) * mOptions.clockSkew_ppm / 1e6;
+
+  // Creation times in simulation time, the trace shifted by the offset and
+  // repeated for the whole duration.
+  std::vector<Frame> created;
+  for (uint64_t cycle_ms = 0; cycle_ms < mDuration_ms + offset_ms;
+       cycle_ms += period_ms) {
+    for (const UplinkRecord& record : mTrace.getRecords()) {
+      const uint64_t local_ms = cycle_ms + record.time_ms;
+      if (local_ms < offset_ms) {
+        continue;
+      }
+      const uint64_t time_ms =
+          static_cast<uint64_t>((local_ms - offset_ms) * skew);
+      if (time_ms >= mDuration_ms) {
+        break;
+      }
+      created.push_back(
+          Frame{0, 0, time_ms, node, record.length, record.flags});
+    }
+  }
+  result.generatedCount += created.size();
+
+  AirTime<AIRTIME_BUCKETS> airTime(AIRTIME_LIMIT_PPM, AIRTIME_BUCKET_MS);
+  std::vector<Frame> pending;
+  bool isDeferred = false;
+  uint64_t now_ms = 0;
+  size_t next = 0;
+
+  while (next < created.size() || !pending.empty()) {
+    if (pending.empty()) {
+      now_ms = std::max(now_ms, created[next].created_ms);
+    }
+
+    // Frames created meanwhile, queued values are replaced by newer ones
+    for (; next < created.size() && created[next].created_ms <= now_ms;
+         next++) {
+      const Frame& frame = created[next];
+      if (!pending.empty() && isValueMsg(frame.flags) &&
+          isValueMsg(pending.back().flags)) {
+        Frame& merged = pending.back();
+        merged.length = std::max(merged.length, frame.length);
+        result.supersededCount++;
+      } else {
+        pending.push_back(frame);
+      }
+    }
+
+    Frame& frame = pending.front();
+    const uint32_t timeOnAir_us = LoRaHandler::getTimeOnAir_us(frame.length);
+    const uint32_t timeOnAir_ms = TimeOnAir::toMs(timeOnAir_us);
+    const uint32_t now32_ms = static_cast<uint32_t>(now_ms);
+
+    if (airTime.getTime_ms(now32_ms) + timeOnAir_ms > airTime.getLimit_ms()) {
+      // Try again when the window has moved a bucket
+      if (!isDeferred) {
+        result.deferredCount++;
+        isDeferred = true;
+      }
+      now_ms = (now_ms / AIRTIME_BUCKET_MS + 1) * AIRTIME_BUCKET_MS;
+      continue;
+    }
+    isDeferred = false;
+
+    frame.start_us = now_ms * US_PER_MS;
+    frame.end_us = frame.start_us + timeOnAir_us;
+    airTime.update(now32_ms, now32_ms + timeOnAir_ms);
+    result.maxNodeAirTime_ms =
+        std::max(result.maxNodeAirTime_ms, airTime.getTime_ms(now32_ms));
+    mMaxTimeOnAir_us = std::max<uint64_t>(mMaxTimeOnAir_us, timeOnAir_us);
+
+    result.sentCount++;
+    result.sentBytes += frame.length;
+    result.airTime_us += timeOnAir_us;
+    mNodes[node].sentCount++;
+    mFrames.push_back(frame);
+    pending.erase(pending.begin());
+
+    // The radio is busy until the end of the transmission
+    now_ms += timeOnAir_ms;
+  }
+}
+
+void Channel::runAir(ChannelResult& result) {
+  enum class EventType : uint8_t { uplinkEnd, ackStart, uplinkStart };
+  struct Event {
+    uint64_t time_us;
+    EventType type;
+    uint32_t index;  // Of the frame, of the ACKed frame for an ACK
+
+    bool operator>(const Event& other) const {
+      return time_us != other.time_us ? time_us > other.time_us
+                                      : type > other.type;
+    }
+  };
+  std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+
+  for (uint32_t i = 0; i < mFrames.size(); i++) {
+    events.push(Event{mFrames[i].start_us, EventType::uplinkStart, i});
+    events.push(Event{mFrames[i].end_us, EventType::uplinkEnd, i});
+  }
+
+  constexpr int64_t NONE = -1;
+  const uint32_t ackTimeOnAir_us =
+      LoRaHandler::getTimeOnAir_us(GatewayConstants::ACK_LENGTH);
+  const uint32_t ackTimeOnAir_ms = TimeOnAir::toMs(ackTimeOnAir_us);
+  // The gateway sends in most minutes, a bucket per minute of the hour keeps
+  // its airtime exact.
+  AirTime<GATEWAY_AIRTIME_BUCKETS> gatewayAirTime(AIRTIME_LIMIT_PPM,
+                                                  Util::MS_PER_MINUTE);
+
+  uint64_t txEnd_us = 0;      // Of the ACK on air
+  uint64_t ackFree_us = 0;    // End of the last scheduled ACK
+  int64_t locked = NONE;      // Frame the receiver is locked to
+  double lockedInterference_mW = 0.0;
+  double onAir_mW = 0.0;      // Sum of the uplinks on air at the gateway
+  uint32_t onAirCount = 0;
+
+  while (!events.empty()) {
+    const Event event = events.top();
+    events.pop();
+    const Frame& frame = mFrames[event.index];
+    const float signal_dBm = mNodes[frame.node].rssi_dBm;
+
+    switch (event.type) {
+      case EventType::uplinkStart:
+        if (event.time_us < txEnd_us) {
+          result.gatewayTxCount++;
+        } else if (signal_dBm < ChannelConstants::SENSITIVITY_DBM) {
+          result.weakCount++;
+        } else if (locked != NONE) {
+          result.busyCount++;
+        } else {
+          locked = event.index;
+          lockedInterference_mW = onAir_mW;
+        }
+        if (locked != NONE && locked != event.index) {
+          lockedInterference_mW += toMilliwatt(signal_dBm);
+        }
+        onAir_mW += toMilliwatt(signal_dBm);
+        onAirCount++;
+        break;
+
+      case EventType::uplinkEnd: {
+        onAirCount--;
+        onAir_mW = onAirCount > 0 ? onAir_mW - toMilliwatt(signal_dBm) : 0.0;
+        if (locked != event.index) {
+          break;
+        }
+        locked = NONE;
+
+        if (!isDecoded(signal_dBm, lockedInterference_mW)) {
+          result.collisionCount++;
+          break;
+        }
+        result.deliveredCount++;
+        result.deliveredBytes += frame.length;
+        result.latencies_ms.push_back(static_cast<uint32_t>(
+            (frame.end_us + US_PER_MS - 1) / US_PER_MS - frame.created_ms));
+        mNodes[frame.node].deliveredCount++;
+
+        if ((frame.flags & FLAGS_REQ_ACK_MASK) == 0) {
+          break;
+        }
+        result.ackRequestCount++;
+        const uint64_t start_us =
+            std::max(frame.end_us + GatewayConstants::REPLY_DELAY_MS *
+                                        US_PER_MS,
+                     ackFree_us);
+        const uint32_t start_ms = static_cast<uint32_t>(start_us / US_PER_MS);
+        if (gatewayAirTime.getTime_ms(start_ms) + ackTimeOnAir_ms >
+            gatewayAirTime.getLimit_ms()) {
+          result.ackSkippedCount++;
+          break;
+        }
+        gatewayAirTime.update(start_ms, start_ms + ackTimeOnAir_ms);
+        ackFree_us = start_us + ackTimeOnAir_us;
+        events.push(Event{start_us, EventType::ackStart, event.index});
+        break;
+      }
+
+      case EventType::ackStart:
+        // Half duplex, the frame being received is lost
+        if (locked != NONE) {
+          result.gatewayTxCount++;
+          locked = NONE;
+        }
+        txEnd_us = event.time_us + ackTimeOnAir_us;
+        result.ackSentCount++;
+        result.gatewayAirTime_us += ackTimeOnAir_us;
+        if (isAckReceived(frame.node, event.time_us, txEnd_us)) {
+          result.ackReceivedCount++;
+        }
+        break;
+    }
+  }
+}
+
+bool Channel::isAckReceived(uint16_t node, uint64_t start_us,
+                            uint64_t end_us) const {
+  // Uplinks overlapping the ACK, all started within the longest time on air
+  // before its end.
+  auto it = std::lower_bound(mFrames.begin(), mFrames.end(), end_us,
+                             [](const Frame& frame, uint64_t time_us) {
+                               return frame.start_us < time_us;
+                             });
+
+  double interference_mW = 0.0;
+  while (it != mFrames.begin()) {
+    --it;
+    if (it->start_us + mMaxTimeOnAir_us <= start_us) {
+      break;
+    }
+    if (it->end_us <= start_us) {
+      continue;
+    }
+    if (it->node == node) {
+      return false;  // Half duplex
+    }
+    interference_mW += toMilliwatt(mOptions.txPower_dBm -
+                                   getLinkLoss_dB(it->node, node));
+  }
+
+  return isDecoded(mNodes[node].rssi_dBm, interference_mW);
+}
+
+float Channel::getLinkLoss_dB(uint16_t a, uint16_t b) const {
+  const float dx = mNodes[a].x_m - mNodes[b].x_m;
+  const float dy = mNodes[a].y_m - mNodes[b].y_m;
+  const float distance_m =
+      std::max(sqrtf(dx * dx + dy * dy), ChannelConstants::MIN_DISTANCE_M);
+  return ChannelConstants::PATH_LOSS_1M_DB +
+         10.0f * mOptions.pathLossExponent * log10f(distance_m) +
+         getShadowing_dB(a, b);
+}
+
+float Channel::getShadowing_dB(uint16_t a, uint16_t b) const {
+  // The same for both directions of a link, Box-Muller of a hash of the link
+  const uint64_t link = static_cast<uint64_t>(std::min(a, b)) << 16 |
+                        std::max(a, b);
+  const uint64_t h = mix(mix(mOptions.seed) ^ link);
+  const double u1 = ((h >> 11) + 1.0) / 9007199254740993.0;  // (0, 1]
+  const double u2 = (mix(h) >> 11) / 9007199254740992.0;     // [0, 1)
+  return static_cast<float>(mOptions.shadowing_dB * sqrt(-2.0 * log(u1)) *
+                            cos(2.0 * M_PI * u2));
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "UplinkTrace.h"
+
+namespace ChannelConstants {
+constexpr float SENSITIVITY_DBM = -123.0f;  // SX1276 at SF7, 125 kHz
+constexpr float CAPTURE_DB = 6.0f;  // Margin over the interference to decode
+constexpr float PATH_LOSS_1M_DB = 31.2f;  // Free space at 1 m, 868 MHz
+constexpr float MIN_DISTANCE_M = 1.0f;
+}  // namespace ChannelConstants
+
+struct ChannelOptions {
+  uint16_t nodeCount{200};
+  uint64_t duration_ms{};  // 0 for the duration of the trace
+  float width_m{100.0f};   // Area of the nodes, the gateway in the middle
+  float length_m{60.0f};
+  float pathLossExponent{3.0f};
+  float shadowing_dB{6.0f};  // Standard deviation, fixed per link
+  int8_t txPower_dBm{17};    // LoRa library default, kept by main.cpp
+  uint16_t clockSkew_ppm{5000};  // Ceramic resonator of the Pro Mini
+  uint32_t seed{1};
+};
+
+/**
+ * @brief Outcome of one or more channel simulation runs.
+ */
+struct ChannelResult {
+  uint64_t duration_ms{};  // Sum over the runs
+  uint32_t nodeCount{};    // Sum over the runs
+
+  // Uplinks
+  uint32_t generatedCount{};   // Frames handed to the radio in the trace
+  uint32_t supersededCount{};  // Value messages merged into a later one
+  uint32_t deferredCount{};    // Frames that waited for the airtime budget
+  uint32_t sentCount{};
+  uint64_t sentBytes{};
+  uint64_t airTime_us{};
+  uint32_t maxNodeAirTime_ms{};  // Busiest hour of any node
+
+  // Gateway reception, each sent frame is counted once
+  uint32_t deliveredCount{};
+  uint64_t deliveredBytes{};
+  uint32_t weakCount{};       // Below the sensitivity
+  uint32_t collisionCount{};  // Interference within the capture margin
+  uint32_t busyCount{};       // Receiver locked to another frame
+  uint32_t gatewayTxCount{};  // Gateway was sending an ACK
+
+  // ACKs
+  uint32_t ackRequestCount{};   // Of delivered frames
+  uint32_t ackSkippedCount{};   // Airtime budget of the gateway reached
+  uint32_t ackSentCount{};
+  uint32_t ackReceivedCount{};
+  uint64_t gatewayAirTime_us{};
+
+  std::vector<uint32_t> latencies_ms;  // Creation to delivery, per frame
+  std::vector<float> nodePdrs;         // Delivered per sent, per node
+  std::vector<float> nodeRssis_dBm;    // At the gateway, per node
+
+  void merge(const ChannelResult& other);
+};
+
+/**
+ * @brief Shared 868 MHz channel with nodes replaying an uplink trace and a
+ * single channel gateway that ACKs.
+ *
+ * Each node replays the trace circularly from a random offset, with a random
+ * clock skew, so all nodes run the report policy of the firmware out of
+ * phase. Frames go through a per node AirTime budget like in LoRaHandler:
+ * frames wait for room, and a waiting value message is merged into the next
+ * one. Time on air is the one of the firmware radio settings.
+ *
+ * Nodes are placed at random in the area. Path loss is log-distance with
+ * log-normal shadowing fixed per link, between the nodes too. The gateway
+ * has one SX127x style receiver: it locks to the first frame above the
+ * sensitivity and misses the ones starting while locked or while it sends.
+ * The locked frame is decoded if it is CAPTURE_DB above the sum of all frames
+ * overlapping it. An ACK is received by the node under the same rules, and
+ * not while the node sends itself.
+ */
+class Channel {
+ public:
+  Channel(const UplinkTrace& trace, const ChannelOptions& options);
+
+  ChannelResult run();
+
+ private:
+  struct Frame {
+    uint64_t start_us;
+    uint64_t end_us;
+    uint64_t created_ms;  // Of the oldest value in the frame
+    uint16_t node;
+    uint8_t length;
+    uint8_t flags;
+  };
+
+  struct Node {
+    float x_m;
+    float y_m;
+    float rssi_dBm;  // At the gateway
+    uint32_t sentCount;
+    uint32_t deliveredCount;
+  };
+
+  void placeNodes();
+  void scheduleNode(uint16_t node, ChannelResult& result);
+  void runAir(ChannelResult& result);
+  bool isAckReceived(uint16_t node, uint64_t start_us, uint64_t end_us) const;
+  float getLinkLoss_dB(uint16_t a, uint16_t b) const;
+  float getShadowing_dB(uint16_t a, uint16_t b) const;
+
+  const UplinkTrace& mTrace;
+  const ChannelOptions mOptions;
+  const uint64_t mDuration_ms;
+  std::vector<Node> mNodes;     // Gateway last
+  std::vector<Frame> mFrames;   // Uplinks in start order
+  uint64_t mMaxTimeOnAir_us{};
+};
@@ -0,0 +1,222 @@
+/**
+ * Channel simulator
+ *
+ * Runs many nodes on a shared channel with one gateway. The nodes replay an
+ * uplink trace written by the node simulator, so the traffic is the one of
+ * the firmware report policy. Prints delivery ratio, throughput and latency
+ * percentiles per number of nodes. See sim/README.md.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "../src/Scenario.h"
+#include "Channel.h"
+#include "UplinkTrace.h"
+
+static void printUsage(const char* name) {
+  fprintf(stderr,
+          "Usage: %s [options] <trace file>\n"
+          "  -n <list>   Numbers of nodes, e.g. 50,100,200 (default 200)\n"
+          "  -R <runs>   Runs per number of nodes (default 4)\n"
+          "  -j <n>      Threads (default all cores)\n"
+          "  -t <time>   Time to simulate, e.g. 1d (default the trace's)\n"
+          "  -a <W>x<L>  Area of the nodes in m (default 100x60)\n"
+          "  -e <n>      Path loss exponent (default 3.0)\n"
+          "  -d <dB>     Shadowing standard deviation (default 6)\n"
+          "  -p <dBm>    TX power (default 17)\n"
+          "  -k <ppm>    Max clock skew of the nodes (default 5000)\n"
+          "  -s <seed>   Seed of the first run (default 1)\n",
+          name);
+}
+
+static bool parseNodeCounts(const char* str, std::vector<uint16_t>& counts) {
+  counts.clear();
+  while (*str != '\0') {
+    char* end;
+    const unsigned long n = strtoul(str, &end, 10);
+    if (end == str || n == 0 || n >= UINT16_MAX) {
+      return false;
+    }
+    counts.push_back(static_cast<uint16_t>(n));
+    str = *end == ',' ? end + 1 : end;
+    if (*end != ',' && *end != '\0') {
+      return false;
+    }
+  }
+  return !counts.empty();
+}
+
+template <typename T>
+static T getPercentile(const std::vector<T>& sorted, double p) {
+  if (sorted.empty()) {
+    return T{};
+  }
+  const size_t i = static_cast<size_t>(p * (sorted.size() - 1) + 0.5);
+  return sorted[i];
+}
+
+static double getPercentage(uint64_t part, uint64_t total) {
+  return total > 0 ? 100.0 * part / total : 0.0;
+}
+
+static void printResult(uint16_t nodeCount, uint16_t runCount,
+                        ChannelResult& r) {
+  std::sort(r.latencies_ms.begin(), r.latencies_ms.end());
+  std::sort(r.nodePdrs.begin(), r.nodePdrs.end());
+  std::sort(r.nodeRssis_dBm.begin(), r.nodeRssis_dBm.end());
+
+  const double hours = r.duration_ms / 3600000.0;
+  const double seconds = r.duration_ms / 1000.0;
+
+  printf("%u nodes, %u runs of %.2f days\n", nodeCount, runCount,
+         r.duration_ms / runCount / 86400000.0);
+  printf("  Channel load    %.4f Erlang, busiest node %.3f %% of an hour\n",
+         r.airTime_us / 1000.0 / r.duration_ms,
+         r.maxNodeAirTime_ms / 36000.0);
+  printf("  Uplinks         %u created, %u superseded, %u deferred by "
+         "airtime, %u sent\n",
+         r.generatedCount, r.supersededCount, r.deferredCount, r.sentCount);
+  printf("  Delivered       PDR %.2f %%, worst node %.2f %%, 5th percentile "
+         "node %.2f %%\n",
+         getPercentage(r.deliveredCount, r.sentCount),
+         100.0 * getPercentile(r.nodePdrs, 0.0),
+         100.0 * getPercentile(r.nodePdrs, 0.05));
+  printf("  Throughput      %.0f frames/h, %.1f B/s delivered\n",
+         r.deliveredCount / hours, r.deliveredBytes / seconds);
+  printf("  Lost            weak %.2f %%, collision %.2f %%, receiver busy "
+         "%.2f %%, gateway TX %.2f %%\n",
+         getPercentage(r.weakCount, r.sentCount),
+         getPercentage(r.collisionCount, r.sentCount),
+         getPercentage(r.busyCount, r.sentCount),
+         getPercentage(r.gatewayTxCount, r.sentCount));
+  printf("  Latency [ms]    p50 %u, p90 %u, p99 %u, max %u\n",
+         getPercentile(r.latencies_ms, 0.5), getPercentile(r.latencies_ms, 0.9),
+         getPercentile(r.latencies_ms, 0.99),
+         getPercentile(r.latencies_ms, 1.0));
+  printf("  ACKs            %.2f %% sent, %u skipped by gateway airtime, "
+         "%.2f %% received, gateway airtime %.3f %%\n",
+         getPercentage(r.ackSentCount, r.ackRequestCount), r.ackSkippedCount,
+         getPercentage(r.ackReceivedCount, r.ackSentCount),
+         getPercentage(r.gatewayAirTime_us / 1000, r.duration_ms));
+  printf("  RSSI [dBm]      min %.1f, median %.1f, max %.1f\n",
+         getPercentile(r.nodeRssis_dBm, 0.0),
+         getPercentile(r.nodeRssis_dBm, 0.5),
+         getPercentile(r.nodeRssis_dBm, 1.0));
+}
+
+int main(int argc, char** argv) {
+  ChannelOptions options;
+  std::vector<uint16_t> nodeCounts{options.nodeCount};
+  unsigned runCount = 4;
+  unsigned threadCount = std::max(1u, std::thread::hardware_concurrency());
+  const char* tracePath = nullptr;
+
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+    bool isOk = true;
+
+    if (strcmp(arg, "-n") == 0 && hasValue) {
+      isOk = parseNodeCounts(argv[++i], nodeCounts);
+    } else if (strcmp(arg, "-R") == 0 && hasValue) {
+      runCount = static_cast<unsigned>(atoi(argv[++i]));
+      isOk = runCount > 0;
+    } else if (strcmp(arg, "-j") == 0 && hasValue) {
+      threadCount = static_cast<unsigned>(atoi(argv[++i]));
+      isOk = threadCount > 0;
+    } else if (strcmp(arg, "-t") == 0 && hasValue) {
+      isOk = Scenario::parseTime(argv[++i], options.duration_ms);
+    } else if (strcmp(arg, "-a") == 0 && hasValue) {
+      isOk = sscanf(argv[++i], "%fx%f", &options.width_m, &options.length_m) ==
+                 2 &&
+             options.width_m > 0 && options.length_m > 0;
+    } else if (strcmp(arg, "-e") == 0 && hasValue) {
+      options.pathLossExponent = strtof(argv[++i], nullptr);
+    } else if (strcmp(arg, "-d") == 0 && hasValue) {
+      options.shadowing_dB = strtof(argv[++i], nullptr);
+    } else if (strcmp(arg, "-p") == 0 && hasValue) {
+      options.txPower_dBm = static_cast<int8_t>(atoi(argv[++i]));
+    } else if (strcmp(arg, "-k") == 0 && hasValue) {
+      options.clockSkew_ppm = static_cast<uint16_t>(atoi(argv[++i]));
+    } else if (strcmp(arg, "-s") == 0 && hasValue) {
+      options.seed = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 0));
+    } else if (arg[0] != '-' && tracePath == nullptr) {
+      tracePath = arg;
+    } else {
+      isOk = false;
+    }
+
+    if (!isOk) {
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  if (tracePath == nullptr) {
+    printUsage(argv[0]);
+    return 1;
+  }
+
+  UplinkTrace trace;
+  if (!trace.load(tracePath)) {
+    return 1;
+  }
+
+  // One task per run, the runs are independent and spread over the threads.
+  // Each run has its own seed, so the results do not depend on the threads.
+  struct Task {
+    ChannelOptions options;
+    ChannelResult result;
+  };
+  std::vector<Task> tasks;
+  for (uint16_t nodeCount : nodeCounts) {
+    for (unsigned run = 0; run < runCount; run++) {
+      Task task;
+      task.options = options;
+      task.options.nodeCount = nodeCount;
+      task.options.seed = options.seed + run;
+      tasks.push_back(task);
+    }
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+
+  std::atomic<size_t> next{0};
+  std::vector<std::thread> threads;
+  threadCount = std::min<unsigned>(threadCount, tasks.size());
+  for (unsigned t = 0; t < threadCount; t++) {
+    threads.emplace_back([&]() {
+      for (size_t i = next++; i < tasks.size(); i = next++) {
+        Channel channel(trace, tasks[i].options);
+        tasks[i].result = channel.run();
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  const std::chrono::duration<double> wallTime =
+      std::chrono::steady_clock::now() - start;
+
+  printf("Trace %s: %zu uplinks in %.2f days per node\n", tracePath,
+         trace.getRecords().size(), trace.getDuration_ms() / 86400000.0);
+  for (size_t i = 0; i < tasks.size(); i += runCount) {
+    ChannelResult total;
+    for (size_t run = 0; run < runCount; run++) {
+      total.merge(tasks[i + run].result);
+    }
+    printf("\n");
+    printResult(tasks[i].options.nodeCount, runCount, total);
+  }
+  printf("\nRun time: %.2f s on %u threads\n", wallTime.count(), threadCount);
+
+  return 0;
+}
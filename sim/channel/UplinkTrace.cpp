@@ -0,0 +1,85 @@
+#include "UplinkTrace.h"
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+static constexpr uint8_t FLAGS_INDEX = 3;  // Header byte of the flags
+
+void UplinkTrace::add(uint64_t time_ms, const uint8_t* frame,
+                      uint8_t length) {
+  const uint8_t flags = length > FLAGS_INDEX ? frame[FLAGS_INDEX] : 0;
+  mRecords.push_back(UplinkRecord{time_ms, length, flags});
+}
+
+bool UplinkTrace::save(const char* path) const {
+  FILE* f = fopen(path, "w");
+  if (f == nullptr) {
+    fprintf(stderr, "%s: Can't create file\n", path);
+    return false;
+  }
+
+  fprintf(f, "# Uplink trace: <time ms> <length> <flags>\n");
+  fprintf(f, "duration %" PRIu64 "\n", mDuration_ms);
+  for (const UplinkRecord& record : mRecords) {
+    fprintf(f, "%" PRIu64 " %u %02X\n", record.time_ms, record.length,
+            record.flags);
+  }
+
+  const bool isOk = ferror(f) == 0;
+  if (fclose(f) != 0 || !isOk) {
+    fprintf(stderr, "%s: Write error\n", path);
+    return false;
+  }
+  return true;
+}
+
+bool UplinkTrace::load(const char* path) {
+  FILE* f = fopen(path, "r");
+  if (f == nullptr) {
+    fprintf(stderr, "%s: Can't open file\n", path);
+    return false;
+  }
+
+  mRecords.clear();
+  mDuration_ms = 0;
+
+  char line[128];
+  unsigned lineNumber = 0;
+  bool isOk = true;
+  while (isOk && fgets(line, sizeof(line), f) != nullptr) {
+    lineNumber++;
+
+    char* comment = strchr(line, '#');
+    if (comment != nullptr) {
+      *comment = '\0';
+    }
+
+    uint64_t time_ms;
+    unsigned length;
+    unsigned flags;
+    char end;
+    if (sscanf(line, " duration %" SCNu64 " %c", &time_ms, &end) == 1) {
+      mDuration_ms = time_ms;
+    } else if (sscanf(line, "%" SCNu64 " %u %x %c", &time_ms, &length,
+                      &flags, &end) == 3 &&
+               length <= UINT8_MAX && flags <= UINT8_MAX) {
+      mRecords.push_back(UplinkRecord{time_ms, static_cast<uint8_t>(length),
+                                      static_cast<uint8_t>(flags)});
+    } else if (strspn(line, " \t\r\n") != strlen(line)) {
+      fprintf(stderr, "%s:%u: Invalid line\n", path, lineNumber);
+      isOk = false;
+    }
+  }
+  fclose(f);
+
+  if (isOk && mRecords.empty()) {
+    fprintf(stderr, "%s: No uplinks\n", path);
+    isOk = false;
+  }
+  if (isOk && mDuration_ms <= mRecords.back().time_ms) {
+    fprintf(stderr, "%s: Duration missing or too short\n", path);
+    isOk = false;
+  }
+  return isOk;
+}
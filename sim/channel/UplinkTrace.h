@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <vector>
+
+/**
+ * @brief Uplink of a node at a time of a simulation.
+ */
+struct UplinkRecord {
+  uint64_t time_ms;  // When the node handed the frame to the radio
+  uint8_t length;    // Frame length, header included
+  uint8_t flags;     // Header flags byte, see LoRaHandler.h
+};
+
+/**
+ * @brief Uplinks of one node, recorded by the node simulator and replayed by
+ * the channel simulator.
+ *
+ * Text file, a `duration <ms>` line followed by one `<time ms> <length>
+ * <flags>` line per uplink, flags in hex. A `#` starts a comment.
+ */
+class UplinkTrace {
+ public:
+  void add(uint64_t time_ms, const uint8_t* frame, uint8_t length);
+
+  /**
+   * @brief Save to a file. Errors are printed to stderr.
+   * @return true if the whole trace was written.
+   */
+  bool save(const char* path) const;
+
+  /**
+   * @brief Load a file. Errors are printed to stderr.
+   * @return true if the whole file was loaded.
+   */
+  bool load(const char* path);
+
+  const std::vector<UplinkRecord>& getRecords() const { return mRecords; }
+
+  // Time covered by the trace, uplinks are in [0, duration).
+  uint64_t getDuration_ms() const { return mDuration_ms; }
+  void setDuration_ms(uint64_t duration_ms) { mDuration_ms = duration_ms; }
+
+ private:
+  std::vector<UplinkRecord> mRecords;
+  uint64_t mDuration_ms{};
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Wire.h"
+
+/**
+ * @brief Simulated I2C device, same interface as Adafruit BusIO v1.17.4 (the
+ * parts used by the node).
+ *
+ * The only device on the bus is an AHT20 at its default address. It answers
+ * with the temperature and humidity of the scenario, and is busy for a
+ * measurement time after a trigger command like the real sensor.
+ */
+class Adafruit_I2CDevice {
+ public:
+  Adafruit_I2CDevice(uint8_t addr, TwoWire* theWire = &Wire)
+      : mAddr{addr} {
+    (void)theWire;
+  }
+
+  bool begin(bool addr_detect = true);
+
+  bool read(uint8_t* buffer, size_t len, bool stop = true);
+
+  bool write(const uint8_t* buffer, size_t len, bool stop = true,
+             const uint8_t* prefix_buffer = nullptr, size_t prefix_len = 0);
+
+  uint8_t address() const { return mAddr; }
+
+ private:
+  const uint8_t mAddr;
+};
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Same defaults as LoRa by Sandeep Mistry v0.8.0.
+#define LORA_DEFAULT_SS_PIN 10
+#define LORA_DEFAULT_RESET_PIN 9
+#define LORA_DEFAULT_DIO0_PIN 2
+
+/**
+ * @brief Simulated radio, same interface as LoRa by Sandeep Mistry v0.8.0
+ * (the parts used by the node).
+ *
+ * A frame is on air for its time on air, calculated from the radio settings,
+ * and is then handed to the simulated channel and the TX done callback is
+ * called. Frames from the channel are only received in receive mode, then the
+ * receive callback is called like from the DIO0 interrupt.
+ */
+class LoRaClass {
+ public:
+  enum class Mode : uint8_t { sleep, standby, rx, tx };
+  static constexpr uint8_t MODE_COUNT = 4;
+  static constexpr uint8_t MAX_PACKET_LENGTH = 255;
+
+  int begin(long frequency);
+  void end();
+
+  int beginPacket(int implicitHeader = false);
+  int endPacket(bool async = false);
+
+  int parsePacket(int size = 0);
+  int packetRssi() { return mRxRssi; }
+
+  size_t write(const uint8_t* buffer, size_t size);
+
+  int available() { return mRxLength - mRxIndex; }
+  int read();
+
+  void onReceive(void (*callback)(int)) { mOnReceive = callback; }
+  void onTxDone(void (*callback)()) { mOnTxDone = callback; }
+
+  void receive(int size = 0);
+  void idle();
+  void sleep();
+
+  void setSpreadingFactor(int sf) { mSf = static_cast<uint8_t>(sf); }
+  void setSignalBandwidth(long sbw) { mBw_Hz = static_cast<uint32_t>(sbw); }
+  void setCodingRate4(int denominator) {
+    mCodingRate4 = static_cast<uint8_t>(denominator);
+  }
+  void setPreambleLength(long length) {
+    mPreamble = static_cast<uint16_t>(length);
+  }
+  void enableCrc() { mCrc = true; }
+  void disableCrc() { mCrc = false; }
+
+  void setPins(int ss = LORA_DEFAULT_SS_PIN, int reset = LORA_DEFAULT_RESET_PIN,
+               int dio0 = LORA_DEFAULT_DIO0_PIN);
+
+  // Simulator side
+  // ----------------------------------------------------------------
+
+  Mode getMode() const { return mMode; }
+
+  /**
+   * @brief Time on air of a frame with the current radio settings.
+   * @return Time in µs.
+   */
+  uint32_t getTimeOnAir_us(uint8_t length) const;
+
+  /**
+   * @brief End of the frame on air.
+   * @return Simulation time in ms, UINT64_MAX if not transmitting.
+   */
+  uint64_t getTxEndTime() const;
+
+  /**
+   * @brief Finish the frame on air if it has ended at the simulation time.
+   */
+  void update();
+
+  /**
+   * @brief Receive a frame from the channel.
+   * @return false if not in receive mode, the frame is lost.
+   */
+  bool deliver(const uint8_t* frame, uint8_t length, int16_t rssi);
+
+  /**
+   * @brief Time spent in a mode since start.
+   * @return Time in ms.
+   */
+  uint64_t getModeTime_ms(Mode mode) const;
+
+ private:
+  void setMode(Mode mode);
+
+  Mode mMode{Mode::sleep};
+  uint64_t mModeStart_ms{};
+  uint64_t mModeTime_ms[MODE_COUNT]{};
+
+  uint8_t mSf{7};
+  uint32_t mBw_Hz{125000};
+  uint8_t mCodingRate4{5};
+  uint16_t mPreamble{8};
+  bool mCrc{};
+
+  uint8_t mTxBuffer[MAX_PACKET_LENGTH]{};
+  uint8_t mTxLength{};
+  uint64_t mTxStart_ms{};
+  uint32_t mTxTimeOnAir_us{};
+
+  uint8_t mRxBuffer[MAX_PACKET_LENGTH]{};
+  uint8_t mRxLength{};
+  uint8_t mRxIndex{};
+  int16_t mRxRssi{};
+  bool mRxPending{};  // Received without a callback, for parsePacket()
+
+  void (*mOnReceive)(int){};
+  void (*mOnTxDone)(){};
+};
+
+extern LoRaClass LoRa;
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stdint.h>
+
+// Same defaults as NewPing by Tim Eckel v1.9.7.
+#define MAX_SENSOR_DISTANCE 500
+#define NO_ECHO 0
+
+/**
+ * @brief Simulated ultrasonic sensor, same interface as NewPing v1.9.7 (the
+ * parts used by the node).
+ *
+ * A ping returns the distance of the scenario, or NO_ECHO when it is beyond
+ * the max distance.
+ */
+class NewPing {
+ public:
+  NewPing(uint8_t trigger_pin, uint8_t echo_pin,
+          unsigned int max_cm_distance = MAX_SENSOR_DISTANCE)
+      : mMaxDistance{max_cm_distance} {
+    (void)trigger_pin;
+    (void)echo_pin;
+  }
+
+  unsigned long ping_cm(unsigned int max_cm_distance = 0);
+
+ private:
+  const unsigned int mMaxDistance;
+};
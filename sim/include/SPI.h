@@ -0,0 +1,3 @@
+#pragma once
+
+// The simulator has no SPI bus, the radio is simulated above it, see LoRa.h.
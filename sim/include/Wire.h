@@ -0,0 +1,7 @@
+#pragma once
+
+// The simulator has no I2C bus, devices are simulated above it, see
+// Adafruit_I2CDevice.h.
+class TwoWire {};
+
+extern TwoWire Wire;
@@ -0,0 +1,78 @@
+#include "Adafruit_I2CDevice.h"
+
+#include <string.h>
+
+#include "AHT20.h"
+#include "Simulator.h"
+
+TwoWire Wire;
+
+static uint32_t toRaw20(float fraction) {
+  if (fraction <= 0.0f) {
+    return 0;
+  }
+  if (fraction >= 1.0f) {
+    return 0xFFFFF;
+  }
+  return static_cast<uint32_t>(fraction * 0x100000);
+}
+
+// CRC-8 of the AHT20, polynomial 0x31 and initial value 0xFF.
+static uint8_t crc8(const uint8_t* data, size_t len) {
+  uint8_t crc = 0xFF;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= data[i];
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x80) ? static_cast<uint8_t>((crc << 1) ^ 0x31)
+                         : static_cast<uint8_t>(crc << 1);
+    }
+  }
+  return crc;
+}
+
+bool Adafruit_I2CDevice::begin(bool addr_detect) {
+  (void)addr_detect;
+  return mAddr == AHT20_I2CADDR_DEFAULT;
+}
+
+bool Adafruit_I2CDevice::write(const uint8_t* buffer, size_t len, bool stop,
+                               const uint8_t* prefix_buffer,
+                               size_t prefix_len) {
+  (void)stop;
+  (void)prefix_buffer;
+  (void)prefix_len;
+
+  if (mAddr != AHT20_I2CADDR_DEFAULT) {
+    return false;
+  }
+
+  if (len > 0 && buffer[0] == AHT20_CMD_TRIGGER) {
+    Simulator::instance().startAhtMeasurement();
+  }
+  return true;
+}
+
+bool Adafruit_I2CDevice::read(uint8_t* buffer, size_t len, bool stop) {
+  (void)stop;
+
+  if (mAddr != AHT20_I2CADDR_DEFAULT) {
+    return false;
+  }
+
+  const Simulator& sim = Simulator::instance();
+  const uint32_t humidity = toRaw20(sim.getHumidity() / 100.0f);
+  const uint32_t temperature =
+      toRaw20((sim.getTemperature() + 50.0f) / 200.0f);
+
+  uint8_t data[7];
+  data[0] = AHT20_STATUS_CALIBRATED | (sim.isAhtBusy() ? AHT20_STATUS_BUSY : 0);
+  data[1] = static_cast<uint8_t>(humidity >> 12);
+  data[2] = static_cast<uint8_t>(humidity >> 4);
+  data[3] = static_cast<uint8_t>((humidity << 4) | (temperature >> 16));
+  data[4] = static_cast<uint8_t>(temperature >> 8);
+  data[5] = static_cast<uint8_t>(temperature);
+  data[6] = crc8(data, 6);
+
+  memcpy(buffer, data, len < sizeof(data) ? len : sizeof(data));
+  return true;
+}
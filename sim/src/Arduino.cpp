@@ -0,0 +1,124 @@
+// Arduino core of the simulator, replaces test/mocks/src/Arduino.cpp. The
+// mock header is kept so the firmware builds the same way as in the unit
+// tests, but nothing here calls the gmock methods, as that would be far too
+// slow for long simulations.
+#include "Arduino.h"
+
+#include <avr/sleep.h>
+#include <avr/wdt.h>
+
+#include "BufferSerial.h"
+#include "Simulator.h"
+
+BufferSerial bufSerial = BufferSerial(16384);  // Output of a loop() at most
+
+static ArduinoMock* arduinoMock = NULL;
+ArduinoMock* arduinoMockInstance() {
+  if (!arduinoMock) {
+    arduinoMock = new ArduinoMock();
+  }
+  return arduinoMock;
+}
+
+void releaseArduinoMock() {
+  if (arduinoMock) {
+    delete arduinoMock;
+    arduinoMock = NULL;
+  }
+}
+
+// The mock holds the clock of the node, millis(). It is moved forward by the
+// simulator, and by PowerManager after a power-down step.
+ArduinoMock::ArduinoMock() : currentMillis{0} {}
+
+void yield(void) {}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (mode == INPUT_PULLUP) {
+    Simulator::instance().setPin(pin, HIGH);
+  }
+}
+
+void digitalWrite(uint8_t pin, uint8_t level) {
+  Simulator::instance().setPin(pin, level);
+}
+
+int digitalRead(uint8_t pin) { return Simulator::instance().getPin(pin); }
+
+int analogRead(uint8_t pin) {
+  UNUSED(pin);
+  return 0;
+}
+
+void analogReference(uint8_t mode) { UNUSED(mode); }
+
+void analogWrite(uint8_t pin, int value) {
+  UNUSED(pin);
+  UNUSED(value);
+}
+
+unsigned long millis(void) {
+  return static_cast<unsigned long>(arduinoMockInstance()->getMillis());
+}
+
+unsigned long micros(void) { return millis() * 1000UL; }
+
+void delay(time_t ms) {
+  Simulator::instance().delay(static_cast<uint32_t>(ms));
+}
+
+void delayMicroseconds(time_t us) { UNUSED(us); }
+
+time_t pulseIn(uint8_t pin, uint8_t state, time_t timeout) {
+  UNUSED(pin);
+  UNUSED(state);
+  UNUSED(timeout);
+  return 0;
+}
+
+void shiftOut(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder,
+              uint8_t val) {
+  UNUSED(dataPin);
+  UNUSED(clockPin);
+  UNUSED(bitOrder);
+  UNUSED(val);
+}
+
+uint8_t shiftIn(uint8_t dataPin, uint8_t clockPin, uint8_t bitOrder) {
+  UNUSED(dataPin);
+  UNUSED(clockPin);
+  UNUSED(bitOrder);
+  return 0;
+}
+
+void attachInterrupt(uint8_t, void (*)(void), int mode) { UNUSED(mode); }
+
+void detachInterrupt(uint8_t) {}
+
+void interrupts(void) {}
+
+void noInterrupts(void) {}
+
+static uint8_t sleepMode = SLEEP_MODE_IDLE;
+
+void set_sleep_mode(uint8_t mode) { sleepMode = mode; }
+
+void sleep_enable(void) {}
+
+void sleep_disable(void) {}
+
+void sleep_bod_disable(void) {}
+
+void sleep_cpu(void) {
+  if (sleepMode == SLEEP_MODE_PWR_DOWN) {
+    Simulator::instance().sleepPowerDown();
+  } else {
+    Simulator::instance().sleepIdle();
+  }
+}
+
+void wdt_enable(uint8_t timeout) {
+  Simulator::instance().setWatchdog(static_cast<int8_t>(timeout));
+}
+
+void wdt_disable(void) { Simulator::instance().setWatchdog(-1); }
@@ -0,0 +1,204 @@
+#include "Gateway.h"
+
+#include <string.h>
+
+#include "Util.h"
+
+static const char* const MSG_TYPE_NAMES[] = {
+    "ping_req",  "ping_msg",     "discovery_req", "discovery_msg",
+    "value_req", "value_msg",    "valueSet_req",  "service_req",
+    "discovery_batch_msg", "announce_msg"};
+
+void Gateway::onUplink(const uint8_t* frame, uint8_t length,
+                       uint64_t time_ms) {
+  if (length < LORA_HEADER_LENGTH) {
+    mInvalidCount++;
+    return;
+  }
+
+  LoRaHeaderT header;
+  header.fromByteArray(frame);
+  if (header.dst != mAddress || header.src != mNodeAddress) {
+    mInvalidCount++;
+    return;
+  }
+
+  mFrameCount[static_cast<uint8_t>(header.flags.msgType)]++;
+
+  const uint8_t* payload = &frame[LORA_HEADER_LENGTH];
+  const uint8_t payloadLength = length - LORA_HEADER_LENGTH;
+
+  if (header.flags.ack_request) {
+    LoRaHeaderT ack;
+    ack.dst = header.src;
+    ack.src = mAddress;
+    ack.id = header.id;
+    ack.flags.ack_response = true;
+    ack.flags.msgType = header.flags.msgType;
+    queueFrame(ack, &GatewayConstants::ACK_PAYLOAD,
+               sizeof(GatewayConstants::ACK_PAYLOAD),
+               time_ms + GatewayConstants::REPLY_DELAY_MS);
+  }
+
+  switch (header.flags.msgType) {
+    case LoRaMsgType::value_msg:
+      onValueMsg(header, payload, payloadLength, time_ms);
+      break;
+
+    case LoRaMsgType::discovery_batch_msg:
+      onDiscoveryBatchMsg(payload, payloadLength);
+      break;
+
+    case LoRaMsgType::announce_msg:
+      onAnnounceMsg(payload, payloadLength, time_ms);
+      break;
+
+    default:
+      break;
+  }
+}
+
+void Gateway::onValueMsg(const LoRaHeaderT& header, const uint8_t* payload,
+                         uint8_t length, uint64_t time_ms) {
+  if (header.flags.compact_values) {
+    // Only requested by gateways that can decode them, never by this one.
+    mUndecodedValueMsgCount++;
+    return;
+  }
+
+  LoRaValuePayloadT values;
+  if (values.fromByteArray(payload, length, header.flags.bitmap_values) == 0) {
+    mInvalidCount++;
+    return;
+  }
+
+  for (uint8_t i = 0; i < values.numberOfEntities; i++) {
+    const ValueItemT& item = values.valueItems[i];
+    if (mReportCount[item.entityId] > 0) {
+      const uint64_t gap_ms = time_ms - mLastReport_ms[item.entityId];
+      if (gap_ms > mMaxReportGap_ms[item.entityId]) {
+        mMaxReportGap_ms[item.entityId] = gap_ms;
+      }
+    }
+    mReportCount[item.entityId]++;
+    mLastReport_ms[item.entityId] = time_ms;
+    mLastValue[item.entityId] = static_cast<int32_t>(item.value);
+  }
+}
+
+void Gateway::onDiscoveryBatchMsg(const uint8_t* payload, uint8_t length) {
+  if (length < 6) {
+    mInvalidCount++;
+    return;
+  }
+
+  const uint32_t hash = ntoh(*reinterpret_cast<const uint32_t*>(payload));
+  if (hash != mSchemaHash) {
+    mSchemaHash = hash;
+    mIsSchemaCached = false;
+    mDiscoveredCount = 0;
+  }
+
+  mDiscoveredCount += payload[5];
+  if (mDiscoveredCount >= payload[4]) {
+    mIsSchemaCached = true;
+  }
+}
+
+void Gateway::onAnnounceMsg(const uint8_t* payload, uint8_t length,
+                            uint64_t time_ms) {
+  if (length < 5) {
+    mInvalidCount++;
+    return;
+  }
+
+  const uint32_t hash = ntoh(*reinterpret_cast<const uint32_t*>(payload));
+  if (mIsSchemaCached && hash == mSchemaHash) {
+    return;
+  }
+
+  const uint8_t allEntities = UINT8_MAX;
+  queueDownlink(LoRaMsgType::discovery_req, &allEntities, sizeof(allEntities),
+                time_ms + GatewayConstants::REPLY_DELAY_MS);
+}
+
+void Gateway::queueDownlink(LoRaMsgType msgType, const uint8_t* payload,
+                            uint8_t length, uint64_t time_ms) {
+  LoRaHeaderT header;
+  header.dst = mNodeAddress;
+  header.src = mAddress;
+  header.id = mMsgId++;
+  header.flags.msgType = msgType;
+  queueFrame(header, payload, length, time_ms);
+}
+
+void Gateway::queueFrame(const LoRaHeaderT& header, const uint8_t* payload,
+                         uint8_t length, uint64_t time_ms) {
+  Downlink downlink;
+  downlink.time_ms = time_ms;
+  downlink.length = header.toByteArray(downlink.frame);
+  if (length > sizeof(downlink.frame) - downlink.length) {
+    length = sizeof(downlink.frame) - downlink.length;
+  }
+  memcpy(&downlink.frame[downlink.length], payload, length);
+  downlink.length += length;
+
+  // Sent in time order, replies may be due before scripted downlinks.
+  auto it = mDownlinks.end();
+  while (it != mDownlinks.begin() && (it - 1)->time_ms > time_ms) {
+    --it;
+  }
+  mDownlinks.insert(it, downlink);
+}
+
+uint64_t Gateway::getNextDownlinkTime() const {
+  return mDownlinks.empty() ? UINT64_MAX : mDownlinks.front().time_ms;
+}
+
+uint8_t Gateway::takeDownlink(uint8_t* frame) {
+  if (mDownlinks.empty()) {
+    return 0;
+  }
+
+  const Downlink& downlink = mDownlinks.front();
+  const uint8_t length = downlink.length;
+  memcpy(frame, downlink.frame, length);
+  mDownlinks.pop_front();
+  return length;
+}
+
+void Gateway::printReport(FILE* f, uint64_t duration_ms) const {
+  const double days = duration_ms / (24.0 * 3600.0 * 1000.0);
+
+  fprintf(f, "Gateway received:\n");
+  for (uint8_t i = 0; i < GatewayConstants::MSG_TYPE_COUNT; i++) {
+    if (mFrameCount[i] == 0) {
+      continue;
+    }
+    const char* name = i < sizeof(MSG_TYPE_NAMES) / sizeof(MSG_TYPE_NAMES[0])
+                           ? MSG_TYPE_NAMES[i]
+                           : "unknown";
+    fprintf(f, "  %-20s %8u frames\n", name, mFrameCount[i]);
+  }
+  if (mInvalidCount > 0) {
+    fprintf(f, "  %-20s %8u frames\n", "invalid", mInvalidCount);
+  }
+  if (mUndecodedValueMsgCount > 0) {
+    fprintf(f, "  %-20s %8u frames\n", "compact value_msg",
+            mUndecodedValueMsgCount);
+  }
+  fprintf(f, "  Discovery schema %08X %s\n", mSchemaHash,
+          mIsSchemaCached ? "cached" : "not cached");
+
+  fprintf(f, "Reports per entity:\n");
+  fprintf(f, "  %6s %8s %8s %14s %12s\n", "entity", "reports", "per day",
+          "max gap [s]", "last value");
+  for (uint16_t id = 0; id < GatewayConstants::ENTITY_COUNT; id++) {
+    if (mReportCount[id] == 0) {
+      continue;
+    }
+    fprintf(f, "  %6u %8u %8.1f %14.0f %12d\n", id, mReportCount[id],
+            days > 0 ? mReportCount[id] / days : 0.0,
+            mMaxReportGap_ms[id] / 1000.0, mLastValue[id]);
+  }
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <deque>
+
+#include "LoRaHandler.h"
+
+namespace GatewayConstants {
+constexpr uint16_t REPLY_DELAY_MS = 100;  // Processing time before a reply
+constexpr uint8_t ACK_PAYLOAD = '!';
+constexpr uint8_t ACK_LENGTH = LORA_HEADER_LENGTH + sizeof(ACK_PAYLOAD);
+constexpr uint16_t MSG_TYPE_COUNT = FLAGS_MSG_TYPE_MASK + 1;
+constexpr uint16_t ENTITY_COUNT = 256;
+}  // namespace GatewayConstants
+
+/**
+ * @brief Gateway stand-in on the simulated channel.
+ *
+ * Decodes the uplinks of one node, keeps statistics of them, and replies like
+ * a gateway: a discovery request to an announce with an unknown schema hash
+ * and an ACK to an ACK request. Downlinks are held until the node receives,
+ * e.g. until its next RX window.
+ */
+class Gateway {
+ public:
+  Gateway(uint8_t address, uint8_t nodeAddress)
+      : mAddress{address}, mNodeAddress{nodeAddress} {}
+
+  void onUplink(const uint8_t* frame, uint8_t length, uint64_t time_ms);
+
+  void queueDownlink(LoRaMsgType msgType, const uint8_t* payload,
+                     uint8_t length, uint64_t time_ms);
+
+  /**
+   * @return Simulation time in ms of the next downlink to send, UINT64_MAX if
+   * there is none.
+   */
+  uint64_t getNextDownlinkTime() const;
+
+  /**
+   * @brief Take the next downlink to send.
+   * @return Frame length, 0 if there is none.
+   */
+  uint8_t takeDownlink(uint8_t* frame);
+
+  void printReport(FILE* f, uint64_t duration_ms) const;
+
+ private:
+  struct Downlink {
+    uint64_t time_ms;
+    uint8_t length;
+    uint8_t frame[LORA_MAX_MESSAGE_LENGTH];
+  };
+
+  void queueFrame(const LoRaHeaderT& header, const uint8_t* payload,
+                  uint8_t length, uint64_t time_ms);
+  void onValueMsg(const LoRaHeaderT& header, const uint8_t* payload,
+                  uint8_t length, uint64_t time_ms);
+  void onDiscoveryBatchMsg(const uint8_t* payload, uint8_t length);
+  void onAnnounceMsg(const uint8_t* payload, uint8_t length,
+                     uint64_t time_ms);
+
+  const uint8_t mAddress;
+  const uint8_t mNodeAddress;
+  uint8_t mMsgId{};
+  std::deque<Downlink> mDownlinks;
+
+  // Discovery schema cache
+  uint32_t mSchemaHash{};
+  bool mIsSchemaCached{};
+  uint16_t mDiscoveredCount{};
+
+  // Statistics
+  uint32_t mFrameCount[GatewayConstants::MSG_TYPE_COUNT]{};
+  uint32_t mInvalidCount{};
+  uint32_t mUndecodedValueMsgCount{};
+  uint32_t mReportCount[GatewayConstants::ENTITY_COUNT]{};
+  uint64_t mLastReport_ms[GatewayConstants::ENTITY_COUNT]{};
+  uint64_t mMaxReportGap_ms[GatewayConstants::ENTITY_COUNT]{};
+  int32_t mLastValue[GatewayConstants::ENTITY_COUNT]{};
+};
@@ -0,0 +1,140 @@
+#include "LoRa.h"
+
+#include <string.h>
+
+#include "Simulator.h"
+#include "TimeOnAir.h"
+
+LoRaClass LoRa;
+
+int LoRaClass::begin(long frequency) {
+  (void)frequency;
+  setMode(Mode::standby);
+  return 1;
+}
+
+void LoRaClass::end() { setMode(Mode::sleep); }
+
+int LoRaClass::beginPacket(int implicitHeader) {
+  (void)implicitHeader;
+  if (mMode == Mode::tx) {
+    return 0;
+  }
+
+  setMode(Mode::standby);
+  mTxLength = 0;
+  return 1;
+}
+
+int LoRaClass::endPacket(bool async) {
+  mTxStart_ms = Simulator::instance().getTime_ms();
+  mTxTimeOnAir_us = getTimeOnAir_us(mTxLength);
+  setMode(Mode::tx);
+
+  if (!async) {
+    // The library polls the radio until the frame is sent.
+    Simulator::instance().delay(TimeOnAir::toMs(mTxTimeOnAir_us));
+  }
+  return 1;
+}
+
+int LoRaClass::parsePacket(int size) {
+  (void)size;
+  if (mRxPending) {
+    mRxPending = false;
+    return mRxLength;
+  }
+
+  if (mMode != Mode::rx && mMode != Mode::tx) {
+    setMode(Mode::rx);
+  }
+  return 0;
+}
+
+size_t LoRaClass::write(const uint8_t* buffer, size_t size) {
+  if (size > static_cast<size_t>(MAX_PACKET_LENGTH - mTxLength)) {
+    size = MAX_PACKET_LENGTH - mTxLength;
+  }
+  memcpy(&mTxBuffer[mTxLength], buffer, size);
+  mTxLength += static_cast<uint8_t>(size);
+  return size;
+}
+
+int LoRaClass::read() {
+  if (mRxIndex >= mRxLength) {
+    return -1;
+  }
+  return mRxBuffer[mRxIndex++];
+}
+
+void LoRaClass::receive(int size) {
+  (void)size;
+  setMode(Mode::rx);
+}
+
+void LoRaClass::idle() { setMode(Mode::standby); }
+
+void LoRaClass::sleep() { setMode(Mode::sleep); }
+
+void LoRaClass::setPins(int ss, int reset, int dio0) {
+  (void)ss;
+  (void)reset;
+  (void)dio0;
+}
+
+uint32_t LoRaClass::getTimeOnAir_us(uint8_t length) const {
+  return TimeOnAir::getTime_us(length, mSf, mBw_Hz, mCodingRate4, mPreamble,
+                               mCrc);
+}
+
+uint64_t LoRaClass::getTxEndTime() const {
+  if (mMode != Mode::tx) {
+    return UINT64_MAX;
+  }
+  return mTxStart_ms + TimeOnAir::toMs(mTxTimeOnAir_us);
+}
+
+void LoRaClass::update() {
+  if (getTxEndTime() > Simulator::instance().getTime_ms()) {
+    return;
+  }
+
+  setMode(Mode::standby);
+  Simulator::instance().onUplink(mTxBuffer, mTxLength, mTxTimeOnAir_us);
+  if (mOnTxDone) {
+    mOnTxDone();
+  }
+}
+
+bool LoRaClass::deliver(const uint8_t* frame, uint8_t length, int16_t rssi) {
+  if (mMode != Mode::rx) {
+    return false;
+  }
+
+  memcpy(mRxBuffer, frame, length);
+  mRxLength = length;
+  mRxIndex = 0;
+  mRxRssi = rssi;
+
+  if (mOnReceive) {
+    mOnReceive(length);
+  } else {
+    mRxPending = true;
+  }
+  return true;
+}
+
+uint64_t LoRaClass::getModeTime_ms(Mode mode) const {
+  uint64_t time_ms = mModeTime_ms[static_cast<uint8_t>(mode)];
+  if (mode == mMode) {
+    time_ms += Simulator::instance().getTime_ms() - mModeStart_ms;
+  }
+  return time_ms;
+}
+
+void LoRaClass::setMode(Mode mode) {
+  const uint64_t now_ms = Simulator::instance().getTime_ms();
+  mModeTime_ms[static_cast<uint8_t>(mMode)] += now_ms - mModeStart_ms;
+  mModeStart_ms = now_ms;
+  mMode = mode;
+}
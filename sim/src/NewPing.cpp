@@ -0,0 +1,18 @@
+#include "NewPing.h"
+
+#include <math.h>
+
+#include "Simulator.h"
+
+unsigned long NewPing::ping_cm(unsigned int max_cm_distance) {
+  const unsigned int maxDistance =
+      (max_cm_distance > 0 && max_cm_distance < mMaxDistance) ? max_cm_distance
+                                                              : mMaxDistance;
+  const float distance = Simulator::instance().getDistance();
+
+  if (distance <= 0.0f || distance > maxDistance) {
+    return NO_ECHO;
+  }
+
+  return static_cast<unsigned long>(lroundf(distance));
+}
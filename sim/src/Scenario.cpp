@@ -0,0 +1,254 @@
+#include "Scenario.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+
+static const char* const DELIMITERS = " \t\r\n";
+
+bool Scenario::parseTime(const char* str, uint64_t& time_ms) {
+  time_ms = 0;
+
+  if (*str == '\0') {
+    return false;
+  }
+
+  while (*str != '\0') {
+    char* end;
+    const unsigned long long n = strtoull(str, &end, 10);
+    if (end == str) {
+      return false;
+    }
+    str = end;
+
+    if (strncmp(str, "ms", 2) == 0) {
+      time_ms += n;
+      str += 2;
+    } else if (*str == 's') {
+      time_ms += n * 1000ULL;
+      str++;
+    } else if (*str == 'm') {
+      time_ms += n * 60ULL * 1000ULL;
+      str++;
+    } else if (*str == 'h') {
+      time_ms += n * 3600ULL * 1000ULL;
+      str++;
+    } else if (*str == 'd') {
+      time_ms += n * 24ULL * 3600ULL * 1000ULL;
+      str++;
+    } else if (*str == '\0' && n == 0) {
+      // A plain 0 needs no unit.
+    } else {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static bool parseNumber(const char* str, float& value) {
+  if (str == nullptr) {
+    return false;
+  }
+  char* end;
+  value = strtof(str, &end);
+  return end != str && *end == '\0';
+}
+
+static bool parseEntityId(const char* str, uint8_t& entityId) {
+  float value;
+  if (!parseNumber(str, value) || value < 0 || value > 255) {
+    return false;
+  }
+  entityId = static_cast<uint8_t>(value);
+  return true;
+}
+
+bool Scenario::parseEvent(char* args, uint64_t time_ms, ScenarioEvent& event) {
+  event = ScenarioEvent{};
+  event.time_ms = time_ms;
+
+  const char* input = strtok(args, DELIMITERS);
+  const char* arg1 = strtok(nullptr, DELIMITERS);
+  const char* arg2 = strtok(nullptr, DELIMITERS);
+
+  if (input == nullptr) {
+    return false;
+  }
+
+  if (strcmp(input, "distance") == 0 || strcmp(input, "temperature") == 0 ||
+      strcmp(input, "humidity") == 0) {
+    event.input = input[0] == 'd'   ? ScenarioInput::distance
+                  : input[0] == 't' ? ScenarioInput::temperature
+                                    : ScenarioInput::humidity;
+    if (!parseNumber(arg1, event.value)) {
+      return false;
+    }
+    return arg2 == nullptr || parseTime(arg2, event.ramp_ms);
+  }
+
+  if (strcmp(input, "door") == 0) {
+    event.input = ScenarioInput::door;
+    if (arg1 == nullptr) {
+      return false;
+    }
+    if (strcmp(arg1, "closed") == 0) {
+      event.value = static_cast<float>(ScenarioDoor::closed);
+    } else if (strcmp(arg1, "open") == 0) {
+      event.value = static_cast<float>(ScenarioDoor::open);
+    } else if (strcmp(arg1, "moving") == 0) {
+      event.value = static_cast<float>(ScenarioDoor::moving);
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  if (strcmp(input, "value_req") == 0) {
+    event.input = ScenarioInput::valueReq;
+    return true;
+  }
+
+  if (strcmp(input, "value_set") == 0) {
+    event.input = ScenarioInput::valueSet;
+    return parseEntityId(arg1, event.entityId) &&
+           parseNumber(arg2, event.value);
+  }
+
+  if (strcmp(input, "service") == 0) {
+    event.input = ScenarioInput::service;
+    return parseEntityId(arg1, event.entityId) &&
+           parseEntityId(arg2, event.service);
+  }
+
+  if (strcmp(input, "discovery_req") == 0) {
+    event.input = ScenarioInput::discoveryReq;
+    event.entityId = UINT8_MAX;
+    return arg1 == nullptr || parseEntityId(arg1, event.entityId);
+  }
+
+  if (strcmp(input, "ping") == 0) {
+    event.input = ScenarioInput::ping;
+    return true;
+  }
+
+  return false;
+}
+
+bool Scenario::load(const char* path) {
+  FILE* f = fopen(path, "r");
+  if (f == nullptr) {
+    fprintf(stderr, "%s: Can't open file\n", path);
+    return false;
+  }
+
+  mEvents.clear();
+
+  char line[256];
+  unsigned lineNumber = 0;
+  uint64_t lastTime_ms = 0;
+  bool ok = true;
+
+  // Repeat block
+  bool inRepeat = false;
+  unsigned repeatCount = 0;
+  uint64_t repeatStart_ms = 0;
+  uint64_t repeatPeriod_ms = 0;
+  std::vector<ScenarioEvent> block;
+
+  while (fgets(line, sizeof(line), f) != nullptr) {
+    lineNumber++;
+
+    char* comment = strchr(line, '#');
+    if (comment != nullptr) {
+      *comment = '\0';
+    }
+
+    char* timeStr = strtok(line, DELIMITERS);
+    if (timeStr == nullptr) {
+      continue;
+    }
+
+    if (strcmp(timeStr, "end") == 0) {
+      if (!inRepeat) {
+        fprintf(stderr, "%s:%u: end without repeat\n", path, lineNumber);
+        ok = false;
+        break;
+      }
+      for (unsigned i = 0; i < repeatCount; i++) {
+        for (ScenarioEvent event : block) {
+          event.time_ms += repeatStart_ms + i * repeatPeriod_ms;
+          mEvents.push_back(event);
+        }
+      }
+      lastTime_ms = repeatStart_ms + repeatCount * repeatPeriod_ms;
+      inRepeat = false;
+      block.clear();
+      continue;
+    }
+
+    const bool isRelative = timeStr[0] == '+';
+    uint64_t time_ms;
+    if (!parseTime(isRelative ? timeStr + 1 : timeStr, time_ms)) {
+      fprintf(stderr, "%s:%u: Invalid time '%s'\n", path, lineNumber,
+              timeStr);
+      ok = false;
+      break;
+    }
+    if (isRelative) {
+      time_ms += lastTime_ms;
+    }
+    lastTime_ms = time_ms;
+
+    char* args = strtok(nullptr, "");
+    if (args != nullptr) {
+      args += strspn(args, DELIMITERS);
+    }
+    if (args != nullptr && strncmp(args, "repeat", 6) == 0) {
+      const char* countStr = strtok(args + 6, DELIMITERS);
+      const char* periodStr = strtok(nullptr, DELIMITERS);
+      float count;
+      if (inRepeat || !parseNumber(countStr, count) || count < 1 ||
+          periodStr == nullptr || !parseTime(periodStr, repeatPeriod_ms)) {
+        fprintf(stderr, "%s:%u: Invalid repeat\n", path, lineNumber);
+        ok = false;
+        break;
+      }
+      inRepeat = true;
+      repeatCount = static_cast<unsigned>(count);
+      repeatStart_ms = time_ms;
+      lastTime_ms = 0;
+      continue;
+    }
+
+    ScenarioEvent event;
+    if (args == nullptr || !parseEvent(args, time_ms, event)) {
+      fprintf(stderr, "%s:%u: Invalid input\n", path, lineNumber);
+      ok = false;
+      break;
+    }
+
+    if (inRepeat) {
+      block.push_back(event);
+    } else {
+      mEvents.push_back(event);
+    }
+  }
+
+  fclose(f);
+
+  if (ok && inRepeat) {
+    fprintf(stderr, "%s: repeat without end\n", path);
+    ok = false;
+  }
+
+  // Events at the same time keep their order in the file.
+  std::stable_sort(mEvents.begin(), mEvents.end(),
+                   [](const ScenarioEvent& a, const ScenarioEvent& b) {
+                     return a.time_ms < b.time_ms;
+                   });
+
+  return ok;
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <vector>
+
+enum class ScenarioInput : uint8_t {
+  distance,     // Distance to the sonar in cm, 0 means no echo
+  temperature,  // AHT20 temperature in °C
+  humidity,     // AHT20 relative humidity in %
+  door,         // Door position, see ScenarioDoor
+  valueReq,     // Gateway downlinks from here on
+  valueSet,
+  service,
+  discoveryReq,
+  ping
+};
+
+enum class ScenarioDoor : uint8_t { closed, open, moving };
+
+/**
+ * @brief Change of an input at a time of the simulation.
+ *
+ * Distance, temperature and humidity change linearly to the value over the
+ * ramp time, the others at once.
+ */
+struct ScenarioEvent {
+  uint64_t time_ms;
+  ScenarioInput input;
+  float value;       // Input value, ScenarioDoor or value to set
+  uint64_t ramp_ms;  // Time to reach the value
+  uint8_t entityId;  // Downlinks only
+  uint8_t service;   // Service request only
+};
+
+/**
+ * @brief Scripted inputs of a simulation, read from a text file.
+ *
+ * One event per line, `<time> <input> [<arguments>]`. Time is a sum of numbers
+ * with unit d, h, m, s or ms, e.g. `1d7h30m`, counted from the start. With a
+ * leading `+` it is counted from the event before instead. A `#` starts a
+ * comment. Inputs:
+ *
+ *   distance <cm> [<ramp time>]
+ *   temperature <°C> [<ramp time>]
+ *   humidity <%> [<ramp time>]
+ *   door closed|open|moving
+ *   value_req
+ *   value_set <entity id> <value>
+ *   service <entity id> <service>
+ *   discovery_req [<entity id>]
+ *   ping
+ *
+ * Lines between `<time> repeat <count> <period>` and `end` are repeated count
+ * times, once per period from the time of the repeat line. Their times are
+ * counted from the start of each repetition.
+ */
+class Scenario {
+ public:
+  /**
+   * @brief Load a scenario file. Errors are printed to stderr.
+   * @return true if the whole file was loaded.
+   */
+  bool load(const char* path);
+
+  const std::vector<ScenarioEvent>& getEvents() const { return mEvents; }
+
+  /**
+   * @brief Parse a time like `1d7h30m`.
+   * @return false if it is not a valid time.
+   */
+  static bool parseTime(const char* str, uint64_t& time_ms);
+
+ private:
+  bool parseEvent(char* args, uint64_t time_ms, ScenarioEvent& event);
+
+  std::vector<ScenarioEvent> mEvents;
+};
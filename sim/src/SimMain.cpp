@@ -0,0 +1,82 @@
+/**
+ * Simulator of the node
+ *
+ * Runs the firmware of src/main.cpp on simulated hardware, with inputs from a
+ * scenario file, and prints the airtime used, the reports received by the
+ * gateway and the EEPROM wear. See sim/README.md.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+
+#include "Scenario.h"
+#include "Simulator.h"
+
+static void printUsage(const char* name) {
+  fprintf(stderr,
+          "Usage: %s [options] [scenario file]\n"
+          "  -t <time>  Time to simulate, e.g. 7d or 1d12h (default 7d)\n"
+          "  -l <%%>     Frames lost on the channel (default 0)\n"
+          "  -r <dBm>   RSSI of downlinks (default -90)\n"
+          "  -s <seed>  Seed of the frame loss (default 1)\n"
+          "  -o <file>  Write the uplinks to a trace, see sim/channel\n"
+          "  -v         Echo the serial output of the node\n",
+          name);
+}
+
+int main(int argc, char** argv) {
+  SimulatorOptions options;
+  const char* scenarioPath = nullptr;
+
+  for (int i = 1; i < argc; i++) {
+    const char* arg = argv[i];
+    const bool hasValue = i + 1 < argc;
+
+    if (strcmp(arg, "-t") == 0 && hasValue) {
+      if (!Scenario::parseTime(argv[++i], options.duration_ms)) {
+        printUsage(argv[0]);
+        return 1;
+      }
+    } else if (strcmp(arg, "-l") == 0 && hasValue) {
+      options.lossPercent = static_cast<uint8_t>(atoi(argv[++i]));
+    } else if (strcmp(arg, "-r") == 0 && hasValue) {
+      options.rssi = static_cast<int16_t>(atoi(argv[++i]));
+    } else if (strcmp(arg, "-s") == 0 && hasValue) {
+      options.seed = static_cast<uint32_t>(strtoul(argv[++i], nullptr, 0));
+    } else if (strcmp(arg, "-o") == 0 && hasValue) {
+      options.tracePath = argv[++i];
+    } else if (strcmp(arg, "-v") == 0) {
+      options.verbose = true;
+    } else if (arg[0] != '-' && scenarioPath == nullptr) {
+      scenarioPath = arg;
+    } else {
+      printUsage(argv[0]);
+      return 1;
+    }
+  }
+
+  // Without a scenario all inputs keep their start values.
+  Scenario scenario;
+  if (scenarioPath != nullptr && !scenario.load(scenarioPath)) {
+    return 1;
+  }
+
+  Simulator& sim = Simulator::instance();
+
+  const auto start = std::chrono::steady_clock::now();
+  const bool isOk = sim.run(scenario, options);
+  const std::chrono::duration<double> wallTime =
+      std::chrono::steady_clock::now() - start;
+
+  fflush(stdout);
+  printf("\n");
+  sim.printReport(stdout);
+  printf("Run time: %.2f s, %.0f times faster than real time\n",
+         wallTime.count(),
+         wallTime.count() > 0 ? sim.getTime_ms() / 1000.0 / wallTime.count()
+                              : 0.0);
+
+  return isOk ? 0 : 1;
+}
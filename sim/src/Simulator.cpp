@@ -0,0 +1,435 @@
+#include "Simulator.h"
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <LoRa.h>
+
+#include <algorithm>
+
+#include "Device.h"
+#include "LoRaHandler.h"
+
+// Firmware state, see src/main.cpp
+extern Device device;
+extern LoRaHandler lora;
+extern uint8_t discoveryCursor;
+
+static constexpr uint64_t MS_PER_HOUR = 3600ULL * 1000ULL;
+static constexpr uint64_t MS_PER_DAY = 24ULL * MS_PER_HOUR;
+
+Simulator& Simulator::instance() {
+  static Simulator simulator;
+  return simulator;
+}
+
+float Simulator::Ramp::getValue(uint64_t time_ms) const {
+  if (time_ms >= mEnd_ms) {
+    return mTo;
+  }
+  if (time_ms <= mStart_ms) {
+    return mFrom;
+  }
+  return mFrom + (mTo - mFrom) * static_cast<float>(time_ms - mStart_ms) /
+                     static_cast<float>(mEnd_ms - mStart_ms);
+}
+
+void Simulator::Ramp::set(float value, uint64_t start_ms, uint64_t ramp_ms) {
+  mFrom = getValue(start_ms);
+  mTo = value;
+  mStart_ms = start_ms;
+  mEnd_ms = start_ms + ramp_ms;
+}
+
+size_t Simulator::SerialEcho::write(uint8_t c) {
+  mCount++;
+  if (mIsEnabled) {
+    putchar(c);
+  }
+  return 1;
+}
+
+bool Simulator::run(const Scenario& scenario, const SimulatorOptions& options) {
+  mOptions = options;
+  mScenario = &scenario;
+  mRandom = options.seed != 0 ? options.seed : 1;
+
+  for (int& level : mPins) {
+    level = HIGH;  // Pull-ups
+  }
+  setDoor(ScenarioDoor::closed);
+  mWakePinCount = 0;
+  mTemperature.set(20.0f, 0, 0);
+  mHumidity.set(50.0f, 0, 0);
+
+  eeprom_clear();  // As delivered
+  mEepromWrites.assign(E2END + 1, 0);
+
+  mSerialEcho.mIsEnabled = options.verbose;
+  Serial.setEcho(&mSerialEcho);
+
+  arduinoMockInstance()->setMillisRaw(0);
+  PowerManager::setAddMillisFunc(
+      [](uint32_t ms) { arduinoMockInstance()->addMillisRaw(ms); });
+  (void)runEvents();
+
+  setup();
+  Serial.flush();
+  mSetupEepromWrites = mEepromWrites;
+
+  while (mTime_ms < mOptions.duration_ms) {
+    const uint64_t start_ms = mTime_ms;
+    loop();
+    Serial.flush();  // Keeps the buffer of the serial mock from overflowing
+
+    if (mTime_ms == start_ms) {
+      delay(SimulatorConstants::LOOP_TIME_MS);
+    }
+  }
+
+  if (mOptions.tracePath == nullptr) {
+    return true;
+  }
+  mTrace.setDuration_ms(mTime_ms);
+  return mTrace.save(mOptions.tracePath);
+}
+
+int Simulator::getPin(uint8_t pin) const {
+  return pin < SimulatorConstants::PIN_COUNT ? mPins[pin] : LOW;
+}
+
+void Simulator::setPin(uint8_t pin, int level) {
+  if (pin < SimulatorConstants::PIN_COUNT) {
+    mPins[pin] = level;
+  }
+}
+
+void Simulator::startAhtMeasurement() {
+  mAhtReady_ms = mTime_ms + SimulatorConstants::AHT20_MEASURE_TIME_MS;
+}
+
+void Simulator::delay(uint32_t ms) {
+  Serial.flush();
+
+  const uint64_t end_ms = mTime_ms + ms;
+  while (mTime_ms < end_ms) {
+    const uint64_t next_ms = std::min(getNextEventTime(), end_ms);
+    mCpuTime_ms[static_cast<uint8_t>(PowerState::active)] += next_ms - mTime_ms;
+    advance(next_ms, true);
+    (void)runEvents();  // Interrupts are served while waiting
+  }
+}
+
+void Simulator::sleepIdle() {
+  Serial.flush();
+
+  if (runEvents()) {
+    return;  // Woken up by a pending interrupt at once
+  }
+
+  const uint64_t wake_ms =
+      std::min(mTime_ms + getFirmwareIdleTime(), getNextEventTime());
+  mCpuTime_ms[static_cast<uint8_t>(PowerState::idle)] += wake_ms - mTime_ms;
+  advance(wake_ms, true);
+  (void)runEvents();
+}
+
+void Simulator::sleepPowerDown() {
+  assert(mWdto >= 0);
+
+  const uint32_t wakePinCount = mWakePinCount;
+  const uint64_t end_ms =
+      mTime_ms + (static_cast<uint64_t>(PowerManager::MIN_POWER_DOWN_MS)
+                  << mWdto);
+  uint64_t& time_ms =
+      mCpuTime_ms[static_cast<uint8_t>(PowerState::powerDown)];
+
+  // Inputs change while asleep, only a wake pin ends the step early. Then
+  // millis() has not been moved forward for the time asleep.
+  (void)runEvents();
+  while (mWakePinCount == wakePinCount) {
+    const uint64_t next_ms = getNextEventTime();
+    if (next_ms >= end_ms) {
+      time_ms += end_ms - mTime_ms;
+      advance(end_ms, false);  // PowerManager moves millis() forward
+      return;
+    }
+    time_ms += next_ms - mTime_ms;
+    advance(next_ms, false);
+    (void)runEvents();
+  }
+}
+
+uint32_t Simulator::getFirmwareIdleTime() const {
+  // Mirrors sleepUntilNextEvent() of src/main.cpp. While there is radio work
+  // or discovery to send the loop has to run at the next timer tick.
+  if (lora.isBusy() || discoveryCursor < device.getSize()) {
+    return 1;
+  }
+
+  const uint32_t now = millis();
+  const uint32_t time_ms = std::min(device.getTimeToNextUpdate(now),
+                                    lora.getTimeToNextRxEvent(now));
+  return std::max(time_ms, static_cast<uint32_t>(1));
+}
+
+void Simulator::advance(uint64_t time_ms, bool isMillisRunning) {
+  if (time_ms <= mTime_ms) {
+    return;
+  }
+
+  if (isMillisRunning) {
+    arduinoMockInstance()->addMillisRaw(time_ms - mTime_ms);
+  }
+  mTime_ms = time_ms;
+}
+
+uint64_t Simulator::getNextEventTime() const {
+  uint64_t next_ms = UINT64_MAX;
+
+  const std::vector<ScenarioEvent>& events = mScenario->getEvents();
+  if (mNextScenarioEvent < events.size()) {
+    next_ms = events[mNextScenarioEvent].time_ms;
+  }
+
+  next_ms = std::min(next_ms, LoRa.getTxEndTime());
+
+  // Downlinks are held while the node doesn't receive.
+  if (LoRa.getMode() == LoRaClass::Mode::rx) {
+    const uint64_t downlink_ms =
+        std::max(mGateway.getNextDownlinkTime(), mChannelFree_ms);
+    next_ms = std::min(next_ms, std::max(downlink_ms, mTime_ms));
+  }
+
+  return next_ms;
+}
+
+bool Simulator::runEvents() {
+  bool isAnyRun = false;
+
+  const std::vector<ScenarioEvent>& events = mScenario->getEvents();
+  while (mNextScenarioEvent < events.size() &&
+         events[mNextScenarioEvent].time_ms <= mTime_ms) {
+    applyScenarioEvent(events[mNextScenarioEvent]);
+    mNextScenarioEvent++;
+    isAnyRun = true;
+  }
+
+  if (LoRa.getTxEndTime() <= mTime_ms) {
+    LoRa.update();
+    isAnyRun = true;
+  }
+
+  while (LoRa.getMode() == LoRaClass::Mode::rx &&
+         mGateway.getNextDownlinkTime() <= mTime_ms &&
+         mChannelFree_ms <= mTime_ms) {
+    uint8_t frame[LORA_MAX_MESSAGE_LENGTH];
+    const uint8_t length = mGateway.takeDownlink(frame);
+    mChannelFree_ms = mTime_ms + TimeOnAir::toMs(LoRa.getTimeOnAir_us(length));
+    mDownlinkCount++;
+    if (isFrameLost()) {
+      mDownlinkLostCount++;
+    } else {
+      (void)LoRa.deliver(frame, length, mOptions.rssi);
+    }
+    isAnyRun = true;
+  }
+
+  return isAnyRun;
+}
+
+void Simulator::applyScenarioEvent(const ScenarioEvent& event) {
+  uint8_t payload[1 + ValueItemT::size()]{};
+
+  switch (event.input) {
+    case ScenarioInput::distance:
+      mDistance.set(event.value, event.time_ms, event.ramp_ms);
+      break;
+
+    case ScenarioInput::temperature:
+      mTemperature.set(event.value, event.time_ms, event.ramp_ms);
+      break;
+
+    case ScenarioInput::humidity:
+      mHumidity.set(event.value, event.time_ms, event.ramp_ms);
+      break;
+
+    case ScenarioInput::door:
+      setDoor(static_cast<ScenarioDoor>(event.value));
+      break;
+
+    case ScenarioInput::valueReq:
+      payload[0] = UINT8_MAX;
+      mGateway.queueDownlink(LoRaMsgType::value_req, payload, 1, mTime_ms);
+      break;
+
+    case ScenarioInput::valueSet: {
+      // A single value item, without the count byte of the header doc, as
+      // parsed by LoRaHandler.
+      const ValueItemT item(
+          event.entityId,
+          static_cast<uint32_t>(static_cast<int32_t>(event.value)));
+      const uint8_t n = item.toByteArray(payload, sizeof(payload));
+      mGateway.queueDownlink(LoRaMsgType::valueSet_req, payload, n, mTime_ms);
+      break;
+    }
+
+    case ScenarioInput::service:
+      payload[0] = event.entityId;
+      payload[1] = event.service;
+      mGateway.queueDownlink(LoRaMsgType::service_req, payload, 2, mTime_ms);
+      break;
+
+    case ScenarioInput::discoveryReq:
+      payload[0] = event.entityId;
+      mGateway.queueDownlink(LoRaMsgType::discovery_req, payload, 1,
+                             mTime_ms);
+      break;
+
+    case ScenarioInput::ping:
+      mGateway.queueDownlink(LoRaMsgType::ping_req, payload, 0, mTime_ms);
+      break;
+  }
+}
+
+void Simulator::setDoor(ScenarioDoor door) {
+  const int closedLevel = door == ScenarioDoor::closed ? LOW : HIGH;
+  const int openLevel = door == ScenarioDoor::open ? LOW : HIGH;
+
+  if (mPins[SimulatorConstants::COVER_CLOSED_PIN] == closedLevel &&
+      mPins[SimulatorConstants::COVER_OPEN_PIN] == openLevel) {
+    return;
+  }
+
+  mPins[SimulatorConstants::COVER_CLOSED_PIN] = closedLevel;
+  mPins[SimulatorConstants::COVER_OPEN_PIN] = openLevel;
+
+  // Pin change interrupt
+  PowerManager::onWakePinIsr();
+  mWakePinCount++;
+}
+
+void Simulator::onUplink(const uint8_t* frame, uint8_t length,
+                         uint32_t timeOnAir_us) {
+  mUplinkCount++;
+  mUplinkBytes += length;
+  mAirTime_us += timeOnAir_us;
+
+  const size_t hour = static_cast<size_t>(mTime_ms / MS_PER_HOUR);
+  if (mHourlyAirTime_us.size() <= hour) {
+    mHourlyAirTime_us.resize(hour + 1, 0);
+  }
+  mHourlyAirTime_us[hour] += timeOnAir_us;
+
+  if (mOptions.tracePath != nullptr) {
+    // Called at the end of the transmission, the trace has the start.
+    mTrace.add(mTime_ms - TimeOnAir::toMs(timeOnAir_us), frame, length);
+  }
+
+  if (isFrameLost()) {
+    mUplinkLostCount++;
+    return;
+  }
+  mGateway.onUplink(frame, length, mTime_ms);
+}
+
+void Simulator::onEepromWrite(int index) {
+  if (index >= 0 && static_cast<size_t>(index) < mEepromWrites.size()) {
+    mEepromWrites[index]++;
+  }
+}
+
+bool Simulator::isFrameLost() {
+  if (mOptions.lossPercent == 0) {
+    return false;
+  }
+
+  // xorshift32, the same seed gives the same run
+  mRandom ^= mRandom << 13;
+  mRandom ^= mRandom >> 17;
+  mRandom ^= mRandom << 5;
+  return mRandom % 100 < mOptions.lossPercent;
+}
+
+static void printPercentage(FILE* f, const char* name, uint64_t time_ms,
+                            uint64_t total_ms) {
+  fprintf(f, "  %-12s %12.1f s %8.3f %%\n", name, time_ms / 1000.0,
+          total_ms > 0 ? 100.0 * time_ms / total_ms : 0.0);
+}
+
+void Simulator::printReport(FILE* f) const {
+  const uint64_t duration_ms = mTime_ms;
+  const double days = static_cast<double>(duration_ms) / MS_PER_DAY;
+
+  fprintf(f, "Simulated %.2f days\n", days);
+
+  fprintf(f, "MCU:\n");
+  printPercentage(f, "active",
+                  mCpuTime_ms[static_cast<uint8_t>(PowerState::active)],
+                  duration_ms);
+  printPercentage(f, "idle",
+                  mCpuTime_ms[static_cast<uint8_t>(PowerState::idle)],
+                  duration_ms);
+  printPercentage(f, "power down",
+                  mCpuTime_ms[static_cast<uint8_t>(PowerState::powerDown)],
+                  duration_ms);
+  fprintf(f, "  Wake pin changes %u, millis() behind by %u ms\n",
+          mWakePinCount,
+          static_cast<uint32_t>(mTime_ms) - static_cast<uint32_t>(millis()));
+
+  fprintf(f, "Radio:\n");
+  static const char* const modeNames[LoRaClass::MODE_COUNT] = {
+      "sleep", "standby", "rx", "tx"};
+  for (uint8_t i = 0; i < LoRaClass::MODE_COUNT; i++) {
+    printPercentage(f, modeNames[i],
+                    LoRa.getModeTime_ms(static_cast<LoRaClass::Mode>(i)),
+                    duration_ms);
+  }
+
+  const uint32_t busiestHour_us =
+      mHourlyAirTime_us.empty()
+          ? 0
+          : *std::max_element(mHourlyAirTime_us.begin(),
+                              mHourlyAirTime_us.end());
+  fprintf(f, "Uplinks: %u frames, %u lost, %llu bytes\n", mUplinkCount,
+          mUplinkLostCount, static_cast<unsigned long long>(mUplinkBytes));
+  fprintf(f, "  Airtime %.1f s, %.4f %% of the time, %.1f s per day\n",
+          mAirTime_us / 1e6,
+          duration_ms > 0 ? mAirTime_us / 10.0 / duration_ms : 0.0,
+          days > 0 ? mAirTime_us / 1e6 / days : 0.0);
+  fprintf(f, "  Busiest hour %.2f s, %.4f %% (limit %d %%)\n",
+          busiestHour_us / 1e6, busiestHour_us / 1e4 / 3600.0,
+          AIRTIME_LIMIT_PERCENT);
+  fprintf(f, "Downlinks: %u frames, %u lost\n", mDownlinkCount,
+          mDownlinkLostCount);
+
+  mGateway.printReport(f, duration_ms);
+
+  // Writes in setup(), e.g. the erase at first start, are only done once.
+  uint64_t eepromWrites = 0;
+  uint64_t setupEepromWrites = 0;
+  uint32_t maxWrites = 0;
+  size_t maxWritesIndex = 0;
+  for (size_t i = 0; i < mEepromWrites.size(); i++) {
+    const uint32_t writes = mEepromWrites[i] - mSetupEepromWrites[i];
+    eepromWrites += writes;
+    setupEepromWrites += mSetupEepromWrites[i];
+    if (writes > maxWrites) {
+      maxWrites = writes;
+      maxWritesIndex = i;
+    }
+  }
+  fprintf(f, "EEPROM: %llu writes in setup, %llu after\n",
+          static_cast<unsigned long long>(setupEepromWrites),
+          static_cast<unsigned long long>(eepromWrites));
+  if (maxWrites > 0 && days > 0) {
+    const double writesPerDay = maxWrites / days;
+    fprintf(f,
+            "  Most written cell %zu: %u writes, %.1f per day, worn out in "
+            "%.1f years\n",
+            maxWritesIndex, maxWrites, writesPerDay,
+            SimulatorConstants::EEPROM_ENDURANCE / writesPerDay / 365.0);
+  }
+
+  fprintf(f, "Serial output: %llu bytes\n",
+          static_cast<unsigned long long>(mSerialEcho.mCount));
+}
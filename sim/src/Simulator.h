@@ -0,0 +1,152 @@
+#pragma once
+
+#include <Print.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include <vector>
+
+#include "Gateway.h"
+#include "PowerManager.h"
+#include "Scenario.h"
+#include "../channel/UplinkTrace.h"
+
+// Wiring and addresses of src/main.cpp
+namespace SimulatorConstants {
+constexpr uint8_t COVER_OPEN_PIN = 8;
+constexpr uint8_t COVER_CLOSED_PIN = 9;
+constexpr uint8_t NODE_ADDRESS = 1;
+constexpr uint8_t GATEWAY_ADDRESS = 0;
+
+constexpr uint8_t PIN_COUNT = 32;
+constexpr uint16_t AHT20_MEASURE_TIME_MS = 80;
+constexpr uint32_t EEPROM_ENDURANCE = 100000;  // Write cycles per cell
+constexpr uint32_t LOOP_TIME_MS = 1;  // A loop without sleep or delay
+}  // namespace SimulatorConstants
+
+struct SimulatorOptions {
+  uint64_t duration_ms{7ULL * 24 * 3600 * 1000};
+  bool verbose{};        // Echo the serial output of the node
+  uint8_t lossPercent{};  // Frames lost on the channel, both directions
+  uint32_t seed{1};
+  int16_t rssi{-90};
+  const char* tracePath{};  // Uplink trace to write, see UplinkTrace.h
+};
+
+/**
+ * @brief Runs the node firmware, setup() and loop() of src/main.cpp, on
+ * simulated hardware and a simulated clock.
+ *
+ * The simulation time only moves forward when the firmware waits: in delay(),
+ * in a busy wait for a sensor and when the MCU sleeps. Idle sleep is
+ * fast-forwarded to the next event, i.e. the next scheduled component update,
+ * RX window event, scenario input or radio interrupt, when the loop has
+ * nothing else to do. Power-down lasts a watchdog step or until a change of a
+ * wake pin, like on the MCU. The time asleep before such a wake up is lost
+ * for millis(), so the node's clock falls behind the simulation time.
+ *
+ * Code runs in zero time otherwise, so the active time is the time spent in
+ * waits and the resolution is 1 ms.
+ */
+class Simulator {
+ public:
+  static Simulator& instance();
+
+  /**
+   * @brief Run setup() and then loop() for the duration of the options.
+   * @return false if the uplink trace could not be written.
+   */
+  bool run(const Scenario& scenario, const SimulatorOptions& options);
+
+  void printReport(FILE* f) const;
+
+  /**
+   * @return Time since start of the simulation in ms. It does not wrap and
+   * does not fall behind like millis() does.
+   */
+  uint64_t getTime_ms() const { return mTime_ms; }
+
+  // Simulated hardware
+  // ----------------------------------------------------------------
+
+  int getPin(uint8_t pin) const;
+  void setPin(uint8_t pin, int level);
+
+  float getDistance() const { return mDistance.getValue(mTime_ms); }
+  float getTemperature() const { return mTemperature.getValue(mTime_ms); }
+  float getHumidity() const { return mHumidity.getValue(mTime_ms); }
+
+  void startAhtMeasurement();
+  bool isAhtBusy() const { return mTime_ms < mAhtReady_ms; }
+
+  void delay(uint32_t ms);
+  void sleepIdle();
+  void sleepPowerDown();
+  void setWatchdog(int8_t wdto) { mWdto = wdto; }
+
+  void onUplink(const uint8_t* frame, uint8_t length, uint32_t timeOnAir_us);
+  void onEepromWrite(int index);
+
+ private:
+  // Input that changes linearly from one value to another over time.
+  class Ramp {
+   public:
+    float getValue(uint64_t time_ms) const;
+    void set(float value, uint64_t start_ms, uint64_t ramp_ms);
+
+   private:
+    float mFrom{};
+    float mTo{};
+    uint64_t mStart_ms{};
+    uint64_t mEnd_ms{};
+  };
+
+  // Counts and optionally echoes the serial output of the node.
+  class SerialEcho : public Print {
+   public:
+    size_t write(uint8_t c) override;
+
+    bool mIsEnabled{};
+    uint64_t mCount{};
+  };
+
+  void advance(uint64_t time_ms, bool isMillisRunning);
+  uint64_t getNextEventTime() const;
+  bool runEvents();
+  void applyScenarioEvent(const ScenarioEvent& event);
+  void setDoor(ScenarioDoor door);
+  uint32_t getFirmwareIdleTime() const;
+  bool isFrameLost();
+
+  SimulatorOptions mOptions;
+  const Scenario* mScenario{};
+  size_t mNextScenarioEvent{};
+  Gateway mGateway{SimulatorConstants::GATEWAY_ADDRESS,
+                   SimulatorConstants::NODE_ADDRESS};
+  SerialEcho mSerialEcho;
+  UplinkTrace mTrace;
+  uint32_t mRandom{};
+
+  uint64_t mTime_ms{};
+  int8_t mWdto{-1};  // Watchdog timeout, -1 when stopped
+
+  int mPins[SimulatorConstants::PIN_COUNT]{};
+  Ramp mDistance;
+  Ramp mTemperature;
+  Ramp mHumidity;
+  uint64_t mAhtReady_ms{};
+  uint64_t mChannelFree_ms{};  // End of the last downlink on air
+
+  // Statistics
+  uint64_t mCpuTime_ms[PowerManager::STATE_COUNT]{};
+  uint32_t mWakePinCount{};
+  uint32_t mUplinkCount{};
+  uint32_t mUplinkLostCount{};
+  uint64_t mUplinkBytes{};
+  uint64_t mAirTime_us{};
+  std::vector<uint32_t> mHourlyAirTime_us;
+  uint32_t mDownlinkCount{};
+  uint32_t mDownlinkLostCount{};
+  std::vector<uint32_t> mEepromWrites;
+  std::vector<uint32_t> mSetupEepromWrites;
+};
@@ -2,6 +2,8 @@
 
 #include <Arduino.h>
 
+#include "Profiler.h"
+
 // TODO: Replace this ugly workaround with something better
 #ifndef HAVE_HWSERIAL0
 #include "BufferSerial.h"
@@ -28,6 +30,8 @@ bool AHTReader::update() {
 
   mLastReadTime = now;
 
+  PROFILE_SCOPE(ProfileSection::ahtUpdate);
+
   if (mAht.getMeasurements(&mLastHumidity, &mLastTemperature)) {
     mReadSuccessful = true;
   } else {
@@ -54,17 +54,7 @@ const __FlashStringHelper* BinarySensor::getStateName() const {
 }
 
 void BinarySensor::getDiscoveryEntity(DiscoveryEntityT& item) const {
-  item.entityId = mBaseComponent.getEntityId();
-  item.componentType = static_cast<uint8_t>(getComponentType());
-  item.deviceClass = static_cast<uint8_t>(getDeviceClass());
-  item.category = static_cast<uint8_t>(getCategory());
-  item.unit = static_cast<uint8_t>(mUnit.type());
-  item.precision = 0;
-  item.sizeCode = 0;
-  item.isSigned = false;
-  item.minValue = 0;
-  item.maxValue = 1;
-  item.name = mBaseComponent.getName();
+  mBaseComponent.getDiscoveryEntity(item);
 }
 
 void BinarySensor::getValueItem(ValueItemT& item) const {
@@ -46,17 +46,7 @@ static const char CoverServiceName[][8] PROGMEM = {"open", "close", "stop",
                                                    "toggle", "unknown"};
 
 void Cover::getDiscoveryEntity(DiscoveryEntityT& item) const {
-  item.entityId = mBaseComponent.getEntityId();
-  item.componentType = static_cast<uint8_t>(getComponentType());
-  item.deviceClass = static_cast<uint8_t>(getDeviceClass());
-  item.category = static_cast<uint8_t>(mBaseComponent.getCategory());
-  item.unit = static_cast<uint8_t>(Unit::Type::none);
-  item.precision = 0;
-  item.sizeCode = 0;
-  item.isSigned = false;
-  item.minValue = 0;
-  item.maxValue = 0;
-  item.name = mBaseComponent.getName();
+  mBaseComponent.getDiscoveryEntity(item);
 }
 
 void Cover::getValueItem(ValueItemT& item) const {
@@ -1,19 +1,222 @@
 #include "Device.h"
 
+#include <string.h>
+
+#include "CompactDiscovery.h"
+#include "Profiler.h"
+
+static_assert(PROFILER_MAX_COMPONENTS >= DEVICE_MAX_COMPONENTS,
+              "A profiler section for each component");
+
 IComponent* Device::getComponent(uint8_t idx) {
   if (idx >= mSize) {
     return nullptr;
   }
-  return mComponents[idx];
+  return at(idx);
 }
 
 IComponent* Device::getComponentByEntityId(uint8_t entityId) {
+  if (entityId > DEVICE_MAX_ENTITY_ID) {
+    return nullptr;
+  }
+
+  const uint8_t idx = mIndexById[entityId];
+  if (idx == NO_INDEX) {
+    return nullptr;
+  }
+  return at(idx);
+}
+
+void Device::buildIndex() {
+  memset(mIndexById, NO_INDEX, sizeof(mIndexById));
+
+  for (uint8_t i = 0; i < mSize; i++) {
+    const uint8_t entityId = at(i)->getEntityId();
+    if (entityId > DEVICE_MAX_ENTITY_ID || mIndexById[entityId] != NO_INDEX) {
+      if (mIsEntityIdsValid) {
+        mInvalidEntityId = entityId;
+        mIsEntityIdsValid = false;
+      }
+      continue;
+    }
+    mIndexById[entityId] = i;
+  }
+}
+
+uint32_t Device::getDiscoveryHash() const {
+  uint32_t hash = CompactDiscovery::FNV_OFFSET_BASIS;
+
+  for (uint8_t i = 0; i < mSize; i++) {
+    DiscoveryEntityT entity;
+    at(i)->getDiscoveryEntity(entity);
+    hash = CompactDiscovery::hashEntity(hash, entity);
+  }
+
+  return hash;
+}
+
+int8_t Device::getIndex(const IComponent* component) const {
+  for (uint8_t i = 0; i < mSize; i++) {
+    if (at(i) == component) {
+      return static_cast<int8_t>(i);
+    }
+  }
+  return -1;
+}
+
+Device::MaskT Device::getUpstream(uint8_t idx) const {
+  const MaskT bit = MaskT{1} << idx;
+  return (mIsDownstream & bit) ? mUpstream[slot(mIsDownstream, idx)] : 0;
+}
+
+void Device::sortComponents() {
+  uint8_t downstreams = 0;
   for (uint8_t i = 0; i < mSize; i++) {
-    if (mComponents[i]->getEntityId() == entityId) {
-      return mComponents[i];
+    MaskT upstreams = 0;
+    const IComponent* upstream;
+    for (uint8_t j = 0; (upstream = at(i)->getUpstream(j)); j++) {
+      const int8_t idx = getIndex(upstream);
+      if (idx >= 0) {
+        upstreams |= MaskT{1} << idx;
+      }
+    }
+    if (upstreams == 0) {
+      continue;
+    }
+
+    if (downstreams == DEVICE_MAX_DOWNSTREAMS ||
+        slot(mIsUpstream | upstreams, mSize) > DEVICE_MAX_UPSTREAMS) {
+      assert(false);  // Too many, updated on its own interval only
+      continue;
+    }
+    // Slots are taken in index order, so this is the last one.
+    mUpstream[downstreams++] = upstreams;
+    mIsDownstream |= MaskT{1} << i;
+    mIsUpstream |= upstreams;
+  }
+
+  // Topological sort, keeping array order among independent components.
+  MaskT done = 0;
+  uint8_t n = 0;
+  while (n < mSize) {
+    uint8_t i = 0;
+    while (i < mSize &&
+           ((done & (MaskT{1} << i)) || (getUpstream(i) & ~done))) {
+      i++;
+    }
+    if (i == mSize) {
+      assert(false);  // Dependency cycle, rest are updated in array order
+      for (i = 0; i < mSize; i++) {
+        if (!(done & (MaskT{1} << i))) {
+          mOrder[n++] = i;
+        }
+      }
+      break;
     }
+    mOrder[n++] = i;
+    done |= MaskT{1} << i;
   }
-  return nullptr;
+}
+
+uint8_t Device::update(uint32_t now) {
+  PROFILE_SCOPE(ProfileSection::deviceUpdate);
+
+  if (!mIsUpdated) {
+    sortComponents();
+    for (uint8_t i = 0; i < mSize; i++) {
+      mNextUpdateTime[i] = now;
+    }
+    mIsUpdated = true;
+  }
+
+  uint8_t count = 0;
+  MaskT changed = 0;
+
+  for (uint8_t k = 0; k < mSize; k++) {
+    const uint8_t i = mOrder[k];
+    const MaskT bit = MaskT{1} << i;
+    IComponent* c = at(i);
+
+    if ((getUpstream(i) & changed) || (mIsDue & bit) ||
+        static_cast<int32_t>(now - mNextUpdateTime[i]) >= 0) {
+      {
+        PROFILE_SCOPE(Profiler::component(i));
+        c->update();
+      }
+      mNextUpdateTime[i] = now + c->getUpdateInterval();
+      if (c->isReportDue()) {
+        mReportDue |= bit;
+      }
+      count++;
+    }
+
+    // Values may also change without update(), e.g. by setValueItem().
+    if (mIsUpstream & bit) {
+      ValueItemT item;
+      c->getValueItem(item);
+      uint32_t& lastValue = mLastValue[slot(mIsUpstream, i)];
+      if (item.value != lastValue) {
+        lastValue = item.value;
+        changed |= bit;
+      }
+    }
+  }
+
+  mIsDue = 0;
+
+  return count;
+}
+
+uint8_t Device::report(QueueValueFunc queue) {
+  uint8_t count = 0;
+
+  for (uint8_t i = 0; i < mSize && mReportDue; i++) {
+    const MaskT bit = MaskT{1} << i;
+    if (!(mReportDue & bit)) {
+      continue;
+    }
+
+    IComponent* c = at(i);
+    if (c->isReportDue()) {
+      ValueItemT item;
+      c->getValueItem(item);
+      if (!queue(item)) {
+        break;  // Queue full, the rest stay in the set
+      }
+      c->setReported(ReportReason::due);
+      count++;
+    }
+    mReportDue &= static_cast<MaskT>(~bit);
+  }
+
+  return count;
+}
+
+void Device::setUpdateDue(const IComponent* component) {
+  const int8_t idx = getIndex(component);
+  if (idx >= 0) {
+    mIsDue |= MaskT{1} << idx;
+  }
+}
+
+uint32_t Device::getTimeToNextUpdate(uint32_t now) const {
+  if (!mIsUpdated || mIsDue) {
+    return 0;
+  }
+
+  uint32_t minTime = UINT32_MAX;
+
+  for (uint8_t i = 0; i < mSize; i++) {
+    const int32_t time = static_cast<int32_t>(mNextUpdateTime[i] - now);
+    if (time <= 0) {
+      return 0;
+    }
+    if (static_cast<uint32_t>(time) < minTime) {
+      minTime = static_cast<uint32_t>(time);
+    }
+  }
+
+  return minTime;
 }
 
 size_t Device::printTo(Print& p) const {
@@ -23,9 +226,9 @@ size_t Device::printTo(Print& p) const {
     if (i > 0) {
       n += p.print(", ");
     }
-    n += p.print(mComponents[i]->getEntityId());
+    n += p.print(at(i)->getEntityId());
     n += p.print(':');
-    n += mComponents[i]->printTo(p);
+    n += at(i)->printTo(p);
   }
 
   n += p.println();
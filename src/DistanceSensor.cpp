@@ -12,19 +12,7 @@ bool DistanceSensor::update() {
 
   mSensor.setValue(newValue);
 
-  const bool largeChange =
-      mSensor.absDiffLastReportedValue() >=
-      DistanceSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT;
-
-  const bool timeToReport =
-      (mSensor.timeSinceLastReport() / 1000) >=
-      DistanceSensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT;
-
-  const bool isReportDue = largeChange || timeToReport;
-
-  mSensor.setIsReportDue(isReportDue);
-
-  return isReportDue;
+  return mSensor.updateIsReportDue(mReportPolicy);
 }
 
 bool DistanceSensor::getDiscoveryEntity(DiscoveryEntityT& item) const {
@@ -9,20 +9,11 @@
 #include "Util.h"
 
 bool HeightSensor::update() {
-  HeightT newValue = mZeroValue.getValue() - mDistanceSensor.getValue();
+  HeightT newValue = mZeroValue.getValue() - mDistanceSensor.getSensor().getValue();
 
   mSensor.setValue(newValue);
 
-  bool largeChange = mSensor.absDiffLastReportedValue() >=
-                     HeightSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT;
-
-  bool timeToReport = (mSensor.timeSinceLastReport() / 1000) >=
-                      HeightSensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT;
-
-  bool isReportDue = largeChange || timeToReport;
-  mSensor.setIsReportDue(isReportDue);
-
-  return isReportDue;
+  return mSensor.updateIsReportDue(mReportPolicy);
 }
 
 bool HeightSensor::getDiscoveryEntity(DiscoveryEntityT& item) const {
@@ -30,6 +21,17 @@ bool HeightSensor::getDiscoveryEntity(DiscoveryEntityT& item) const {
   return true;
 }
 
+const IComponent* HeightSensor::getUpstream(uint8_t idx) const {
+  switch (idx) {
+    case 0:
+      return &mDistanceSensor;
+    case 1:
+      return &mZeroValue;
+    default:
+      return nullptr;
+  }
+}
+
 bool HeightSensor::setValueItem(const ValueItemT& item) {
   switch (item.entityId - mSensor.getEntityId() - 1) {
     case 0:
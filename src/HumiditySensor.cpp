@@ -14,6 +14,10 @@ extern BufferSerial Serial;
 #endif
 
 bool HumiditySensor::update() {
+  // Shared with the temperature sensor, the reader skips a read if it just
+  // did one.
+  (void)mAhtReader.update();
+
   if (mAhtReader.isReadSuccessful()) {
     int16_t newValue = round(mAhtReader.getHumidity());
     if (newValue < 0) {
@@ -26,16 +30,7 @@ bool HumiditySensor::update() {
     mSensor.setValue(static_cast<HumidityT>(newValue));
   }
 
-  bool largeChange = mSensor.absDiffLastReportedValue() >=
-                     HumiditySensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT;
-
-  bool timeToReport = (mSensor.timeSinceLastReport() / 1000) >=
-                      HumiditySensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT;
-
-  bool isReportDue = largeChange || timeToReport;
-  mSensor.setIsReportDue(isReportDue);
-
-  return isReportDue;
+  return mSensor.updateIsReportDue(mReportPolicy);
 }
 
 bool HumiditySensor::setValueItem(const ValueItemT& item) { return false; }
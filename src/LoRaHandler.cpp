@@ -3,8 +3,17 @@
 #include <Arduino.h>
 #include <LoRa.h>  // LoRa by Sandeep Mistry v0.8.0
 
+#include "Device.h"
+#include "Log.h"
+#include "Profiler.h"
 #include "Util.h"
 
+// A value request queues the values of all components at once.
+static_assert(LORA_VALUE_QUEUE_SIZE >= DEVICE_MAX_COMPONENTS,
+              "A queued value for each component");
+static_assert(LORA_COMPACT_VALUE_ENTITIES >= DEVICE_MAX_COMPONENTS,
+              "A compact value entity for each component");
+
 #define LORA_BROADCAST_ADDRESS 255
 
 static constexpr uint8_t msgTypeMask = 0x0f;
@@ -18,68 +27,277 @@ int16_t LoRaHandler::begin(OnDiscoveryReqMsgFunc onDiscoveryReqMsgFunc,
   mOnValueSetReqMsgFunc = onValueSetReqMsgFunc;
   mOnServiceReqMsgFunc = onServiceReqMsgFunc;
 
-  return mLoRa.begin(LORA_FREQUENCY);
+  sInstance = this;
+  mLoRa.onTxDone(&LoRaHandler::onTxDoneIsr);
+
+  if (!mLoRa.begin(LORA_FREQUENCY)) {
+    return 0;
+  }
+
+  // Set all parameters used by the time on air estimate explicitly, so the
+  // estimate can't drift from library defaults.
+  mLoRa.setSpreadingFactor(LORA_SPREADING_FACTOR);
+  mLoRa.setSignalBandwidth(LORA_SIGNAL_BANDWIDTH);
+  mLoRa.setCodingRate4(LORA_CODING_RATE4);
+  mLoRa.setPreambleLength(LORA_PREAMBLE_LENGTH);
+#if (LORA_CRC_ENABLED)
+  mLoRa.enableCrc();
+#else
+  mLoRa.disableCrc();
+#endif
+
+  return 1;
+}
+
+LoRaHandler* LoRaHandler::sInstance = nullptr;
+
+void LoRaHandler::onReceiveIsr(int packetSize) {
+  if (sInstance) {
+    sInstance->handleRxIrq(packetSize);
+  }
+}
+
+void LoRaHandler::enableRxInterrupt() {
+  mRxIrqEnabled = true;
+  mLoRa.onReceive(&LoRaHandler::onReceiveIsr);
+  setRadioState(LoRaRadioState::rx);
+}
+
+void LoRaHandler::setRadioState(LoRaRadioState state) {
+  mRadioState = state;
+  if (mTxState == LoRaTxState::idle) {
+    applyRadioState();
+  }
+}
+
+void LoRaHandler::setRxPeriod(uint16_t period_s) {
+  mRxPeriod_s = period_s;
+  mRxWindowOpen = false;
+
+  if (period_s == 0) {
+    setRadioState(LoRaRadioState::rx);
+    return;
+  }
+
+  // First window after the next uplink.
+  mNextRxWindow = millis() + period_s * 1000UL;
+  setRadioState(LoRaRadioState::sleep);
+}
+
+void LoRaHandler::openRxWindow(uint32_t now) {
+  mRxWindowOpen = true;
+  mRxWindowEnd = now + LORA_RX_WINDOW_MS;
+  setRadioState(LoRaRadioState::rx);
+}
+
+void LoRaHandler::updateRxWindow() {
+  if (mRxPeriod_s == 0) {
+    return;
+  }
+
+  const uint32_t now = millis();
+
+  if (mRxWindowOpen) {
+    if (static_cast<int32_t>(now - mRxWindowEnd) >= 0) {
+      mRxWindowOpen = false;
+      setRadioState(LoRaRadioState::sleep);
+    }
+    return;
+  }
+
+  if (static_cast<int32_t>(now - mNextRxWindow) >= 0) {
+    do {
+      mNextRxWindow += mRxPeriod_s * 1000UL;
+    } while (static_cast<int32_t>(now - mNextRxWindow) >= 0);
+    openRxWindow(now);
+  }
+}
+
+uint32_t LoRaHandler::getTimeToNextRxEvent(uint32_t now) const {
+  if (mRxPeriod_s == 0) {
+    return UINT32_MAX;
+  }
+
+  const int32_t time = static_cast<int32_t>(
+      (mRxWindowOpen ? mRxWindowEnd : mNextRxWindow) - now);
+  return time > 0 ? static_cast<uint32_t>(time) : 0;
+}
+
+void LoRaHandler::applyRadioState() {
+  switch (mRadioState) {
+    case LoRaRadioState::sleep:
+      mLoRa.sleep();
+      break;
+    case LoRaRadioState::standby:
+      mLoRa.idle();
+      break;
+    case LoRaRadioState::rx:
+      mLoRa.receive();
+      break;
+  }
+}
+
+void LoRaHandler::handleRxIrq(int packetSize) {
+  auto* slot = mRxQueue.getWriteSlot();
+  if (slot == nullptr || packetSize <= 0 ||
+      packetSize > LORA_MAX_RX_MESSAGE_LENGTH) {
+    mRxDropCount = mRxDropCount + 1;
+    return;
+  }
+
+  uint8_t length = 0;
+  while (length < packetSize) {
+    int b = mLoRa.read();
+    if (b < 0) {
+      break;
+    }
+    slot->buf[length++] = static_cast<uint8_t>(b);
+  }
+
+  slot->length = length;
+  slot->rssi = static_cast<int16_t>(mLoRa.packetRssi());
+  mRxQueue.commit();
 }
 
 int16_t LoRaHandler::loraRx() {
-  // try to parse packet
-  int16_t packetSize = mLoRa.parsePacket();
-  if (packetSize <= 0) {
+  PROFILE_SCOPE(ProfileSection::loraRx);
+
+  if (!mRxIrqEnabled) {
+    if (mTxState != LoRaTxState::idle) {
+      // Polling would put the transmitting radio into receive.
+      return 0;
+    }
+    if (mRadioState == LoRaRadioState::sleep) {
+      // Polling would wake up the radio.
+      return 0;
+    }
+
+    // try to parse packet
+    int16_t packetSize = mLoRa.parsePacket();
+    if (packetSize <= 0) {
+      return 0;
+    }
+    return readPacket(packetSize);
+  }
+
+  // Frames are dropped in the interrupt, logged here.
+  const uint8_t dropCount = mRxDropCount;
+  if (dropCount != mRxDropCountLogged) {
+#if LOG_ENABLED(LORA, WARN)
+    printMillis(Log);
+    Log.print(F("LoRaRx: Dropped "));
+    Log.print(static_cast<uint8_t>(dropCount - mRxDropCountLogged));
+    Log.println(F(" frames, too long or RX queue full"));
+#endif
+    mRxDropCountLogged = dropCount;
+  }
+
+  auto* slot = mRxQueue.getReadSlot();
+  if (slot == nullptr) {
+    return 0;
+  }
+
+#if LOG_ENABLED(LORA, DEBUG)
+  printMillis(Log);
+  Log.print(F("LoRaRx: '"));
+#endif
+
+  int16_t ret = handleFrame(slot->buf, slot->length, slot->rssi);
+  mRxQueue.release();
+
+  if (mRxWindowOpen) {
+    // The gateway may have more to send.
+    mRxWindowEnd = millis() + LORA_RX_WINDOW_MS;
+  }
+
+  return ret;
+}
+
+int16_t LoRaHandler::readPacket(int16_t packetSize) {
+  if (packetSize > LORA_MAX_RX_MESSAGE_LENGTH) {
+#if LOG_ENABLED(LORA, WARN)
+    printMillis(Log);
+    Log.print(F("LoRaRx: Dropped frame of "));
+    Log.print(packetSize);
+    Log.println(F(" bytes, longer than any downlink"));
+#endif
     return 0;
   }
 
   // received a packet
-#ifdef DEBUG_LORA_MESSAGE
-  printMillis(Serial);
-  Serial.print(F("LoRaRx: '"));
+#if LOG_ENABLED(LORA, DEBUG)
+  printMillis(Log);
+  Log.print(F("LoRaRx: '"));
 #endif
 
+  // Polled frames don't use the queue, its free slot is a scratch buffer.
+  auto* slot = mRxQueue.getWriteSlot();
+  if (slot == nullptr) {
+#if LOG_ENABLED(LORA, ERROR)
+    Log.println(F("', Error: No free RX slot"));
+#endif
+    return -1;
+  }
+
   // read packet
   for (int16_t i = 0; i < packetSize; i++) {
     int b = mLoRa.read();
     if (b < 0) {
-      Serial.print(F("', Error: Failed to read byte "));
-      Serial.print(i);
-      Serial.print(F(" of "));
-      Serial.println(packetSize);
+#if LOG_ENABLED(LORA, ERROR)
+      Log.print(F("', Error: Failed to read byte "));
+      Log.print(i);
+      Log.print(F(" of "));
+      Log.println(packetSize);
+#endif
       return -1;
     }
-    mBuffer[i] = b;
+    slot->buf[i] = b;
+  }
+
+  return handleFrame(slot->buf, static_cast<uint8_t>(packetSize),
+                     static_cast<int16_t>(mLoRa.packetRssi()));
+}
+
+int16_t LoRaHandler::handleFrame(uint8_t* buf, uint8_t length, int16_t rssi) {
+  if (length < LORA_HEADER_LENGTH) {
+#if LOG_ENABLED(LORA, ERROR)
+    Log.println(F("', Error: Frame too short"));
+#endif
+    return -1;
   }
 
-  uint8_t payload_length = packetSize - LORA_HEADER_LENGTH;
+  uint8_t payload_length = length - LORA_HEADER_LENGTH;
 
   // Decrypt packet
   if (mCipher) {
-    mCipher->decrypt(&mBuffer[LORA_HEADER_LENGTH - 1],
-                     &mBuffer[LORA_HEADER_LENGTH - 1], payload_length + 1);
+    PROFILE_SCOPE(ProfileSection::decrypt);
+    mCipher->decrypt(&buf[LORA_HEADER_LENGTH - 1], &buf[LORA_HEADER_LENGTH - 1],
+                     payload_length + 1);
   }
 
   // Parse header
   LoRaRxMessageT rxMsg;
-  rxMsg.header.fromByteArray(mBuffer);
+  rxMsg.header.fromByteArray(buf);
   rxMsg.payload_length = payload_length;
+  rxMsg.rssi = rssi;
 
-#ifdef DEBUG_LORA_MESSAGE
+#if LOG_ENABLED(LORA, DEBUG)
   // Print message as HEX
-  Serial.print(F("H: "));
-  printArray(Serial, mBuffer, LORA_HEADER_LENGTH, HEX);
-  Serial.print(F(" P: "));
-  printArray(Serial, &mBuffer[LORA_HEADER_LENGTH], rxMsg.payload_length, HEX);
+  Log.print(F("H: "));
+  printArray(Log, buf, LORA_HEADER_LENGTH, HEX);
+  Log.print(F(" P: "));
+  printArray(Log, &buf[LORA_HEADER_LENGTH], rxMsg.payload_length, HEX);
 
   // print RSSI of packet
-  Serial.print(F("' with RSSI "));
-#endif
-  rxMsg.rssi = static_cast<int16_t>(mLoRa.packetRssi());
-#ifdef DEBUG_LORA_MESSAGE
-  Serial.print(rxMsg.rssi);
+  Log.print(F("' with RSSI "));
+  Log.print(rxMsg.rssi);
 #endif
 
   // Check if it is addressed to me or broadcast
   if (rxMsg.header.dst != mMyAddress &&
       rxMsg.header.dst != LORA_BROADCAST_ADDRESS) {
-#ifdef DEBUG_LORA_MESSAGE
-    Serial.println(F(", not for me, drop msg."));
+#if LOG_ENABLED(LORA, DEBUG)
+    Log.println(F(", not for me, drop msg."));
 #endif
     return 0;
   }
@@ -87,58 +305,82 @@ int16_t LoRaHandler::loraRx() {
   // Check msg id
   // mMsgIdDown += 1;
   // if (rxMsg.header.id != mMsgIdDown) {
-  //   Serial.print(F(", unexpected msg id "));
-  //   Serial.print(rxMsg.header.id);
-  //   Serial.print(F(" != "));
-  //   Serial.print(mMsgIdDown);
+  //   Log.print(F(", unexpected msg id "));
+  //   Log.print(rxMsg.header.id);
+  //   Log.print(F(" != "));
+  //   Log.print(mMsgIdDown);
   //   return -1;
   // }
 
   // Send ack if requested
   if (isAckRequest(rxMsg.header)) {
-#ifdef DEBUG_LORA_MESSAGE
-    Serial.print(F(", sending ACK"));
+#if LOG_ENABLED(LORA, DEBUG)
+    Log.print(F(", sending ACK"));
 #endif
     sendAck(rxMsg.header);
   }
 
   if (isAckResponse(rxMsg.header)) {
-#ifdef DEBUG_LORA_MESSAGE
-    Serial.println(F(", ACK response"));
+#if LOG_ENABLED(LORA, DEBUG)
+    Log.println(F(", ACK response"));
 #endif
+    if (rxMsg.header.src == mGatewayAddress &&
+        rxMsg.header.flags.msgType == LoRaMsgType::value_msg) {
+      mValueEncoder.confirm(rxMsg.header.id);
+    }
     return 0;
   }
 
-  Serial.println();
+  if (rxMsg.header.src == mGatewayAddress) {
+    setCompactValues(rxMsg.header.flags.compact_values);
+    mBitmapValues = rxMsg.header.flags.bitmap_values;
+  }
+
+#if LOG_ENABLED(LORA, DEBUG)
+  Log.println();
+#endif
 
   // Parse message
-  if (parseMsg(rxMsg, &mBuffer[LORA_HEADER_LENGTH]) == -1) {
-#ifdef DEBUG_LORA_MESSAGE
-    Serial.println(F(", Error: Failed to parse msg"));
+  if (parseMsg(rxMsg, &buf[LORA_HEADER_LENGTH]) == -1) {
+#if LOG_ENABLED(LORA, ERROR)
+    Log.println(F(", Error: Failed to parse msg"));
 #endif
     return -1;
   }
 
-  return packetSize;
+  return length;
 }
 
 int8_t LoRaHandler::parseMsg(const LoRaRxMessageT& rxMsg, uint8_t* payload) {
-  printMillis(Serial);
-  Serial.print(F("Parsing msg type="));
-  Serial.println(static_cast<uint8_t>(rxMsg.header.flags.msgType));
+#if LOG_ENABLED(LORA, DEBUG)
+  printMillis(Log);
+  Log.print(F("Parsing msg type="));
+  Log.println(static_cast<uint8_t>(rxMsg.header.flags.msgType));
+#endif
 
   switch (rxMsg.header.flags.msgType) {
     case LoRaMsgType::ping_req:
-      printMillis(Serial);
-      Serial.print(F("Ping request, from "));
-      Serial.print(rxMsg.header.src);
-      Serial.print(F(", RSSI "));
-      Serial.print(rxMsg.rssi);
-      Serial.print(F("dBm"));
+#if LOG_ENABLED(LORA, INFO)
+      printMillis(Log);
+      Log.print(F("Ping request, from "));
+      Log.print(rxMsg.header.src);
+      Log.print(F(", RSSI "));
+      Log.print(rxMsg.rssi);
+      Log.print(F("dBm"));
+#endif
       sendPing(rxMsg.header.src, rxMsg.rssi);
       break;
 
     case LoRaMsgType::discovery_req:
+      if (rxMsg.payload_length >= 5 &&
+          ntoh(*(reinterpret_cast<const uint32_t*>(&payload[1]))) ==
+              mDiscoveryHash) {
+#if LOG_ENABLED(LORA, INFO)
+        printMillis(Log);
+        Log.println(F("Discovery schema cached by gateway, not sending"));
+#endif
+        break;
+      }
       if (mOnDiscoveryReqMsgFunc) {
         uint8_t entityId = payload[0];
         mOnDiscoveryReqMsgFunc(entityId);
@@ -146,6 +388,8 @@ int8_t LoRaHandler::parseMsg(const LoRaRxMessageT& rxMsg, uint8_t* payload) {
       break;
 
     case LoRaMsgType::value_req:
+      // Gateway may have lost track of values, resync with absolute values.
+      mValueEncoder.invalidate();
       if (mOnValueReqMsgFunc) {
         mOnValueReqMsgFunc();
       }
@@ -153,8 +397,10 @@ int8_t LoRaHandler::parseMsg(const LoRaRxMessageT& rxMsg, uint8_t* payload) {
 
     case LoRaMsgType::valueSet_req:
       if (mOnValueSetReqMsgFunc) {
-        Serial.print(F("Value set request for entityId "));
-        Serial.println(payload[0]);
+#if LOG_ENABLED(LORA, DEBUG)
+        Log.print(F("Value set request for entityId "));
+        Log.println(payload[0]);
+#endif
         ValueItemT valueItem;
         valueItem.fromByteArray(payload, rxMsg.payload_length);
         mOnValueSetReqMsgFunc(valueItem);
@@ -184,95 +430,292 @@ int8_t LoRaHandler::parseMsg(const LoRaRxMessageT& rxMsg, uint8_t* payload) {
   return 0;
 }
 
-void LoRaHandler::printMessage(const LoRaTxMessageT& msg) {
-  Serial.print(F("H: "));
+#if LOG_ENABLED(LORA, DEBUG)
+void LoRaHandler::printMessage() {
+  Log.print(F("H: "));
   uint8_t buf[LORA_HEADER_LENGTH];
-  msg.header.toByteArray(buf);
-  printArray(Serial, buf, LORA_HEADER_LENGTH, HEX);
-
-  Serial.print(F(" P: "));
-  if (msg.payload_length == 0) {
-    Serial.print(F("--"));
-  } else if (msg.header.flags.ack_response and msg.payload_length == '!') {
-    Serial.print(F("(ACK)"));
+  mTxHeader.toByteArray(buf);
+  printArray(Log, buf, LORA_HEADER_LENGTH, HEX);
+
+  Log.print(F(" P: "));
+  if (mTxPayloadLength == 0) {
+    Log.print(F("--"));
+  } else if (mTxHeader.flags.ack_response and mTxPayloadLength == '!') {
+    Log.print(F("(ACK)"));
   } else {
-    printArray(Serial, msg.payload, msg.payload_length, HEX);
+    printArray(Log, getTxPayload(), mTxPayloadLength, HEX);
   }
-  Serial.println();
+  Log.println();
 }
+#endif
 
-void LoRaHandler::sendMsg(const LoRaTxMessageT& msg) {
-#ifdef DEBUG_LORA_MESSAGE
-  printMillis(Serial);
+void LoRaHandler::beginFrame() {
+  if (mTxLength != 0) {
+    // Previous frame is still waiting for the radio, let it go first.
+    flushTx();
+  }
+  mTxPayloadLength = 0;
+}
+
+bool LoRaHandler::sendMsg() {
+  PROFILE_SCOPE(ProfileSection::sendMsg);
+
+#if LOG_ENABLED(LORA, DEBUG)
+  printMillis(Log);
 #ifdef LORA_DRY_RUN
-  Serial.print(F("LoRaTx_dry: "));
+  Log.print(F("LoRaTx_dry: "));
 #else
-  Serial.print(F("LoRaTx: "));
+  Log.print(F("LoRaTx: "));
 #endif
-  printMessage(msg);
+  printMessage();
 #endif
 
-  if (mAirTime.isLimitReached()) {
-    printMillis(Serial);
-    Serial.println(F("AirTime limit reached! Not sending."));
-    return;
+  const uint8_t length = LORA_HEADER_LENGTH + mTxPayloadLength;
+  if (!mAirTime.isRoomFor(getTimeOnAir_ms(length))) {
+#if LOG_ENABLED(LORA, WARN)
+    printMillis(Log);
+    Log.println(F("AirTime limit reached! Not sending."));
+#endif
+    return false;
   }
 
 #ifdef LORA_DRY_RUN
-  return;
+  return true;
 #endif
 
-  uint8_t n = msg.header.toByteArray(mBuffer);
-  memcpy(&mBuffer[n], msg.payload, msg.payload_length);
-  n += msg.payload_length;
+  // The payload is already in place after the header.
+  (void)mTxHeader.toByteArray(mBuffer);
 
   if (mCipher) {
+    PROFILE_SCOPE(ProfileSection::encrypt);
     mCipher->encrypt(&mBuffer[LORA_HEADER_LENGTH - 1],
-                     &mBuffer[LORA_HEADER_LENGTH - 1],
-                     n - LORA_HEADER_LENGTH + 1);
+                     &mBuffer[LORA_HEADER_LENGTH - 1], mTxPayloadLength + 1);
+  }
+
+  mTxLength = length;
+  if (mTxState == LoRaTxState::idle) {
+    mTxState = LoRaTxState::queued;
   }
 
+  updateTx();
+  return true;
+}
+
+void LoRaHandler::onTxDoneIsr() {
+  if (sInstance) {
+    sInstance->handleTxDoneIrq();
+  }
+}
+
+void LoRaHandler::handleTxDoneIrq() {
+  mTxEndTime = millis();
+  mTxDone = true;
+}
+
+void LoRaHandler::updateTx() {
+  switch (mTxState) {
+    case LoRaTxState::idle:
+      break;
+
+    case LoRaTxState::queued:
+      startTx();
+      break;
+
+    case LoRaTxState::transmitting:
+      if (!mTxDone) {
+        if (millis() - mTxStartTime < LORA_TX_TIMEOUT_MS) {
+          break;
+        }
+        // No TX done interrupt, assume the frame went out as estimated.
+#if LOG_ENABLED(LORA, WARN)
+        printMillis(Log);
+        Log.println(F("LoRaTx: No TX done interrupt"));
+#endif
+        mTxEndTime = mTxStartTime + mTxTimeOnAir_ms;
+      }
+      mTxState = LoRaTxState::done;
+      // fall through
+
+    case LoRaTxState::done:
+      finishTx();
+      break;
+  }
+
+  if (mTxState == LoRaTxState::idle) {
+    sendValueQueue();
+  }
+}
+
+bool LoRaHandler::queueValueItem(const ValueItemT& item) {
+  if (!mValueQueue.push(item)) {
+#if LOG_ENABLED(LORA, ERROR)
+    printMillis(Log);
+    Log.print(F("Err: Value queue full, dropping entityId "));
+    Log.println(item.entityId);
+#endif
+    return false;
+  }
+  return true;
+}
+
+void LoRaHandler::sendValueQueue() {
+  if (mValueQueue.isEmpty()) {
+    return;
+  }
+
+  // Pending values of the message that last had this id are too old to be
+  // confirmed now.
+  const uint8_t msgId = mMsgIdUp + 1;
+  mValueEncoder.expire(msgId);
+
+  if (mBitmapValues) {
+    mValueQueue.sortByEntityId();
+  }
+
+  const uint8_t first = mValueQueue[0].entityId;
+  const uint8_t last = mValueQueue[mValueQueue.size() - 1].entityId;
+  if (mBitmapValues && isBitmapShorter(first, last, mValueQueue.size())) {
+    // Range of the whole queue, endMsg() trims the bitmap if it is split.
+    beginBitmapValueMsg(first, last);
+  } else {
+    beginValueMsg();
+  }
+
+  // Longest an item can get, so the airtime budget is checked before adding.
+  const uint8_t maxItemSize =
+      mCompactValues ? CompactValue::MAX_ITEM_SIZE : ValueItemT::size();
+
+  // Split the message to what fits in the payload and the airtime budget.
+  // Items left in the queue are deferred, newer values replace them while
+  // waiting.
+  uint8_t count = 0;
+  while (count < mValueQueue.size()) {
+    if (!mAirTime.isRoomFor(getTimeOnAir_ms(
+            LORA_HEADER_LENGTH + mTxPayloadLength + maxItemSize))) {
+      break;
+    }
+    if (!addValueItem(mValueQueue[count])) {
+      break;
+    }
+    count++;
+  }
+  if (count == 0) {
+    return;
+  }
+
+  if (mTxHeader.flags.compact_values) {
+    for (uint8_t i = 0; i < count; i++) {
+      mValueEncoder.setSent(mValueQueue[i], msgId);
+    }
+  }
+  mValueQueue.pop(count);
+  endMsg();
+}
+
+bool LoRaHandler::isBitmapShorter(uint8_t firstEntityId, uint8_t lastEntityId,
+                                  uint8_t count) const {
+  // Bytes spent on addressing the entities, values excluded.
+  uint16_t bitmapCost = LoRaValuePayloadT::BITMAP_HEADER_LENGTH +
+                        (lastEntityId - firstEntityId) / 8 + 1;
+  if (mCompactValues) {
+    // Mode bytes, the mode is in the entity id byte otherwise.
+    bitmapCost += (count + CompactValue::MODES_PER_BYTE - 1) /
+                  CompactValue::MODES_PER_BYTE;
+  }
+  const uint16_t idCost = 1 + count;  // Number of entities and ids
+  return bitmapCost < idCost;
+}
+
+bool LoRaHandler::registerValueEntity(const DiscoveryEntityT& entity) {
+  return mValueEncoder.addEntity(entity.entityId, entity.isSigned);
+}
+
+void LoRaHandler::setCompactValues(bool compactValues) {
+  if (compactValues && !mCompactValues) {
+    // Gateway has no confirmed values to apply deltas to.
+    mValueEncoder.invalidate();
+  }
+  mCompactValues = compactValues;
+}
+
+void LoRaHandler::flushTx() {
+  while (mTxState != LoRaTxState::idle) {
+    updateTx();
+    yield();
+  }
+}
+
+void LoRaHandler::startTx() {
   (void)mLoRa.beginPacket();
-  (void)mLoRa.write(mBuffer, n);
+  (void)mLoRa.write(mBuffer, mTxLength);
+
+  mTxDone = false;
+  mTxTimeOnAir_ms = static_cast<uint16_t>(getTimeOnAir_ms(mTxLength));
+  mTxStartTime = millis();
+  (void)mLoRa.endPacket(true);
+
+  // The frame is in the radio FIFO now, buffer is free for the next one.
+  mTxLength = 0;
+  mTxState = LoRaTxState::transmitting;
+}
+
+void LoRaHandler::finishTx() {
+  mAirTime.update(mTxStartTime, mTxEndTime);
+
+#if LOG_ENABLED(LORA, DEBUG)
+  printMillis(Log);
+  Log.print(F("AirTime: "));
+  Log.print(mAirTime.getTime_ms());
+  Log.print(F(" ms, "));
+  Log.print(mAirTime.getTime_ppm());
+  Log.println(F(" ppm"));
+#endif
 
-  uint32_t sendStartTime = millis();
-  (void)mLoRa.endPacket();
-  uint32_t sendEndTime = millis();
+  if (mTxLength != 0) {
+    mTxState = LoRaTxState::queued;
+    startTx();
+    return;
+  }
 
-  mAirTime.update(sendStartTime, sendEndTime);
+  mTxState = LoRaTxState::idle;
 
-  printMillis(Serial);
-  Serial.print(F("AirTime: "));
-  Serial.print(mAirTime.getTime_ms());
-  Serial.print(F(" ms, "));
-  Serial.print(mAirTime.getTime_ppm());
-  Serial.println(F(" ppm"));
+  if (mRxPeriod_s != 0) {
+    // Periodic windows are counted from the end of the last uplink, the
+    // gateway knows when that was.
+    mNextRxWindow = mTxEndTime + mRxPeriod_s * 1000UL;
+    mRxWindowOpen = true;
+    mRxWindowEnd = millis() + LORA_RX_WINDOW_MS;
+    mRadioState = LoRaRadioState::rx;
+  }
+
+  if (mRadioState != LoRaRadioState::standby) {
+    // Radio is in standby after transmitting.
+    applyRadioState();
+  }
 }
 
 void LoRaHandler::sendAck(const LoRaHeaderT& rxHeader) {
-  LoRaTxMessageT msg;
-  msg.header.dst = rxHeader.src;
-  msg.header.src = mMyAddress;
-  msg.header.id = rxHeader.id;
-  msg.header.flags.fromByte(0);
-  msg.header.flags.ack_response = true;
-  msg.header.flags.msgType = rxHeader.flags.msgType;
-  msg.payload_length = 1;
-  msg.payload[0] = '!';  // ACK is special and has an ! as payload.
-  sendMsg(msg);
+  beginFrame();
+  mTxHeader.dst = rxHeader.src;
+  mTxHeader.src = mMyAddress;
+  mTxHeader.id = rxHeader.id;
+  mTxHeader.flags.fromByte(0);
+  mTxHeader.flags.ack_response = true;
+  mTxHeader.flags.msgType = rxHeader.flags.msgType;
+  getTxPayload()[0] = '!';  // ACK is special and has an ! as payload.
+  mTxPayloadLength = 1;
+  sendMsg();
 }
 
 void LoRaHandler::sendPing(const uint8_t toAddr, int16_t rssi) {
-  LoRaTxMessageT msg;
-  setDefaultHeader(msg.header);
-  msg.payload_length = 0;
-  msg.header.dst = toAddr;
-  msg.header.id = ++mMsgIdUp;
-  msg.header.flags.msgType = LoRaMsgType::ping_msg;
-  int16_t* pValue_n = reinterpret_cast<int16_t*>(&msg.payload[0]);
-  *pValue_n = hton(rssi);
-  msg.payload_length += 2;
-  sendMsg(msg);
+  beginFrame();
+  setDefaultHeader(mTxHeader);
+  mTxHeader.dst = toAddr;
+  mTxHeader.id = ++mMsgIdUp;
+  mTxHeader.flags.msgType = LoRaMsgType::ping_msg;
+  *(reinterpret_cast<int16_t*>(getTxPayload())) = hton(rssi);
+  mTxPayloadLength = 2;
+  sendMsg();
 }
 
 void LoRaHandler::setDefaultHeader(LoRaHeaderT& header) {
@@ -284,53 +727,200 @@ void LoRaHandler::setDefaultHeader(LoRaHeaderT& header) {
 }
 
 void LoRaHandler::beginDiscoveryMsg() {
-  setDefaultHeader(mMsgTx.header);
-  mMsgTx.payload_length = 0;
-  mMsgTx.header.flags.msgType = LoRaMsgType::discovery_msg;
+  beginFrame();
+  setDefaultHeader(mTxHeader);
+  mTxHeader.flags.msgType = LoRaMsgType::discovery_msg;
 }
 
-void LoRaHandler::endMsg() {
-  mMsgTx.header.id = ++mMsgIdUp;
-  sendMsg(mMsgTx);
+bool LoRaHandler::endMsg() {
+  if (mTxHeader.flags.msgType == LoRaMsgType::value_msg &&
+      mTxHeader.flags.bitmap_values) {
+    trimValueBitmap();
+  }
+  mTxHeader.id = ++mMsgIdUp;
+  return sendMsg();
 }
 
 void LoRaHandler::addDiscoveryEntity(const DiscoveryEntityT& item) {
   size_t length =
-      item.toByteArray(&mMsgTx.payload[mMsgTx.payload_length],
-                       sizeof(mMsgTx.payload) - mMsgTx.payload_length);
+      item.toByteArray(&getTxPayload()[mTxPayloadLength],
+                       LORA_MAX_PAYLOAD_LENGTH - mTxPayloadLength);
   if (length == 0) {
-    printMillis(Serial);
-    Serial.println(F("Err: Discovery entity length = 0"));
+#if LOG_ENABLED(LORA, ERROR)
+    printMillis(Log);
+    Log.println(F("Err: Discovery entity length = 0"));
+#endif
   }
-  mMsgTx.payload_length += length;
+  mTxPayloadLength += length;
+}
+
+void LoRaHandler::sendAnnounceMsg() {
+  beginFrame();
+  setDefaultHeader(mTxHeader);
+  mTxHeader.id = ++mMsgIdUp;
+  mTxHeader.flags.msgType = LoRaMsgType::announce_msg;
+  uint8_t* payload = getTxPayload();
+  *(reinterpret_cast<uint32_t*>(&payload[0])) = hton(mDiscoveryHash);
+  payload[4] = mDiscoveryEntityCount;
+  *(reinterpret_cast<uint16_t*>(&payload[5])) = hton(mRxPeriod_s);
+  mTxPayloadLength = 7;
+  sendMsg();
+}
+
+void LoRaHandler::beginDiscoveryBatchMsg() {
+  beginFrame();
+  setDefaultHeader(mTxHeader);
+  mTxHeader.flags.msgType = LoRaMsgType::discovery_batch_msg;
+  *(reinterpret_cast<uint32_t*>(&getTxPayload()[0])) = hton(mDiscoveryHash);
+  getTxPayload()[4] = mDiscoveryEntityCount;
+  getTxPayload()[5] = 0;  // Number of entities in this message
+  mTxPayloadLength = 6;
+}
+
+bool LoRaHandler::addDiscoveryBatchEntity(const DiscoveryEntityT& entity) {
+  const size_t n = CompactDiscovery::entityToByteArray(
+      entity, &getTxPayload()[mTxPayloadLength],
+      LORA_MAX_PAYLOAD_LENGTH - mTxPayloadLength);
+  if (n == 0) {
+    return false;
+  }
+  mTxPayloadLength += n;
+  getTxPayload()[5]++;
+  return true;
 }
 
 void LoRaHandler::beginValueMsg() {
-  setDefaultHeader(mMsgTx.header);
-  mMsgTx.header.flags.msgType = LoRaMsgType::value_msg;
-  mMsgTx.payload[0] = 0;  // numberOfEntities
-  mMsgTx.payload_length = 1;
-
-  printMillis(Serial);
-  Serial.print(F("Begin value msg: mMsgTx.payload[0]="));
-  Serial.print(mMsgTx.payload[0], HEX);
-  Serial.print(F(", mMsgTx.payload_length="));
-  Serial.println(mMsgTx.payload_length, DEC);
-}
-
-void LoRaHandler::addValueItem(const ValueItemT& item) {
-  mMsgTx.payload_length +=
-      item.toByteArray(&mMsgTx.payload[mMsgTx.payload_length],
-                       sizeof(mMsgTx.payload) - mMsgTx.payload_length);
-  mMsgTx.payload[0]++;
-
-  printMillis(Serial);
-  Serial.print(F("Add value item: entityId="));
-  Serial.print(item.entityId, DEC);
-  Serial.print(F(", value="));
-  Serial.print(item.value, HEX);
-  Serial.print(F(", mMsgTx.payload[0]="));
-  Serial.print(mMsgTx.payload[0], DEC);
-  Serial.print(F(", mMsgTx.payload_length="));
-  Serial.println(mMsgTx.payload_length, DEC);
+  beginFrame();
+  setDefaultHeader(mTxHeader);
+  mTxHeader.flags.msgType = LoRaMsgType::value_msg;
+  mTxHeader.flags.compact_values = mCompactValues;
+  getTxPayload()[0] = 0;  // numberOfEntities
+  mTxPayloadLength = 1;
+
+#if LOG_ENABLED(LORA, DEBUG)
+  printMillis(Log);
+  Log.print(F("Begin value msg: payload[0]="));
+  Log.print(getTxPayload()[0], HEX);
+  Log.print(F(", payload_length="));
+  Log.println(mTxPayloadLength, DEC);
+#endif
+}
+
+void LoRaHandler::beginBitmapValueMsg(uint8_t firstEntityId,
+                                      uint8_t lastEntityId) {
+  beginValueMsg();
+  mTxHeader.flags.bitmap_values = true;
+
+  if (lastEntityId < firstEntityId) {
+    lastEntityId = firstEntityId;
+  }
+  const uint8_t bitmapLength = (lastEntityId - firstEntityId) / 8 + 1;
+
+  getTxPayload()[0] = firstEntityId;
+  getTxPayload()[1] = bitmapLength;
+  memset(&getTxPayload()[LoRaValuePayloadT::BITMAP_HEADER_LENGTH], 0,
+         bitmapLength);
+  mTxPayloadLength =
+      LoRaValuePayloadT::BITMAP_HEADER_LENGTH + bitmapLength;
+  mBitmapCount = 0;
+}
+
+bool LoRaHandler::addValueItem(const ValueItemT& item) {
+  uint8_t* buf = &getTxPayload()[mTxPayloadLength];
+  const size_t length = LORA_MAX_PAYLOAD_LENGTH - mTxPayloadLength;
+  size_t n;
+  if (mTxHeader.flags.bitmap_values) {
+    n = addBitmapValue(item, buf, length);
+  } else {
+    n = mTxHeader.flags.compact_values
+            ? mValueEncoder.encode(item, buf, length)
+            : item.toByteArray(buf, length);
+    if (n != 0) {
+      getTxPayload()[0]++;
+    }
+  }
+  if (n == 0) {
+    return false;
+  }
+  mTxPayloadLength += n;
+
+#if LOG_ENABLED(LORA, DEBUG)
+  printMillis(Log);
+  Log.print(F("Add value item: entityId="));
+  Log.print(item.entityId, DEC);
+  Log.print(F(", value="));
+  Log.print(item.value, HEX);
+  Log.print(F(", payload[0]="));
+  Log.print(getTxPayload()[0], DEC);
+  Log.print(F(", payload_length="));
+  Log.println(mTxPayloadLength, DEC);
+#endif
+  return true;
+}
+
+size_t LoRaHandler::addBitmapValue(const ValueItemT& item, uint8_t* buf,
+                                   size_t length) {
+  const uint8_t first = getTxPayload()[0];
+  const uint8_t bitmapLength = getTxPayload()[1];
+  if (item.entityId < first || item.entityId - first >= 8 * bitmapLength ||
+      (mBitmapCount > 0 && item.entityId <= mBitmapLastId)) {
+#if LOG_ENABLED(LORA, ERROR)
+    printMillis(Log);
+    Log.print(F("Err: Bitmap value out of order, entityId "));
+    Log.println(item.entityId);
+#endif
+    return 0;
+  }
+
+  size_t n;
+  if (mTxHeader.flags.compact_values) {
+    const uint8_t group = mBitmapCount % CompactValue::MODES_PER_BYTE;
+    const uint8_t head = group == 0 ? 1 : 0;  // New mode byte
+    if (length <= head) {
+      return 0;
+    }
+
+    CompactValue::Mode mode;
+    n = mValueEncoder.encodeValue(item, &buf[head], length - head, mode);
+    if (n == 0) {
+      return 0;
+    }
+    if (head) {
+      buf[0] = 0;
+      mBitmapModeIndex = mTxPayloadLength;
+    }
+    getTxPayload()[mBitmapModeIndex] |= static_cast<uint8_t>(mode)
+                                        << (CompactValue::MODE_BITS * group);
+    n += head;
+  } else {
+    if (length < sizeof(item.value)) {
+      return 0;
+    }
+    *(reinterpret_cast<uint32_t*>(buf)) = hton(item.value);
+    n = sizeof(item.value);
+  }
+
+  const uint8_t bit = item.entityId - first;
+  getTxPayload()[LoRaValuePayloadT::BITMAP_HEADER_LENGTH + bit / 8] |=
+      1 << (bit % 8);
+  mBitmapCount++;
+  mBitmapLastId = item.entityId;
+  return n;
+}
+
+void LoRaHandler::trimValueBitmap() {
+  const uint8_t bitmapLength = getTxPayload()[1];
+  const uint8_t usedLength =
+      mBitmapCount > 0 ? (mBitmapLastId - getTxPayload()[0]) / 8 + 1 : 1;
+  if (usedLength >= bitmapLength) {
+    return;
+  }
+
+  // Message was split, move the values to right after the used bitmap bytes.
+  uint8_t* values =
+      &getTxPayload()[LoRaValuePayloadT::BITMAP_HEADER_LENGTH + bitmapLength];
+  memmove(values - (bitmapLength - usedLength), values,
+          mTxPayloadLength - (values - getTxPayload()));
+  getTxPayload()[1] = usedLength;
+  mTxPayloadLength -= bitmapLength - usedLength;
 }
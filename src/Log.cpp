@@ -0,0 +1,38 @@
+#include "Log.h"
+
+#include <Arduino.h>
+
+Logger Log(Serial);
+
+size_t Logger::write(uint8_t c) {
+#ifdef LOG_NON_BLOCKING
+  if (mIsDropping) {
+    mIsDropping = c != '\n';
+    return 1;
+  }
+
+  // A line cut short is ended with "~\r\n" before the next byte.
+  if (mOut.availableForWrite() < (mIsDropped ? 4 : 1)) {
+    mIsDropping = c != '\n';
+    mIsDropped = true;
+    mDropCount++;
+    return 1;
+  }
+
+  if (mIsDropped) {
+    mOut.write('~');
+    mOut.write('\r');
+    mOut.write('\n');
+    mIsDropped = false;
+  }
+#endif
+  return mOut.write(c);
+}
+
+size_t Logger::write(const uint8_t* buffer, size_t size) {
+#ifdef LOG_NON_BLOCKING
+  return Print::write(buffer, size);  // Byte by byte
+#else
+  return mOut.write(buffer, size);
+#endif
+}
@@ -0,0 +1,47 @@
+#include "MemoryMonitor.h"
+
+#include <Arduino.h>
+
+#ifdef __AVR__
+extern uint8_t __heap_start;  // avr-libc, end of .bss
+extern void* __brkval;        // avr-libc malloc, end of heap if used
+
+static uint8_t* getHeapEnd() {
+  return __brkval != nullptr ? static_cast<uint8_t*>(__brkval) : &__heap_start;
+}
+
+static uint8_t* getStackPointer() { return reinterpret_cast<uint8_t*>(SP); }
+#endif
+
+void MemoryMonitor::begin() {
+#ifdef __AVR__
+  begin(getHeapEnd(), getStackPointer() - STACK_MARGIN);
+#endif
+}
+
+void MemoryMonitor::begin(uint8_t* start, uint8_t* end) {
+  mStart = start;
+  mEnd = end > start ? end : start;
+  for (uint8_t* p = mStart; p < mEnd; p++) {
+    *p = PAINT;
+  }
+  mMinFree = static_cast<uint16_t>(mEnd - mStart);
+}
+
+uint16_t MemoryMonitor::getFreeRam() const {
+#ifdef __AVR__
+  return static_cast<uint16_t>(getStackPointer() - getHeapEnd());
+#else
+  return static_cast<uint16_t>(mEnd - mStart);
+#endif
+}
+
+uint16_t MemoryMonitor::getMinFreeRam() {
+  // Only the bottom of the region can still be painted.
+  uint16_t n = 0;
+  while (n < mMinFree && mStart[n] == PAINT) {
+    n++;
+  }
+  mMinFree = n;
+  return n;
+}
@@ -0,0 +1,147 @@
+#include "PowerManager.h"
+
+#include <Arduino.h>
+#include <avr/sleep.h>
+#include <avr/wdt.h>
+
+#ifdef __AVR__
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+
+extern volatile unsigned long timer0_millis;  // Arduino core, wiring.c
+
+ISR(WDT_vect) {}
+ISR(PCINT0_vect) { PowerManager::onWakePinIsr(); }
+ISR(PCINT1_vect) { PowerManager::onWakePinIsr(); }
+ISR(PCINT2_vect) { PowerManager::onWakePinIsr(); }
+
+static void startWatchdog(uint8_t wdto) {
+  // Interrupt mode only, a timeout shall wake up and not reset.
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    wdt_reset();
+    MCUSR &= ~_BV(WDRF);
+    WDTCSR = _BV(WDCE) | _BV(WDE);
+    WDTCSR = _BV(WDIE) | (wdto & 0x07) | ((wdto & 0x08) ? _BV(WDP3) : 0);
+  }
+}
+
+static void stopWatchdog() { wdt_disable(); }
+
+static void addTimer0Millis(uint32_t ms) {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { timer0_millis += ms; }
+}
+
+static void enablePinChangeInterrupt(uint8_t pin) {
+  *digitalPinToPCMSK(pin) |= _BV(digitalPinToPCMSKbit(pin));
+  *digitalPinToPCICR(pin) |= _BV(digitalPinToPCICRbit(pin));
+}
+
+PowerManager::AddMillisFunc PowerManager::sAddMillisFunc = addTimer0Millis;
+#else
+// Native build, the test or the simulator runs the clock and sets
+// sAddMillisFunc.
+static void startWatchdog(uint8_t wdto) { wdt_enable(wdto); }
+
+static void stopWatchdog() { wdt_disable(); }
+
+static void enablePinChangeInterrupt(uint8_t pin) { (void)pin; }
+
+PowerManager::AddMillisFunc PowerManager::sAddMillisFunc = nullptr;
+#endif
+
+volatile bool PowerManager::sWakePinChanged = false;
+
+void PowerManager::begin(const uint8_t* pins, uint8_t count) {
+  for (uint8_t i = 0; i < count; i++) {
+    enablePinChangeInterrupt(pins[i]);
+  }
+  mLastTime = millis();
+}
+
+bool PowerManager::sleep(uint32_t duration_ms, PowerState deepest) {
+  uint32_t now = millis();
+  addTime(PowerState::active, now - mLastTime);
+  mLastTime = now;
+
+  if (takeWakePinChanged()) {
+    return true;
+  }
+
+  if (deepest == PowerState::powerDown && duration_ms < MIN_POWER_DOWN_MS) {
+    deepest = PowerState::idle;
+  }
+
+  bool isWakePinChanged = false;
+
+  switch (deepest) {
+    case PowerState::active:
+      return false;
+
+    case PowerState::idle:
+      // Until the next interrupt.
+      set_sleep_mode(SLEEP_MODE_IDLE);
+      sleep_enable();
+      sleep_cpu();
+      sleep_disable();
+      isWakePinChanged = takeWakePinChanged();
+      break;
+
+    case PowerState::powerDown:
+      Serial.flush();
+      set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+
+      while (duration_ms >= MIN_POWER_DOWN_MS) {
+        uint8_t wdto = WDTO_8S;
+        while (static_cast<uint32_t>(MIN_POWER_DOWN_MS) << wdto > duration_ms) {
+          wdto--;
+        }
+        const uint16_t step_ms = static_cast<uint16_t>(MIN_POWER_DOWN_MS)
+                                 << wdto;
+
+        startWatchdog(wdto);
+        noInterrupts();
+        if (sWakePinChanged) {
+          interrupts();
+        } else {
+          sleep_enable();
+          sleep_bod_disable();
+          interrupts();  // The next instruction is run before any interrupt
+          sleep_cpu();
+          sleep_disable();
+        }
+        stopWatchdog();
+
+        isWakePinChanged = takeWakePinChanged();
+        if (isWakePinChanged) {
+          break;
+        }
+
+        if (sAddMillisFunc) {
+          sAddMillisFunc(step_ms);
+        }
+        duration_ms -= step_ms;
+      }
+      break;
+  }
+
+  now = millis();
+  addTime(deepest, now - mLastTime);
+  mLastTime = now;
+
+  return isWakePinChanged;
+}
+
+void PowerManager::addTime(PowerState state, uint32_t time_ms) {
+  const uint8_t i = static_cast<uint8_t>(state);
+  time_ms += mTimeRest_ms[i];
+  mTime_s[i] += time_ms / 1000;
+  mTimeRest_ms[i] = static_cast<uint16_t>(time_ms % 1000);
+}
+
+bool PowerManager::takeWakePinChanged() {
+  noInterrupts();
+  const bool isChanged = sWakePinChanged;
+  sWakePinChanged = false;
+  interrupts();
+  return isChanged;
+}
@@ -9,7 +9,7 @@
 bool PresenceBinarySensor::update() {
   uint32_t timestamp = millis();
 
-  HeightT height = mHeightSensor.getValue();
+  HeightT height = mHeightSensor.getSensor().getValue();
 
   bool newState =
       (height >= mLowLimit.getValue()) && (height <= mHighLimit.getValue());
@@ -42,6 +42,21 @@ bool PresenceBinarySensor::getDiscoveryEntity(DiscoveryEntityT& item) const {
   return true;
 }
 
+const IComponent* PresenceBinarySensor::getUpstream(uint8_t idx) const {
+  switch (idx) {
+    case 0:
+      return &mHeightSensor;
+    case 1:
+      return &mLowLimit;
+    case 2:
+      return &mHighLimit;
+    case 3:
+      return &mMinStableTime;
+    default:
+      return nullptr;
+  }
+}
+
 bool PresenceBinarySensor::setValueItem(const ValueItemT& item) {
   switch (item.entityId - mBinarySensor.getEntityId() - 1) {
     case 0:
@@ -0,0 +1,92 @@
+#include "Profiler.h"
+
+#ifdef PROFILER_ENABLED
+
+namespace ProfilerConstants {
+static const char SectionName[][14] PROGMEM = {
+    "loop", "deviceUpdate", "ahtUpdate", "loraRx",
+    "sendMsg", "encrypt", "decrypt"};
+
+static_assert(sizeof(SectionName) / sizeof(SectionName[0]) ==
+                  static_cast<uint8_t>(ProfileSection::component0),
+              "A name for each section before component0");
+}  // namespace ProfilerConstants
+
+ProfileStatsT Profiler::sStats[Profiler::SECTIONS];
+
+void Profiler::add(ProfileSection section, uint32_t duration_us) {
+  const uint8_t i = static_cast<uint8_t>(section);
+  if (i >= SECTIONS) {
+    return;
+  }
+
+  ProfileStatsT& s = sStats[i];
+  if (s.count == 0) {
+    s.min_us = duration_us;
+    s.max_us = duration_us;
+  } else {
+    if (duration_us < s.min_us) {
+      s.min_us = duration_us;
+    }
+    if (duration_us > s.max_us) {
+      s.max_us = duration_us;
+    }
+  }
+
+  if (s.count == UINT16_MAX || s.total_us > UINT32_MAX - duration_us) {
+    s.total_us /= 2;
+    s.count /= 2;
+  }
+  s.total_us += duration_us;
+  s.count++;
+}
+
+const ProfileStatsT& Profiler::getStats(ProfileSection section) {
+  return sStats[static_cast<uint8_t>(section)];
+}
+
+void Profiler::reset() {
+  for (ProfileStatsT& s : sStats) {
+    s = ProfileStatsT{};
+  }
+}
+
+size_t Profiler::printTo(Print& p) {
+  size_t n = 0;
+  n += p.print(F("Profile, min/mean/max us (count)"));
+#ifdef F_CPU
+  n += p.print(F(", 1 us = "));
+  n += p.print(F_CPU / 1000000UL);
+  n += p.print(F(" cycles"));
+#endif
+  n += p.println();
+
+  const uint8_t components = static_cast<uint8_t>(ProfileSection::component0);
+  for (uint8_t i = 0; i < SECTIONS; i++) {
+    const ProfileStatsT& s = sStats[i];
+    if (s.count == 0) {
+      continue;
+    }
+
+    n += p.print(F("  "));
+    if (i < components) {
+      n += p.print(reinterpret_cast<const __FlashStringHelper*>(
+          ProfilerConstants::SectionName[i]));
+    } else {
+      n += p.print(F("component"));
+      n += p.print(i - components);
+    }
+    n += p.print(F(": "));
+    n += p.print(s.min_us);
+    n += p.print('/');
+    n += p.print(s.getMean_us());
+    n += p.print('/');
+    n += p.print(s.max_us);
+    n += p.print(F(" ("));
+    n += p.print(s.count);
+    n += p.println(')');
+  }
+  return n;
+}
+
+#endif
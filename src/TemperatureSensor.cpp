@@ -14,6 +14,10 @@ extern BufferSerial Serial;
 #endif
 
 bool TemperatureSensor::update() {
+  // Shared with the humidity sensor, the reader skips a read if it just did
+  // one.
+  (void)mAhtReader.update();
+
   if (mAhtReader.isReadSuccessful()) {
     TemperatureT newValue = round(mAhtReader.getTemperature() * 10);
     mSensor.setValue(newValue);
@@ -22,18 +26,7 @@ bool TemperatureSensor::update() {
         F("TemperatureSensor: AHT read unsuccessful, not updating value"));
   }
 
-  bool largeChange =
-      mSensor.absDiffLastReportedValue() >=
-      TemperatureSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT;
-
-  bool timeToReport =
-      (mSensor.timeSinceLastReport() / 1000) >=
-      TemperatureSensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT;
-
-  bool isReportDue = largeChange || timeToReport;
-  mSensor.setIsReportDue(isReportDue);
-
-  return isReportDue;
+  return mSensor.updateIsReportDue(mReportPolicy);
 }
 
 bool TemperatureSensor::setValueItem(const ValueItemT& item) { return false; }
@@ -39,14 +39,20 @@
 #include "AHTReader.h"
 #include "Component.h"
 #include "Device.h"
+#include "DiagnosticSensor.h"
 #include "DistanceSensor.h"
 #include "EeAdressMap.h"
 #include "GarageCover.h"
 #include "HeightSensor.h"
 #include "HumiditySensor.h"
 #include "LoRaHandler.h"
+#include "Log.h"
+#include "MemoryMonitor.h"
 #include "PersistentNumberComponent.h"
+#include "PowerManager.h"
 #include "PresenceBinarySensor.h"
+#include "Profiler.h"
+#include "ReportPolicy.h"
 #include "TemperatureSensor.h"
 #include "Util.h"
 
@@ -59,26 +65,13 @@
 #define SERIAL_BAUD_RATE 115200
 
 // Increment when breaking changes of configuration are made.
-#define CONFIG_MAGIC 0x00
-
-// Debug flags
-#define DEBUG_SENSOR_VALUES true
-#define DEBUG_SENSOR_REPORT false
-#define DEBUG_SERVICE true
-
-// Debugging helper macros
-#if (DEBUG_SENSOR_REPORT)
-#define LOG_SENSOR(sensor) \
-  printMillis(Serial);     \
-  (sensor)->printTo(Serial);
-#else
-#define LOG_SENSOR(sensor)
-#endif
+#define CONFIG_MAGIC 0x01
 
-#if (DEBUG_SERVICE)
+// Debugging helper macros, see Log.h for log levels
+#if LOG_ENABLED(MAIN, INFO)
 #define LOG_SERVICE(component, service) \
-  printMillis(Serial);                  \
-  (component)->printTo(Serial, (service));
+  printMillis(Log);                     \
+  (component)->printTo(Log, (service));
 #else
 #define LOG_SERVICE(component, service)
 #endif
@@ -96,6 +89,9 @@
 // AHT20 configuration
 #define AHT20_SENSOR_ENABLED true
 
+// Sleep between scheduled events, see PowerManager.h
+#define POWER_SAVE_ENABLED true
+
 // LoRa configuration
 #define LORA_ENABLED true
 #define LORA_RESET_PIN 5
@@ -103,12 +99,7 @@
 #define LORA_DIO0_PIN LORA_DEFAULT_DIO0_PIN
 #define LORA_MY_ADDRESS 1
 #define LORA_GATEWAY_ADDRESS 0
-
-// Sensor update interval
-#define UPDATE_SENSORS_INTERVAL (uint32_t)(1000u)  // Ones per second
-
-#define SEND_CONFIG_VALUES_INTERVAL \
-  ((uint32_t)1000u * 60u * 15u)  // Once per 15 minutes
+#define LORA_RX_PERIOD_S 0  // RX window period, 0 for continuous receive
 
 // Local constants
 // ----------------------------------------------------------------
@@ -125,12 +116,150 @@ const char carPresenceSensorLowLimitName[] PROGMEM = "Car Presence Low Limit";
 const char carPresenceSensorHighLimitName[] PROGMEM = "Car Presence High Limit";
 const char carPresenceSensorMinStableTimeName[] PROGMEM =
     "Car Presence Min Stable Time";
+const char activeTimeName[] PROGMEM = "Active Time";
+const char idleTimeName[] PROGMEM = "Idle Time";
+const char powerDownTimeName[] PROGMEM = "Power Down Time";
+const char minFreeRamName[] PROGMEM = "Min Free RAM";
+const char temperatureHysteresisName[] PROGMEM = "Temperature Hysteresis";
+const char temperatureMinIntervalName[] PROGMEM = "Temperature Min Interval";
+const char temperatureMaxIntervalName[] PROGMEM = "Temperature Max Interval";
+const char temperatureBurstName[] PROGMEM = "Temperature Burst";
+const char temperatureRefillTimeName[] PROGMEM = "Temperature Refill Time";
+const char temperatureHysteresisPctName[] PROGMEM =
+    "Temperature Relative Hysteresis";
+const char humidityHysteresisName[] PROGMEM = "Humidity Hysteresis";
+const char humidityMinIntervalName[] PROGMEM = "Humidity Min Interval";
+const char humidityMaxIntervalName[] PROGMEM = "Humidity Max Interval";
+const char humidityBurstName[] PROGMEM = "Humidity Burst";
+const char humidityRefillTimeName[] PROGMEM = "Humidity Refill Time";
+const char humidityHysteresisPctName[] PROGMEM = "Humidity Relative Hysteresis";
+const char distanceHysteresisName[] PROGMEM = "Distance Hysteresis";
+const char distanceMinIntervalName[] PROGMEM = "Distance Min Interval";
+const char distanceMaxIntervalName[] PROGMEM = "Distance Max Interval";
+const char distanceBurstName[] PROGMEM = "Distance Burst";
+const char distanceRefillTimeName[] PROGMEM = "Distance Refill Time";
+const char distanceHysteresisPctName[] PROGMEM = "Distance Relative Hysteresis";
+const char heightHysteresisName[] PROGMEM = "Height Hysteresis";
+const char heightMinIntervalName[] PROGMEM = "Height Min Interval";
+const char heightMaxIntervalName[] PROGMEM = "Height Max Interval";
+const char heightBurstName[] PROGMEM = "Height Burst";
+const char heightRefillTimeName[] PROGMEM = "Height Refill Time";
+const char heightHysteresisPctName[] PROGMEM = "Height Relative Hysteresis";
+#ifdef PROFILER_ENABLED
+const char maxLoopTimeName[] PROGMEM = "Max Loop Time";
+#endif
 
 static const uint16_t HEIGHT_SENSOR_STABLE_TIME_DEFAULT = 5000;
 static const HeightT HEIGHT_SENSOR_ZERO_VALUE_DEFAULT = 60;
 static const HeightT CAR_PRESENCE_SENSOR_LOW_LIMIT_DEFAULT = 180;
 static const HeightT CAR_PRESENCE_SENSOR_HIGH_LIMIT_DEFAULT = 200;
 static const uint16_t CAR_PRESENCE_SENSOR_MIN_STABLE_TIME_DEFAULT = 10000;
+static const uint8_t REPORT_HYSTERESIS_PCT_DEFAULT = 0;   // None
+static const uint16_t REPORT_MIN_INTERVAL_DEFAULT = 0;    // s
+static const uint16_t REPORT_MAX_INTERVAL_DEFAULT = 300;  // s
+static const uint8_t REPORT_BURST_DEFAULT = 5;
+static const uint16_t REPORT_REFILL_TIME_DEFAULT = 60;  // s
+
+// Metadata of the entities, built at compile time and stored in flash memory
+// to save RAM. Components only keep their mutable state in RAM.
+const DiscoveryEntityT garageCoverEntity PROGMEM =
+    GarageCover::makeEntity(0, garageCoverName);
+const DiscoveryEntityT temperatureSensorEntity PROGMEM =
+    TemperatureSensor::makeEntity(1, temperatureSensorName);
+const DiscoveryEntityT humiditySensorEntity PROGMEM =
+    HumiditySensor::makeEntity(2, humiditySensorName);
+const DiscoveryEntityT distanceSensorEntity PROGMEM =
+    DistanceSensor::makeEntity(3, distanceSensorName);
+const DiscoveryEntityT heightSensorStableTimeEntity PROGMEM =
+    Number<uint16_t>::makeEntity(4, heightSensorStableTimeName,
+                                 NumberDeviceClass::DURATION, Unit::Type::ms,
+                                 0, BaseComponent::Category::CONFIG, 0,
+                                 Util::MS_PER_MINUTE);
+const DiscoveryEntityT heightSensorZeroValueEntity PROGMEM =
+    Number<HeightT>::makeEntity(5, heightSensorZeroValueName,
+                                NumberDeviceClass::DISTANCE, Unit::Type::cm, 0,
+                                BaseComponent::Category::CONFIG,
+                                -MAX_SENSOR_DISTANCE, MAX_SENSOR_DISTANCE);
+const DiscoveryEntityT heightSensorEntity PROGMEM =
+    HeightSensor::makeEntity(6, heightSensorName);
+const DiscoveryEntityT carPresenceSensorLowLimitEntity PROGMEM =
+    Number<HeightT>::makeEntity(7, carPresenceSensorLowLimitName,
+                                NumberDeviceClass::DISTANCE, Unit::Type::cm, 0,
+                                BaseComponent::Category::CONFIG, 0,
+                                MAX_SENSOR_DISTANCE);
+const DiscoveryEntityT carPresenceSensorHighLimitEntity PROGMEM =
+    Number<HeightT>::makeEntity(8, carPresenceSensorHighLimitName,
+                                NumberDeviceClass::DISTANCE, Unit::Type::cm, 0,
+                                BaseComponent::Category::CONFIG, 0,
+                                MAX_SENSOR_DISTANCE);
+const DiscoveryEntityT carPresenceSensorMinStableTimeEntity PROGMEM =
+    Number<uint16_t>::makeEntity(9, carPresenceSensorMinStableTimeName,
+                                 NumberDeviceClass::DURATION, Unit::Type::ms,
+                                 0, BaseComponent::Category::CONFIG, 0,
+                                 Util::MS_PER_MINUTE);
+const DiscoveryEntityT carPresenceSensorEntity PROGMEM =
+    PresenceBinarySensor::makeEntity(10, carPresenceSensorName);
+const DiscoveryEntityT activeTimeSensorEntity PROGMEM =
+    DiagnosticSensor<uint32_t>::makeEntity(
+        11, activeTimeName, SensorDeviceClass::DURATION, Unit::Type::s);
+const DiscoveryEntityT idleTimeSensorEntity PROGMEM =
+    DiagnosticSensor<uint32_t>::makeEntity(
+        12, idleTimeName, SensorDeviceClass::DURATION, Unit::Type::s);
+const DiscoveryEntityT powerDownTimeSensorEntity PROGMEM =
+    DiagnosticSensor<uint32_t>::makeEntity(
+        13, powerDownTimeName, SensorDeviceClass::DURATION, Unit::Type::s);
+const DiscoveryEntityT minFreeRamSensorEntity PROGMEM =
+    DiagnosticSensor<uint16_t>::makeEntity(
+        14, minFreeRamName, SensorDeviceClass::DATA_SIZE, Unit::Type::B);
+// Report config of the sensors, in ReportConfig::Item order. The entity ids
+// are grouped by item, one per sensor: 16-19 min interval, 20-23 hysteresis,
+// 24-27 relative hysteresis, 28-31 max interval, 32-35 burst and 36-39 refill
+// time.
+const DiscoveryEntityT temperatureReportEntities[] PROGMEM = {
+    ReportConfig::makeHysteresisEntity(20, temperatureHysteresisName,
+                                       NumberDeviceClass::TEMPERATURE_DELTA,
+                                       Unit::Type::C, 1, 100),
+    ReportConfig::makeMinIntervalEntity(16, temperatureMinIntervalName),
+    ReportConfig::makeMaxIntervalEntity(28, temperatureMaxIntervalName),
+    ReportConfig::makeBurstEntity(32, temperatureBurstName),
+    ReportConfig::makeRefillTimeEntity(36, temperatureRefillTimeName),
+    ReportConfig::makeHysteresisPctEntity(24, temperatureHysteresisPctName),
+};
+const DiscoveryEntityT humidityReportEntities[] PROGMEM = {
+    ReportConfig::makeHysteresisEntity(21, humidityHysteresisName,
+                                       NumberDeviceClass::HUMIDITY,
+                                       Unit::Type::percent, 0, 100),
+    ReportConfig::makeMinIntervalEntity(17, humidityMinIntervalName),
+    ReportConfig::makeMaxIntervalEntity(29, humidityMaxIntervalName),
+    ReportConfig::makeBurstEntity(33, humidityBurstName),
+    ReportConfig::makeRefillTimeEntity(37, humidityRefillTimeName),
+    ReportConfig::makeHysteresisPctEntity(25, humidityHysteresisPctName),
+};
+const DiscoveryEntityT distanceReportEntities[] PROGMEM = {
+    ReportConfig::makeHysteresisEntity(22, distanceHysteresisName,
+                                       NumberDeviceClass::DISTANCE,
+                                       Unit::Type::cm, 0, MAX_SENSOR_DISTANCE),
+    ReportConfig::makeMinIntervalEntity(18, distanceMinIntervalName),
+    ReportConfig::makeMaxIntervalEntity(30, distanceMaxIntervalName),
+    ReportConfig::makeBurstEntity(34, distanceBurstName),
+    ReportConfig::makeRefillTimeEntity(38, distanceRefillTimeName),
+    ReportConfig::makeHysteresisPctEntity(26, distanceHysteresisPctName),
+};
+const DiscoveryEntityT heightReportEntities[] PROGMEM = {
+    ReportConfig::makeHysteresisEntity(23, heightHysteresisName,
+                                       NumberDeviceClass::DISTANCE,
+                                       Unit::Type::cm, 0, MAX_SENSOR_DISTANCE),
+    ReportConfig::makeMinIntervalEntity(19, heightMinIntervalName),
+    ReportConfig::makeMaxIntervalEntity(31, heightMaxIntervalName),
+    ReportConfig::makeBurstEntity(35, heightBurstName),
+    ReportConfig::makeRefillTimeEntity(39, heightRefillTimeName),
+    ReportConfig::makeHysteresisPctEntity(27, heightHysteresisPctName),
+};
+#ifdef PROFILER_ENABLED
+const DiscoveryEntityT maxLoopTimeSensorEntity PROGMEM =
+    DiagnosticSensor<uint32_t>::makeEntity(
+        15, maxLoopTimeName, SensorDeviceClass::DURATION, Unit::Type::us);
+#endif
 
 // Local variables
 // ----------------------------------------------------------------
@@ -138,32 +267,65 @@ AHT20 aht;
 AHTReader ahtReader(aht);
 NewPing sonar(SONAR_TRIGGER_PIN, SONAR_ECHO_PIN, SONAR_MAX_DISTANCE_CM);
 
-uint32_t lastUpdateSensorsTime = 0;
-uint32_t lastSentConfigValuesTime = 0;
+PowerManager powerManager;
+
+MemoryMonitor memoryMonitor;
+
+// Pins that wake up from power-down when changed
+const uint8_t wakePins[] = {COVER_OPEN_PIN, COVER_CLOSED_PIN};
+
+uint8_t discoveryCursor = UINT8_MAX;  // Next component to send discovery for
+bool isDiscoveryDeferred = false;     // Waiting for airtime
+
+// Report config of the sensors, see ReportPolicy.h
+ReportConfig temperatureReport(
+    EE_ADDRESS_REPORT_TEMPERATURE, temperatureReportEntities,
+    {TemperatureSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT,
+     REPORT_HYSTERESIS_PCT_DEFAULT, REPORT_MIN_INTERVAL_DEFAULT,
+     REPORT_MAX_INTERVAL_DEFAULT, REPORT_BURST_DEFAULT,
+     REPORT_REFILL_TIME_DEFAULT});
+
+ReportConfig humidityReport(
+    EE_ADDRESS_REPORT_HUMIDITY, humidityReportEntities,
+    {HumiditySensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT,
+     REPORT_HYSTERESIS_PCT_DEFAULT, REPORT_MIN_INTERVAL_DEFAULT,
+     REPORT_MAX_INTERVAL_DEFAULT, REPORT_BURST_DEFAULT,
+     REPORT_REFILL_TIME_DEFAULT});
+
+ReportConfig distanceReport(
+    EE_ADDRESS_REPORT_DISTANCE, distanceReportEntities,
+    {DistanceSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT,
+     REPORT_HYSTERESIS_PCT_DEFAULT, REPORT_MIN_INTERVAL_DEFAULT,
+     REPORT_MAX_INTERVAL_DEFAULT, REPORT_BURST_DEFAULT,
+     REPORT_REFILL_TIME_DEFAULT});
+
+ReportConfig heightReport(
+    EE_ADDRESS_REPORT_HEIGHT, heightReportEntities,
+    {HeightSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT,
+     REPORT_HYSTERESIS_PCT_DEFAULT, REPORT_MIN_INTERVAL_DEFAULT,
+     REPORT_MAX_INTERVAL_DEFAULT, REPORT_BURST_DEFAULT,
+     REPORT_REFILL_TIME_DEFAULT});
 
 // Components
-GarageCover garageCover = GarageCover(0, garageCoverName, COVER_CLOSED_PIN,
+GarageCover garageCover = GarageCover(garageCoverEntity, COVER_CLOSED_PIN,
                                       COVER_OPEN_PIN, COVER_RELAY_PIN);
 
 TemperatureSensor temperatureSensor =
-    TemperatureSensor(1, temperatureSensorName, ahtReader);
+    TemperatureSensor(temperatureSensorEntity, ahtReader, temperatureReport);
 
 HumiditySensor humiditySensor =
-    HumiditySensor(2, humiditySensorName, ahtReader);
+    HumiditySensor(humiditySensorEntity, ahtReader, humidityReport);
 
-DistanceSensor distanceSensor = DistanceSensor(3, distanceSensorName, sonar);
+DistanceSensor distanceSensor =
+    DistanceSensor(distanceSensorEntity, sonar, distanceReport);
 
 PersistentNumber<uint16_t> configStableTime = PersistentNumber<uint16_t>(
-    EE_ADDRESS_CONFIG_HEIGHT_SENSOR_0, 4, heightSensorStableTimeName,
-    NumberDeviceClass::DURATION, Unit::Type::ms, 0,
-    BaseComponent::Category::CONFIG, HEIGHT_SENSOR_STABLE_TIME_DEFAULT, 0,
-    Util::MS_PER_MINUTE);
+    EE_ADDRESS_CONFIG_HEIGHT_SENSOR_0, heightSensorStableTimeEntity,
+    HEIGHT_SENSOR_STABLE_TIME_DEFAULT);
 
 PersistentNumber<HeightT> configZeroValue = PersistentNumber<HeightT>(
-    EE_ADDRESS_CONFIG_HEIGHT_SENSOR_1, 5, heightSensorZeroValueName,
-    NumberDeviceClass::DISTANCE, Unit::Type::cm, 0,
-    BaseComponent::Category::CONFIG, HEIGHT_SENSOR_ZERO_VALUE_DEFAULT,
-    -MAX_SENSOR_DISTANCE, MAX_SENSOR_DISTANCE);
+    EE_ADDRESS_CONFIG_HEIGHT_SENSOR_1, heightSensorZeroValueEntity,
+    HEIGHT_SENSOR_ZERO_VALUE_DEFAULT);
 
 PersistentNumberComponent<uint16_t> heightSensorStableTime =
     PersistentNumberComponent<uint16_t>(configStableTime);
@@ -172,26 +334,21 @@ PersistentNumberComponent<HeightT> heightSensorZeroValue =
     PersistentNumberComponent<HeightT>(configZeroValue);
 
 HeightSensor heightSensor =
-    HeightSensor(6, heightSensorName, distanceSensor.getSensor(),
-                 heightSensorStableTime, heightSensorZeroValue);
+    HeightSensor(heightSensorEntity, distanceSensor, heightSensorStableTime,
+                 heightSensorZeroValue, heightReport);
 
 PersistentNumber<HeightT> configLowLimit = PersistentNumber<HeightT>(
-    EE_ADDRESS_CONFIG_PRESENCE_BINARY_SENSOR_0, 7,
-    carPresenceSensorLowLimitName, NumberDeviceClass::DISTANCE, Unit::Type::cm,
-    0, BaseComponent::Category::CONFIG, CAR_PRESENCE_SENSOR_LOW_LIMIT_DEFAULT,
-    0, MAX_SENSOR_DISTANCE);
+    EE_ADDRESS_CONFIG_PRESENCE_BINARY_SENSOR_0,
+    carPresenceSensorLowLimitEntity, CAR_PRESENCE_SENSOR_LOW_LIMIT_DEFAULT);
 
 PersistentNumber<HeightT> configHighLimit = PersistentNumber<HeightT>(
-    EE_ADDRESS_CONFIG_PRESENCE_BINARY_SENSOR_1, 8,
-    carPresenceSensorHighLimitName, NumberDeviceClass::DISTANCE, Unit::Type::cm,
-    0, BaseComponent::Category::CONFIG, CAR_PRESENCE_SENSOR_HIGH_LIMIT_DEFAULT,
-    0, MAX_SENSOR_DISTANCE);
+    EE_ADDRESS_CONFIG_PRESENCE_BINARY_SENSOR_1,
+    carPresenceSensorHighLimitEntity, CAR_PRESENCE_SENSOR_HIGH_LIMIT_DEFAULT);
 
 PersistentNumber<uint16_t> configMinStableTime = PersistentNumber<uint16_t>(
-    EE_ADDRESS_CONFIG_PRESENCE_BINARY_SENSOR_2, 9,
-    carPresenceSensorMinStableTimeName, NumberDeviceClass::DURATION,
-    Unit::Type::ms, 0, BaseComponent::Category::CONFIG,
-    CAR_PRESENCE_SENSOR_MIN_STABLE_TIME_DEFAULT, 0, Util::MS_PER_MINUTE);
+    EE_ADDRESS_CONFIG_PRESENCE_BINARY_SENSOR_2,
+    carPresenceSensorMinStableTimeEntity,
+    CAR_PRESENCE_SENSOR_MIN_STABLE_TIME_DEFAULT);
 
 PersistentNumberComponent<HeightT> carPresenceSensorLowLimit =
     PersistentNumberComponent<HeightT>(configLowLimit);
@@ -202,23 +359,95 @@ PersistentNumberComponent<HeightT> carPresenceSensorHighLimit =
 PersistentNumberComponent<uint16_t> carPresenceSensorMinStableTime =
     PersistentNumberComponent<uint16_t>(configMinStableTime);
 
-PresenceBinarySensor carPresenceSensor =
-    PresenceBinarySensor(10, carPresenceSensorName, heightSensor.getSensor(),
-                         carPresenceSensorLowLimit, carPresenceSensorHighLimit,
-                         carPresenceSensorMinStableTime);
-
-// Array of all components for easy iteration
-IComponent* components[] = {&garageCover,
-                            &temperatureSensor,
-                            &humiditySensor,
-                            &distanceSensor,
-                            &heightSensorStableTime,
-                            &heightSensorZeroValue,
-                            &heightSensor,
-                            &carPresenceSensorLowLimit,
-                            &carPresenceSensorHighLimit,
-                            &carPresenceSensorMinStableTime,
-                            &carPresenceSensor};
+PresenceBinarySensor carPresenceSensor = PresenceBinarySensor(
+    carPresenceSensorEntity, heightSensor, carPresenceSensorLowLimit,
+    carPresenceSensorHighLimit, carPresenceSensorMinStableTime);
+
+static uint32_t getActiveTime() {
+  return powerManager.getTime_s(PowerState::active);
+}
+
+static uint32_t getIdleTime() {
+  return powerManager.getTime_s(PowerState::idle);
+}
+
+static uint32_t getPowerDownTime() {
+  return powerManager.getTime_s(PowerState::powerDown);
+}
+
+DiagnosticSensor<uint32_t> activeTimeSensor =
+    DiagnosticSensor<uint32_t>(activeTimeSensorEntity, getActiveTime);
+
+DiagnosticSensor<uint32_t> idleTimeSensor =
+    DiagnosticSensor<uint32_t>(idleTimeSensorEntity, getIdleTime);
+
+DiagnosticSensor<uint32_t> powerDownTimeSensor =
+    DiagnosticSensor<uint32_t>(powerDownTimeSensorEntity, getPowerDownTime);
+
+static uint16_t getMinFreeRam() { return memoryMonitor.getMinFreeRam(); }
+
+// Stack high water mark, to see RAM regressions before they crash a node.
+DiagnosticSensor<uint16_t> minFreeRamSensor =
+    DiagnosticSensor<uint16_t>(minFreeRamSensorEntity, getMinFreeRam);
+
+#ifdef PROFILER_ENABLED
+static uint32_t getMaxLoopTime() {
+  return Profiler::getStats(ProfileSection::loop).max_us;
+}
+
+DiagnosticSensor<uint32_t> maxLoopTimeSensor =
+    DiagnosticSensor<uint32_t>(maxLoopTimeSensorEntity, getMaxLoopTime);
+#endif
+
+// Array of all components for easy iteration (stored in flash memory to save
+// RAM)
+IComponent* const components[] PROGMEM = {&garageCover,
+                                          &temperatureSensor,
+                                          &humiditySensor,
+                                          &distanceSensor,
+                                          &heightSensorStableTime,
+                                          &heightSensorZeroValue,
+                                          &heightSensor,
+                                          &carPresenceSensorLowLimit,
+                                          &carPresenceSensorHighLimit,
+                                          &carPresenceSensorMinStableTime,
+                                          &carPresenceSensor,
+                                          &activeTimeSensor,
+                                          &idleTimeSensor,
+                                          &powerDownTimeSensor,
+                                          &minFreeRamSensor,
+                                          &temperatureReport.minInterval,
+                                          &humidityReport.minInterval,
+                                          &distanceReport.minInterval,
+                                          &heightReport.minInterval,
+                                          &temperatureReport.hysteresis,
+                                          &humidityReport.hysteresis,
+                                          &distanceReport.hysteresis,
+                                          &heightReport.hysteresis,
+                                          &temperatureReport.hysteresisPct,
+                                          &humidityReport.hysteresisPct,
+                                          &distanceReport.hysteresisPct,
+                                          &heightReport.hysteresisPct,
+                                          &temperatureReport.maxInterval,
+                                          &humidityReport.maxInterval,
+                                          &distanceReport.maxInterval,
+                                          &heightReport.maxInterval,
+                                          &temperatureReport.burst,
+                                          &humidityReport.burst,
+                                          &distanceReport.burst,
+                                          &heightReport.burst,
+                                          &temperatureReport.refillTime,
+                                          &humidityReport.refillTime,
+                                          &distanceReport.refillTime,
+                                          &heightReport.refillTime,
+#ifdef PROFILER_ENABLED
+                                          &maxLoopTimeSensor,
+#endif
+};
+
+static_assert(sizeof(components) / sizeof(components[0]) <=
+                  DEVICE_MAX_COMPONENTS,
+              "Raise DEVICE_MAX_COMPONENTS, it is sized to the components");
 
 // Device instance that holds all components and provides helper functions to
 // access them
@@ -244,7 +473,6 @@ void onDiscoveryReqMsg(uint8_t entityId);
 void onValueReqMsg(void);
 void onValueSetReqMsg(const ValueItemT& item);
 void onServiceReqMsg(const LoRaServiceItemT& item);
-int freeRam();
 
 // Local function definitions
 // ----------------------------------------------------------------
@@ -259,75 +487,19 @@ static void loadConfigValuesForAllComponents() {
   }
 }
 
-static void updateSensors() {
-  // printMillis(Serial);
-  // Serial.println("Updating sensors");
-
-#if (AHT20_SENSOR_ENABLED)
-  ahtReader.update();
-#endif
-
-  for (uint8_t i = 0; i < device.getSize(); i++) {
-    IComponent* c = device.getComponent(i);
-    if (c == nullptr) {
-      continue;
-    }
-
-    if (c->update()) {
-      LOG_SENSOR(c);
-      // c->setReported();
-    }
-  }
-}
-
-static bool isReportDue() {
-  uint8_t reportDueCount = 0;
-
-  for (uint8_t i = 0; i < device.getSize(); i++) {
-    IComponent* c = device.getComponent(i);
-    if (c == nullptr) {
-      continue;
-    }
-
-    if (c->isReportDue()) {
-      if (reportDueCount == 0) {
-        printMillis(Serial);
-        Serial.print(F("Report is due for entityIds: "));
-      } else {
-        Serial.print(F(", "));
-      }
-      Serial.print(c->getEntityId());
-      reportDueCount++;
-    }
-  }
-
-  const bool isReportDue = reportDueCount > 0;
-
-  if (isReportDue) {
-    Serial.println();
-  }
-
-  return isReportDue;
-}
-
 static void sendSensorValueForComponent(IComponent* component) {
   if (component == nullptr) {
     return;
   }
 
-  lora.beginValueMsg();
-
   ValueItemT item;
   component->getValueItem(item);
-  lora.addValueItem(item);
-  component->setReported();
-
-  lora.endMsg();
+  if (lora.queueValueItem(item)) {
+    component->setReported(ReportReason::request);
+  }
 }
 
 static void sendSensorValueForAllComponents() {
-  lora.beginValueMsg();
-
   for (uint8_t i = 0; i < device.getSize(); i++) {
     IComponent* c = device.getComponent(i);
     if (c == nullptr) {
@@ -336,82 +508,138 @@ static void sendSensorValueForAllComponents() {
 
     ValueItemT item;
     c->getValueItem(item);
-    lora.addValueItem(item);
-    c->setReported();
+    if (lora.queueValueItem(item)) {
+      c->setReported(ReportReason::request);
+    }
   }
 
-  lora.endMsg();
+#if LOG_ENABLED(MAIN, DEBUG)
+  printMillis(Log);
+  Log.println(F("Queued sensor values for all components"));
+#endif
+}
 
-  printMillis(Serial);
-  Serial.println(F("Sent sensor values for all components"));
+// Queues a value of the report set, see Device::report().
+static bool queueValueItem(const ValueItemT& item) {
+  if (!lora.queueValueItem(item)) {
+    return false;
+  }
+
+#if LOG_ENABLED(MAIN, DEBUG)
+  printMillis(Log);
+  Log.print(F("Queued report for entityId "));
+  Log.println(item.entityId);
+#endif
+  return true;
 }
 
-static void sendSensorValueForComponentsWhereReportIsDue() {
-  lora.beginValueMsg();
+void sendSensorValueForEntity(uint8_t entityId) {
+  IComponent* c = device.getComponentByEntityId(entityId);
+  sendSensorValueForComponent(c);
+}
 
-  uint8_t itemsAdded = 0;
+static void registerValueEntitiesForAllComponents() {
   for (uint8_t i = 0; i < device.getSize(); i++) {
-    IComponent* c = device.getComponent(i);
+    const IComponent* c = device.getComponent(i);
     if (c == nullptr) {
       continue;
     }
 
-    if (c->isReportDue()) {
-      ValueItemT item;
-      c->getValueItem(item);
-      lora.addValueItem(item);
-      itemsAdded++;
-      c->setReported();
+    DiscoveryEntityT discovery_entity;
+    c->getDiscoveryEntity(discovery_entity);
+    if (!lora.registerValueEntity(discovery_entity)) {
+#if LOG_ENABLED(MAIN, ERROR)
+      printMillis(Log);
+      Log.print(F("Err: No compact value entity left, sending raw entityId "));
+      Log.println(discovery_entity.entityId);
+#endif
     }
   }
-
-  if (itemsAdded > 0) {
-    lora.endMsg();
-  }
 }
 
-void sendSensorValueForEntity(uint8_t entityId) {
-  IComponent* c = device.getComponentByEntityId(entityId);
-  sendSensorValueForComponent(c);
-}
+static bool addDiscoveryEntityForComponent(const IComponent* component) {
+  DiscoveryEntityT discovery_entity;
+  component->getDiscoveryEntity(discovery_entity);
+  if (!lora.addDiscoveryBatchEntity(discovery_entity)) {
+    return false;
+  }
 
-static void sendDiscoveryMsg(DiscoveryEntityT& discovery_entity) {
-  printMillis(Serial);
-  Serial.print(F("Sending discovery for "));
-  Serial.print(discovery_entity.entityId);
-  Serial.print(':');
-  Serial.println(
+#if LOG_ENABLED(MAIN, INFO)
+  printMillis(Log);
+  Log.print(F("Adding discovery for "));
+  Log.print(discovery_entity.entityId);
+  Log.print(':');
+  Log.println(
       reinterpret_cast<const __FlashStringHelper*>(discovery_entity.name));
-
-  lora.beginDiscoveryMsg();
-  lora.addDiscoveryEntity(discovery_entity);
-  lora.endMsg();
+#endif
+  return true;
 }
 
-static void sendDiscoveryMsgForComponent(const IComponent* component) {
-  if (component == nullptr) {
+// Sends one discovery batch message from discoveryCursor when the radio is
+// idle, called from loop() until all components have been sent.
+static void sendPendingDiscovery() {
+  if (discoveryCursor >= device.getSize() ||
+      lora.getTxState() != LoRaTxState::idle) {
     return;
   }
 
-  DiscoveryEntityT discovery_entity;
-  component->getDiscoveryEntity(discovery_entity);
-  sendDiscoveryMsg(discovery_entity);
-}
+  lora.beginDiscoveryBatchMsg();
+
+  uint8_t cursor = discoveryCursor;
+  uint8_t count = 0;
+  while (cursor < device.getSize()) {
+    const IComponent* c = device.getComponent(cursor);
+    if (c != nullptr && !addDiscoveryEntityForComponent(c)) {
+      if (count == 0) {
+#if LOG_ENABLED(MAIN, ERROR)
+        printMillis(Log);
+        Log.print(F("Err: Discovery entity too long, component "));
+        Log.println(cursor);
+#endif
+        discoveryCursor = cursor + 1;
+      }
+      break;
+    }
+    cursor++;
+    count++;
+  }
 
-static void sendDiscoveryMsgForAllComponents() {
-  for (uint8_t i = 0; i < device.getSize(); i++) {
-    if (i > 0) {
-      delay(500);
+  if (count == 0) {
+    return;
+  }
+
+  // Without airtime left the batch is built again from the same component at
+  // the next wake up, until the airtime budget has room.
+  if (!lora.isRoomForMsg()) {
+#if LOG_ENABLED(MAIN, WARN)
+    if (!isDiscoveryDeferred) {
+      printMillis(Log);
+      Log.print(F("No airtime, discovery deferred at component "));
+      Log.println(discoveryCursor);
     }
+#endif
+    isDiscoveryDeferred = true;
+    return;
+  }
+  isDiscoveryDeferred = false;
 
-    const IComponent* c = device.getComponent(i);
-    sendDiscoveryMsgForComponent(c);
+  if (lora.endMsg()) {
+    discoveryCursor = cursor;
   }
 }
 
+static void sendDiscoveryMsgForAllComponents() { discoveryCursor = 0; }
+
 static void sendDiscoveryMsgForEntity(uint8_t entityId) {
   const IComponent* c = device.getComponentByEntityId(entityId);
-  sendDiscoveryMsgForComponent(c);
+  if (c == nullptr) {
+    return;
+  }
+
+  lora.beginDiscoveryBatchMsg();
+  if (addDiscoveryEntityForComponent(c)) {
+    lora.endMsg();
+  }
 }
 
 static void printWelcomeMsg() {
@@ -458,16 +686,54 @@ static void checkEepromConfig() {
   Serial.println();
 }
 
-#if (DEBUG_SENSOR_VALUES)
+#if LOG_ENABLED(MAIN, DEBUG)
 static void printAllSensors(Print& p) { device.printTo(p); }
 #endif
 
+#if (POWER_SAVE_ENABLED)
+// Sleeps until the next component update or RX window event, a change of a
+// cover pin or, while the radio is in use, the next interrupt.
+static void sleepUntilNextEvent() {
+  const uint32_t now = millis();
+  uint32_t duration_ms = device.getTimeToNextUpdate(now);
+  PowerState deepest = PowerState::powerDown;
+
+#if (LORA_ENABLED)
+  const uint32_t rxTime_ms = lora.getTimeToNextRxEvent(now);
+  if (rxTime_ms < duration_ms) {
+    duration_ms = rxTime_ms;
+  }
+
+  // The DIO0 interrupt can't wake up from power-down.
+  if (lora.isBusy() || lora.getRadioState() == LoRaRadioState::rx ||
+      (discoveryCursor < device.getSize() && !isDiscoveryDeferred)) {
+    deepest = PowerState::idle;
+  }
+#endif
+
+  if (powerManager.sleep(duration_ms, deepest)) {
+    device.setUpdateDue(&garageCover);
+  }
+}
+#endif
+
 void setup() {
+  // Before the stack has grown, all below it is still free.
+  memoryMonitor.begin();
+
   Serial.begin(SERIAL_BAUD_RATE);
   delay(100);  // Allow serial connection to stabilize
 
   printWelcomeMsg();
 
+  if (!device.isEntityIdsValid()) {
+    Serial.print(F("ERROR: Duplicate or out of range entityId "));
+    Serial.println(device.getInvalidEntityId());
+    while (1) {
+      delay(1000);
+    }
+  }
+
   checkEepromConfig();
 
   printMillis(Serial);
@@ -506,42 +772,76 @@ void setup() {
     Serial.println(F("LoRa started"));
   }
 
+  lora.enableRxInterrupt();
+#if (LORA_RX_PERIOD_S > 0)
+  // Downlinks only arrive in RX windows, the radio sleeps in between.
+  lora.setRxPeriod(LORA_RX_PERIOD_S);
+#endif
+
+  registerValueEntitiesForAllComponents();
+
+  // Full discovery is only sent when the gateway asks for it, after it has
+  // compared the hash with its cache.
+  const uint32_t discoveryHash = device.getDiscoveryHash();
+  lora.setDiscoverySchema(discoveryHash, device.getSize());
   printMillis(Serial);
-  Serial.println(F("Sending discovery for all components"));
-  sendDiscoveryMsgForAllComponents();
-  printMillis(Serial);
-  Serial.println(F("Discovery sent for all components"));
+  Serial.print(F("Announcing discovery schema hash "));
+  printHex(Serial, discoveryHash, true);
+  Serial.println();
+  lora.sendAnnounceMsg();
 #else
   printMillis(Serial);
   Serial.println(F("LoRa is disabled"));
 #endif
 
+#if (POWER_SAVE_ENABLED)
+  powerManager.begin(wakePins, sizeof(wakePins));
+#endif
+
+  printMillis(Serial);
+  Serial.print(F("Free RAM: "));
+  Serial.print(memoryMonitor.getFreeRam());
+  Serial.print(F(" bytes, min "));
+  Serial.println(memoryMonitor.getMinFreeRam());
+
   printMillis(Serial);
   Serial.println(F("Setup complete, starting loop"));
 }
 
 void loop() {
-  auto curMillis = millis();
-
-  if (curMillis - lastUpdateSensorsTime >= UPDATE_SENSORS_INTERVAL) {
-    lastUpdateSensorsTime += UPDATE_SENSORS_INTERVAL;
-    updateSensors();
-
-#if (DEBUG_SENSOR_VALUES)
-    printMillis(Serial);
-    printAllSensors(Serial);
+  {
+    // Timed apart from the sleep below.
+    PROFILE_SCOPE(ProfileSection::loop);
+
+    auto curMillis = millis();
+
+    // Each component is updated at its own interval, e.g. the sonar and the
+    // AHT sensor only once a minute.
+    if (device.update(curMillis) > 0) {
+#if LOG_ENABLED(MAIN, DEBUG)
+      printMillis(Log);
+      printAllSensors(Log);
 #endif
+    }
 
 #if (LORA_ENABLED)
-    if (isReportDue()) {
-      sendSensorValueForAllComponents();
+    // Only the components that are due for reporting, changed or at their
+    // report interval, are sent. Retried here while the queue is full.
+    if (device.isReportDue()) {
+      (void)device.report(queueValueItem);
     }
+
+    sendPendingDiscovery();
+    lora.updateTx();
+    lora.updateRxWindow();
+
+    // FIXME: This crashes sometimes
+    (void)lora.loraRx();
 #endif
   }
 
-#if (LORA_ENABLED)
-  // FIXME: This crashes sometimes
-  (void)lora.loraRx();
+#if (POWER_SAVE_ENABLED)
+  sleepUntilNextEvent();
 #endif
 }
 
@@ -553,19 +853,31 @@ void onDiscoveryReqMsg(uint8_t entityId) {
   sendDiscoveryMsgForEntity(entityId);
 }
 
-void onValueReqMsg(void) { sendSensorValueForAllComponents(); }
+void onValueReqMsg(void) {
+  sendSensorValueForAllComponents();
+
+#ifdef PROFILER_ENABLED
+  // The gateway asking for all values is also when to dump the profile.
+  printMillis(Serial);
+  Profiler::printTo(Serial);
+#endif
+}
 
 void onValueSetReqMsg(const ValueItemT& valueItem) {
   IComponent* c = device.getComponentByEntityId(valueItem.entityId);
   if (c) {
     c->setValueItem(valueItem);
-    Serial.print(F("Set value item for entityId "));
-    Serial.print(valueItem.entityId);
-    Serial.print(F(": "));
-    Serial.println(valueItem.value);
+#if LOG_ENABLED(MAIN, INFO)
+    Log.print(F("Set value item for entityId "));
+    Log.print(valueItem.entityId);
+    Log.print(F(": "));
+    Log.println(valueItem.value);
+#endif
   } else {
-    Serial.print(F("Received value set request for unknown entityId "));
-    Serial.println(valueItem.entityId);
+#if LOG_ENABLED(MAIN, WARN)
+    Log.print(F("Received value set request for unknown entityId "));
+    Log.println(valueItem.entityId);
+#endif
   }
 }
 
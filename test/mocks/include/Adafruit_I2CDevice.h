@@ -0,0 +1,63 @@
+#pragma once
+
+#include <assert.h>
+#include <gmock/gmock.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Wire.h"
+
+class Adafruit_I2CDeviceMock {
+ public:
+  virtual ~Adafruit_I2CDeviceMock() = default;
+  MOCK_METHOD(bool, begin, (bool));
+  MOCK_METHOD(bool, read, (uint8_t*, size_t, bool));
+  MOCK_METHOD(bool, write,
+              (const uint8_t*, size_t, bool, const uint8_t*, size_t));
+};
+
+inline Adafruit_I2CDeviceMock* i2cDeviceMock = nullptr;
+
+inline Adafruit_I2CDeviceMock* i2cDeviceMockInstance() {
+  if (!i2cDeviceMock) {
+    i2cDeviceMock = new Adafruit_I2CDeviceMock();
+  }
+  return i2cDeviceMock;
+}
+
+inline void releaseI2CDeviceMock() {
+  delete i2cDeviceMock;
+  i2cDeviceMock = nullptr;
+}
+
+/**
+ * @brief Same interface as Adafruit BusIO (the parts used by the node), every
+ * instance forwards to the mock of i2cDeviceMockInstance().
+ */
+class Adafruit_I2CDevice {
+ public:
+  Adafruit_I2CDevice(uint8_t addr, TwoWire* theWire = &Wire) : mAddr{addr} {
+    (void)theWire;
+  }
+
+  bool begin(bool addr_detect = true) {
+    assert(i2cDeviceMock != nullptr);
+    return i2cDeviceMock->begin(addr_detect);
+  }
+
+  bool read(uint8_t* buffer, size_t len, bool stop = true) {
+    assert(i2cDeviceMock != nullptr);
+    return i2cDeviceMock->read(buffer, len, stop);
+  }
+
+  bool write(const uint8_t* buffer, size_t len, bool stop = true,
+             const uint8_t* prefix_buffer = nullptr, size_t prefix_len = 0) {
+    assert(i2cDeviceMock != nullptr);
+    return i2cDeviceMock->write(buffer, len, stop, prefix_buffer, prefix_len);
+  }
+
+  uint8_t address() const { return mAddr; }
+
+ private:
+  const uint8_t mAddr;
+};
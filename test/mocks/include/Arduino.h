@@ -47,14 +47,15 @@ void yield(void);
 #define digitalPinToInterrupt(p) \
   ((p) == 2 ? 0 : ((p) == 3 ? 1 : NOT_AN_INTERRUPT))
 
-#define A0
-#define A1
-#define A2
-#define A3
-#define A4
-#define A5
-#define A6
-#define A7
+// Pin numbers of the ATmega328P
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define A6 20
+#define A7 21
 
 #define lowByte(w) (static_cast<uint8_t>((w)&0xff))
 #define highByte(w) (static_cast<uint8_t>((w) >> 8))
@@ -148,6 +149,8 @@ class ArduinoMock {
   MOCK_METHOD(int, analogRead, (int));
   MOCK_METHOD(void, delay, (int));
   MOCK_METHOD(unsigned long, millis, ());
+  MOCK_METHOD(unsigned long, micros, ());
+  MOCK_METHOD(void, sleepCpu, (uint8_t));
 };
 ArduinoMock* arduinoMockInstance();
 void releaseArduinoMock();
@@ -13,10 +13,14 @@ class BufferSerial : public Stream {
 
   unsigned char* _buffer;
 
+  Print* _echo{nullptr};
+
  public:
   explicit BufferSerial(size_t buffer_size);
   virtual ~BufferSerial();
 
+  void begin(unsigned long baud) { (void)baud; }
+
   virtual int available(void) override;
   virtual int peek(void) override;
   virtual int read(void) override;
@@ -29,5 +33,8 @@ class BufferSerial : public Stream {
   // inline size_t write(unsigned int n) { return write((uint8_t)n); }
   // inline size_t write(int n) { return write((uint8_t)n); }
   using Print::write;  // pull in write(str) and write(buf, size) from Print
+
+  // Every byte written is also written to echo, e.g. by the simulator.
+  void setEcho(Print* echo) { _echo = echo; }
   // operator bool() { return true; }
 };
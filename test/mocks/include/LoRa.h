@@ -43,23 +43,23 @@ class LoRaClass /* : public Stream */ {
   //   virtual void flush();
 
   // #ifndef ARDUINO_SAMD_MKRWAN1300
-  //   void onReceive(void(*callback)(int));
-  //   void onTxDone(void(*callback)());
+  virtual void onReceive(void (*callback)(int)) = 0;
+  virtual void onTxDone(void (*callback)()) = 0;
 
-  //   void receive(int size = 0);
+  virtual void receive(int size = 0) = 0;
   // #endif
-  // void idle();
-  // void sleep();
+  virtual void idle() = 0;
+  virtual void sleep() = 0;
 
   // void setTxPower(int level, int outputPin = PA_OUTPUT_PA_BOOST_PIN);
   // void setFrequency(long frequency);
-  // void setSpreadingFactor(int sf);
-  // void setSignalBandwidth(long sbw);
-  // void setCodingRate4(int denominator);
-  // void setPreambleLength(long length);
+  virtual void setSpreadingFactor(int sf) = 0;
+  virtual void setSignalBandwidth(long sbw) = 0;
+  virtual void setCodingRate4(int denominator) = 0;
+  virtual void setPreambleLength(long length) = 0;
   // void setSyncWord(int sw);
-  // void enableCrc();
-  // void disableCrc();
+  virtual void enableCrc() = 0;
+  virtual void disableCrc() = 0;
   // void enableInvertIQ();
   // void disableInvertIQ();
 
@@ -121,4 +121,15 @@ class LoRaMock : public LoRaClass {
   MOCK_METHOD(size_t, write, (const uint8_t *, size_t));
   MOCK_METHOD(int, available, ());
   MOCK_METHOD(int, read, ());
+  MOCK_METHOD(void, onReceive, (void (*)(int)));
+  MOCK_METHOD(void, receive, (int));
+  MOCK_METHOD(void, idle, ());
+  MOCK_METHOD(void, sleep, ());
+  MOCK_METHOD(void, onTxDone, (void (*)()));
+  MOCK_METHOD(void, setSpreadingFactor, (int));
+  MOCK_METHOD(void, setSignalBandwidth, (long));
+  MOCK_METHOD(void, setCodingRate4, (int));
+  MOCK_METHOD(void, setPreambleLength, (long));
+  MOCK_METHOD(void, enableCrc, ());
+  MOCK_METHOD(void, disableCrc, ());
 };
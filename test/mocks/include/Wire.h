@@ -0,0 +1,7 @@
+#pragma once
+
+// No I2C bus in the tests, devices are mocked above it, see
+// Adafruit_I2CDevice.h.
+class TwoWire {};
+
+inline TwoWire Wire;
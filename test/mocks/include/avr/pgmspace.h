@@ -1,3 +1,13 @@
-#pragma once
-
-#define pgm_read_dword_near(x) (*(uint32_t*)(x))
+#pragma once
+
+#include <string.h>
+
+#define pgm_read_byte(x) (*(const uint8_t*)(x))
+#define pgm_read_word(x) (*(const uint16_t*)(x))
+#define pgm_read_dword(x) (*(const uint32_t*)(x))
+#define pgm_read_dword_near(x) (*(uint32_t*)(x))
+#define pgm_read_ptr(x) (*(void* const*)(x))
+
+#define strlen_P(s) strlen(s)
+#define strcpy_P(dst, src) strcpy((dst), (src))
+#define memcpy_P(dst, src, n) memcpy((dst), (src), (n))
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <stdint.h>
+
+#define SLEEP_MODE_IDLE 0
+#define SLEEP_MODE_PWR_DOWN 2
+
+// Calls ArduinoMock::sleepCpu() with the mode last set.
+void set_sleep_mode(uint8_t mode);
+void sleep_enable(void);
+void sleep_disable(void);
+void sleep_bod_disable(void);
+void sleep_cpu(void);
@@ -3,6 +3,8 @@
 #include <ctime>
 
 #include "BufferSerial.h"
+#include "avr/sleep.h"
+#include "avr/wdt.h"
 
 #define SECS_YR_2000 ((time_t)(946684800UL))  // the time at the start of y2k
 
@@ -68,7 +70,11 @@ unsigned long millis(void) {
   return arduinoMock->millis();
 }
 
-unsigned long micros(void) { return 0; }
+unsigned long micros(void) {
+  assert(arduinoMock != NULL);
+  return arduinoMock->micros();
+}
+
 void delay(time_t a) {
   assert(arduinoMock != NULL);
   arduinoMock->delay(a);
@@ -104,3 +110,22 @@ void detachInterrupt(uint8_t) {}
 void interrupts(void) {}
 
 void noInterrupts(void) {}
+
+static uint8_t sleepMode = SLEEP_MODE_IDLE;
+
+void set_sleep_mode(uint8_t mode) { sleepMode = mode; }
+
+void sleep_enable(void) {}
+
+void sleep_disable(void) {}
+
+void sleep_bod_disable(void) {}
+
+void sleep_cpu(void) {
+  assert(arduinoMock != NULL);
+  arduinoMock->sleepCpu(sleepMode);
+}
+
+void wdt_enable(uint8_t timeout) { UNUSED(timeout); }
+
+void wdt_disable(void) {}
@@ -66,5 +66,9 @@ size_t BufferSerial::write(uint8_t c) {
   _buffer[_buffer_head] = c;
   _buffer_head = i;
 
+  if (_echo) {
+    _echo->write(c);
+  }
+
   return 1;
 }
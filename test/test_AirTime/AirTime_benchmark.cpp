@@ -0,0 +1,52 @@
+#include "AirTime.h"
+
+#include <gtest/gtest.h>
+#include <stdio.h>
+
+#include <chrono>
+
+#include "Util.h"
+
+// Measures the cost of transmitting and checking the airtime, with gaps of
+// different length in between. The cost shall not grow with the gap.
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr uint32_t kIterations = 200000;
+
+static double updateTime_ns(uint32_t gap_ms) {
+  AirTime<32> at(10000, 10000);
+  uint32_t t = 0;
+  volatile uint32_t sink = 0;
+
+  auto start = Clock::now();
+  for (uint32_t i = 0; i < kIterations; i++) {
+    t += gap_ms;
+    sink = sink + at.getTime_ms(t);
+    at.update(t, t + 50);
+  }
+  auto end = Clock::now();
+
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         kIterations;
+}
+
+TEST(AirTime_benchmark, update_cost_shall_not_grow_with_gap) {
+  const uint32_t gaps_ms[] = {
+      1000,                     Util::MS_PER_MINUTE,
+      10 * Util::MS_PER_MINUTE, 59 * Util::MS_PER_MINUTE,
+      Util::MS_PER_HOUR,        24 * Util::MS_PER_HOUR,
+  };
+
+  double min_ns = 1e9;
+  double max_ns = 0;
+  for (uint32_t gap_ms : gaps_ms) {
+    double ns = updateTime_ns(gap_ms);
+    printf("gap %10u ms: %6.1f ns/update\n", gap_ms, ns);
+    min_ns = ns < min_ns ? ns : min_ns;
+    max_ns = ns > max_ns ? ns : max_ns;
+  }
+
+  // Generous bound, timing on a shared host is noisy.
+  EXPECT_LT(max_ns, 5 * min_ns + 50);
+}
@@ -6,9 +6,6 @@
 #include "Arduino.h"
 #include "BufferSerial.h"
 
-// Include source implementation
-#include "../../src/AirTime.cpp"
-
 using ::testing::Return;
 using ::testing::ReturnPointee;
 
@@ -25,7 +22,7 @@ class AirTime_test : public ::testing::Test {
 };
 
 TEST_F(AirTime_test, construct_airtime_shall_be_zero_and_limit_not_reached) {
-  auto at = AirTime(10000);
+  auto at = AirTime<Util::MINUTES_PER_HOUR>(10000);
   EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(Return(0));
 
   EXPECT_EQ(at.getTime_ms(), 0);
@@ -35,7 +32,7 @@ TEST_F(AirTime_test, construct_airtime_shall_be_zero_and_limit_not_reached) {
 
 TEST_F(AirTime_test,
        update_1ms_within_current_minute_shall_be_one_and_limit_not_reached) {
-  auto at = AirTime(10000);
+  auto at = AirTime<Util::MINUTES_PER_HOUR>(10000);
   EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(Return(2));
 
   at.update(1, 2);
@@ -48,7 +45,7 @@ TEST_F(AirTime_test,
 TEST_F(
     AirTime_test,
     update_35999ms_then_1ms_within_current_minute_shall_be_10000ppm_and_limit_reached) {
-  auto at = AirTime(10000);
+  auto at = AirTime<Util::MINUTES_PER_HOUR>(10000);
   EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(Return(36000));
 
   at.update(2, 36000);
@@ -67,13 +64,13 @@ TEST_F(
 }
 
 TEST_F(AirTime_test, update_1ms_shall_be_gone_after_1hour) {
-  auto at = AirTime(10000);
+  auto at = AirTime<Util::MINUTES_PER_HOUR>(10000);
   EXPECT_CALL(*pArduinoMock, millis())
       .WillOnce(Return(1))
-      .WillOnce(Return(MS_PER_HOUR - 1))
-      .WillOnce(Return(MS_PER_HOUR - 1))
-      .WillOnce(Return(MS_PER_HOUR))
-      .WillOnce(Return(MS_PER_HOUR));
+      .WillOnce(Return(Util::MS_PER_HOUR - 1))
+      .WillOnce(Return(Util::MS_PER_HOUR - 1))
+      .WillOnce(Return(Util::MS_PER_HOUR))
+      .WillOnce(Return(Util::MS_PER_HOUR));
 
   at.update(0, 1);
 
@@ -91,13 +88,13 @@ TEST_F(AirTime_test, update_1ms_shall_be_gone_after_1hour) {
 TEST_F(
     AirTime_test,
     update_over_minute_boundary_shall_be_split_over_two_minutes_first_minute_gone_after_1hour) {
-  auto at = AirTime(10000);
+  auto at = AirTime<Util::MINUTES_PER_HOUR>(10000);
   EXPECT_CALL(*pArduinoMock, millis())
-      .WillOnce(Return(MS_PER_MINUTE + 1))
-      .WillOnce(Return(MS_PER_HOUR))
-      .WillOnce(Return(MS_PER_HOUR + MS_PER_MINUTE));
+      .WillOnce(Return(Util::MS_PER_MINUTE + 1))
+      .WillOnce(Return(Util::MS_PER_HOUR))
+      .WillOnce(Return(Util::MS_PER_HOUR + Util::MS_PER_MINUTE));
 
-  at.update(MS_PER_MINUTE - 2, MS_PER_MINUTE + 1);
+  at.update(Util::MS_PER_MINUTE - 2, Util::MS_PER_MINUTE + 1);
 
   EXPECT_EQ(at.getTime_ms(), 3);
   EXPECT_EQ(at.getTime_ms(), 1);
@@ -106,17 +103,17 @@ TEST_F(
 
 TEST_F(AirTime_test,
        update_of_time_over_two_minutes_shall_be_split_over_three_minutes) {
-  auto at = AirTime(10000);
+  auto at = AirTime<Util::MINUTES_PER_HOUR>(10000);
   EXPECT_CALL(*pArduinoMock, millis())
-      .WillOnce(Return(MS_PER_MINUTE * 2 + 1))
-      .WillOnce(Return(MS_PER_HOUR))
-      .WillOnce(Return(MS_PER_HOUR + MS_PER_MINUTE))
-      .WillOnce(Return(MS_PER_HOUR + MS_PER_MINUTE * 2));
+      .WillOnce(Return(Util::MS_PER_MINUTE * 2 + 1))
+      .WillOnce(Return(Util::MS_PER_HOUR))
+      .WillOnce(Return(Util::MS_PER_HOUR + Util::MS_PER_MINUTE))
+      .WillOnce(Return(Util::MS_PER_HOUR + Util::MS_PER_MINUTE * 2));
 
-  at.update(MS_PER_MINUTE - 1, MS_PER_MINUTE * 2 + 1);
+  at.update(Util::MS_PER_MINUTE - 1, Util::MS_PER_MINUTE * 2 + 1);
 
-  EXPECT_EQ(at.getTime_ms(), MS_PER_MINUTE + 2);
-  EXPECT_EQ(at.getTime_ms(), MS_PER_MINUTE + 1);
+  EXPECT_EQ(at.getTime_ms(), Util::MS_PER_MINUTE + 2);
+  EXPECT_EQ(at.getTime_ms(), Util::MS_PER_MINUTE + 1);
   EXPECT_EQ(at.getTime_ms(), 1);
   EXPECT_EQ(at.getTime_ms(), 0);
 }
@@ -124,35 +121,35 @@ TEST_F(AirTime_test,
 TEST_F(
     AirTime_test,
     update_over_one_hour_10ms_each_minute_shall_result_in_600ms_then_decay_over_one_hour_shall_result_in_0ms) {
-  auto at = AirTime(10000);
+  auto at = AirTime<Util::MINUTES_PER_HOUR>(10000);
   uint32_t start = 100;
   uint32_t end = start + 10;
   uint32_t expected_ms = 0;
   EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(ReturnPointee(&end));
 
   // Add values each minute over an hour
-  for (uint8_t i = 0; i < MINUTES_PER_HOUR; i++) {
+  for (uint8_t i = 0; i < Util::MINUTES_PER_HOUR; i++) {
     Serial.flush();
     at.update(start, end);
 
     expected_ms += (end - start);
     EXPECT_EQ(at.getTime_ms(), expected_ms);
 
-    start += MS_PER_MINUTE;
-    end += MS_PER_MINUTE;
+    start += Util::MS_PER_MINUTE;
+    end += Util::MS_PER_MINUTE;
   }
 
-  uint32_t t = 100 + MS_PER_HOUR - MS_PER_MINUTE;
+  uint32_t t = 100 + Util::MS_PER_HOUR - Util::MS_PER_MINUTE;
   EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(ReturnPointee(&t));
 
   EXPECT_EQ(at.getTime_ms(), 600);
 
   // Add no values over an hour to decay airtime
-  for (uint8_t i = 0; i < MINUTES_PER_HOUR; i++) {
+  for (uint8_t i = 0; i < Util::MINUTES_PER_HOUR; i++) {
     Serial.flush();
     at.update();
 
-    t += MS_PER_MINUTE;
+    t += Util::MS_PER_MINUTE;
 
     expected_ms -= 10;
     EXPECT_EQ(at.getTime_ms(), expected_ms);
@@ -164,13 +161,13 @@ TEST_F(
 TEST_F(
     AirTime_test,
     multiple_updates_during_same_minute_shall_add_them_in_the_same_slot_and_be_gone_after_1hour) {
-  auto at = AirTime(10000);
+  auto at = AirTime<Util::MINUTES_PER_HOUR>(10000);
   EXPECT_CALL(*pArduinoMock, millis())
       .WillOnce(Return(510))
-      .WillOnce(Return(MS_PER_HOUR - 1))
-      .WillOnce(Return(MS_PER_HOUR - 1))
-      .WillOnce(Return(MS_PER_HOUR))
-      .WillOnce(Return(MS_PER_HOUR));
+      .WillOnce(Return(Util::MS_PER_HOUR - 1))
+      .WillOnce(Return(Util::MS_PER_HOUR - 1))
+      .WillOnce(Return(Util::MS_PER_HOUR))
+      .WillOnce(Return(Util::MS_PER_HOUR));
 
   at.update(100, 110);
   at.update(200, 210);
@@ -195,7 +192,7 @@ TEST_F(
 TEST_F(
     AirTime_test,
     for_airtime_ppm_above_UINT16_MAX_getTime_ppm_shall_be_limited_to_UINT16_MAX) {
-  auto at = AirTime(10000);
+  auto at = AirTime<Util::MINUTES_PER_HOUR>(10000);
   EXPECT_CALL(*pArduinoMock, millis())
       .WillOnce(Return(235924))
       .WillOnce(Return(235925))
@@ -225,10 +222,75 @@ TEST_F(
 }
 
 TEST_F(AirTime_test, update_during_millis_rollover) {
-  auto at = AirTime(10000);
+  auto at = AirTime<Util::MINUTES_PER_HOUR>(10000);
   EXPECT_CALL(*pArduinoMock, millis()).WillOnce(Return(1));
 
   at.update(UINT32_MAX, 1);
 
   EXPECT_EQ(at.getTime_ms(), 2);
 }
+
+TEST_F(AirTime_test, is_room_for_shall_check_time_left_within_limit) {
+  auto at = AirTime<Util::MINUTES_PER_HOUR>(10000);
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(Return(30000));
+
+  EXPECT_EQ(at.getLimit_ms(), 36000);
+
+  at.update(0, 30000);
+
+  EXPECT_TRUE(at.isRoomFor(6000));
+  EXPECT_FALSE(at.isRoomFor(6001));
+}
+
+TEST_F(AirTime_test, ten_second_buckets_shall_decay_in_ten_second_steps) {
+  auto at = AirTime<4>(10000, 10000);
+
+  at.update(9990, 10010);
+
+  EXPECT_EQ(at.getTime_ms(10010), 20);
+  EXPECT_EQ(at.getTime_ms(Util::MS_PER_HOUR - 1), 20);
+  EXPECT_EQ(at.getTime_ms(Util::MS_PER_HOUR), 10);
+  EXPECT_EQ(at.getTime_ms(Util::MS_PER_HOUR + 10000), 0);
+}
+
+TEST_F(AirTime_test, gap_longer_than_one_hour_shall_clear_all) {
+  auto at = AirTime<4>(10000, 10000);
+
+  at.update(0, 10);
+  at.update(20000, 20010);
+  EXPECT_EQ(at.getEntries(), 2);
+
+  EXPECT_EQ(at.getTime_ms(10 * Util::MS_PER_HOUR), 0);
+  EXPECT_EQ(at.getEntries(), 0);
+
+  at.update(10 * Util::MS_PER_HOUR, 10 * Util::MS_PER_HOUR + 5);
+  EXPECT_EQ(at.getTime_ms(10 * Util::MS_PER_HOUR + 5), 5);
+}
+
+TEST_F(AirTime_test, more_buckets_than_entries_shall_merge_and_expire_late) {
+  auto at = AirTime<2>(10000, 10000);
+
+  at.update(0, 10);
+  at.update(10000, 10020);
+  at.update(20000, 20030);
+
+  EXPECT_EQ(at.getEntries(), 2);
+  EXPECT_EQ(at.getTime_ms(20030), 60);
+
+  // First bucket was merged into the second, it expires with it.
+  EXPECT_EQ(at.getTime_ms(Util::MS_PER_HOUR), 60);
+  EXPECT_EQ(at.getTime_ms(Util::MS_PER_HOUR + 10000), 30);
+  EXPECT_EQ(at.getTime_ms(Util::MS_PER_HOUR + 20000), 0);
+}
+
+TEST_F(AirTime_test, transmission_started_before_current_bucket_shall_count) {
+  auto at = AirTime<4>(10000, 10000);
+
+  // Window moved to next bucket while transmitting.
+  EXPECT_EQ(at.getTime_ms(10005), 0);
+  at.update(9990, 10010);
+
+  EXPECT_EQ(at.getTime_ms(10010), 20);
+  EXPECT_EQ(at.getTime_ms(Util::MS_PER_HOUR + 9999), 20);
+  EXPECT_EQ(at.getTime_ms(Util::MS_PER_HOUR + 10000), 0);
+}
@@ -10,6 +10,13 @@
 
 using ::testing::Return;
 
+// Metadata of an entity, in flash on target.
+static constexpr DiscoveryEntityT entity(const char* name) {
+  return BaseComponent::makeEntity<uint8_t>(23, name,
+                                            BaseComponent::Type::SENSOR, 0,
+                                            BaseComponent::Category::CONFIG);
+}
+
 class BaseComponent_test : public ::testing::Test {
  protected:
   void SetUp() override { strBuf[0] = '\0'; }
@@ -31,18 +38,50 @@ class BaseComponent_test : public ::testing::Test {
   char strBuf[256];
 };
 
-TEST_F(BaseComponent_test, getEntityId_constructor_1_param) {
-  BaseComponent cmp = BaseComponent(23);
+TEST_F(BaseComponent_test, getEntityId_without_name) {
+  const DiscoveryEntityT e = entity(nullptr);
+  BaseComponent cmp = BaseComponent(e);
   EXPECT_EQ(cmp.getEntityId(), 23);
 }
 
-TEST_F(BaseComponent_test, getEntityId_constructor_2_params) {
-  BaseComponent cmp = BaseComponent(23, "Hello");
+TEST_F(BaseComponent_test, getEntityId_with_name) {
+  const DiscoveryEntityT e = entity("Hello");
+  BaseComponent cmp = BaseComponent(e);
   EXPECT_EQ(cmp.getEntityId(), 23);
+  EXPECT_STREQ(cmp.getName(), "Hello");
+  EXPECT_EQ(cmp.getCategory(), BaseComponent::Category::CONFIG);
+}
+
+TEST_F(BaseComponent_test, makeEntity_shall_set_all_fields) {
+  constexpr DiscoveryEntityT e = BaseComponent::makeEntity<int16_t>(
+      7, "", BaseComponent::Type::NUMBER, 5, BaseComponent::Category::CONFIG,
+      Unit::Type::cm, 4, -300, 300);
+
+  EXPECT_EQ(e.entityId, 7);
+  EXPECT_EQ(e.componentType, static_cast<uint8_t>(BaseComponent::Type::NUMBER));
+  EXPECT_EQ(e.deviceClass, 5);
+  EXPECT_EQ(e.category, static_cast<uint8_t>(BaseComponent::Category::CONFIG));
+  EXPECT_EQ(e.unit, static_cast<uint8_t>(Unit::Type::cm));
+  EXPECT_EQ(e.precision, 3);  // Clamped
+  EXPECT_EQ(e.sizeCode, 1);
+  EXPECT_TRUE(e.isSigned);
+  EXPECT_EQ(static_cast<int16_t>(e.minValue), -300);
+  EXPECT_EQ(e.maxValue, 300);
+}
+
+TEST_F(BaseComponent_test, getDiscoveryEntity_shall_copy_entity) {
+  const DiscoveryEntityT e = entity("Hello");
+  BaseComponent cmp = BaseComponent(e);
+  DiscoveryEntityT item{};
+
+  cmp.getDiscoveryEntity(item);
+
+  EXPECT_EQ(memcmp(&item, &e, sizeof(item)), 0);
 }
 
 TEST_F(BaseComponent_test, setReported_and_timeSinceLastReport) {
-  BaseComponent cmp = BaseComponent(23);
+  const DiscoveryEntityT e = entity(nullptr);
+  BaseComponent cmp = BaseComponent(e);
   ArduinoMock* arduinoMock = arduinoMockInstance();
   EXPECT_CALL(*arduinoMock, millis())
       .WillOnce(Return(10000ul))
@@ -60,7 +99,8 @@ TEST_F(BaseComponent_test, setReported_and_timeSinceLastReport) {
 }
 
 TEST_F(BaseComponent_test, isReportDue) {
-  BaseComponent cmp = BaseComponent(23);
+  const DiscoveryEntityT e = entity(nullptr);
+  BaseComponent cmp = BaseComponent(e);
   ArduinoMock* arduinoMock = arduinoMockInstance();
   EXPECT_CALL(*arduinoMock, millis()).WillOnce(Return(10000ul));
 
@@ -81,7 +121,8 @@ TEST_F(BaseComponent_test, isReportDue) {
 }
 
 TEST_F(BaseComponent_test, print_name_when_no_name_is_set) {
-  BaseComponent cmp = BaseComponent(23);
+  const DiscoveryEntityT e = entity(nullptr);
+  BaseComponent cmp = BaseComponent(e);
   const char* expectStr = "";
 
   size_t printedChars = cmp.printTo(Serial);
@@ -93,7 +134,8 @@ TEST_F(BaseComponent_test, print_name_when_no_name_is_set) {
 
 TEST_F(BaseComponent_test, print_name_when_empty_name_is_set) {
   const char* expectStr = "";
-  BaseComponent cmp = BaseComponent(23, expectStr);
+  const DiscoveryEntityT e = entity(expectStr);
+  BaseComponent cmp = BaseComponent(e);
 
   size_t printedChars = cmp.printTo(Serial);
 
@@ -104,7 +146,8 @@ TEST_F(BaseComponent_test, print_name_when_empty_name_is_set) {
 
 TEST_F(BaseComponent_test, print_name_when_shortest_name_is_set) {
   const char* expectStr = "B";
-  BaseComponent cmp = BaseComponent(23, expectStr);
+  const DiscoveryEntityT e = entity(expectStr);
+  BaseComponent cmp = BaseComponent(e);
 
   size_t printedChars = cmp.printTo(Serial);
 
@@ -115,7 +158,8 @@ TEST_F(BaseComponent_test, print_name_when_shortest_name_is_set) {
 
 TEST_F(BaseComponent_test, print_name_when_large_name_is_set) {
   const char* expectStr = "123456789012345678901234567890";
-  BaseComponent cmp = BaseComponent(23, expectStr);
+  const DiscoveryEntityT e = entity(expectStr);
+  BaseComponent cmp = BaseComponent(e);
 
   size_t printedChars = cmp.printTo(Serial);
 
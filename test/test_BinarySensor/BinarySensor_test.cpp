@@ -13,10 +13,16 @@
 using ::testing::_;
 using ::testing::Return;
 
+static const char binarySensorName[] = "BinarySensor";
+
+// Metadata of the sensor, in flash on target.
+static const DiscoveryEntityT binarySensorEntity =
+    BinarySensor::makeEntity(34, binarySensorName);
+
 class BinarySensor_test : public ::testing::Test {
  protected:
   void SetUp() override {
-    pBS = new BinarySensor(34, "BinarySensor");
+    pBS = new BinarySensor(binarySensorEntity);
     strBuf[0] = '\0';
   }
 
@@ -39,8 +45,9 @@ class BinarySensor_test : public ::testing::Test {
 };
 
 TEST(BinarySensor_getStateName_test, battery) {
-  BinarySensor bs =
-      BinarySensor(34, "BinarySensor", BinarySensorDeviceClass::battery);
+  const DiscoveryEntityT entity = BinarySensor::makeEntity(
+      34, binarySensorName, BinarySensorDeviceClass::BATTERY);
+  BinarySensor bs = BinarySensor(entity);
   bs.setState(false);
   EXPECT_STREQ(bs.getStateName(), "normal");
   bs.setState(true);
@@ -48,8 +55,9 @@ TEST(BinarySensor_getStateName_test, battery) {
 }
 
 TEST(BinarySensor_getStateName_test, cold) {
-  BinarySensor bs =
-      BinarySensor(34, "BinarySensor", BinarySensorDeviceClass::cold);
+  const DiscoveryEntityT entity = BinarySensor::makeEntity(
+      34, binarySensorName, BinarySensorDeviceClass::COLD);
+  BinarySensor bs = BinarySensor(entity);
   bs.setState(false);
   EXPECT_STREQ(bs.getStateName(), "normal");
   bs.setState(true);
@@ -57,8 +65,9 @@ TEST(BinarySensor_getStateName_test, cold) {
 }
 
 TEST(BinarySensor_getStateName_test, heat) {
-  BinarySensor bs =
-      BinarySensor(34, "BinarySensor", BinarySensorDeviceClass::heat);
+  const DiscoveryEntityT entity = BinarySensor::makeEntity(
+      34, binarySensorName, BinarySensorDeviceClass::HEAT);
+  BinarySensor bs = BinarySensor(entity);
   bs.setState(false);
   EXPECT_STREQ(bs.getStateName(), "normal");
   bs.setState(true);
@@ -66,8 +75,9 @@ TEST(BinarySensor_getStateName_test, heat) {
 }
 
 TEST(BinarySensor_getStateName_test, connectivity) {
-  BinarySensor bs =
-      BinarySensor(34, "BinarySensor", BinarySensorDeviceClass::connectivity);
+  const DiscoveryEntityT entity = BinarySensor::makeEntity(
+      34, binarySensorName, BinarySensorDeviceClass::CONNECTIVITY);
+  BinarySensor bs = BinarySensor(entity);
   bs.setState(false);
   EXPECT_STREQ(bs.getStateName(), "disconnected");
   bs.setState(true);
@@ -75,8 +85,9 @@ TEST(BinarySensor_getStateName_test, connectivity) {
 }
 
 TEST(BinarySensor_getStateName_test, door) {
-  BinarySensor bs =
-      BinarySensor(34, "BinarySensor", BinarySensorDeviceClass::door);
+  const DiscoveryEntityT entity = BinarySensor::makeEntity(
+      34, binarySensorName, BinarySensorDeviceClass::DOOR);
+  BinarySensor bs = BinarySensor(entity);
   bs.setState(false);
   EXPECT_STREQ(bs.getStateName(), "closed");
   bs.setState(true);
@@ -84,8 +95,9 @@ TEST(BinarySensor_getStateName_test, door) {
 }
 
 TEST(BinarySensor_getStateName_test, garageDoor) {
-  BinarySensor bs =
-      BinarySensor(34, "BinarySensor", BinarySensorDeviceClass::garageDoor);
+  const DiscoveryEntityT entity = BinarySensor::makeEntity(
+      34, binarySensorName, BinarySensorDeviceClass::GARAGE_DOOR);
+  BinarySensor bs = BinarySensor(entity);
   bs.setState(false);
   EXPECT_STREQ(bs.getStateName(), "closed");
   bs.setState(true);
@@ -93,8 +105,9 @@ TEST(BinarySensor_getStateName_test, garageDoor) {
 }
 
 TEST(BinarySensor_getStateName_test, opening) {
-  BinarySensor bs =
-      BinarySensor(34, "BinarySensor", BinarySensorDeviceClass::opening);
+  const DiscoveryEntityT entity = BinarySensor::makeEntity(
+      34, binarySensorName, BinarySensorDeviceClass::OPENING);
+  BinarySensor bs = BinarySensor(entity);
   bs.setState(false);
   EXPECT_STREQ(bs.getStateName(), "closed");
   bs.setState(true);
@@ -102,8 +115,9 @@ TEST(BinarySensor_getStateName_test, opening) {
 }
 
 TEST(BinarySensor_getStateName_test, window) {
-  BinarySensor bs =
-      BinarySensor(34, "BinarySensor", BinarySensorDeviceClass::window);
+  const DiscoveryEntityT entity = BinarySensor::makeEntity(
+      34, binarySensorName, BinarySensorDeviceClass::WINDOW);
+  BinarySensor bs = BinarySensor(entity);
   bs.setState(false);
   EXPECT_STREQ(bs.getStateName(), "closed");
   bs.setState(true);
@@ -111,8 +125,9 @@ TEST(BinarySensor_getStateName_test, window) {
 }
 
 TEST(BinarySensor_getStateName_test, lock) {
-  BinarySensor bs =
-      BinarySensor(34, "BinarySensor", BinarySensorDeviceClass::lock);
+  const DiscoveryEntityT entity = BinarySensor::makeEntity(
+      34, binarySensorName, BinarySensorDeviceClass::LOCK);
+  BinarySensor bs = BinarySensor(entity);
   bs.setState(false);
   EXPECT_STREQ(bs.getStateName(), "locked");
   bs.setState(true);
@@ -120,8 +135,9 @@ TEST(BinarySensor_getStateName_test, lock) {
 }
 
 TEST(BinarySensor_getStateName_test, moisture) {
-  BinarySensor bs =
-      BinarySensor(34, "BinarySensor", BinarySensorDeviceClass::moisture);
+  const DiscoveryEntityT entity = BinarySensor::makeEntity(
+      34, binarySensorName, BinarySensorDeviceClass::MOISTURE);
+  BinarySensor bs = BinarySensor(entity);
   bs.setState(false);
   EXPECT_STREQ(bs.getStateName(), "dry");
   bs.setState(true);
@@ -129,8 +145,9 @@ TEST(BinarySensor_getStateName_test, moisture) {
 }
 
 TEST(BinarySensor_getStateName_test, gas) {
-  BinarySensor bs =
-      BinarySensor(34, "BinarySensor", BinarySensorDeviceClass::gas);
+  const DiscoveryEntityT entity = BinarySensor::makeEntity(
+      34, binarySensorName, BinarySensorDeviceClass::GAS);
+  BinarySensor bs = BinarySensor(entity);
   bs.setState(false);
   EXPECT_STREQ(bs.getStateName(), "clear");
   bs.setState(true);
@@ -138,8 +155,9 @@ TEST(BinarySensor_getStateName_test, gas) {
 }
 
 TEST(BinarySensor_getStateName_test, motion) {
-  BinarySensor bs =
-      BinarySensor(34, "BinarySensor", BinarySensorDeviceClass::motion);
+  const DiscoveryEntityT entity = BinarySensor::makeEntity(
+      34, binarySensorName, BinarySensorDeviceClass::MOTION);
+  BinarySensor bs = BinarySensor(entity);
   bs.setState(false);
   EXPECT_STREQ(bs.getStateName(), "clear");
   bs.setState(true);
@@ -147,8 +165,9 @@ TEST(BinarySensor_getStateName_test, motion) {
 }
 
 TEST(BinarySensor_getStateName_test, occupancy) {
-  BinarySensor bs =
-      BinarySensor(34, "BinarySensor", BinarySensorDeviceClass::occupancy);
+  const DiscoveryEntityT entity = BinarySensor::makeEntity(
+      34, binarySensorName, BinarySensorDeviceClass::OCCUPANCY);
+  BinarySensor bs = BinarySensor(entity);
   bs.setState(false);
   EXPECT_STREQ(bs.getStateName(), "clear");
   bs.setState(true);
@@ -156,8 +175,9 @@ TEST(BinarySensor_getStateName_test, occupancy) {
 }
 
 TEST(BinarySensor_getStateName_test, smoke) {
-  BinarySensor bs =
-      BinarySensor(34, "BinarySensor", BinarySensorDeviceClass::smoke);
+  const DiscoveryEntityT entity = BinarySensor::makeEntity(
+      34, binarySensorName, BinarySensorDeviceClass::SMOKE);
+  BinarySensor bs = BinarySensor(entity);
   bs.setState(false);
   EXPECT_STREQ(bs.getStateName(), "clear");
   bs.setState(true);
@@ -165,8 +185,9 @@ TEST(BinarySensor_getStateName_test, smoke) {
 }
 
 TEST(BinarySensor_getStateName_test, sound) {
-  BinarySensor bs =
-      BinarySensor(34, "BinarySensor", BinarySensorDeviceClass::sound);
+  const DiscoveryEntityT entity = BinarySensor::makeEntity(
+      34, binarySensorName, BinarySensorDeviceClass::SOUND);
+  BinarySensor bs = BinarySensor(entity);
   bs.setState(false);
   EXPECT_STREQ(bs.getStateName(), "clear");
   bs.setState(true);
@@ -174,8 +195,9 @@ TEST(BinarySensor_getStateName_test, sound) {
 }
 
 TEST(BinarySensor_getStateName_test, vibration) {
-  BinarySensor bs =
-      BinarySensor(34, "BinarySensor", BinarySensorDeviceClass::vibration);
+  const DiscoveryEntityT entity = BinarySensor::makeEntity(
+      34, binarySensorName, BinarySensorDeviceClass::VIBRATION);
+  BinarySensor bs = BinarySensor(entity);
   bs.setState(false);
   EXPECT_STREQ(bs.getStateName(), "clear");
   bs.setState(true);
@@ -183,8 +205,9 @@ TEST(BinarySensor_getStateName_test, vibration) {
 }
 
 TEST(BinarySensor_getStateName_test, presence) {
-  BinarySensor bs =
-      BinarySensor(34, "BinarySensor", BinarySensorDeviceClass::presence);
+  const DiscoveryEntityT entity = BinarySensor::makeEntity(
+      34, binarySensorName, BinarySensorDeviceClass::PRESENCE);
+  BinarySensor bs = BinarySensor(entity);
   bs.setState(false);
   EXPECT_STREQ(bs.getStateName(), "away");
   bs.setState(true);
@@ -192,8 +215,9 @@ TEST(BinarySensor_getStateName_test, presence) {
 }
 
 TEST(BinarySensor_getStateName_test, problem) {
-  BinarySensor bs =
-      BinarySensor(34, "BinarySensor", BinarySensorDeviceClass::problem);
+  const DiscoveryEntityT entity = BinarySensor::makeEntity(
+      34, binarySensorName, BinarySensorDeviceClass::PROBLEM);
+  BinarySensor bs = BinarySensor(entity);
   bs.setState(false);
   EXPECT_STREQ(bs.getStateName(), "OK");
   bs.setState(true);
@@ -201,8 +225,9 @@ TEST(BinarySensor_getStateName_test, problem) {
 }
 
 TEST(BinarySensor_getStateName_test, safety) {
-  BinarySensor bs =
-      BinarySensor(34, "BinarySensor", BinarySensorDeviceClass::safety);
+  const DiscoveryEntityT entity = BinarySensor::makeEntity(
+      34, binarySensorName, BinarySensorDeviceClass::SAFETY);
+  BinarySensor bs = BinarySensor(entity);
   bs.setState(false);
   EXPECT_STREQ(bs.getStateName(), "safe");
   bs.setState(true);
@@ -210,8 +235,9 @@ TEST(BinarySensor_getStateName_test, safety) {
 }
 
 TEST(BinarySensor_getStateName_test, none) {
-  BinarySensor bs =
-      BinarySensor(34, "BinarySensor", BinarySensorDeviceClass::none);
+  const DiscoveryEntityT entity = BinarySensor::makeEntity(
+      34, binarySensorName, BinarySensorDeviceClass::NONE);
+  BinarySensor bs = BinarySensor(entity);
   bs.setState(false);
   EXPECT_STREQ(bs.getStateName(), "off");
   bs.setState(true);
@@ -219,8 +245,9 @@ TEST(BinarySensor_getStateName_test, none) {
 }
 
 TEST(BinarySensor_getStateName_test, unknown) {
-  BinarySensor bs = BinarySensor(34, "BinarySensor",
-                                 static_cast<BinarySensorDeviceClass>(255));
+  const DiscoveryEntityT entity = BinarySensor::makeEntity(
+      34, binarySensorName, static_cast<BinarySensorDeviceClass>(255));
+  BinarySensor bs = BinarySensor(entity);
   bs.setState(false);
   EXPECT_STREQ(bs.getStateName(), "off");
   bs.setState(true);
@@ -228,11 +255,11 @@ TEST(BinarySensor_getStateName_test, unknown) {
 }
 
 TEST_F(BinarySensor_test, getComponentType) {
-  EXPECT_EQ(pBS->getComponentType(), BaseComponent::Type::binarySensor);
+  EXPECT_EQ(pBS->getComponentType(), BaseComponent::Type::BINARY_SENSOR);
 }
 
 TEST_F(BinarySensor_test, getDeviceClass) {
-  EXPECT_EQ(pBS->getDeviceClass(), BinarySensorDeviceClass::none);
+  EXPECT_EQ(pBS->getDeviceClass(), BinarySensorDeviceClass::NONE);
 }
 
 TEST_F(BinarySensor_test, getDiscoveryEntity) {
@@ -242,9 +269,9 @@ TEST_F(BinarySensor_test, getDiscoveryEntity) {
 
   EXPECT_EQ(item.entityId, 34);
   EXPECT_EQ(item.componentType,
-            static_cast<uint8_t>(BaseComponent::Type::binarySensor));
+            static_cast<uint8_t>(BaseComponent::Type::BINARY_SENSOR));
   EXPECT_EQ(item.deviceClass,
-            static_cast<uint8_t>(BinarySensorDeviceClass::none));
+            static_cast<uint8_t>(BinarySensorDeviceClass::NONE));
   EXPECT_EQ(item.unit, static_cast<uint8_t>(Unit::Type::none));
   EXPECT_FALSE(item.isSigned);
   EXPECT_EQ(item.sizeCode, 0);
@@ -265,14 +292,14 @@ TEST_F(BinarySensor_test, getValueItem) {
   ValueItemT item;
   pBS->setState(false);
 
-  pBS->getValueItem(&item);
+  pBS->getValueItem(item);
 
   EXPECT_EQ(item.entityId, 34);
   EXPECT_EQ(item.value, 0);
 
   pBS->setState(true);
 
-  pBS->getValueItem(&item);
+  pBS->getValueItem(item);
 
   EXPECT_EQ(item.entityId, 34);
   EXPECT_EQ(item.value, 1);
@@ -338,3 +365,15 @@ TEST_F(BinarySensor_test, isReportDue) {
 
   releaseArduinoMock();
 }
+
+TEST_F(BinarySensor_test, getDiscoveryEntity_min_max_name) {
+  DiscoveryEntityT item;
+
+  pBS->getDiscoveryEntity(item);
+
+  EXPECT_EQ(item.category,
+            static_cast<uint8_t>(BaseComponent::Category::DIAGNOSTIC));
+  EXPECT_EQ(item.minValue, 0);
+  EXPECT_EQ(item.maxValue, 1);
+  EXPECT_STREQ(item.name, binarySensorName);
+}
@@ -0,0 +1,113 @@
+#include "CompactDiscovery.h"
+
+#include <gtest/gtest.h>
+
+static const char carPresenceName[] PROGMEM = "Car Presence Min Stable Time";
+static const char mixedName[] PROGMEM = "Garage Door Sensor";
+
+static DiscoveryEntityT makeEntity(uint8_t entityId, const char* name) {
+  DiscoveryEntityT entity{};
+  entity.entityId = entityId;
+  entity.componentType = 2;
+  entity.unit = 12;
+  entity.sizeCode = 1;
+  entity.maxValue = 60000;
+  entity.name = name;
+  return entity;
+}
+
+TEST(CompactDiscovery_test, dictionary_words_shall_be_one_byte) {
+  uint8_t buf[32];
+
+  EXPECT_EQ(CompactDiscovery::encodeName(carPresenceName, buf, sizeof(buf)),
+            6);
+  EXPECT_EQ(buf[0], 0x80);  // Car
+  EXPECT_EQ(buf[1], 0x8C);  // Presence
+  EXPECT_EQ(buf[5], 0);
+}
+
+TEST(CompactDiscovery_test, name_round_trip) {
+  for (const char* name : {carPresenceName, mixedName}) {
+    uint8_t buf[32];
+    char decoded[32];
+
+    size_t n = CompactDiscovery::encodeName(name, buf, sizeof(buf));
+    ASSERT_GT(n, 0);
+    EXPECT_EQ(CompactDiscovery::decodeName(buf, n, decoded, sizeof(decoded)),
+              n);
+    EXPECT_STREQ(decoded, name);
+  }
+}
+
+TEST(CompactDiscovery_test, words_not_in_dictionary_shall_be_spelled_out) {
+  uint8_t buf[32];
+  const uint8_t expected[] = {'G', 'a', 'r', 'a', 'g', 'e', 0x93,
+                              ' ', 'S', 'e', 'n', 's', 'o', 'r', 0};
+
+  ASSERT_EQ(CompactDiscovery::encodeName(mixedName, buf, sizeof(buf)),
+            sizeof(expected));
+  EXPECT_EQ(memcmp(buf, expected, sizeof(expected)), 0);
+}
+
+TEST(CompactDiscovery_test, encode_shall_not_write_past_length) {
+  uint8_t buf[8];
+  memset(buf, 0xAA, sizeof(buf));
+
+  EXPECT_EQ(CompactDiscovery::encodeName(mixedName, buf, 4), 0);
+  EXPECT_EQ(buf[4], 0xAA);
+}
+
+TEST(CompactDiscovery_test, decode_shall_fail_on_unknown_word) {
+  const uint8_t buf[] = {0xFE, 0};
+  char name[16];
+
+  EXPECT_EQ(CompactDiscovery::decodeName(buf, sizeof(buf), name, sizeof(name)),
+            0);
+}
+
+TEST(CompactDiscovery_test, entity_shall_be_smaller_than_plain) {
+  const DiscoveryEntityT entity = makeEntity(9, carPresenceName);
+  uint8_t plain[64];
+  uint8_t compact[64];
+
+  const size_t n = entity.toByteArray(plain, sizeof(plain));
+  const size_t m =
+      CompactDiscovery::entityToByteArray(entity, compact, sizeof(compact));
+
+  EXPECT_EQ(n, DiscoveryEntityT::HEADER_SIZE + sizeof(carPresenceName));
+  EXPECT_EQ(m, DiscoveryEntityT::HEADER_SIZE + 6);
+  EXPECT_EQ(memcmp(plain, compact, DiscoveryEntityT::HEADER_SIZE), 0);
+}
+
+TEST(CompactDiscovery_test, hash_shall_be_fnv1a_of_plain_entity) {
+  const DiscoveryEntityT entity = makeEntity(9, carPresenceName);
+  uint8_t plain[64];
+  const size_t n = entity.toByteArray(plain, sizeof(plain));
+
+  uint32_t expected = CompactDiscovery::FNV_OFFSET_BASIS;
+  for (size_t i = 0; i < n; i++) {
+    expected = (expected ^ plain[i]) * CompactDiscovery::FNV_PRIME;
+  }
+
+  EXPECT_EQ(CompactDiscovery::hashEntity(CompactDiscovery::FNV_OFFSET_BASIS,
+                                         entity),
+            expected);
+}
+
+TEST(CompactDiscovery_test, hash_shall_change_with_any_field) {
+  const DiscoveryEntityT entity = makeEntity(9, carPresenceName);
+  const uint32_t hash =
+      CompactDiscovery::hashEntity(CompactDiscovery::FNV_OFFSET_BASIS, entity);
+
+  DiscoveryEntityT other = entity;
+  other.maxValue++;
+  EXPECT_NE(
+      CompactDiscovery::hashEntity(CompactDiscovery::FNV_OFFSET_BASIS, other),
+      hash);
+
+  other = entity;
+  other.name = mixedName;
+  EXPECT_NE(
+      CompactDiscovery::hashEntity(CompactDiscovery::FNV_OFFSET_BASIS, other),
+      hash);
+}
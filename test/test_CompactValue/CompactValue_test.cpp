@@ -0,0 +1,225 @@
+#include "CompactValue.h"
+
+#include <gtest/gtest.h>
+
+using CompactValue::Mode;
+
+TEST(CompactValue_test, zigzag) {
+  EXPECT_EQ(CompactValue::zigzag(0), 0);
+  EXPECT_EQ(CompactValue::zigzag(-1), 1);
+  EXPECT_EQ(CompactValue::zigzag(1), 2);
+  EXPECT_EQ(CompactValue::zigzag(-2), 3);
+  EXPECT_EQ(CompactValue::zigzag(INT32_MAX), UINT32_MAX - 1);
+  EXPECT_EQ(CompactValue::zigzag(INT32_MIN), UINT32_MAX);
+
+  for (int32_t v : {0, 1, -1, 63, -64, 1000, -1000, INT32_MAX, INT32_MIN}) {
+    EXPECT_EQ(CompactValue::unzigzag(CompactValue::zigzag(v)), v);
+  }
+}
+
+TEST(CompactValue_test, varint_round_trip) {
+  uint8_t buf[5];
+
+  for (uint32_t v : {0u, 1u, 127u, 128u, 16383u, 16384u, UINT32_MAX}) {
+    uint8_t n = CompactValue::writeVarint(buf, sizeof(buf), v);
+    EXPECT_EQ(n, CompactValue::varintSize(v));
+
+    uint32_t r;
+    EXPECT_EQ(CompactValue::readVarint(buf, n, r), n);
+    EXPECT_EQ(r, v);
+  }
+}
+
+TEST(CompactValue_test, varint_shall_not_write_past_length) {
+  uint8_t buf[2] = {0xAA, 0xAA};
+
+  EXPECT_EQ(CompactValue::writeVarint(buf, 1, 128), 0);
+  EXPECT_EQ(buf[0], 0xAA);
+}
+
+TEST(CompactValue_test, truncated_varint_shall_fail) {
+  const uint8_t buf[] = {0x80, 0x80};
+  uint32_t v;
+
+  EXPECT_EQ(CompactValue::readVarint(buf, sizeof(buf), v), 0);
+}
+
+TEST(CompactValue_test, unregistered_entity_shall_be_sent_raw) {
+  CompactValueEncoder<2> enc;
+  uint8_t buf[8];
+
+  EXPECT_EQ(enc.encode(ValueItemT(5, 0x11223344), buf, sizeof(buf)), 5);
+  EXPECT_EQ(buf[0], 0x85);
+  EXPECT_EQ(buf[1], 0x11);
+  EXPECT_EQ(buf[4], 0x44);
+
+  Mode mode;
+  ValueItemT item;
+  EXPECT_EQ(CompactValue::readItem(buf, 5, mode, item), 5);
+  EXPECT_EQ(mode, Mode::raw);
+  EXPECT_EQ(item, ValueItemT(5, 0x11223344));
+}
+
+TEST(CompactValue_test, unsigned_value_shall_be_plain_varint) {
+  CompactValueEncoder<2> enc;
+  enc.addEntity(3, false);
+  uint8_t buf[8];
+
+  EXPECT_EQ(enc.encode(ValueItemT(3, 100), buf, sizeof(buf)), 2);
+  EXPECT_EQ(buf[0], 0x03);
+  EXPECT_EQ(buf[1], 100);
+}
+
+TEST(CompactValue_test, signed_value_shall_be_zigzag_varint) {
+  CompactValueEncoder<2> enc;
+  enc.addEntity(3, true);
+  uint8_t buf[8];
+
+  // int16_t -5 as sent by Sensor::getValueItem()
+  ValueItemT item(3, static_cast<uint32_t>(static_cast<int16_t>(-5)));
+  EXPECT_EQ(enc.encode(item, buf, sizeof(buf)), 2);
+  EXPECT_EQ(buf[1], 9);
+
+  Mode mode;
+  ValueItemT r;
+  EXPECT_EQ(CompactValue::readItem(buf, 2, mode, r), 2);
+  EXPECT_EQ(mode, Mode::absolute);
+  EXPECT_EQ(CompactValue::unzigzag(r.value), -5);
+}
+
+TEST(CompactValue_test, encode_value_shall_leave_out_entity_id) {
+  CompactValueEncoder<2> enc;
+  enc.addEntity(3, true);
+  uint8_t buf[8];
+  Mode mode;
+
+  EXPECT_EQ(enc.encodeValue(ValueItemT(3, 100), buf, sizeof(buf), mode), 2);
+  EXPECT_EQ(mode, Mode::absolute);
+  EXPECT_EQ(buf[0], 0xC8);
+  EXPECT_EQ(buf[1], 0x01);
+
+  EXPECT_EQ(enc.encodeValue(ValueItemT(4, 1), buf, sizeof(buf), mode), 4);
+  EXPECT_EQ(mode, Mode::raw);
+  EXPECT_EQ(buf[3], 0x01);
+}
+
+TEST(CompactValue_test, large_entity_id_shall_be_escaped) {
+  CompactValueEncoder<2> enc;
+  enc.addEntity(200, false);
+  uint8_t buf[8];
+
+  EXPECT_EQ(enc.encode(ValueItemT(200, 1), buf, sizeof(buf)), 3);
+  EXPECT_EQ(buf[0], 0x3F);
+  EXPECT_EQ(buf[1], 200);
+
+  Mode mode;
+  ValueItemT r;
+  EXPECT_EQ(CompactValue::readItem(buf, 3, mode, r), 3);
+  EXPECT_EQ(r, ValueItemT(200, 1));
+}
+
+TEST(CompactValue_test, delta_only_after_confirmed) {
+  CompactValueEncoder<2> enc;
+  enc.addEntity(1, false);
+  uint8_t buf[8];
+
+  EXPECT_EQ(enc.encode(ValueItemT(1, 5000), buf, sizeof(buf)), 3);
+  enc.setSent(ValueItemT(1, 5000), 7);
+
+  // Not confirmed yet
+  EXPECT_EQ(enc.encode(ValueItemT(1, 5001), buf, sizeof(buf)), 3);
+  EXPECT_EQ(buf[0] >> CompactValue::MODE_SHIFT, 0);
+
+  enc.confirm(7);
+
+  EXPECT_EQ(enc.encode(ValueItemT(1, 4999), buf, sizeof(buf)), 2);
+  EXPECT_EQ(buf[0], 0x41);
+  EXPECT_EQ(CompactValue::unzigzag(buf[1]), -1);
+}
+
+TEST(CompactValue_test, confirm_of_other_msg_shall_not_confirm) {
+  CompactValueEncoder<2> enc;
+  enc.addEntity(1, false);
+  uint8_t buf[8];
+
+  enc.setSent(ValueItemT(1, 5000), 7);
+  enc.confirm(8);
+
+  EXPECT_EQ(enc.encode(ValueItemT(1, 5000), buf, sizeof(buf)), 3);
+}
+
+TEST(CompactValue_test, unconfirmed_resend_shall_disable_delta) {
+  CompactValueEncoder<2> enc;
+  enc.addEntity(1, false);
+  uint8_t buf[8];
+
+  enc.setSent(ValueItemT(1, 5000), 1);
+  enc.confirm(1);
+  enc.setSent(ValueItemT(1, 6000), 2);  // ACK lost, gateway may have it
+
+  EXPECT_EQ(enc.encode(ValueItemT(1, 6000), buf, sizeof(buf)), 3);
+  EXPECT_EQ(buf[0] >> CompactValue::MODE_SHIFT, 0);
+
+  enc.expire(2);
+  EXPECT_EQ(enc.encode(ValueItemT(1, 6000), buf, sizeof(buf)), 3);
+  EXPECT_EQ(buf[0] >> CompactValue::MODE_SHIFT, 0);
+}
+
+TEST(CompactValue_test, invalidate_shall_disable_delta) {
+  CompactValueEncoder<2> enc;
+  enc.addEntity(1, false);
+  uint8_t buf[8];
+
+  enc.setSent(ValueItemT(1, 5000), 1);
+  enc.confirm(1);
+  enc.invalidate();
+
+  EXPECT_EQ(enc.encode(ValueItemT(1, 5000), buf, sizeof(buf)), 3);
+}
+
+TEST(CompactValue_test, eleven_entity_report_shall_be_small) {
+  // Same entities as the garage node.
+  struct {
+    uint8_t entityId;
+    bool isSigned;
+    uint32_t value;
+  } const entities[] = {
+      {0, false, 1},                                        // Cover state
+      {1, true, static_cast<uint32_t>(int16_t{215})},       // Temperature
+      {2, false, 45},                                       // Humidity
+      {3, false, 123},                                      // Distance
+      {4, true, static_cast<uint32_t>(int16_t{-3})},        // Height
+      {5, false, 5000},                                     // Stable time
+      {6, true, static_cast<uint32_t>(int16_t{60})},        // Zero value
+      {7, false, 0},                                        // Presence
+      {8, true, static_cast<uint32_t>(int16_t{180})},       // Low limit
+      {9, true, static_cast<uint32_t>(int16_t{200})},       // High limit
+      {10, false, 10000},                                   // Min stable time
+  };
+  const size_t plainSize = 1 + 11 * ValueItemT::size();
+
+  CompactValueEncoder<12> enc;
+  for (const auto& e : entities) {
+    enc.addEntity(e.entityId, e.isSigned);
+  }
+
+  uint8_t buf[64];
+  size_t absoluteSize = 1;
+  for (const auto& e : entities) {
+    ValueItemT item(e.entityId, e.value);
+    absoluteSize += enc.encode(item, &buf[absoluteSize], 64 - absoluteSize);
+    enc.setSent(item, 1);
+  }
+  enc.confirm(1);
+
+  // Next report with small changes.
+  size_t deltaSize = 1;
+  for (const auto& e : entities) {
+    ValueItemT item(e.entityId, e.value + 1);
+    deltaSize += enc.encode(item, &buf[deltaSize], 64 - deltaSize);
+  }
+
+  EXPECT_EQ(plainSize, 56);
+  EXPECT_LE(absoluteSize, 30);
+  EXPECT_EQ(deltaSize, 1 + 11 * 2);
+}
@@ -15,10 +15,15 @@ using ::testing::_;
 using ::testing::Invoke;
 using ::testing::Return;
 
+static const char coverName[] = "Cover";
+
+// Metadata of the cover, in flash on target.
+static const DiscoveryEntityT coverEntity = Cover::makeEntity(34, coverName);
+
 class Cover_test : public ::testing::Test {
  protected:
   void SetUp() override {
-    pC = new Cover(34, "Cover");
+    pC = new Cover(coverEntity);
     strBuf[0] = '\0';
   }
 
@@ -41,11 +46,11 @@ class Cover_test : public ::testing::Test {
 };
 
 TEST_F(Cover_test, getComponentType) {
-  EXPECT_EQ(pC->getComponentType(), BaseComponent::Type::cover);
+  EXPECT_EQ(pC->getComponentType(), BaseComponent::Type::COVER);
 }
 
 TEST_F(Cover_test, getDeviceClass) {
-  EXPECT_EQ(pC->getDeviceClass(), CoverDeviceClass::none);
+  EXPECT_EQ(pC->getDeviceClass(), CoverDeviceClass::NONE);
 }
 
 TEST_F(Cover_test, getDiscoveryEntity) {
@@ -55,70 +60,71 @@ TEST_F(Cover_test, getDiscoveryEntity) {
 
   EXPECT_EQ(item.entityId, 34);
   EXPECT_EQ(item.componentType,
-            static_cast<uint8_t>(BaseComponent::Type::cover));
-  EXPECT_EQ(item.deviceClass, static_cast<uint8_t>(CoverDeviceClass::none));
+            static_cast<uint8_t>(BaseComponent::Type::COVER));
+  EXPECT_EQ(item.deviceClass, static_cast<uint8_t>(CoverDeviceClass::NONE));
   EXPECT_EQ(item.unit, static_cast<uint8_t>(Unit::Type::none));
   EXPECT_FALSE(item.isSigned);
   EXPECT_EQ(item.sizeCode, 0);
   EXPECT_EQ(item.precision, 0);
+  EXPECT_STREQ(item.name, coverName);
 }
 
 TEST_F(Cover_test, getEntityId) { EXPECT_EQ(pC->getEntityId(), 34); }
 
 TEST_F(Cover_test, getServiceName_of_service_as_arg) {
-  EXPECT_STREQ(pC->getServiceName(CoverService::close), "close");
-  EXPECT_STREQ(pC->getServiceName(CoverService::open), "open");
-  EXPECT_STREQ(pC->getServiceName(CoverService::stop), "stop");
-  EXPECT_STREQ(pC->getServiceName(CoverService::toggle), "toggle");
+  EXPECT_STREQ(pC->getServiceName(CoverService::CLOSE), "close");
+  EXPECT_STREQ(pC->getServiceName(CoverService::OPEN), "open");
+  EXPECT_STREQ(pC->getServiceName(CoverService::STOP), "stop");
+  EXPECT_STREQ(pC->getServiceName(CoverService::TOGGLE), "toggle");
 }
 
 TEST_F(Cover_test, getState) {
-  EXPECT_EQ(pC->getState(), CoverState::closed);
+  EXPECT_EQ(pC->getState(), CoverState::CLOSED);
 
-  pC->setState(CoverState::opening);
-  EXPECT_EQ(pC->getState(), CoverState::opening);
+  pC->setState(CoverState::OPENING);
+  EXPECT_EQ(pC->getState(), CoverState::OPENING);
 
-  pC->setState(CoverState::open);
-  EXPECT_EQ(pC->getState(), CoverState::open);
+  pC->setState(CoverState::OPEN);
+  EXPECT_EQ(pC->getState(), CoverState::OPEN);
 
-  pC->setState(CoverState::closing);
-  EXPECT_EQ(pC->getState(), CoverState::closing);
+  pC->setState(CoverState::CLOSING);
+  EXPECT_EQ(pC->getState(), CoverState::CLOSING);
 }
 
 TEST_F(Cover_test, getStateName_of_current_state) {
   EXPECT_STREQ(pC->getStateName(), "closed");
 
-  pC->setState(CoverState::opening);
+  pC->setState(CoverState::OPENING);
   EXPECT_STREQ(pC->getStateName(), "opening");
 
-  pC->setState(CoverState::open);
+  pC->setState(CoverState::OPEN);
   EXPECT_STREQ(pC->getStateName(), "open");
 
-  pC->setState(CoverState::closing);
+  pC->setState(CoverState::CLOSING);
   EXPECT_STREQ(pC->getStateName(), "closing");
 }
 
 TEST_F(Cover_test, getValueItem) {
   ValueItemT item;
-  pC->setState(CoverState::closed);
-  pC->getValueItem(&item);
+  pC->setState(CoverState::CLOSED);
+  pC->getValueItem(item);
   EXPECT_EQ(item.entityId, 34);
-  EXPECT_EQ(item.value, static_cast<uint32_t>(CoverState::closed));
+  EXPECT_EQ(item.value, static_cast<uint32_t>(CoverState::CLOSED));
 
-  pC->setState(CoverState::opening);
-  pC->getValueItem(&item);
+  pC->setState(CoverState::OPENING);
+  pC->getValueItem(item);
   EXPECT_EQ(item.entityId, 34);
-  EXPECT_EQ(item.value, static_cast<uint32_t>(CoverState::opening));
+  EXPECT_EQ(item.value, static_cast<uint32_t>(CoverState::OPENING));
 
-  pC->setState(CoverState::open);
-  pC->getValueItem(&item);
+  pC->setState(CoverState::OPEN);
+  pC->getValueItem(item);
   EXPECT_EQ(item.entityId, 34);
-  EXPECT_EQ(item.value, static_cast<uint32_t>(CoverState::open));
+  EXPECT_EQ(item.value, static_cast<uint32_t>(CoverState::OPEN));
 
-  pC->setState(CoverState::closing);
-  pC->getValueItem(&item);
+  pC->setState(CoverState::CLOSING);
+  pC->getValueItem(item);
   EXPECT_EQ(item.entityId, 34);
-  EXPECT_EQ(item.value, static_cast<uint32_t>(CoverState::closing));
+  EXPECT_EQ(item.value, static_cast<uint32_t>(CoverState::CLOSING));
 }
 
 TEST_F(Cover_test, setReported_isDiffLastReportedState_timeSinceLastReport) {
@@ -131,7 +137,7 @@ TEST_F(Cover_test, setReported_isDiffLastReportedState_timeSinceLastReport) {
   pC->setReported();
   EXPECT_EQ(pC->isDiffLastReportedState(), false);
   EXPECT_EQ(pC->timeSinceLastReport(), 10000 - 0);
-  pC->setState(CoverState::opening);
+  pC->setState(CoverState::OPENING);
   EXPECT_EQ(pC->isDiffLastReportedState(), true);
   pC->setReported();
   EXPECT_EQ(pC->timeSinceLastReport(), 35999 - 20500);
@@ -140,7 +146,7 @@ TEST_F(Cover_test, setReported_isDiffLastReportedState_timeSinceLastReport) {
 
 TEST_F(Cover_test, print_when_state_is_closed) {
   const char* expectStr = "Cover=closed";
-  pC->setState(CoverState::closed);
+  pC->setState(CoverState::CLOSED);
 
   size_t printedChars = pC->printTo(Serial);
 
@@ -151,7 +157,7 @@ TEST_F(Cover_test, print_when_state_is_closed) {
 
 TEST_F(Cover_test, print_when_state_is_opening) {
   const char* expectStr = "Cover=opening";
-  pC->setState(CoverState::opening);
+  pC->setState(CoverState::OPENING);
 
   size_t printedChars = pC->printTo(Serial);
 
@@ -162,7 +168,7 @@ TEST_F(Cover_test, print_when_state_is_opening) {
 
 TEST_F(Cover_test, print_when_state_is_open) {
   const char* expectStr = "Cover=open";
-  pC->setState(CoverState::open);
+  pC->setState(CoverState::OPEN);
 
   size_t printedChars = pC->printTo(Serial);
 
@@ -173,7 +179,7 @@ TEST_F(Cover_test, print_when_state_is_open) {
 
 TEST_F(Cover_test, print_when_state_is_closing) {
   const char* expectStr = "Cover=closing";
-  pC->setState(CoverState::closing);
+  pC->setState(CoverState::CLOSING);
 
   size_t printedChars = pC->printTo(Serial);
 
@@ -184,10 +190,10 @@ TEST_F(Cover_test, print_when_state_is_closing) {
 
 TEST_F(Cover_test, print_when_state_is_closed_and_service_open_is_called) {
   const char* expectStr = "Cover: service=open state=closed";
-  pC->setState(CoverState::closed);
+  pC->setState(CoverState::CLOSED);
 
   size_t printedChars =
-      pC->printTo(Serial, static_cast<uint8_t>(CoverService::open));
+      pC->printTo(Serial, static_cast<uint8_t>(CoverService::OPEN));
 
   bufSerReadStr();
   EXPECT_STREQ(strBuf, expectStr);
@@ -196,10 +202,10 @@ TEST_F(Cover_test, print_when_state_is_closed_and_service_open_is_called) {
 
 TEST_F(Cover_test, print_when_state_is_open_and_service_close_is_called) {
   const char* expectStr = "Cover: service=close state=open";
-  pC->setState(CoverState::open);
+  pC->setState(CoverState::OPEN);
 
   size_t printedChars =
-      pC->printTo(Serial, static_cast<uint8_t>(CoverService::close));
+      pC->printTo(Serial, static_cast<uint8_t>(CoverService::CLOSE));
 
   bufSerReadStr();
   EXPECT_STREQ(strBuf, expectStr);
@@ -208,10 +214,10 @@ TEST_F(Cover_test, print_when_state_is_open_and_service_close_is_called) {
 
 TEST_F(Cover_test, print_when_state_is_opening_and_service_stop_is_called) {
   const char* expectStr = "Cover: service=stop state=opening";
-  pC->setState(CoverState::opening);
+  pC->setState(CoverState::OPENING);
 
   size_t printedChars =
-      pC->printTo(Serial, static_cast<uint8_t>(CoverService::stop));
+      pC->printTo(Serial, static_cast<uint8_t>(CoverService::STOP));
 
   bufSerReadStr();
   EXPECT_STREQ(strBuf, expectStr);
@@ -220,10 +226,10 @@ TEST_F(Cover_test, print_when_state_is_opening_and_service_stop_is_called) {
 
 TEST_F(Cover_test, print_when_state_is_closing_and_service_toggle_is_called) {
   const char* expectStr = "Cover: service=toggle state=closing";
-  pC->setState(CoverState::closing);
+  pC->setState(CoverState::CLOSING);
 
   size_t printedChars =
-      pC->printTo(Serial, static_cast<uint8_t>(CoverService::toggle));
+      pC->printTo(Serial, static_cast<uint8_t>(CoverService::TOGGLE));
 
   bufSerReadStr();
   EXPECT_STREQ(strBuf, expectStr);
@@ -232,10 +238,10 @@ TEST_F(Cover_test, print_when_state_is_closing_and_service_toggle_is_called) {
 
 TEST_F(Cover_test, print_when_state_is_closed_and_service_unknown_is_called) {
   const char* expectStr = "Cover: service=unknown state=closed";
-  pC->setState(CoverState::closed);
+  pC->setState(CoverState::CLOSED);
 
   size_t printedChars =
-      pC->printTo(Serial, static_cast<uint8_t>(CoverService::unknown));
+      pC->printTo(Serial, static_cast<uint8_t>(CoverService::UNKNOWN));
 
   bufSerReadStr();
   EXPECT_STREQ(strBuf, expectStr);
@@ -243,12 +249,12 @@ TEST_F(Cover_test, print_when_state_is_closed_and_service_unknown_is_called) {
 }
 
 TEST_F(Cover_test, serviceDecode) {
-  EXPECT_EQ(pC->serviceDecode(0), CoverService::open);
-  EXPECT_EQ(pC->serviceDecode(1), CoverService::close);
-  EXPECT_EQ(pC->serviceDecode(2), CoverService::stop);
-  EXPECT_EQ(pC->serviceDecode(3), CoverService::toggle);
-  EXPECT_EQ(pC->serviceDecode(4), CoverService::unknown);
-  EXPECT_EQ(pC->serviceDecode(5), CoverService::unknown);
+  EXPECT_EQ(pC->serviceDecode(0), CoverService::OPEN);
+  EXPECT_EQ(pC->serviceDecode(1), CoverService::CLOSE);
+  EXPECT_EQ(pC->serviceDecode(2), CoverService::STOP);
+  EXPECT_EQ(pC->serviceDecode(3), CoverService::TOGGLE);
+  EXPECT_EQ(pC->serviceDecode(4), CoverService::UNKNOWN);
+  EXPECT_EQ(pC->serviceDecode(5), CoverService::UNKNOWN);
 }
 
 TEST_F(Cover_test, isReportDue) {
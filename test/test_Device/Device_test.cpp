@@ -2,6 +2,8 @@
 
 #include <gtest/gtest.h>
 
+#include <vector>
+
 #include "BufferSerial.h"
 #include "Component.h"
 #include "Print.h"
@@ -9,26 +11,34 @@
 // Include source implementation
 #include "../../src/Device.cpp"
 
+static uint8_t* updateLog;  // Entity ids in update order
+
 class ComponentChild : public IComponent {
  public:
-  explicit ComponentChild(uint8_t entityId) : mEntityId{entityId} {}
+  explicit ComponentChild(uint8_t entityId,
+                          uint32_t updateInterval = UPDATE_INTERVAL_DEFAULT_MS)
+      : mEntityId{entityId}, mUpdateInterval{updateInterval} {}
 
   void callService(uint8_t service) final { (void)service; }
 
-  uint8_t getConfigItemValues(ConfigItemValueT* items,
-                              uint8_t length) const final {
-    (void)items;
-    (void)length;
-    return 0;
+  bool getDiscoveryEntity(DiscoveryEntityT& item) const final {
+    (void)item;
+    return false;
   }
 
-  void getDiscoveryItem(DiscoveryItemT* item) const final { (void)item; }
-
   uint8_t getEntityId() const final { return mEntityId; }
 
-  void getValueItem(ValueItemT& item) const final { (void)item; }
+  void getValueItem(ValueItemT& item) const final {
+    item.entityId = mEntityId;
+    item.value = mValue;
+  }
 
-  bool isReportDue() const final { return false; }
+  bool setValueItem(const ValueItemT& item) final {
+    (void)item;
+    return false;
+  }
+
+  bool isReportDue() const final { return mIsReportDue; }
 
   void loadConfigValues() final {}
 
@@ -40,19 +50,41 @@ class ComponentChild : public IComponent {
     return 0;
   }
 
-  bool setConfigItemValues(const ConfigItemValueT* items,
-                           uint8_t length) final {
-    (void)items;
-    (void)length;
+  void setReported(ReportReason reason) final {
+    mIsReportDue = false;
+    mReportReason = reason;
+  }
+
+  bool update() final {
+    mUpdateCount++;
+    mIsReportDue = mReportOnUpdate;
+    if (updateLog) {
+      *updateLog++ = mEntityId;
+    }
+    if (mUpstream) {
+      ValueItemT item;
+      mUpstream->getValueItem(item);
+      mValue = item.value + 1;
+    }
     return false;
   }
 
-  void setReported() final {}
+  uint32_t getUpdateInterval() const final { return mUpdateInterval; }
+
+  const IComponent* getUpstream(uint8_t idx) const final {
+    return idx == 0 ? mUpstream : nullptr;
+  }
 
-  bool update() final { return false; }
+  uint8_t mUpdateCount{};
+  uint32_t mValue{};
+  const IComponent* mUpstream{};
+  bool mIsReportDue{};
+  bool mReportOnUpdate{};
+  ReportReason mReportReason{ReportReason::request};
 
  private:
   const uint8_t mEntityId;
+  const uint32_t mUpdateInterval;
 };
 
 class Device_test : public ::testing::Test {
@@ -102,8 +134,38 @@ TEST_F(Device_test, getComponentByEntityId) {
   EXPECT_EQ(n.getComponentByEntityId(10), &c0);
 }
 
+TEST_F(Device_test, entity_ids_shall_be_valid) {
+  EXPECT_TRUE(n.isEntityIdsValid());
+}
+
+TEST(DeviceIndex_test, duplicate_entity_id_shall_be_invalid) {
+  ComponentChild c0 = ComponentChild(4);
+  ComponentChild c1 = ComponentChild(5);
+  ComponentChild c2 = ComponentChild(4);
+  IComponent* components[] = {&c0, &c1, &c2};
+  Device device = Device(components, 3);
+
+  EXPECT_FALSE(device.isEntityIdsValid());
+  EXPECT_EQ(device.getInvalidEntityId(), 4);
+  EXPECT_EQ(device.getComponentByEntityId(4), &c0);  // First one
+  EXPECT_EQ(device.getComponentByEntityId(5), &c1);
+}
+
+TEST(DeviceIndex_test, out_of_range_entity_id_shall_be_invalid) {
+  ComponentChild c0 = ComponentChild(DEVICE_MAX_ENTITY_ID);
+  ComponentChild c1 = ComponentChild(DEVICE_MAX_ENTITY_ID + 1);
+  IComponent* components[] = {&c0, &c1};
+  Device device = Device(components, 2);
+
+  EXPECT_FALSE(device.isEntityIdsValid());
+  EXPECT_EQ(device.getInvalidEntityId(), DEVICE_MAX_ENTITY_ID + 1);
+  EXPECT_EQ(device.getComponentByEntityId(DEVICE_MAX_ENTITY_ID), &c0);
+  EXPECT_EQ(device.getComponentByEntityId(DEVICE_MAX_ENTITY_ID + 1), nullptr);
+  EXPECT_EQ(device.getComponentByEntityId(UINT8_MAX), nullptr);
+}
+
 TEST_F(DevicePrint_test, print) {
-  const char* expectedStr = "10, 11";
+  const char* expectedStr = "10:10, 11:11\r\n";  // Entity id and value
 
   size_t len = n.printTo(*pSerial);
   bufSerReadStr();
@@ -111,3 +173,245 @@ TEST_F(DevicePrint_test, print) {
   EXPECT_STREQ(strBuf, expectedStr);
   EXPECT_EQ(len, strlen(expectedStr));
 }
+
+TEST(DeviceUpdate_test, components_shall_update_at_own_interval) {
+  ComponentChild fast = ComponentChild(1, 1000);
+  ComponentChild slow = ComponentChild(2, 60000);
+  IComponent* components[] = {&fast, &slow};
+  Device device = Device(components, 2);
+
+  EXPECT_EQ(device.update(5000), 2);  // All are due at first update
+  EXPECT_EQ(device.getTimeToNextUpdate(5000), 1000);
+  EXPECT_EQ(device.update(5999), 0);
+  EXPECT_EQ(device.update(6000), 1);
+
+  for (uint32_t t = 7000; t < 65000; t += 1000) {
+    device.update(t);
+  }
+  EXPECT_EQ(fast.mUpdateCount, 60);
+  EXPECT_EQ(slow.mUpdateCount, 1);
+
+  EXPECT_EQ(device.getTimeToNextUpdate(64500), 500);
+  EXPECT_EQ(device.update(65000), 2);
+  EXPECT_EQ(slow.mUpdateCount, 2);
+}
+
+TEST(DeviceUpdate_test, update_shall_handle_millis_wrap_around) {
+  ComponentChild c = ComponentChild(1, 1000);
+  IComponent* components[] = {&c};
+  Device device = Device(components, 1);
+
+  EXPECT_EQ(device.update(UINT32_MAX - 499), 1);
+  EXPECT_EQ(device.getTimeToNextUpdate(UINT32_MAX), 501);
+  EXPECT_EQ(device.update(499), 0);
+  EXPECT_EQ(device.update(500), 1);
+}
+
+TEST(DeviceUpdate_test, upstream_shall_update_first) {
+  ComponentChild presence = ComponentChild(3);
+  ComponentChild height = ComponentChild(2);
+  ComponentChild distance = ComponentChild(1);
+  presence.mUpstream = &height;
+  height.mUpstream = &distance;
+  IComponent* components[] = {&presence, &height, &distance};
+  Device device = Device(components, 3);
+
+  uint8_t log[3] = {};
+  updateLog = log;
+  distance.mValue = 10;
+
+  EXPECT_EQ(device.update(0), 3);
+  updateLog = nullptr;
+  EXPECT_EQ(log[0], 1);
+  EXPECT_EQ(log[1], 2);
+  EXPECT_EQ(log[2], 3);
+  EXPECT_EQ(presence.mValue, 12);
+}
+
+TEST(DeviceUpdate_test, downstream_shall_update_only_on_change) {
+  ComponentChild distance = ComponentChild(1, 1000);
+  ComponentChild height = ComponentChild(2, 60000);
+  height.mUpstream = &distance;
+  IComponent* components[] = {&distance, &height};
+  Device device = Device(components, 2);
+
+  EXPECT_EQ(device.update(0), 2);
+  EXPECT_EQ(device.update(1000), 1);  // Distance unchanged
+  EXPECT_EQ(height.mUpdateCount, 1);
+
+  distance.mValue = 5;  // As if measured, or set by setValueItem()
+  EXPECT_EQ(device.update(1500), 1);
+  EXPECT_EQ(height.mUpdateCount, 2);
+  EXPECT_EQ(height.mValue, 6);
+
+  EXPECT_EQ(device.update(2000), 1);
+  EXPECT_EQ(height.mUpdateCount, 2);
+
+  EXPECT_EQ(device.update(61500), 2);  // Own interval
+  EXPECT_EQ(height.mUpdateCount, 3);
+}
+
+TEST(DeviceUpdate_test, linked_components_between_others_shall_update) {
+  ComponentChild other0 = ComponentChild(1, 60000);
+  ComponentChild presence = ComponentChild(2, 60000);
+  ComponentChild other1 = ComponentChild(3, 60000);
+  ComponentChild height = ComponentChild(4, 60000);
+  ComponentChild distance = ComponentChild(5, 1000);
+  presence.mUpstream = &height;
+  height.mUpstream = &distance;
+  IComponent* components[] = {&other0, &presence, &other1, &height, &distance};
+  Device device = Device(components, 5);
+
+  EXPECT_EQ(device.update(0), 5);
+  EXPECT_EQ(presence.mValue, 2);
+
+  distance.mValue = 10;
+  EXPECT_EQ(device.update(1000), 3);
+  EXPECT_EQ(height.mValue, 11);
+  EXPECT_EQ(presence.mValue, 12);
+  EXPECT_EQ(other0.mUpdateCount, 1);
+  EXPECT_EQ(other1.mUpdateCount, 1);
+}
+
+#ifndef SKIP_DEATH_TESTS
+TEST(DeviceUpdate_test, too_many_downstream_components_shall_assert) {
+  ComponentChild upstream = ComponentChild(0);
+  ComponentChild d1 = ComponentChild(1);
+  ComponentChild d2 = ComponentChild(2);
+  ComponentChild d3 = ComponentChild(3);
+  ComponentChild d4 = ComponentChild(4);
+  ComponentChild d5 = ComponentChild(5);
+  ComponentChild* downstream[] = {&d1, &d2, &d3, &d4, &d5};
+  static_assert(sizeof(downstream) / sizeof(downstream[0]) >
+                    DEVICE_MAX_DOWNSTREAMS,
+                "One more than fits");
+  for (ComponentChild* d : downstream) {
+    d->mUpstream = &upstream;
+  }
+  IComponent* components[] = {&upstream, &d1, &d2, &d3, &d4, &d5};
+  Device device = Device(components, 6);
+
+  EXPECT_DEATH({ device.update(0); }, "");
+}
+#endif
+
+TEST(DeviceUpdate_test, setUpdateDue_shall_update_before_interval) {
+  ComponentChild c0 = ComponentChild(1, 1000);
+  ComponentChild c1 = ComponentChild(2, 1000);
+  IComponent* components[] = {&c0, &c1};
+  Device device = Device(components, 2);
+
+  EXPECT_EQ(device.update(0), 2);
+  device.setUpdateDue(&c1);
+  EXPECT_EQ(device.getTimeToNextUpdate(10), 0);
+  EXPECT_EQ(device.update(10), 1);
+  EXPECT_EQ(c1.mUpdateCount, 2);
+  EXPECT_EQ(device.getTimeToNextUpdate(10), 990);
+}
+
+static ValueItemT queued[4];
+static uint8_t queuedCount;
+static uint8_t queueRoom;
+
+static bool queueValue(const ValueItemT& item) {
+  if (queueRoom == 0) {
+    return false;
+  }
+  queueRoom--;
+  queued[queuedCount++] = item;
+  return true;
+}
+
+class DeviceReport_test : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    queuedCount = 0;
+    queueRoom = 4;
+    c1.mReportOnUpdate = true;
+  }
+
+  ComponentChild c0 = ComponentChild(1, 1000);
+  ComponentChild c1 = ComponentChild(2, 1000);
+  ComponentChild c2 = ComponentChild(3, 60000);
+  IComponent* components[3] = {&c0, &c1, &c2};
+  Device device = Device(components, 3);
+};
+
+TEST_F(DeviceReport_test, only_due_components_shall_be_reported) {
+  EXPECT_FALSE(device.isReportDue());
+  device.update(0);
+  EXPECT_TRUE(device.isReportDue());
+
+  EXPECT_EQ(device.report(queueValue), 1);
+
+  EXPECT_EQ(queuedCount, 1);
+  EXPECT_EQ(queued[0].entityId, 2);
+  EXPECT_FALSE(c1.isReportDue());
+  EXPECT_EQ(c1.mReportReason, ReportReason::due);
+  EXPECT_FALSE(device.isReportDue());
+}
+
+TEST_F(DeviceReport_test, report_set_shall_only_grow_by_updated_components) {
+  device.update(0);
+  device.report(queueValue);
+
+  c2.mReportOnUpdate = true;  // Not updated until 60000
+  device.update(1000);
+  EXPECT_EQ(device.report(queueValue), 1);
+  EXPECT_EQ(queued[1].entityId, 2);
+
+  device.update(60000);
+  EXPECT_EQ(device.report(queueValue), 2);
+  EXPECT_EQ(queued[2].entityId, 2);
+  EXPECT_EQ(queued[3].entityId, 3);
+}
+
+TEST_F(DeviceReport_test, full_queue_shall_keep_component_in_report_set) {
+  device.update(0);
+  queueRoom = 0;
+
+  EXPECT_EQ(device.report(queueValue), 0);
+  EXPECT_TRUE(device.isReportDue());
+  EXPECT_TRUE(c1.isReportDue());
+
+  queueRoom = 1;
+  EXPECT_EQ(device.report(queueValue), 1);
+  EXPECT_FALSE(device.isReportDue());
+}
+
+TEST_F(DeviceReport_test, component_reported_elsewhere_shall_be_dropped) {
+  device.update(0);
+  c1.setReported(ReportReason::request);  // E.g. all values on request
+
+  EXPECT_EQ(device.report(queueValue), 0);
+  EXPECT_EQ(queuedCount, 0);
+  EXPECT_FALSE(device.isReportDue());
+}
+
+TEST(DeviceCapacity_test, components_above_32_shall_be_updated_and_reported) {
+  const uint8_t last = DEVICE_MAX_COMPONENTS - 1;
+  std::vector<ComponentChild> c;
+  c.reserve(DEVICE_MAX_COMPONENTS);
+  IComponent* components[DEVICE_MAX_COMPONENTS];
+  for (uint8_t i = 0; i < DEVICE_MAX_COMPONENTS; i++) {
+    c.emplace_back(i);
+    components[i] = &c[i];
+  }
+  Device device = Device(components, DEVICE_MAX_COMPONENTS);
+
+  EXPECT_TRUE(device.isEntityIdsValid());
+  EXPECT_EQ(device.getComponentByEntityId(last), &c[last]);
+
+  EXPECT_EQ(device.update(0), DEVICE_MAX_COMPONENTS);
+  device.setUpdateDue(&c[last - 3]);
+  EXPECT_EQ(device.update(10), 1);
+  EXPECT_EQ(c[last - 3].mUpdateCount, 2);
+
+  queuedCount = 0;
+  queueRoom = 1;
+  c[last].mReportOnUpdate = true;
+  device.setUpdateDue(&c[last]);
+  device.update(20);
+  EXPECT_EQ(device.report(queueValue), 1);
+  EXPECT_EQ(queued[0].entityId, last);
+}
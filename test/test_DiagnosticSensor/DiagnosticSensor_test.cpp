@@ -0,0 +1,70 @@
+#include "DiagnosticSensor.h"
+
+#include <gtest/gtest.h>
+
+#include "Arduino.h"
+#include "BufferSerial.h"
+#include "Unit.h"
+
+using ::testing::Return;
+
+static uint32_t fakeValue;
+
+static uint32_t getFakeValue() { return fakeValue; }
+
+static const DiscoveryEntityT entity = DiagnosticSensor<uint32_t>::makeEntity(
+    13, "Power Down Time", SensorDeviceClass::DURATION, Unit::Type::s);
+
+class DiagnosticSensor_test : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    pArduinoMock = arduinoMockInstance();
+    fakeValue = 0;
+  }
+
+  void TearDown() override { releaseArduinoMock(); }
+
+  ArduinoMock* pArduinoMock;
+  DiagnosticSensor<uint32_t> ds =
+      DiagnosticSensor<uint32_t>(entity, getFakeValue);
+};
+
+TEST_F(DiagnosticSensor_test, getDiscoveryEntity) {
+  DiscoveryEntityT item;
+
+  EXPECT_TRUE(ds.getDiscoveryEntity(item));
+  EXPECT_EQ(item.entityId, 13);
+  EXPECT_EQ(item.componentType,
+            static_cast<uint8_t>(BaseComponent::Type::SENSOR));
+  EXPECT_EQ(item.deviceClass,
+            static_cast<uint8_t>(SensorDeviceClass::DURATION));
+  EXPECT_EQ(item.category,
+            static_cast<uint8_t>(BaseComponent::Category::DIAGNOSTIC));
+  EXPECT_EQ(item.unit, static_cast<uint8_t>(Unit::Type::s));
+  EXPECT_EQ(item.sizeCode, 2);
+  EXPECT_FALSE(item.isSigned);
+}
+
+TEST_F(DiagnosticSensor_test, update_shall_read_value_and_report) {
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(Return(1000));
+  fakeValue = 12345;
+
+  EXPECT_TRUE(ds.update());
+  EXPECT_TRUE(ds.isReportDue());
+
+  ValueItemT item;
+  ds.getValueItem(item);
+  EXPECT_EQ(item, ValueItemT(13, 12345));
+
+  ds.setReported(ReportReason::due);
+  EXPECT_FALSE(ds.isReportDue());
+}
+
+TEST_F(DiagnosticSensor_test, setValueItem_shall_fail) {
+  EXPECT_FALSE(ds.setValueItem(ValueItemT(13, 1)));
+}
+
+TEST_F(DiagnosticSensor_test, update_interval_shall_be_report_interval) {
+  EXPECT_EQ(ds.getUpdateInterval(),
+            DiagnosticSensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT * 1000UL);
+}
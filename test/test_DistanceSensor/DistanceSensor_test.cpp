@@ -11,23 +11,38 @@
 // Include source implementation
 #include "../../src/DistanceSensor.cpp"
 
-#define SONAR_TRIGGER_PIN 7
-#define SONAR_ECHO_PIN 6
-#define SONAR_MAX_DISTANCE_CM 300
-
 using ::testing::Return;
+using ::testing::ReturnPointee;
 
 using DistanceT = int16_t;  // cm
 
+static const char distanceSensorName[] = "DistanceSensor";
+
+// Metadata of the sensor and its report config, in flash on target.
+static const DiscoveryEntityT entity =
+    DistanceSensor::makeEntity(7, distanceSensorName);
+
+static const DiscoveryEntityT reportEntities[] = {
+    ReportConfig::makeHysteresisEntity(22, "Distance Hysteresis",
+                                       NumberDeviceClass::DISTANCE,
+                                       Unit::Type::cm, 0, MAX_SENSOR_DISTANCE),
+    ReportConfig::makeMinIntervalEntity(18, "Distance Min Interval"),
+    ReportConfig::makeMaxIntervalEntity(30, "Distance Max Interval"),
+    ReportConfig::makeBurstEntity(34, "Distance Burst"),
+    ReportConfig::makeRefillTimeEntity(38, "Distance Refill Time"),
+    ReportConfig::makeHysteresisPctEntity(26, "Distance Relative Hysteresis"),
+};
+
 class DistanceSensor_test : public ::testing::Test {
  protected:
   void SetUp() override {
     pArduinoMock = arduinoMockInstance();
+    EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(ReturnPointee(&now));
     pSonarMock = new NewPingMock();
     strBuf[0] = '\0';
     eeprom_clear();
 
-    pDs = new DistanceSensor(7, "DistanceSensor", *pSonarMock);
+    pDs = new DistanceSensor(entity, *pSonarMock, config);
   }
 
   void TearDown() override {
@@ -48,6 +63,10 @@ class DistanceSensor_test : public ::testing::Test {
     strBuf[i] = '\0';
   }
 
+  // Without a rate limit: hysteresis 10 cm and max interval 300 s.
+  ReportConfig config{0x00, reportEntities, {10, 0, 0, 300, 0, 60}};
+
+  uint32_t now{};
   char strBuf[256];
   ArduinoMock* pArduinoMock;
   NewPingMock* pSonarMock;
@@ -58,65 +77,23 @@ TEST_F(DistanceSensor_test, callService_shall_do_nothing) {
   pDs->callService(0);
 }
 
-TEST_F(DistanceSensor_test, getConfigItemValues) {
-  ConfigItemValueT items[3];
-
-  EXPECT_EQ(pDs->getConfigItemValues(items, sizeof(items) / sizeof(items[0])),
-            3);
-
-  EXPECT_EQ(items[0].configId, 0);
-  EXPECT_EQ(items[0].value,
-            DistanceSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT);
+TEST_F(DistanceSensor_test, getDiscoveryEntity) {
+  DiscoveryEntityT item;
 
-  EXPECT_EQ(items[1].configId, 1);
-  EXPECT_EQ(items[1].value,
-            DistanceSensorConstants::CONFIG_MEASURE_INTERVAL_DEFAULT);
+  EXPECT_TRUE(pDs->getDiscoveryEntity(item));
 
-  EXPECT_EQ(items[2].configId, 2);
-  EXPECT_EQ(items[2].value,
-            DistanceSensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT);
-}
-
-TEST_F(DistanceSensor_test, DISABLED_getDiscoveryItem) {
-  DiscoveryItemT item;
-
-  pDs->getDiscoveryItem(&item);
-
-  EXPECT_EQ(item.entity.entityId, 7);
-  EXPECT_EQ(item.entity.componentType,
-            static_cast<uint8_t>(BaseComponent::Type::sensor));
-  EXPECT_EQ(item.entity.deviceClass,
-            static_cast<uint8_t>(SensorDeviceClass::distance));
-  EXPECT_EQ(item.entity.unit, static_cast<uint8_t>(Unit::Type::cm));
-  EXPECT_TRUE(item.entity.isSigned);
-  EXPECT_EQ(item.entity.sizeCode, sizeof(DistanceT) / 2);
-  EXPECT_EQ(item.entity.precision, 0);
-
-  EXPECT_EQ(item.numberOfConfigItems, 3);
-
-  EXPECT_EQ(item.configItems[0].configId, 0);
-  EXPECT_EQ(item.configItems[0].unit, static_cast<uint8_t>(Unit::Type::cm));
-  EXPECT_FALSE(item.configItems[0].isSigned);
-  EXPECT_EQ(item.configItems[0].sizeCode, sizeof(uint16_t) / 2);
-  EXPECT_EQ(item.configItems[0].precision, 0);
-  EXPECT_EQ(item.configItems[0].minValue, 0);
-  EXPECT_EQ(item.configItems[0].maxValue, MAX_SENSOR_DISTANCE);
-
-  EXPECT_EQ(item.configItems[1].configId, 1);
-  EXPECT_EQ(item.configItems[1].unit, static_cast<uint8_t>(Unit::Type::s));
-  EXPECT_FALSE(item.configItems[1].isSigned);
-  EXPECT_EQ(item.configItems[1].sizeCode, sizeof(uint16_t) / 2);
-  EXPECT_EQ(item.configItems[1].precision, 0);
-  EXPECT_EQ(item.configItems[1].minValue, 0);
-  EXPECT_EQ(item.configItems[1].maxValue, Util::SECONDS_PER_HOUR);
-
-  EXPECT_EQ(item.configItems[2].configId, 2);
-  EXPECT_EQ(item.configItems[2].unit, static_cast<uint8_t>(Unit::Type::s));
-  EXPECT_FALSE(item.configItems[2].isSigned);
-  EXPECT_EQ(item.configItems[2].sizeCode, sizeof(uint16_t) / 2);
-  EXPECT_EQ(item.configItems[2].precision, 0);
-  EXPECT_EQ(item.configItems[2].minValue, 0);
-  EXPECT_EQ(item.configItems[2].maxValue, Util::SECONDS_PER_TWELVE_HOURS);
+  EXPECT_EQ(item.entityId, 7);
+  EXPECT_EQ(item.componentType,
+            static_cast<uint8_t>(BaseComponent::Type::SENSOR));
+  EXPECT_EQ(item.deviceClass,
+            static_cast<uint8_t>(SensorDeviceClass::DISTANCE));
+  EXPECT_EQ(item.unit, static_cast<uint8_t>(Unit::Type::cm));
+  EXPECT_TRUE(item.isSigned);
+  EXPECT_EQ(item.sizeCode, sizeof(DistanceT) / 2);
+  EXPECT_EQ(item.precision, 0);
+  EXPECT_EQ(static_cast<int32_t>(item.minValue), INT16_MIN);
+  EXPECT_EQ(static_cast<int32_t>(item.maxValue), INT16_MAX);
+  EXPECT_STREQ(item.name, distanceSensorName);
 }
 
 TEST_F(DistanceSensor_test, getEntityId) { EXPECT_EQ(pDs->getEntityId(), 7); }
@@ -129,201 +106,92 @@ TEST_F(DistanceSensor_test, getSensor) {
 TEST_F(DistanceSensor_test, getValueItem) {
   ValueItemT item;
 
-  pDs->getValueItem(&item);
+  pDs->getValueItem(item);
 
   EXPECT_EQ(item.entityId, 7);
   EXPECT_EQ(item.value, 0);
 }
 
-TEST_F(DistanceSensor_test,
-       loadConfigValues_wrong_crc_shall_set_default_values) {
-  pDs->loadConfigValues();
-
-  ConfigItemValueT items[3];
-  EXPECT_EQ(pDs->getConfigItemValues(items, sizeof(items) / sizeof(items[0])),
-            3);
-  EXPECT_EQ(items[0].value,
-            DistanceSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT);
-  EXPECT_EQ(items[1].value,
-            DistanceSensorConstants::CONFIG_MEASURE_INTERVAL_DEFAULT);
-  EXPECT_EQ(items[2].value,
-            DistanceSensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT);
+TEST_F(DistanceSensor_test, setValueItem_shall_not_set_value) {
+  EXPECT_FALSE(pDs->setValueItem({7, 123}));
+
+  EXPECT_EQ(pDs->getSensor().getValue(), 0);
 }
 
-TEST_F(DistanceSensor_test, DISABLED_loadConfigValues_OK) {
-  (void)EEPROM.put(
-      EE_ADDRESS_CONFIG_DISTANCE_SENSOR_0,
-      DistanceSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT + 1);
-  eeprom_write_byte(EE_ADDRESS_CONFIG_DISTANCE_SENSOR_0 + sizeof(DistanceT),
-                    0x31);  // Correct CRC8 of value
-  (void)EEPROM.put(
-      EE_ADDRESS_CONFIG_DISTANCE_SENSOR_1,
-      DistanceSensorConstants::CONFIG_MEASURE_INTERVAL_DEFAULT + 1);
-  eeprom_write_byte(EE_ADDRESS_CONFIG_DISTANCE_SENSOR_1 + sizeof(DistanceT),
-                    0xB3);  // Correct CRC8 of value
-  (void)EEPROM.put(EE_ADDRESS_CONFIG_DISTANCE_SENSOR_2,
-                   DistanceSensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT + 1);
-  eeprom_write_byte(EE_ADDRESS_CONFIG_DISTANCE_SENSOR_2 + sizeof(DistanceT),
-                    0xD6);  // Correct CRC8 of value
-
-  pDs->loadConfigValues();
-
-  ConfigItemValueT items[3];
-  EXPECT_EQ(pDs->getConfigItemValues(items, sizeof(items) / sizeof(items[0])),
-            3);
-  EXPECT_EQ(items[0].value,
-            DistanceSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT + 1);
-  EXPECT_EQ(items[1].value,
-            DistanceSensorConstants::CONFIG_MEASURE_INTERVAL_DEFAULT + 1);
-  EXPECT_EQ(items[2].value,
-            DistanceSensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT + 1);
+TEST_F(DistanceSensor_test, getUpdateInterval) {
+  EXPECT_EQ(pDs->getUpdateInterval(),
+            DistanceSensorConstants::CONFIG_MEASURE_INTERVAL_DEFAULT * 1000UL);
 }
 
 TEST_F(DistanceSensor_test, print) {
   const char* expectStr = "DistanceSensor=0cm";
-  NewPingMock sonarMock;
-  DistanceSensor ds = DistanceSensor(7, "DistanceSensor", sonarMock);
 
-  EXPECT_EQ(ds.printTo(Serial), strlen(expectStr));
+  EXPECT_EQ(pDs->printTo(Serial), strlen(expectStr));
 
   bufSerReadStr();
   EXPECT_STREQ(strBuf, expectStr);
 }
 
 TEST_F(DistanceSensor_test, print_service_shall_do_nothing) {
-  NewPingMock sonarMock;
-  DistanceSensor ds = DistanceSensor(7, "DistanceSensor", sonarMock);
-  EXPECT_EQ(ds.printTo(Serial, 0), 0);
+  EXPECT_EQ(pDs->printTo(Serial, 0), 0);
 }
 
-TEST_F(DistanceSensor_test, setConfigs_all_in_order) {
-  ConfigItemValueT inItems[3] = {{0, 100}, {1, 1001}, {2, 1002}};
-
-  EXPECT_TRUE(pDs->setConfigItemValues(inItems, 3));
-
-  ConfigItemValueT items[3];
-  EXPECT_EQ(pDs->getConfigItemValues(items, sizeof(items) / sizeof(items[0])),
-            3);
-  EXPECT_EQ(items[0].value, 100);
-  EXPECT_EQ(items[1].value, 1001);
-  EXPECT_EQ(items[2].value, 1002);
-}
-
-TEST_F(DistanceSensor_test, setConfigs_all_out_of_order) {
-  ConfigItemValueT inItems[3] = {{2, 2002}, {1, 2001}, {0, 200}};
-
-  EXPECT_TRUE(pDs->setConfigItemValues(inItems, 3));
-
-  ConfigItemValueT items[3];
-  EXPECT_EQ(pDs->getConfigItemValues(items, sizeof(items) / sizeof(items[0])),
-            3);
-  EXPECT_EQ(items[0].value, 200);
-  EXPECT_EQ(items[1].value, 2001);
-  EXPECT_EQ(items[2].value, 2002);
-}
-
-TEST_F(DistanceSensor_test, setConfigs_one) {
-  ConfigItemValueT inItems[1] = {{2, 3002}};
-
-  EXPECT_TRUE(pDs->setConfigItemValues(inItems, 1));
-
-  ConfigItemValueT items[3];
-  EXPECT_EQ(pDs->getConfigItemValues(items, sizeof(items) / sizeof(items[0])),
-            3);
-  EXPECT_EQ(items[0].value,
-            DistanceSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT);
-  EXPECT_EQ(items[1].value,
-            DistanceSensorConstants::CONFIG_MEASURE_INTERVAL_DEFAULT);
-  EXPECT_EQ(items[2].value, 3002);
-}
+TEST_F(DistanceSensor_test, update_shall_set_value_from_sonar) {
+  EXPECT_CALL(*pSonarMock, ping_cm(0)).WillOnce(Return(123));
 
-TEST_F(DistanceSensor_test, setConfigs_too_many) {
-  ConfigItemValueT inItems[4] = {{0, 100}, {1, 1001}, {2, 1002}, {3, 1003}};
+  pDs->update();
 
-  EXPECT_FALSE(pDs->setConfigItemValues(inItems, 4));
-}
-
-TEST_F(DistanceSensor_test, setConfigs_out_of_range) {
-  ConfigItemValueT inItems[1] = {{4, 3004}};
-
-  EXPECT_FALSE(pDs->setConfigItemValues(inItems, 1));
-}
-
-TEST_F(DistanceSensor_test, setReported) {
-  EXPECT_CALL(*pArduinoMock, millis()).Times(1);
-
-  pDs->setReported();
-}
-
-TEST_F(
-    DistanceSensor_test,
-    DISABLED_update_largeValueDiff_largeTimeDiff_withConfigsZero_shall_return_false) {
-  EXPECT_CALL(*pSonarMock, ping_cm(0))
-      .WillOnce(
-          Return(DistanceSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT));
-  EXPECT_CALL(*pArduinoMock, millis()).Times(0);
-
-  ConfigItemValueT inItems[3] = {{0, 0}, {1, 0}, {2, 0}};
-  EXPECT_TRUE(pDs->setConfigItemValues(inItems, 3));
-
-  EXPECT_FALSE(pDs->update());
+  EXPECT_EQ(pDs->getSensor().getValue(), 123);
 }
 
 TEST_F(DistanceSensor_test,
-       DISABLED_update_smallValueDiff_smallTimeDiff_shall_return_false) {
-  EXPECT_CALL(*pSonarMock, ping_cm(0))
-      .WillOnce(Return(
-          DistanceSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT - 1));
-  EXPECT_CALL(*pArduinoMock, millis())
-      .WillOnce(Return(
-          DistanceSensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT * 1000 - 1));
+       update_smallValueDiff_smallTimeDiff_shall_return_false) {
+  pDs->setReported(ReportReason::due);
+  now = 300000 - 1;
+  EXPECT_CALL(*pSonarMock, ping_cm(0)).WillOnce(Return(9));
 
   EXPECT_FALSE(pDs->update());
+  EXPECT_FALSE(pDs->isReportDue());
 }
 
 TEST_F(DistanceSensor_test,
-       DISABLED_update_smallValueDiff_largeTimeDiff_shall_return_true) {
-  EXPECT_CALL(*pSonarMock, ping_cm(0))
-      .WillOnce(Return(
-          DistanceSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT - 1));
-  EXPECT_CALL(*pArduinoMock, millis())
-      .WillOnce(Return(DistanceSensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT *
-                       1000));
+       update_smallValueDiff_largeTimeDiff_shall_return_true) {
+  pDs->setReported(ReportReason::due);
+  now = 300000;
+  EXPECT_CALL(*pSonarMock, ping_cm(0)).WillOnce(Return(9));
 
   EXPECT_TRUE(pDs->update());
+  EXPECT_TRUE(pDs->isReportDue());
 }
 
 TEST_F(DistanceSensor_test,
        update_largeValueDiff_smallTimeDiff_shall_return_true) {
-  EXPECT_CALL(*pSonarMock, ping_cm(0))
-      .WillOnce(
-          Return(DistanceSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT));
-  EXPECT_CALL(*pArduinoMock, millis())
-      .WillOnce(
-          Return(DistanceSensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT - 1));
+  pDs->setReported(ReportReason::due);
+  now = 1000;
+  EXPECT_CALL(*pSonarMock, ping_cm(0)).WillOnce(Return(10));
 
   EXPECT_TRUE(pDs->update());
 }
 
-TEST_F(DistanceSensor_test,
-       DISABLED_update_largeValueDiff_largeTimeDiff_shall_return_true) {
+TEST_F(DistanceSensor_test, update_shall_compare_with_last_reported_value) {
   EXPECT_CALL(*pSonarMock, ping_cm(0))
-      .WillOnce(Return(
-          DistanceSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT - 1));
-  EXPECT_CALL(*pArduinoMock, millis())
-      .WillOnce(Return(DistanceSensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT *
-                       1000));
+      .WillOnce(Return(100))
+      .WillOnce(Return(105))
+      .WillOnce(Return(110));
+
+  pDs->update();
+  pDs->setReported(ReportReason::due);
+  now = 1000;
 
+  EXPECT_FALSE(pDs->update());
   EXPECT_TRUE(pDs->update());
 }
 
 TEST_F(DistanceSensor_test, isReportDue) {
-  EXPECT_CALL(*pArduinoMock, millis()).WillOnce(Return(0));
-
   // Newly constructed shall be true
   EXPECT_TRUE(pDs->isReportDue());
 
   // Shall be set to false when setReported() is called
-  pDs->setReported();
+  pDs->setReported(ReportReason::due);
   EXPECT_FALSE(pDs->isReportDue());
 }
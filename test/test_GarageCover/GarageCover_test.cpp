@@ -12,6 +12,12 @@
 
 using ::testing::Return;
 
+static const char garageCoverName[] = "GarageCover";
+
+// Metadata of the cover, in flash on target.
+static const DiscoveryEntityT entity =
+    GarageCover::makeEntity(0, garageCoverName);
+
 class GarageCover_test : public ::testing::Test {
  protected:
   void SetUp() override {
@@ -23,7 +29,7 @@ class GarageCover_test : public ::testing::Test {
     EXPECT_CALL(*pArduinoMock, digitalWrite(13, LOW));
     eeprom_clear();
 
-    pGc = new GarageCover(91, "GarageCover", 11, 12, 13);
+    pGc = new GarageCover(entity, 11, 12, 13);
   }
 
   void TearDown() override {
@@ -67,183 +73,140 @@ void expectCalls_relayActivatedTwoTimes(ArduinoMock* pArduinoMock) {
 }
 
 TEST_F(GarageCover_test, callService_open_when_closed_then_relayOneTime) {
-  pGc->mCover.setState(CoverState::closed);
+  pGc->mCover.setState(CoverState::CLOSED);
   expectCalls_relayActivatedOneTime(pArduinoMock);
   pGc->callService(0);  // open
 }
 
 TEST_F(GarageCover_test, callService_open_when_closing_then_relayTwoTimes) {
-  pGc->mCover.setState(CoverState::closing);
+  pGc->mCover.setState(CoverState::CLOSING);
   expectCalls_relayActivatedTwoTimes(pArduinoMock);
   pGc->callService(0);  // open
 }
 
 TEST_F(GarageCover_test, callService_open_when_open_then_relayNoTime) {
-  pGc->mCover.setState(CoverState::open);
+  pGc->mCover.setState(CoverState::OPEN);
   expectCalls_relayActivatedNoTimes(pArduinoMock);
   pGc->callService(0);  // open
 }
 
 TEST_F(GarageCover_test, callService_open_when_opening_then_relayNoTime) {
-  pGc->mCover.setState(CoverState::opening);
+  pGc->mCover.setState(CoverState::OPENING);
   expectCalls_relayActivatedNoTimes(pArduinoMock);
   pGc->callService(0);  // open
 }
 
 TEST_F(GarageCover_test, callService_close_when_open_then_relayOneTime) {
-  pGc->mCover.setState(CoverState::open);
+  pGc->mCover.setState(CoverState::OPEN);
   expectCalls_relayActivatedOneTime(pArduinoMock);
   pGc->callService(1);  // close
 }
 
 TEST_F(GarageCover_test, callService_close_when_opening_then_relayTwoTimes) {
-  pGc->mCover.setState(CoverState::opening);
+  pGc->mCover.setState(CoverState::OPENING);
   expectCalls_relayActivatedTwoTimes(pArduinoMock);
   pGc->callService(1);  // close
 }
 
 TEST_F(GarageCover_test, callService_close_when_closed_then_relayNoTime) {
-  pGc->mCover.setState(CoverState::closed);
+  pGc->mCover.setState(CoverState::CLOSED);
   expectCalls_relayActivatedNoTimes(pArduinoMock);
   pGc->callService(1);  // close
 }
 
 TEST_F(GarageCover_test, callService_close_when_closing_then_relayNoTime) {
-  pGc->mCover.setState(CoverState::closing);
+  pGc->mCover.setState(CoverState::CLOSING);
   expectCalls_relayActivatedNoTimes(pArduinoMock);
   pGc->callService(1);  // close
 }
 
 TEST_F(GarageCover_test, callService_stop_when_opening_then_relayOneTime) {
-  pGc->mCover.setState(CoverState::opening);
+  pGc->mCover.setState(CoverState::OPENING);
   expectCalls_relayActivatedOneTime(pArduinoMock);
   pGc->callService(2);  // stop
 }
 
 TEST_F(GarageCover_test, callService_stop_when_closing_then_relayOneTime) {
-  pGc->mCover.setState(CoverState::closing);
+  pGc->mCover.setState(CoverState::CLOSING);
   expectCalls_relayActivatedOneTime(pArduinoMock);
   pGc->callService(2);  // stop
 }
 
 TEST_F(GarageCover_test, callService_stop_when_closed_then_relayNoTime) {
-  pGc->mCover.setState(CoverState::closed);
+  pGc->mCover.setState(CoverState::CLOSED);
   expectCalls_relayActivatedNoTimes(pArduinoMock);
   pGc->callService(2);  // stop
 }
 
 TEST_F(GarageCover_test, callService_stop_when_open_then_relayNoTime) {
-  pGc->mCover.setState(CoverState::open);
+  pGc->mCover.setState(CoverState::OPEN);
   expectCalls_relayActivatedNoTimes(pArduinoMock);
   pGc->callService(2);  // stop
 }
 
 TEST_F(GarageCover_test, callService_toggle_when_open_then_relayOneTime) {
-  pGc->mCover.setState(CoverState::open);
+  pGc->mCover.setState(CoverState::OPEN);
   expectCalls_relayActivatedOneTime(pArduinoMock);
   pGc->callService(3);  // toggle
 }
 
 TEST_F(GarageCover_test, callService_toggle_when_closed_then_relayOneTime) {
-  pGc->mCover.setState(CoverState::closed);
+  pGc->mCover.setState(CoverState::CLOSED);
   expectCalls_relayActivatedOneTime(pArduinoMock);
   pGc->callService(3);  // toggle
 }
 
 TEST_F(GarageCover_test, callService_toggle_when_opening_then_relayOwoTimes) {
-  pGc->mCover.setState(CoverState::opening);
+  pGc->mCover.setState(CoverState::OPENING);
   expectCalls_relayActivatedTwoTimes(pArduinoMock);
   pGc->callService(3);  // toggle
 }
 
 TEST_F(GarageCover_test, callService_toggle_when_closing_then_relayOwoTimes) {
-  pGc->mCover.setState(CoverState::closing);
+  pGc->mCover.setState(CoverState::CLOSING);
   expectCalls_relayActivatedTwoTimes(pArduinoMock);
   pGc->callService(3);  // toggle
 }
 
 TEST_F(GarageCover_test, callService_unknown) {
-  pGc->mCover.setState(CoverState::closed);
+  pGc->mCover.setState(CoverState::CLOSED);
   expectCalls_relayActivatedNoTimes(pArduinoMock);
   pGc->callService(4);  // unknown
 }
 
-TEST_F(GarageCover_test, getConfigItemValuesMsg) {
-  ConfigItemValueT items[1];
-
-  EXPECT_EQ(pGc->getConfigItemValues(items, sizeof(items) / sizeof(items[0])),
-            1);
-
-  EXPECT_EQ(items[0].configId, 0);
-  EXPECT_EQ(items[0].value,
-            GarageCoverConstants::CONFIG_REPORT_INTERVAL_DEFAULT);
-}
-
 TEST_F(GarageCover_test, getDeviceClass) {
-  EXPECT_EQ(pGc->mCover.getDeviceClass(), CoverDeviceClass::garage);
+  EXPECT_EQ(pGc->mCover.getDeviceClass(), CoverDeviceClass::GARAGE);
 }
 
-TEST_F(GarageCover_test, getDiscoveryItem) {
-  DiscoveryItemT item;
-
-  pGc->getDiscoveryItem(&item);
+TEST_F(GarageCover_test, getDiscoveryEntity) {
+  DiscoveryEntityT item;
 
-  EXPECT_EQ(item.entity.entityId, 91);
-  EXPECT_EQ(item.entity.componentType,
-            static_cast<uint8_t>(BaseComponent::Type::cover));
-  EXPECT_EQ(item.entity.deviceClass,
-            static_cast<uint8_t>(CoverDeviceClass::garage));
-  EXPECT_EQ(item.entity.unit, static_cast<uint8_t>(Unit::Type::none));
-  EXPECT_FALSE(item.entity.isSigned);
-  EXPECT_EQ(item.entity.sizeCode, 0);
-  EXPECT_EQ(item.entity.precision, 0);
+  EXPECT_TRUE(pGc->getDiscoveryEntity(item));
 
-  EXPECT_EQ(item.numberOfConfigItems, 1);
-
-  EXPECT_EQ(item.configItems[0].configId, 0);
-  EXPECT_EQ(item.configItems[0].unit, static_cast<uint8_t>(Unit::Type::s));
-  EXPECT_FALSE(item.configItems[0].isSigned);
-  EXPECT_EQ(item.configItems[0].sizeCode, sizeof(uint16_t) / 2);
-  EXPECT_EQ(item.configItems[0].precision, 0);
-  EXPECT_EQ(item.configItems[0].minValue, 0);
-  EXPECT_EQ(item.configItems[0].maxValue, Util::SECONDS_PER_TWELVE_HOURS);
+  EXPECT_EQ(item.entityId, 0);
+  EXPECT_EQ(item.componentType,
+            static_cast<uint8_t>(BaseComponent::Type::COVER));
+  EXPECT_EQ(item.deviceClass, static_cast<uint8_t>(CoverDeviceClass::GARAGE));
+  EXPECT_EQ(item.unit, static_cast<uint8_t>(Unit::Type::none));
+  EXPECT_FALSE(item.isSigned);
+  EXPECT_EQ(item.sizeCode, 0);
+  EXPECT_EQ(item.precision, 0);
+  EXPECT_STREQ(item.name, garageCoverName);
 }
 
-TEST_F(GarageCover_test, getEntityId) { EXPECT_EQ(pGc->getEntityId(), 91); }
+TEST_F(GarageCover_test, getEntityId) { EXPECT_EQ(pGc->getEntityId(), 0); }
 
 TEST_F(GarageCover_test, getValueItem) {
   ValueItemT item;
 
-  pGc->getValueItem(&item);
+  pGc->getValueItem(item);
 
-  EXPECT_EQ(item.entityId, 91);
+  EXPECT_EQ(item.entityId, 0);
   EXPECT_EQ(item.value, 0);
 }
 
-TEST_F(GarageCover_test, loadConfigValues_wrong_crc_shall_set_default_values) {
-  pGc->loadConfigValues();
-
-  ConfigItemValueT items[1];
-  EXPECT_EQ(pGc->getConfigItemValues(items, sizeof(items) / sizeof(items[0])),
-            1);
-  EXPECT_EQ(items[0].value,
-            GarageCoverConstants::CONFIG_REPORT_INTERVAL_DEFAULT);
-}
-
-TEST_F(GarageCover_test, loadConfigValues_OK) {
-  (void)EEPROM.put(
-      EE_ADDRESS_CONFIG_GARAGE_COVER_0,
-      (uint16_t)(GarageCoverConstants::CONFIG_REPORT_INTERVAL_DEFAULT + 1));
-  eeprom_write_byte(EE_ADDRESS_CONFIG_GARAGE_COVER_0 + sizeof(uint16_t),
-                    0x40);  // Correct CRC8 of value
-
-  pGc->loadConfigValues();
-
-  ConfigItemValueT items[1];
-  EXPECT_EQ(pGc->getConfigItemValues(items, sizeof(items) / sizeof(items[0])),
-            1);
-  EXPECT_EQ(items[0].value,
-            GarageCoverConstants::CONFIG_REPORT_INTERVAL_DEFAULT + 1);
+TEST_F(GarageCover_test, setValueItem_shall_return_false) {
+  EXPECT_FALSE(pGc->setValueItem({0, 1}));
 }
 
 TEST_F(GarageCover_test, print) {
@@ -252,7 +215,7 @@ TEST_F(GarageCover_test, print) {
   EXPECT_CALL(*pArduinoMock, pinMode(12, INPUT_PULLUP));
   EXPECT_CALL(*pArduinoMock, pinMode(13, OUTPUT));
   EXPECT_CALL(*pArduinoMock, digitalWrite(13, LOW));
-  GarageCover gc = GarageCover(91, "GarageCover", 11, 12, 13);
+  GarageCover gc = GarageCover(entity, 11, 12, 13);
 
   EXPECT_EQ(gc.printTo(Serial), strlen(expectStr));
 
@@ -266,45 +229,17 @@ TEST_F(GarageCover_test, print_service_open) {
   EXPECT_CALL(*pArduinoMock, pinMode(12, INPUT_PULLUP));
   EXPECT_CALL(*pArduinoMock, pinMode(13, OUTPUT));
   EXPECT_CALL(*pArduinoMock, digitalWrite(13, LOW));
-  GarageCover gc = GarageCover(91, "GarageCover", 11, 12, 13);
+  GarageCover gc = GarageCover(entity, 11, 12, 13);
 
-  EXPECT_EQ(gc.printTo(Serial, static_cast<uint8_t>(CoverService::open)),
+  EXPECT_EQ(gc.printTo(Serial, static_cast<uint8_t>(CoverService::OPEN)),
             strlen(expectStr));
 
   bufSerReadStr();
   EXPECT_STREQ(strBuf, expectStr);
 }
 
-TEST_F(GarageCover_test, setConfigs) {
-  ConfigItemValueT inItems[1] = {{0, 1000}};
-
-  EXPECT_TRUE(pGc->setConfigItemValues(inItems, 1));
-
-  ConfigItemValueT items[1];
-  EXPECT_EQ(pGc->getConfigItemValues(items, sizeof(items) / sizeof(items[0])),
-            1);
-  EXPECT_EQ(items[0].value, 1000);
-}
-
-TEST_F(GarageCover_test, setConfigs_too_many) {
-  ConfigItemValueT inItems[2] = {{0, 1000}, {1, 1001}};
-
-  EXPECT_FALSE(pGc->setConfigItemValues(inItems, 2));
-}
-
-TEST_F(GarageCover_test, setConfigs_out_of_range) {
-  ConfigItemValueT inItems[1] = {{1, 3001}};
-
-  EXPECT_FALSE(pGc->setConfigItemValues(inItems, 1));
-}
-
-TEST_F(GarageCover_test, setReported) {
-  EXPECT_CALL(*pArduinoMock, millis()).Times(1);
-  pGc->setReported();
-}
-
 TEST_F(GarageCover_test, update_closing_closed_closed) {
-  pGc->mCover.setState(CoverState::closing);
+  pGc->mCover.setState(CoverState::CLOSING);
   EXPECT_CALL(*pArduinoMock, digitalRead(11))
       .WillOnce(Return(LOW))
       .WillOnce(Return(LOW));
@@ -312,13 +247,13 @@ TEST_F(GarageCover_test, update_closing_closed_closed) {
       .WillOnce(Return(HIGH))
       .WillOnce(Return(HIGH));
   EXPECT_EQ(pGc->update(), true);
-  EXPECT_EQ(pGc->mCover.getState(), CoverState::closed);
+  EXPECT_EQ(pGc->mCover.getState(), CoverState::CLOSED);
   EXPECT_EQ(pGc->update(), false);
-  EXPECT_EQ(pGc->mCover.getState(), CoverState::closed);
+  EXPECT_EQ(pGc->mCover.getState(), CoverState::CLOSED);
 }
 
 TEST_F(GarageCover_test, update_opening_open_open) {
-  pGc->mCover.setState(CoverState::opening);
+  pGc->mCover.setState(CoverState::OPENING);
   EXPECT_CALL(*pArduinoMock, digitalRead(11))
       .WillOnce(Return(HIGH))
       .WillOnce(Return(HIGH));
@@ -326,13 +261,13 @@ TEST_F(GarageCover_test, update_opening_open_open) {
       .WillOnce(Return(LOW))
       .WillOnce(Return(LOW));
   EXPECT_EQ(pGc->update(), true);
-  EXPECT_EQ(pGc->mCover.getState(), CoverState::open);
+  EXPECT_EQ(pGc->mCover.getState(), CoverState::OPEN);
   EXPECT_EQ(pGc->update(), false);
-  EXPECT_EQ(pGc->mCover.getState(), CoverState::open);
+  EXPECT_EQ(pGc->mCover.getState(), CoverState::OPEN);
 }
 
 TEST_F(GarageCover_test, update_closed_opening_opening) {
-  pGc->mCover.setState(CoverState::closed);
+  pGc->mCover.setState(CoverState::CLOSED);
   EXPECT_CALL(*pArduinoMock, digitalRead(11))
       .WillOnce(Return(HIGH))
       .WillOnce(Return(HIGH));
@@ -340,13 +275,13 @@ TEST_F(GarageCover_test, update_closed_opening_opening) {
       .WillOnce(Return(HIGH))
       .WillOnce(Return(HIGH));
   EXPECT_EQ(pGc->update(), true);
-  EXPECT_EQ(pGc->mCover.getState(), CoverState::opening);
+  EXPECT_EQ(pGc->mCover.getState(), CoverState::OPENING);
   EXPECT_EQ(pGc->update(), false);
-  EXPECT_EQ(pGc->mCover.getState(), CoverState::opening);
+  EXPECT_EQ(pGc->mCover.getState(), CoverState::OPENING);
 }
 
 TEST_F(GarageCover_test, update_open_closing_closing) {
-  pGc->mCover.setState(CoverState::open);
+  pGc->mCover.setState(CoverState::OPEN);
   EXPECT_CALL(*pArduinoMock, digitalRead(11))
       .WillOnce(Return(HIGH))
       .WillOnce(Return(HIGH));
@@ -354,17 +289,17 @@ TEST_F(GarageCover_test, update_open_closing_closing) {
       .WillOnce(Return(HIGH))
       .WillOnce(Return(HIGH));
   EXPECT_EQ(pGc->update(), true);
-  EXPECT_EQ(pGc->mCover.getState(), CoverState::closing);
+  EXPECT_EQ(pGc->mCover.getState(), CoverState::CLOSING);
   EXPECT_EQ(pGc->update(), false);
-  EXPECT_EQ(pGc->mCover.getState(), CoverState::closing);
+  EXPECT_EQ(pGc->mCover.getState(), CoverState::CLOSING);
 }
 
 TEST_F(GarageCover_test, update_closed_both_pins_low_shall_stay_in_same_state) {
-  pGc->mCover.setState(CoverState::closed);
+  pGc->mCover.setState(CoverState::CLOSED);
   EXPECT_CALL(*pArduinoMock, digitalRead(11)).WillOnce(Return(LOW));
   EXPECT_CALL(*pArduinoMock, digitalRead(12)).WillOnce(Return(LOW));
   EXPECT_EQ(pGc->update(), false);
-  EXPECT_EQ(pGc->mCover.getState(), CoverState::closed);
+  EXPECT_EQ(pGc->mCover.getState(), CoverState::CLOSED);
 }
 
 TEST_F(GarageCover_test, isReportDue) {
@@ -374,6 +309,6 @@ TEST_F(GarageCover_test, isReportDue) {
   EXPECT_TRUE(pGc->isReportDue());
 
   // Shall be set to false when setReported() is called
-  pGc->setReported();
+  pGc->setReported(ReportReason::due);
   EXPECT_FALSE(pGc->isReportDue());
 }
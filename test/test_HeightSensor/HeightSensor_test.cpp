@@ -4,34 +4,55 @@
 
 #include "BufferSerial.h"
 #include "EEPROM.h"
+#include "NewPing.h"
 #include "Sensor.h"
 #include "Unit.h"
 #include "Util.h"
 
 // Include source implementation
+#include "../../src/DistanceSensor.cpp"
 #include "../../src/HeightSensor.cpp"
 
 using ::testing::Return;
+using ::testing::ReturnPointee;
 
 using HeightT = int16_t;  // cm
 
+static const char heightSensorName[] = "HeightSensor";
+
+// Metadata of the sensors, numbers and report config, in flash on target.
+static const DiscoveryEntityT distanceEntity =
+    DistanceSensor::makeEntity(3, "Distance");
+static const DiscoveryEntityT stableTimeEntity = Number<uint16_t>::makeEntity(
+    4, "Height Stable Time", NumberDeviceClass::DURATION, Unit::Type::ms, 0,
+    BaseComponent::Category::CONFIG, 0, Util::MS_PER_MINUTE);
+static const DiscoveryEntityT zeroValueEntity = Number<HeightT>::makeEntity(
+    5, "Height Zero Value", NumberDeviceClass::DISTANCE, Unit::Type::cm, 0,
+    BaseComponent::Category::CONFIG, -MAX_SENSOR_DISTANCE, MAX_SENSOR_DISTANCE);
+static const DiscoveryEntityT heightEntity =
+    HeightSensor::makeEntity(6, heightSensorName);
+
+static const DiscoveryEntityT reportEntities[] = {
+    ReportConfig::makeHysteresisEntity(23, "Height Hysteresis",
+                                       NumberDeviceClass::DISTANCE,
+                                       Unit::Type::cm, 0, MAX_SENSOR_DISTANCE),
+    ReportConfig::makeMinIntervalEntity(19, "Height Min Interval"),
+    ReportConfig::makeMaxIntervalEntity(31, "Height Max Interval"),
+    ReportConfig::makeBurstEntity(35, "Height Burst"),
+    ReportConfig::makeRefillTimeEntity(39, "Height Refill Time"),
+    ReportConfig::makeHysteresisPctEntity(27, "Height Relative Hysteresis"),
+};
+
 class HeightSensor_test : public ::testing::Test {
  protected:
   void SetUp() override {
     pArduinoMock = arduinoMockInstance();
+    EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(ReturnPointee(&now));
     eeprom_clear();
     strBuf[0] = '\0';
-
-    pDistanceSensor = new Sensor<DistanceT>(
-        99, "Distance", SensorDeviceClass::distance, Unit::Type::cm);
-    pHs = new HeightSensor(39, "HeightSensor", *pDistanceSensor);
   }
 
-  void TearDown() override {
-    delete pHs;
-    delete pDistanceSensor;
-    releaseArduinoMock();
-  }
+  void TearDown() override { releaseArduinoMock(); }
 
   void bufSerReadStr() {
     size_t i = 0;
@@ -45,106 +66,92 @@ class HeightSensor_test : public ::testing::Test {
     strBuf[i] = '\0';
   }
 
-  char strBuf[256];
-  ArduinoMock* pArduinoMock;
-  Sensor<DistanceT>* pDistanceSensor;
-  HeightSensor* pHs;
-};
+  void setDistance(DistanceT distance) {
+    distanceSensor.getSensor().setValue(distance);
+  }
 
-TEST_F(HeightSensor_test, callService_shall_do_nothing) { pHs->callService(0); }
+  // Without a rate limit: hysteresis 10 cm and max interval 300 s.
+  ReportConfig config{0x00, reportEntities, {10, 0, 0, 300, 0, 60}};
 
-TEST_F(HeightSensor_test, getConfigItemValues) {
-  ConfigItemValueT items[4];
+  // As above with a min interval of 60 s.
+  ReportConfig minIntervalConfig{0x00, reportEntities,
+                                 {10, 0, 60, 300, 0, 60}};
 
-  EXPECT_EQ(pHs->getConfigItemValues(items, sizeof(items) / sizeof(items[0])),
-            4);
+  // As above without a max interval.
+  ReportConfig noMaxIntervalConfig{0x00, reportEntities, {10, 0, 0, 0, 0, 60}};
 
-  EXPECT_EQ(items[0].configId, 0);
-  EXPECT_EQ(items[0].value,
-            HeightSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT);
+  uint32_t now{};
+  char strBuf[256];
+  ArduinoMock* pArduinoMock;
+  NewPingMock sonarMock;
+
+  DistanceSensor distanceSensor =
+      DistanceSensor(distanceEntity, sonarMock, config);
+
+  PersistentNumber<uint16_t> configStableTime =
+      PersistentNumber<uint16_t>(0x10, stableTimeEntity, 5000);
+  PersistentNumber<HeightT> configZeroValue =
+      PersistentNumber<HeightT>(0x20, zeroValueEntity, 200);
+  PersistentNumberComponent<uint16_t> stableTime =
+      PersistentNumberComponent<uint16_t>(configStableTime);
+  PersistentNumberComponent<HeightT> zeroValue =
+      PersistentNumberComponent<HeightT>(configZeroValue);
+
+  HeightSensor hs = HeightSensor(heightEntity, distanceSensor, stableTime,
+                                 zeroValue, config);
+};
 
-  EXPECT_EQ(items[1].configId, 1);
-  EXPECT_EQ(items[1].value,
-            HeightSensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT);
+TEST_F(HeightSensor_test, callService_shall_do_nothing) { hs.callService(0); }
 
-  EXPECT_EQ(items[2].configId, 2);
-  EXPECT_EQ(items[2].value, HeightSensorConstants::CONFIG_STABLE_TIME_DEFAULT);
+TEST_F(HeightSensor_test, getDiscoveryEntity) {
+  DiscoveryEntityT item;
 
-  EXPECT_EQ(items[3].configId, 3);
-  EXPECT_EQ(items[3].value, HeightSensorConstants::CONFIG_ZERO_VALUE_DEFAULT);
-}
+  EXPECT_TRUE(hs.getDiscoveryEntity(item));
 
-TEST_F(HeightSensor_test, DISABLED_getDiscoveryItem) {
-  DiscoveryItemT item;
-
-  pHs->getDiscoveryItem(&item);
-
-  EXPECT_EQ(item.entity.entityId, 39);
-  EXPECT_EQ(item.entity.componentType,
-            static_cast<uint8_t>(BaseComponent::Type::sensor));
-  EXPECT_EQ(item.entity.deviceClass,
-            static_cast<uint8_t>(SensorDeviceClass::distance));
-  EXPECT_EQ(item.entity.unit, static_cast<uint8_t>(Unit::Type::cm));
-  EXPECT_TRUE(item.entity.isSigned);
-  EXPECT_EQ(item.entity.sizeCode, sizeof(HeightT) / 2);
-  EXPECT_EQ(item.entity.precision, 0);
-
-  EXPECT_EQ(item.numberOfConfigItems, 4);
-
-  EXPECT_EQ(item.configItems[0].configId, 0);
-  EXPECT_EQ(item.configItems[0].unit, static_cast<uint8_t>(Unit::Type::cm));
-  EXPECT_FALSE(item.configItems[0].isSigned);
-  EXPECT_EQ(item.configItems[0].sizeCode, sizeof(uint16_t) / 2);
-  EXPECT_EQ(item.configItems[0].precision, 0);
-  EXPECT_EQ(item.configItems[0].minValue, 0);
-  EXPECT_EQ(item.configItems[0].maxValue, MAX_SENSOR_DISTANCE);
-
-  EXPECT_EQ(item.configItems[1].configId, 1);
-  EXPECT_EQ(item.configItems[1].unit, static_cast<uint8_t>(Unit::Type::s));
-  EXPECT_FALSE(item.configItems[1].isSigned);
-  EXPECT_EQ(item.configItems[1].sizeCode, sizeof(uint16_t) / 2);
-  EXPECT_EQ(item.configItems[1].precision, 0);
-  EXPECT_EQ(item.configItems[1].minValue, 0);
-  EXPECT_EQ(item.configItems[1].maxValue, Util::SECONDS_PER_HOUR);
-
-  EXPECT_EQ(item.configItems[2].configId, 2);
-  EXPECT_EQ(item.configItems[2].unit, static_cast<uint8_t>(Unit::Type::ms));
-  EXPECT_FALSE(item.configItems[2].isSigned);
-  EXPECT_EQ(item.configItems[2].sizeCode, sizeof(uint16_t) / 2);
-  EXPECT_EQ(item.configItems[2].precision, 0);
-  EXPECT_EQ(item.configItems[2].minValue, 0);
-  EXPECT_EQ(item.configItems[2].maxValue, Util::MS_PER_MINUTE);
-
-  EXPECT_EQ(item.configItems[3].configId, 3);
-  EXPECT_EQ(item.configItems[3].unit, static_cast<uint8_t>(Unit::Type::cm));
-  EXPECT_TRUE(item.configItems[3].isSigned);
-  EXPECT_EQ(item.configItems[3].sizeCode, sizeof(HeightT) / 2);
-  EXPECT_EQ(item.configItems[3].precision, 0);
-  EXPECT_EQ(item.configItems[3].minValue, -MAX_SENSOR_DISTANCE);
-  EXPECT_EQ(item.configItems[3].maxValue, MAX_SENSOR_DISTANCE);
+  EXPECT_EQ(item.entityId, 6);
+  EXPECT_EQ(item.componentType,
+            static_cast<uint8_t>(BaseComponent::Type::SENSOR));
+  EXPECT_EQ(item.deviceClass,
+            static_cast<uint8_t>(SensorDeviceClass::DISTANCE));
+  EXPECT_EQ(item.unit, static_cast<uint8_t>(Unit::Type::cm));
+  EXPECT_TRUE(item.isSigned);
+  EXPECT_EQ(item.sizeCode, sizeof(HeightT) / 2);
+  EXPECT_EQ(item.precision, 0);
+  EXPECT_EQ(static_cast<int32_t>(item.minValue), INT16_MIN);
+  EXPECT_EQ(static_cast<int32_t>(item.maxValue), INT16_MAX);
+  EXPECT_STREQ(item.name, heightSensorName);
 }
 
-TEST_F(HeightSensor_test, getEntityId) { EXPECT_EQ(pHs->getEntityId(), 39); }
+TEST_F(HeightSensor_test, getEntityId) { EXPECT_EQ(hs.getEntityId(), 6); }
 
 TEST_F(HeightSensor_test, getSensor) {
-  Sensor<HeightT>& sensor = pHs->getSensor();
-  EXPECT_EQ(sensor.getEntityId(), 39);
+  Sensor<HeightT>& sensor = hs.getSensor();
+  EXPECT_EQ(sensor.getEntityId(), 6);
+}
+
+TEST_F(HeightSensor_test, getUpstream) {
+  EXPECT_EQ(hs.getUpstream(0), &distanceSensor);
+  EXPECT_EQ(hs.getUpstream(1), &zeroValue);
+  EXPECT_EQ(hs.getUpstream(2), nullptr);
 }
 
 TEST_F(HeightSensor_test, getValueItem) {
   ValueItemT item;
 
-  pHs->getValueItem(&item);
+  hs.getValueItem(item);
 
-  EXPECT_EQ(item.entityId, 39);
+  EXPECT_EQ(item.entityId, 6);
   EXPECT_EQ(item.value, 0);
 }
 
+TEST_F(HeightSensor_test, setValueItem_of_own_entity_shall_return_false) {
+  EXPECT_FALSE(hs.setValueItem({6, 123}));
+
+  EXPECT_EQ(hs.getSensor().getValue(), 0);
+}
+
 TEST_F(HeightSensor_test, print) {
   const char* expectStr = "HeightSensor=0cm";
-  Sensor<DistanceT> ds = Sensor<DistanceT>(
-      99, "Distance", SensorDeviceClass::distance, Unit::Type::cm);
-  HeightSensor hs = HeightSensor(39, "HeightSensor", ds);
 
   EXPECT_EQ(hs.printTo(Serial), strlen(expectStr));
 
@@ -153,198 +160,96 @@ TEST_F(HeightSensor_test, print) {
 }
 
 TEST_F(HeightSensor_test, print_service_shall_do_nothing) {
-  Sensor<DistanceT> ds = Sensor<DistanceT>(
-      99, "Distance", SensorDeviceClass::distance, Unit::Type::cm);
-  HeightSensor hs = HeightSensor(39, "HeightSensor", ds);
   EXPECT_EQ(hs.printTo(Serial, 0), 0);
 }
 
-TEST_F(HeightSensor_test, setConfigs_all_in_order) {
-  ConfigItemValueT inItems[4] = {{0, 100}, {1, 1001}, {2, 1002}, {3, 103}};
-  EXPECT_TRUE(pHs->setConfigItemValues(inItems, 4));
+TEST_F(HeightSensor_test, update_shall_set_zero_value_minus_distance) {
+  setDistance(150);
 
-  ConfigItemValueT items[4];
-  EXPECT_EQ(pHs->getConfigItemValues(items, sizeof(items) / sizeof(items[0])),
-            4);
+  hs.update();
 
-  EXPECT_EQ(items[0].value, 100);
-  EXPECT_EQ(items[1].value, 1001);
-  EXPECT_EQ(items[2].value, 1002);
-  EXPECT_EQ(items[3].value, 103);
+  EXPECT_EQ(hs.getSensor().getValue(), 200 - 150);
 }
 
-TEST_F(HeightSensor_test, setConfigs_all_out_of_order) {
-  ConfigItemValueT inItems[4] = {{3, 203}, {2, 2002}, {1, 2001}, {0, 200}};
-  EXPECT_TRUE(pHs->setConfigItemValues(inItems, 4));
-
-  ConfigItemValueT items[4];
-  EXPECT_EQ(pHs->getConfigItemValues(items, sizeof(items) / sizeof(items[0])),
-            4);
-  EXPECT_EQ(items[0].value, 200);
-  EXPECT_EQ(items[1].value, 2001);
-  EXPECT_EQ(items[2].value, 2002);
-  EXPECT_EQ(items[3].value, 203);
-}
+TEST_F(HeightSensor_test, update_shall_follow_zero_value) {
+  setDistance(150);
+  zeroValue.setValue(250);
 
-TEST_F(HeightSensor_test, setConfigs_one) {
-  ConfigItemValueT inItems[1] = {{3, 303}};
-  EXPECT_TRUE(pHs->setConfigItemValues(inItems, 1));
-
-  ConfigItemValueT items[4];
-  EXPECT_EQ(pHs->getConfigItemValues(items, sizeof(items) / sizeof(items[0])),
-            4);
-  EXPECT_EQ(items[0].value,
-            HeightSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT);
-  EXPECT_EQ(items[1].value,
-            HeightSensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT);
-  EXPECT_EQ(items[2].value, HeightSensorConstants::CONFIG_STABLE_TIME_DEFAULT);
-  EXPECT_EQ(items[3].value, 303);
-}
+  hs.update();
 
-TEST_F(HeightSensor_test, setConfigs_too_many) {
-  ConfigItemValueT inItems[5] = {
-      {0, 100}, {1, 1001}, {2, 1002}, {3, 1003}, {4, 1004}};
-  EXPECT_FALSE(pHs->setConfigItemValues(inItems, 5));
-}
-
-TEST_F(HeightSensor_test, setConfigs_out_of_range) {
-  ConfigItemValueT inItems[1] = {{4, 3004}};
-  EXPECT_FALSE(pHs->setConfigItemValues(inItems, 1));
-}
-
-TEST_F(HeightSensor_test, setReported) {
-  EXPECT_CALL(*pArduinoMock, millis()).Times(1);
-  pHs->setReported();
-}
-
-TEST_F(HeightSensor_test,
-       update_largeValueDiff_largeTimeDiff_withConfigsZero_shall_return_false) {
-  pDistanceSensor->setValue(70);
-  EXPECT_CALL(*pArduinoMock, millis()).Times(0);
-  ConfigItemValueT inItems[4] = {{0, 0}, {1, 0}, {2, 0}, {3, 0}};
-  EXPECT_TRUE(pHs->setConfigItemValues(inItems, 4));
-  EXPECT_FALSE(pHs->update());
+  EXPECT_EQ(hs.getSensor().getValue(), 250 - 150);
 }
 
 TEST_F(HeightSensor_test,
        update_smallValueDiff_smallTimeDiff_shall_return_false) {
-  pDistanceSensor->setValue(
-      HeightSensorConstants::CONFIG_ZERO_VALUE_DEFAULT +
-      HeightSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT - 1);
-  EXPECT_CALL(*pArduinoMock, millis())
-      .WillOnce(Return(
-          HeightSensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT * 1000 - 1));
-  EXPECT_FALSE(pHs->update());
+  setDistance(200);
+  hs.update();
+  hs.setReported(ReportReason::due);
+  now = 300000 - 1;
+  setDistance(200 - 9);
+
+  EXPECT_FALSE(hs.update());
+  EXPECT_FALSE(hs.isReportDue());
 }
 
 TEST_F(HeightSensor_test,
        update_smallValueDiff_largeTimeDiff_shall_return_true) {
-  pDistanceSensor->setValue(
-      HeightSensorConstants::CONFIG_ZERO_VALUE_DEFAULT +
-      HeightSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT - 1);
-  EXPECT_CALL(*pArduinoMock, millis())
-      .WillOnce(
-          Return(HeightSensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT * 1000));
-  EXPECT_TRUE(pHs->update());
+  setDistance(200);
+  hs.update();
+  hs.setReported(ReportReason::due);
+  now = 300000;
+  setDistance(200 - 9);
+
+  EXPECT_TRUE(hs.update());
+  EXPECT_TRUE(hs.isReportDue());
 }
 
 TEST_F(HeightSensor_test,
        update_largeValueDiff_smallTimeDiff_shall_return_true) {
-  pDistanceSensor->setValue(
-      HeightSensorConstants::CONFIG_ZERO_VALUE_DEFAULT +
-      HeightSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT);
-  EXPECT_CALL(*pArduinoMock, millis())
-      .WillOnce(Return(
-          HeightSensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT * 1000 - 1));
-  EXPECT_TRUE(pHs->update());
-}
+  setDistance(200);
+  hs.update();
+  hs.setReported(ReportReason::due);
+  now = 1000;
+  setDistance(200 - 10);
 
-TEST_F(HeightSensor_test,
-       update_largeValueDiff_largeTimeDiff_shall_return_true) {
-  pDistanceSensor->setValue(
-      HeightSensorConstants::CONFIG_ZERO_VALUE_DEFAULT +
-      HeightSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT);
-  EXPECT_CALL(*pArduinoMock, millis())
-      .WillOnce(
-          Return(HeightSensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT * 1000));
-  EXPECT_TRUE(pHs->update());
+  EXPECT_TRUE(hs.update());
 }
 
 TEST_F(HeightSensor_test, isReportDue) {
-  EXPECT_CALL(*pArduinoMock, millis()).WillOnce(Return(0));
-
   // Newly constructed shall be true
-  EXPECT_TRUE(pHs->isReportDue());
+  EXPECT_TRUE(hs.isReportDue());
 
   // Shall be set to false when setReported() is called
-  pHs->setReported();
-  EXPECT_FALSE(pHs->isReportDue());
+  hs.setReported(ReportReason::due);
+  EXPECT_FALSE(hs.isReportDue());
+}
+
+TEST_F(HeightSensor_test, getUpdateInterval_shall_be_max_interval) {
+  EXPECT_EQ(hs.getUpdateInterval(), 300000);
 }
 
-TEST_F(HeightSensor_test, loadConfigValues_crc_fail_shall_load_defaults) {
-  pHs->loadConfigValues();
-
-  ConfigItemValueT items[4];
-  EXPECT_EQ(pHs->getConfigItemValues(items, arrayLength(items)), 4);
-  EXPECT_EQ(items[0].value,
-            HeightSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT);
-  EXPECT_EQ(items[1].value,
-            HeightSensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT);
-  EXPECT_EQ(items[2].value, HeightSensorConstants::CONFIG_STABLE_TIME_DEFAULT);
-  EXPECT_EQ(items[3].value, HeightSensorConstants::CONFIG_ZERO_VALUE_DEFAULT);
+TEST_F(HeightSensor_test, getUpdateInterval_without_max_interval) {
+  HeightSensor sensor = HeightSensor(heightEntity, distanceSensor, stableTime,
+                                     zeroValue, noMaxIntervalConfig);
+
+  EXPECT_EQ(sensor.getUpdateInterval(),
+            HeightSensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT * 1000UL);
 }
 
 TEST_F(HeightSensor_test,
-       DISABLED_loadConfigValues_crc_ok_shall_load_stored_values) {
-  CRC8 crc;
-  int eeAddr = 0;
-
-  const uint16_t expectedConfig0 = 100;
-  crc.restart();
-  crc.add(lowByte(expectedConfig0));
-  crc.add(highByte(expectedConfig0));
-  const uint8_t expectedCrc0 = crc.calc();
-  eeAddr = EE_ADDRESS_CONFIG_HEIGHT_SENSOR_0;
-  eeprom_write_byte(eeAddr++, lowByte(expectedConfig0));
-  eeprom_write_byte(eeAddr++, highByte(expectedConfig0));
-  eeprom_write_byte(eeAddr++, expectedCrc0);
-
-  const uint16_t expectedConfig1 = 1001;
-  crc.restart();
-  crc.add(lowByte(expectedConfig1));
-  crc.add(highByte(expectedConfig1));
-  const uint8_t expectedCrc1 = crc.calc();
-  eeAddr = EE_ADDRESS_CONFIG_HEIGHT_SENSOR_1;
-  eeprom_write_byte(eeAddr++, lowByte(expectedConfig1));
-  eeprom_write_byte(eeAddr++, highByte(expectedConfig1));
-  eeprom_write_byte(eeAddr++, expectedCrc1);
-
-  const uint16_t expectedConfig2 = 1002;
-  crc.restart();
-  crc.add(lowByte(expectedConfig2));
-  crc.add(highByte(expectedConfig2));
-  const uint8_t expectedCrc2 = crc.calc();
-  eeAddr = EE_ADDRESS_CONFIG_HEIGHT_SENSOR_2;
-  eeprom_write_byte(eeAddr++, lowByte(expectedConfig2));
-  eeprom_write_byte(eeAddr++, highByte(expectedConfig2));
-  eeprom_write_byte(eeAddr++, expectedCrc2);
-
-  const HeightT expectedConfig3 = 103;
-  crc.restart();
-  crc.add(lowByte(expectedConfig3));
-  crc.add(highByte(expectedConfig3));
-  const uint8_t expectedCrc3 = crc.calc();
-  eeAddr = EE_ADDRESS_CONFIG_HEIGHT_SENSOR_3;
-  eeprom_write_byte(eeAddr++, lowByte(expectedConfig3));
-  eeprom_write_byte(eeAddr++, highByte(expectedConfig3));
-  eeprom_write_byte(eeAddr++, expectedCrc3);
-
-  pHs->loadConfigValues();
-
-  ConfigItemValueT items[4];
-  EXPECT_EQ(pHs->getConfigItemValues(items, arrayLength(items)), 4);
-  EXPECT_EQ(items[0].value, expectedConfig0);
-  EXPECT_EQ(items[1].value, expectedConfig1);
-  EXPECT_EQ(items[2].value, expectedConfig2);
-  EXPECT_EQ(items[3].value, expectedConfig3);
+       getUpdateInterval_shall_be_left_of_min_interval_when_held_back) {
+  HeightSensor sensor = HeightSensor(heightEntity, distanceSensor, stableTime,
+                                     zeroValue, minIntervalConfig);
+  setDistance(200);
+  sensor.update();
+  sensor.setReported(ReportReason::due);
+
+  now = 10000;
+  setDistance(200 - 50);
+  EXPECT_FALSE(sensor.update());
+  EXPECT_EQ(sensor.getUpdateInterval(), 60000 - 10000);
+
+  now = 60000;
+  EXPECT_TRUE(sensor.update());
+  EXPECT_EQ(sensor.getUpdateInterval(), 300000);
 }
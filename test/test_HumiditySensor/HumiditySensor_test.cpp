@@ -2,33 +2,57 @@
 
 #include <gtest/gtest.h>
 
-#include "Unit.h"
+#include "Adafruit_I2CDevice.h"
 #include "BufferSerial.h"
-#include "DHT.h"
 #include "EEPROM.h"
+#include "Unit.h"
 
 // Include source implementation
-#include "../../src/Util.cpp"
+#include "../../src/AHT20.cpp"
+#include "../../src/AHTReader.cpp"
 #include "../../src/HumiditySensor.cpp"
 
+using ::testing::_;
+using ::testing::DoAll;
 using ::testing::Return;
-
-using HumidityT = uint8_t;  // percent
+using ::testing::ReturnPointee;
+using ::testing::SetArgPointee;
+using ::testing::SetArrayArgument;
+
+using HumidityT = uint8_t;  // %
+
+static const char humiditySensorName[] = "HumiditySensor";
+
+// Metadata of the sensor and its report config, in flash on target.
+static const DiscoveryEntityT entity =
+    HumiditySensor::makeEntity(2, humiditySensorName);
+
+static const DiscoveryEntityT reportEntities[] = {
+    ReportConfig::makeHysteresisEntity(21, "Humidity Hysteresis",
+                                       NumberDeviceClass::HUMIDITY,
+                                       Unit::Type::percent, 0, 100),
+    ReportConfig::makeMinIntervalEntity(17, "Humidity Min Interval"),
+    ReportConfig::makeMaxIntervalEntity(29, "Humidity Max Interval"),
+    ReportConfig::makeBurstEntity(33, "Humidity Burst"),
+    ReportConfig::makeRefillTimeEntity(37, "Humidity Refill Time"),
+    ReportConfig::makeHysteresisPctEntity(25, "Humidity Relative Hysteresis"),
+};
 
 class HumiditySensor_test : public ::testing::Test {
  protected:
   void SetUp() override {
     strBuf[0] = '\0';
     pArduinoMock = arduinoMockInstance();
-    pDhtMock = new DHTMock();
+    EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(ReturnPointee(&now));
+    pI2cMock = i2cDeviceMockInstance();
     eeprom_clear();
 
-    pHs = new HumiditySensor(51, "HumiditySensor", *pDhtMock);
+    pHs = new HumiditySensor(entity, ahtReader, config);
   }
 
   void TearDown() override {
     delete pHs;
-    delete pDhtMock;
+    releaseI2CDeviceMock();
     releaseArduinoMock();
   }
 
@@ -44,9 +68,40 @@ class HumiditySensor_test : public ::testing::Test {
     strBuf[i] = '\0';
   }
 
+  // The AHT20 shall answer a measurement with the humidity in %.
+  void expectMeasurement(float humidity) {
+    const uint32_t h = humidity * 0x100000 / 100;
+    measurement[0] = 0;  // Status, not busy
+    measurement[1] = h >> 12;
+    measurement[2] = h >> 4;
+    measurement[3] = (h << 4) & 0xF0;
+    measurement[4] = 0;
+    measurement[5] = 0;
+
+    EXPECT_CALL(*pI2cMock, write(_, 3, _, _, _)).WillOnce(Return(true));
+    EXPECT_CALL(*pI2cMock, read(_, 1, _))
+        .WillOnce(DoAll(SetArgPointee<0>(0), Return(true)));
+    EXPECT_CALL(*pI2cMock, read(_, 6, _))
+        .WillOnce(DoAll(SetArrayArgument<0>(measurement, measurement + 6),
+                        Return(true)));
+  }
+
+  HumidityT getValue() const {
+    ValueItemT item;
+    pHs->getValueItem(item);
+    return static_cast<HumidityT>(item.value);
+  }
+
+  // Without a rate limit: hysteresis 10 % and max interval 300 s.
+  ReportConfig config{0x00, reportEntities, {10, 0, 0, 300, 0, 60}};
+
+  uint32_t now{};
+  uint8_t measurement[6]{};
   char strBuf[256];
   ArduinoMock* pArduinoMock;
-  DHTMock* pDhtMock;
+  Adafruit_I2CDeviceMock* pI2cMock;
+  AHT20 aht;
+  AHTReader ahtReader = AHTReader(aht);
   HumiditySensor* pHs;
 };
 
@@ -54,264 +109,104 @@ TEST_F(HumiditySensor_test, callService_shall_do_nothing) {
   pHs->callService(0);
 }
 
-TEST_F(HumiditySensor_test, getConfigItemValues) {
-  ConfigItemValueT items[4];
+TEST_F(HumiditySensor_test, getDiscoveryEntity) {
+  DiscoveryEntityT item;
 
-  EXPECT_EQ(pHs->getConfigItemValues(items, sizeof(items) / sizeof(items[0])),
-            4);
+  EXPECT_TRUE(pHs->getDiscoveryEntity(item));
 
-  EXPECT_EQ(items[0].configId, 0);
-  EXPECT_EQ(items[0].value, 10);
-
-  EXPECT_EQ(items[1].configId, 1);
-  EXPECT_EQ(items[1].value, 60);
-
-  EXPECT_EQ(items[2].configId, 2);
-  EXPECT_EQ(items[2].value, 300);
-
-  EXPECT_EQ(items[3].configId, 3);
-  EXPECT_EQ(items[3].value, 0);
-}
-
-TEST_F(HumiditySensor_test, getDiscoveryItem) {
-  DiscoveryItemT item;
-
-  pHs->getDiscoveryItem(&item);
-
-  EXPECT_EQ(item.entity.entityId, 51);
-  EXPECT_EQ(item.entity.componentType,
-            static_cast<uint8_t>(BaseComponent::Type::sensor));
-  EXPECT_EQ(item.entity.deviceClass,
-            static_cast<uint8_t>(SensorDeviceClass::humidity));
-  EXPECT_EQ(item.entity.unit, static_cast<uint8_t>(Unit::Type::percent));
-  EXPECT_FALSE(item.entity.isSigned);
-  EXPECT_EQ(item.entity.sizeCode, sizeof(HumidityT) / 2);
-  EXPECT_EQ(item.entity.precision, 0);
-
-  EXPECT_EQ(item.numberOfConfigItems, 4);
-
-  EXPECT_EQ(item.configItems[0].configId, 0);
-  EXPECT_EQ(item.configItems[0].unit,
-            static_cast<uint8_t>(Unit::Type::percent));
-  EXPECT_FALSE(item.configItems[0].isSigned);
-  EXPECT_EQ(item.configItems[0].sizeCode, sizeof(HumidityT) / 2);
-  EXPECT_EQ(item.configItems[0].precision, 0);
-
-  EXPECT_EQ(item.configItems[1].configId, 1);
-  EXPECT_EQ(item.configItems[1].unit, static_cast<uint8_t>(Unit::Type::s));
-  EXPECT_FALSE(item.configItems[1].isSigned);
-  EXPECT_EQ(item.configItems[1].sizeCode, sizeof(uint16_t) / 2);
-  EXPECT_EQ(item.configItems[1].precision, 0);
-
-  EXPECT_EQ(item.configItems[2].configId, 2);
-  EXPECT_EQ(item.configItems[2].unit, static_cast<uint8_t>(Unit::Type::s));
-  EXPECT_FALSE(item.configItems[2].isSigned);
-  EXPECT_EQ(item.configItems[2].sizeCode, sizeof(uint16_t) / 2);
-  EXPECT_EQ(item.configItems[2].precision, 0);
-
-  EXPECT_EQ(item.configItems[3].configId, 3);
-  EXPECT_EQ(item.configItems[3].unit,
-            static_cast<uint8_t>(Unit::Type::percent));
-  EXPECT_TRUE(item.configItems[3].isSigned);
-  EXPECT_EQ(item.configItems[3].sizeCode, sizeof(HumidityT) / 2);
-  EXPECT_EQ(item.configItems[3].precision, 0);
+  EXPECT_EQ(item.entityId, 2);
+  EXPECT_EQ(item.componentType,
+            static_cast<uint8_t>(BaseComponent::Type::SENSOR));
+  EXPECT_EQ(item.deviceClass,
+            static_cast<uint8_t>(SensorDeviceClass::HUMIDITY));
+  EXPECT_EQ(item.unit, static_cast<uint8_t>(Unit::Type::percent));
+  EXPECT_FALSE(item.isSigned);
+  EXPECT_EQ(item.sizeCode, sizeof(HumidityT) / 2);
+  EXPECT_EQ(item.precision, 0);
+  EXPECT_EQ(item.minValue, 0);
+  EXPECT_EQ(item.maxValue, 100);
+  EXPECT_STREQ(item.name, humiditySensorName);
 }
 
-TEST_F(HumiditySensor_test, getEntityId) { EXPECT_EQ(pHs->getEntityId(), 51); }
+TEST_F(HumiditySensor_test, getEntityId) { EXPECT_EQ(pHs->getEntityId(), 2); }
 
 TEST_F(HumiditySensor_test, getValueItem) {
   ValueItemT item;
 
-  pHs->getValueItem(&item);
+  pHs->getValueItem(item);
 
-  EXPECT_EQ(item.entityId, 51);
+  EXPECT_EQ(item.entityId, 2);
   EXPECT_EQ(item.value, 0);
 }
 
+TEST_F(HumiditySensor_test, setValueItem_shall_not_set_value) {
+  EXPECT_FALSE(pHs->setValueItem({2, 12}));
+}
+
 TEST_F(HumiditySensor_test, print) {
   const char* expectStr = "HumiditySensor=0%";
-  HumiditySensor hs = HumiditySensor(51, "HumiditySensor", *pDhtMock);
 
-  EXPECT_EQ(hs.printTo(Serial), strlen(expectStr));
+  EXPECT_EQ(pHs->printTo(Serial), strlen(expectStr));
 
   bufSerReadStr();
   EXPECT_STREQ(strBuf, expectStr);
 }
 
 TEST_F(HumiditySensor_test, print_service_shall_do_nothing) {
-  HumiditySensor hs = HumiditySensor(51, "HumiditySensor", *pDhtMock);
-  EXPECT_EQ(hs.printTo(Serial, 0), 0);
-}
-
-TEST_F(HumiditySensor_test, setConfigs_all_in_order) {
-  ConfigItemValueT inItems[4] = {{0, 100}, {1, 1001}, {2, 1002}, {3, 103}};
-  EXPECT_TRUE(pHs->setConfigItemValues(inItems, 4));
-
-  ConfigItemValueT items[4];
-  EXPECT_EQ(pHs->getConfigItemValues(items, sizeof(items) / sizeof(items[0])),
-            4);
-  EXPECT_EQ(items[0].value, 100);
-  EXPECT_EQ(items[1].value, 1001);
-  EXPECT_EQ(items[2].value, 1002);
-  EXPECT_EQ(items[3].value, 100);  // Clamped to max 100
+  EXPECT_EQ(pHs->printTo(Serial, 0), 0);
 }
 
-TEST_F(HumiditySensor_test, setConfigs_all_out_of_order) {
-  ConfigItemValueT inItems[4] = {{3, 23}, {2, 2002}, {1, 2001}, {0, 20}};
-  EXPECT_TRUE(pHs->setConfigItemValues(inItems, 4));
-
-  ConfigItemValueT items[4];
-  EXPECT_EQ(pHs->getConfigItemValues(items, sizeof(items) / sizeof(items[0])),
-            4);
-  EXPECT_EQ(items[0].value, 20);
-  EXPECT_EQ(items[1].value, 2001);
-  EXPECT_EQ(items[2].value, 2002);
-  EXPECT_EQ(items[3].value, 23);
-}
+TEST_F(HumiditySensor_test, update_shall_set_rounded_value) {
+  expectMeasurement(45.6f);
 
-TEST_F(HumiditySensor_test, setConfigs_one) {
-  ConfigItemValueT inItems[1] = {{3, 33}};
-  EXPECT_TRUE(pHs->setConfigItemValues(inItems, 1));
-
-  ConfigItemValueT items[4];
-  EXPECT_EQ(pHs->getConfigItemValues(items, sizeof(items) / sizeof(items[0])),
-            4);
-  EXPECT_EQ(items[0].value, 10);
-  EXPECT_EQ(items[1].value, 60);
-  EXPECT_EQ(items[2].value, 300);
-  EXPECT_EQ(items[3].value, 33);
-}
+  pHs->update();
 
-TEST_F(HumiditySensor_test, setConfigs_too_many) {
-  ConfigItemValueT inItems[5] = {
-      {0, 100}, {1, 1001}, {2, 1002}, {3, 103}, {4, 1004}};
-  EXPECT_FALSE(pHs->setConfigItemValues(inItems, 5));
+  EXPECT_EQ(getValue(), 46);
 }
 
-TEST_F(HumiditySensor_test, setConfigs_out_of_range) {
-  ConfigItemValueT inItems[1] = {{4, 3004}};
-  EXPECT_FALSE(pHs->setConfigItemValues(inItems, 1));
-}
+TEST_F(HumiditySensor_test, update_read_failed_shall_keep_value) {
+  expectMeasurement(45.6f);
+  pHs->update();
 
-TEST_F(HumiditySensor_test, setReported) {
-  EXPECT_CALL(*pArduinoMock, millis()).Times(1);
-  pHs->setReported();
-}
+  now = 2000;
+  EXPECT_CALL(*pI2cMock, write(_, 3, _, _, _)).WillOnce(Return(false));
+  pHs->update();
 
-TEST_F(HumiditySensor_test,
-       update_largeValueDiff_largeTimeDiff_withConfigsZero_shall_return_false) {
-  EXPECT_CALL(*pDhtMock, read(false)).WillOnce(Return(true));
-  EXPECT_CALL(*pDhtMock, readHumidity(false)).WillOnce(Return(10));
-  EXPECT_CALL(*pArduinoMock, millis()).Times(0);
-  ConfigItemValueT inItems[4] = {{0, 0}, {1, 0}, {2, 0}, {3, 0}};
-  EXPECT_TRUE(pHs->setConfigItemValues(inItems, 4));
-  EXPECT_FALSE(pHs->update());
+  EXPECT_EQ(getValue(), 46);
 }
 
 TEST_F(HumiditySensor_test,
        update_smallValueDiff_smallTimeDiff_shall_return_false) {
-  EXPECT_CALL(*pDhtMock, read(false)).WillOnce(Return(true));
-  EXPECT_CALL(*pDhtMock, readHumidity(false)).WillOnce(Return(9));
-  EXPECT_CALL(*pArduinoMock, millis()).WillOnce(Return(59999));
+  pHs->setReported(ReportReason::due);
+  now = 300000 - 1;
+  expectMeasurement(9.0f);
+
   EXPECT_FALSE(pHs->update());
 }
 
 TEST_F(HumiditySensor_test,
        update_smallValueDiff_largeTimeDiff_shall_return_true) {
-  EXPECT_CALL(*pDhtMock, read(false)).WillOnce(Return(true));
-  EXPECT_CALL(*pDhtMock, readHumidity(false)).WillOnce(Return(9));
-  EXPECT_CALL(*pArduinoMock, millis()).WillOnce(Return(300000));
+  pHs->setReported(ReportReason::due);
+  now = 300000;
+  expectMeasurement(9.0f);
+
   EXPECT_TRUE(pHs->update());
 }
 
 TEST_F(HumiditySensor_test,
        update_largeValueDiff_smallTimeDiff_shall_return_true) {
-  EXPECT_CALL(*pDhtMock, read(false)).WillOnce(Return(true));
-  EXPECT_CALL(*pDhtMock, readHumidity(false)).WillOnce(Return(10));
-  EXPECT_CALL(*pArduinoMock, millis()).WillOnce(Return(299999));
-  EXPECT_TRUE(pHs->update());
-}
+  pHs->setReported(ReportReason::due);
+  now = 300000 - 1;
+  expectMeasurement(10.2f);
 
-TEST_F(HumiditySensor_test,
-       update_largeValueDiff_largeTimeDiff_shall_return_true) {
-  EXPECT_CALL(*pDhtMock, read(false)).WillOnce(Return(true));
-  EXPECT_CALL(*pDhtMock, readHumidity(false)).WillOnce(Return(10));
-  EXPECT_CALL(*pArduinoMock, millis()).WillOnce(Return(300000));
   EXPECT_TRUE(pHs->update());
 }
 
 TEST_F(HumiditySensor_test, isReportDue) {
-  EXPECT_CALL(*pArduinoMock, millis()).WillOnce(Return(0));
-
   // Newly constructed shall be true
   EXPECT_TRUE(pHs->isReportDue());
 
   // Shall be set to false when setReported() is called
-  pHs->setReported();
+  pHs->setReported(ReportReason::due);
   EXPECT_FALSE(pHs->isReportDue());
 }
-
-TEST_F(HumiditySensor_test, loadConfigValues_crc_fail_shall_load_defaults) {
-  pHs->loadConfigValues();
-
-  ConfigItemValueT items[4];
-  EXPECT_EQ(pHs->getConfigItemValues(items, arrayLength(items)), 4);
-  EXPECT_EQ(items[0].value,
-            HumiditySensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT);
-  EXPECT_EQ(items[1].value,
-            HumiditySensorConstants::CONFIG_MEASURE_INTERVAL_DEFAULT);
-  EXPECT_EQ(items[2].value,
-            HumiditySensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT);
-  EXPECT_EQ(items[3].value,
-            HumiditySensorConstants::CONFIG_COMPENSATION_DEFAULT);
-}
-
-TEST_F(HumiditySensor_test, DISABLED_loadConfigValues_crc_ok_shall_load_stored_values) {
-  CRC8 crc;
-  int eeAddr = 0;
-
-  const HumidityT expectedConfig0 = 63;
-  crc.restart();
-  crc.add(expectedConfig0);
-  const uint8_t expectedCrc0 = crc.calc();
-  eeAddr = EE_ADDRESS_CONFIG_HUMIDITY_SENSOR_0;
-  eeprom_write_byte(eeAddr++, lowByte(expectedConfig0));
-  eeprom_write_byte(eeAddr++, expectedCrc0);
-
-  const uint16_t expectedConfig1 = 2001;
-  crc.restart();
-  crc.add(lowByte(expectedConfig1));
-  crc.add(highByte(expectedConfig1));
-  const uint8_t expectedCrc1 = crc.calc();
-  eeAddr = EE_ADDRESS_CONFIG_HUMIDITY_SENSOR_1;
-  eeprom_write_byte(eeAddr++, lowByte(expectedConfig1));
-  eeprom_write_byte(eeAddr++, highByte(expectedConfig1));
-  eeprom_write_byte(eeAddr++, expectedCrc1);
-
-  const uint16_t expectedConfig2 = 2002;
-  crc.restart();
-  crc.add(lowByte(expectedConfig2));
-  crc.add(highByte(expectedConfig2));
-  const uint8_t expectedCrc2 = crc.calc();
-  eeAddr = EE_ADDRESS_CONFIG_HUMIDITY_SENSOR_2;
-  eeprom_write_byte(eeAddr++, lowByte(expectedConfig2));
-  eeprom_write_byte(eeAddr++, highByte(expectedConfig2));
-  eeprom_write_byte(eeAddr++, expectedCrc2);
-
-  const int8_t expectedConfig3 = -33;
-  crc.restart();
-  crc.add(expectedConfig3);
-  const uint8_t expectedCrc3 = crc.calc();
-  eeAddr = EE_ADDRESS_CONFIG_HUMIDITY_SENSOR_3;
-  eeprom_write_byte(eeAddr++, lowByte(expectedConfig3));
-  eeprom_write_byte(eeAddr++, expectedCrc3);
-
-  pHs->loadConfigValues();
-
-  ConfigItemValueT items[4];
-  EXPECT_EQ(pHs->getConfigItemValues(items, arrayLength(items)), 4);
-  EXPECT_EQ(items[0].value, expectedConfig0);
-  EXPECT_EQ(items[1].value, expectedConfig1);
-  EXPECT_EQ(items[2].value, expectedConfig2);
-  EXPECT_EQ(items[3].value, expectedConfig3);
-}
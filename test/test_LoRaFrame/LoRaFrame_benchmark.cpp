@@ -0,0 +1,171 @@
+#include <LoRaFrame.h>
+#include <gtest/gtest.h>
+#include <stdio.h>
+
+#include <chrono>
+#include <vector>
+
+#include "CompactValue.h"
+#include "LoRaHandler.h"
+
+// Measures how many frames per second a gateway decodes, with the values
+// resolved. The frames are the mix a node sends: mostly value messages in
+// the four formats, some announce and ping messages.
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr uint32_t kFrames = 1024;
+static constexpr uint32_t kRounds = 2000;
+static constexpr uint8_t kNodes = 50;
+static constexpr uint8_t kMaxValues = 32;
+
+namespace {
+
+struct CapturedFrame {
+  uint8_t length;
+  uint8_t bytes[LORA_MAX_MESSAGE_LENGTH];
+};
+
+std::vector<CapturedFrame> captureFrames() {
+  std::vector<CapturedFrame> frames(kFrames);
+  static CompactValueEncoder<16> encoders[kNodes + 1];
+  for (CompactValueEncoder<16>& encoder : encoders) {
+    for (uint8_t id = 0; id < 16; id++) {
+      encoder.addEntity(id, false);
+    }
+  }
+
+  uint32_t seed = 1;
+  for (uint32_t i = 0; i < kFrames; i++) {
+    seed = seed * 1103515245UL + 12345;
+    CapturedFrame& frame = frames[i];
+    LoRaHeaderT header;
+    header.dst = 0;
+    header.src = 1 + i % kNodes;
+    header.id = static_cast<uint8_t>(i);
+    uint8_t* payload = &frame.bytes[LORA_HEADER_LENGTH];
+    const size_t length = sizeof(frame.bytes) - LORA_HEADER_LENGTH;
+    size_t n = 0;
+
+    if (i % 16 == 0) {
+      header.flags.msgType = LoRaMsgType::announce_msg;
+      const uint8_t announce[] = {0x19, 0x9F, 0xBC, 0xE9, 14, 0x01, 0x2C};
+      memcpy(payload, announce, sizeof(announce));
+      n = sizeof(announce);
+    } else if (i % 16 == 1) {
+      header.flags.msgType = LoRaMsgType::ping_msg;
+      payload[0] = 0xFF;
+      payload[1] = 0xA6;
+      n = 2;
+    } else {
+      header.flags.msgType = LoRaMsgType::value_msg;
+      header.flags.compact_values = i % 2;
+      const bool bitmap = i % 4 >= 2;
+      LoRaValuePayloadT values;
+      values.numberOfEntities = 1 + (seed >> 16) % 8;
+      for (uint8_t j = 0; j < values.numberOfEntities; j++) {
+        values.valueItems[j] =
+            ValueItemT(2 * j, static_cast<uint32_t>(seed >> (j + 8)) % 5000);
+      }
+
+      if (!header.flags.compact_values) {
+        n = values.toByteArray(payload, length, bitmap);
+      } else if (!bitmap) {
+        CompactValueEncoder<16>& encoder = encoders[header.src];
+        payload[0] = values.numberOfEntities;
+        n = 1;
+        for (uint8_t j = 0; j < values.numberOfEntities; j++) {
+          n += encoder.encode(values.valueItems[j], &payload[n], length - n);
+          encoder.setSent(values.valueItems[j], header.id);
+        }
+        encoder.confirm(header.id);
+      } else {
+        LoRaFrame::Header h;
+        h.flags =
+            LoRaFrame::FLAG_COMPACT_VALUES | LoRaFrame::FLAG_BITMAP_VALUES;
+        LoRaFrame::ValueWriter writer(
+            h, payload, length, values.valueItems[0].entityId,
+            values.valueItems[values.numberOfEntities - 1].entityId);
+        for (uint8_t j = 0; j < values.numberOfEntities; j++) {
+          writer.add(LoRaFrame::RawValue{values.valueItems[j].entityId,
+                                         LoRaFrame::ValueMode::absolute,
+                                         values.valueItems[j].value});
+        }
+        n = writer.getLength();
+      }
+      header.flags.bitmap_values = bitmap;
+    }
+
+    header.toByteArray(frame.bytes);
+    frame.length = static_cast<uint8_t>(LORA_HEADER_LENGTH + n);
+  }
+  return frames;
+}
+
+}  // namespace
+
+TEST(LoRaFrame_benchmark, decode_frames) {
+  const std::vector<CapturedFrame> frames = captureFrames();
+  // One decoder per node, as a gateway keeps them
+  static LoRaFrame::ValueDecoder decoders[kNodes + 1];
+  LoRaFrame::Value values[kMaxValues];
+  uint32_t errors = 0;
+  volatile uint32_t sink = 0;
+  size_t bytes = 0;
+
+  auto start = Clock::now();
+  for (uint32_t round = 0; round < kRounds; round++) {
+    for (const CapturedFrame& captured : frames) {
+      LoRaFrame::Frame frame;
+      if (frame.decode(LoRaFrame::Span(captured.bytes, captured.length)) ==
+          0) {
+        errors++;
+        continue;
+      }
+      bytes += captured.length;
+
+      switch (frame.header.getMsgType()) {
+        case LoRaFrame::MsgType::value_msg: {
+          size_t count;
+          if (!decoders[frame.header.src].decode(frame.header, frame.payload,
+                                                 values, kMaxValues, count)) {
+            errors++;
+          }
+          for (size_t i = 0; i < count; i++) {
+            sink = sink + values[i].value;
+          }
+          break;
+        }
+
+        case LoRaFrame::MsgType::announce_msg: {
+          LoRaFrame::AnnounceMsg msg;
+          errors += msg.decode(frame.payload) == 0;
+          sink = sink + msg.hash;
+          break;
+        }
+
+        case LoRaFrame::MsgType::ping_msg: {
+          LoRaFrame::PingMsg msg;
+          errors += msg.decode(frame.payload) == 0;
+          sink = sink + msg.rssi;
+          break;
+        }
+
+        default:
+          errors++;
+          break;
+      }
+    }
+  }
+  auto end = Clock::now();
+
+  const double s = std::chrono::duration<double>(end - start).count();
+  const double framesPerSecond = kFrames * kRounds / s;
+  printf("%u frames in %.3f s: %.2f M frames/s, %.1f MB/s\n",
+         kFrames * kRounds, s, framesPerSecond / 1e6, bytes / s / 1e6);
+
+  EXPECT_EQ(errors, 0);
+  // Generous bound, the tests are built without optimization on a shared
+  // host. An optimized build does several times more.
+  EXPECT_GT(framesPerSecond, 1e6);
+}
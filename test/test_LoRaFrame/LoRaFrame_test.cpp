@@ -0,0 +1,342 @@
+#include <LoRaFrame.h>
+#include <gtest/gtest.h>
+
+#include "CompactDiscovery.h"
+#include "CompactValue.h"
+#include "LoRaHandler.h"
+
+using LoRaFrame::RawValue;
+using LoRaFrame::Span;
+using LoRaFrame::Value;
+using LoRaFrame::ValueMode;
+
+static const char carPresenceName[] PROGMEM = "Car Presence Min Stable Time";
+static const char mixedName[] PROGMEM = "Garage Door Sensor";
+
+static LoRaFrame::Header makeHeader(uint8_t flags) {
+  LoRaFrame::Header header;
+  header.flags = flags;
+  header.setMsgType(LoRaFrame::MsgType::value_msg);
+  return header;
+}
+
+TEST(LoRaFrame_test, header_shall_match_node) {
+  LoRaHeaderT node;
+  node.dst = 1;
+  node.src = 2;
+  node.id = 3;
+  node.flags.ack_request = true;
+  node.flags.compact_values = true;
+  node.flags.msgType = LoRaMsgType::announce_msg;
+  uint8_t buf[LORA_HEADER_LENGTH];
+  node.toByteArray(buf);
+
+  LoRaFrame::Frame frame;
+  EXPECT_EQ(frame.decode(Span(buf, sizeof(buf))), sizeof(buf));
+  EXPECT_EQ(frame.header.dst, 1);
+  EXPECT_EQ(frame.header.src, 2);
+  EXPECT_EQ(frame.header.id, 3);
+  EXPECT_TRUE(frame.header.isAckRequest());
+  EXPECT_TRUE(frame.header.isCompactValues());
+  EXPECT_FALSE(frame.header.isBitmapValues());
+  EXPECT_FALSE(frame.header.isAck());
+  EXPECT_EQ(frame.header.getMsgType(), LoRaFrame::MsgType::announce_msg);
+  EXPECT_EQ(frame.payload.size, 0);
+
+  uint8_t out[LORA_HEADER_LENGTH];
+  EXPECT_EQ(frame.header.encode(out, sizeof(out)), sizeof(out));
+  EXPECT_EQ(memcmp(out, buf, sizeof(buf)), 0);
+
+  EXPECT_EQ(frame.decode(Span(buf, 3)), 0);
+}
+
+TEST(LoRaFrame_test, plain_values_shall_match_node) {
+  for (bool bitmap : {false, true}) {
+    LoRaValuePayloadT node;
+    node.numberOfEntities = 3;
+    node.valueItems[0] = ValueItemT(1, 100);
+    node.valueItems[1] = ValueItemT(2, static_cast<uint32_t>(-5));
+    node.valueItems[2] = ValueItemT(12, 0x12345678);
+    uint8_t buf[LORA_MAX_PAYLOAD_LENGTH];
+    const size_t n = node.toByteArray(buf, sizeof(buf), bitmap);
+    ASSERT_NE(n, 0);
+
+    const LoRaFrame::Header header =
+        makeHeader(bitmap ? LoRaFrame::FLAG_BITMAP_VALUES : 0);
+    LoRaFrame::ValueReader reader(header, Span(buf, n));
+    RawValue value;
+    for (uint8_t i = 0; i < node.numberOfEntities; i++) {
+      ASSERT_TRUE(reader.next(value));
+      EXPECT_EQ(value.entityId, node.valueItems[i].entityId);
+      EXPECT_EQ(value.mode, ValueMode::plain);
+      EXPECT_EQ(value.value, node.valueItems[i].value);
+    }
+    EXPECT_FALSE(reader.next(value));
+    EXPECT_FALSE(reader.isError());
+
+    // And back
+    uint8_t out[LORA_MAX_PAYLOAD_LENGTH];
+    LoRaFrame::ValueWriter writer(header, out, sizeof(out), 1, 12);
+    for (uint8_t i = 0; i < node.numberOfEntities; i++) {
+      EXPECT_TRUE(writer.add(RawValue{node.valueItems[i].entityId,
+                                      ValueMode::plain,
+                                      node.valueItems[i].value}));
+    }
+    ASSERT_EQ(writer.getLength(), n);
+    EXPECT_EQ(memcmp(out, buf, n), 0);
+  }
+}
+
+TEST(LoRaFrame_test, compact_values_shall_resolve_deltas) {
+  CompactValueEncoder<4> encoder;
+  encoder.addEntity(1, true);
+  encoder.addEntity(70, false);
+
+  LoRaFrame::ValueDecoder decoder;
+  decoder.addEntity(1, true, 1);
+  decoder.addEntity(70, false, 2);
+
+  const LoRaFrame::Header header =
+      makeHeader(LoRaFrame::FLAG_COMPACT_VALUES);
+  const ValueItemT frames[][3] = {
+      {ValueItemT(1, static_cast<uint32_t>(-250)), ValueItemT(70, 100000),
+       ValueItemT(5, 0xCAFE)},
+      {ValueItemT(1, static_cast<uint32_t>(-248)), ValueItemT(70, 99990),
+       ValueItemT(5, 0xBEEF)}};
+
+  uint8_t msgId = 0;
+  for (const auto& items : frames) {
+    uint8_t buf[LORA_MAX_PAYLOAD_LENGTH];
+    buf[0] = 3;
+    size_t n = 1;
+    for (const ValueItemT& item : items) {
+      n += encoder.encode(item, &buf[n], sizeof(buf) - n);
+      encoder.setSent(item, msgId);
+    }
+    encoder.confirm(msgId++);  // The gateway ACKs
+
+    Value values[4];
+    size_t count;
+    ASSERT_TRUE(decoder.decode(header, Span(buf, n), values, 4, count));
+    ASSERT_EQ(count, 3);
+    for (uint8_t i = 0; i < 3; i++) {
+      EXPECT_EQ(values[i].entityId, items[i].entityId);
+      EXPECT_EQ(values[i].value, items[i].value);
+    }
+  }
+}
+
+TEST(LoRaFrame_test, delta_without_value_before_shall_fail) {
+  const uint8_t payload[] = {1, 0x41, 0x02};  // One delta of entity 1
+  LoRaFrame::ValueDecoder decoder;
+  Value values[1];
+  size_t count;
+
+  EXPECT_FALSE(decoder.decode(makeHeader(LoRaFrame::FLAG_COMPACT_VALUES),
+                              Span(payload, sizeof(payload)), values, 1,
+                              count));
+}
+
+TEST(LoRaFrame_test, bitmap_compact_values_round_trip) {
+  const LoRaFrame::Header header = makeHeader(
+      LoRaFrame::FLAG_COMPACT_VALUES | LoRaFrame::FLAG_BITMAP_VALUES);
+  const RawValue values[] = {
+      {0, ValueMode::absolute, 5},   {1, ValueMode::raw, 0xDEADBEEF},
+      {3, ValueMode::delta, 3},      {9, ValueMode::absolute, 300},
+      {10, ValueMode::absolute, 1}};
+
+  uint8_t buf[32];
+  LoRaFrame::ValueWriter writer(header, buf, sizeof(buf), 0, 10);
+  for (const RawValue& value : values) {
+    EXPECT_TRUE(writer.add(value));
+  }
+  EXPECT_FALSE(writer.add(RawValue{10, ValueMode::absolute, 1}));  // Order
+
+  // First id, bitmap of ids 0-15, modes of values 0-3, values, the mode of
+  // value 4 and its value
+  const uint8_t expected[] = {0,    2,    0x0B, 0x06, 0x18, 5,    0xDE,
+                              0xAD, 0xBE, 0xEF, 3,    0xAC, 0x02, 0x00,
+                              1};
+  ASSERT_EQ(writer.getLength(), sizeof(expected));
+  EXPECT_EQ(memcmp(buf, expected, sizeof(expected)), 0);
+
+  LoRaFrame::ValueReader reader(header, Span(buf, writer.getLength()));
+  RawValue value;
+  for (const RawValue& v : values) {
+    ASSERT_TRUE(reader.next(value));
+    EXPECT_EQ(value.entityId, v.entityId);
+    EXPECT_EQ(value.mode, v.mode);
+    EXPECT_EQ(value.value, v.value);
+  }
+  EXPECT_FALSE(reader.next(value));
+  EXPECT_FALSE(reader.isError());
+}
+
+TEST(LoRaFrame_test, truncated_values_shall_fail) {
+  LoRaValuePayloadT node;
+  node.numberOfEntities = 2;
+  node.valueItems[0] = ValueItemT(1, 100);
+  node.valueItems[1] = ValueItemT(2, 200);
+  uint8_t buf[16];
+  const size_t n = node.toByteArray(buf, sizeof(buf));
+
+  LoRaFrame::ValueReader reader(makeHeader(0), Span(buf, n - 1));
+  RawValue value;
+  EXPECT_TRUE(reader.next(value));
+  EXPECT_FALSE(reader.next(value));
+  EXPECT_TRUE(reader.isError());
+
+  const uint8_t bitmap[] = {0, 40};  // Longer than any node sends
+  LoRaFrame::ValueReader bitmapReader(
+      makeHeader(LoRaFrame::FLAG_BITMAP_VALUES),
+      Span(bitmap, sizeof(bitmap)));
+  EXPECT_FALSE(bitmapReader.next(value));
+  EXPECT_TRUE(bitmapReader.isError());
+}
+
+TEST(LoRaFrame_test, signed_values_shall_be_sign_extended) {
+  // A 2 byte signed entity sent raw with its bits only
+  const uint8_t payload[] = {1, 0x80 | 7, 0x00, 0x00, 0xFF, 0xFE};
+  LoRaFrame::ValueDecoder decoder;
+  decoder.addEntity(7, true, 1);
+  Value values[1];
+  size_t count;
+
+  ASSERT_TRUE(decoder.decode(makeHeader(LoRaFrame::FLAG_COMPACT_VALUES),
+                             Span(payload, sizeof(payload)), values, 1,
+                             count));
+  ASSERT_EQ(count, 1);
+  EXPECT_EQ(static_cast<int32_t>(values[0].value), -2);
+}
+
+TEST(LoRaFrame_test, dictionary_shall_match_node) {
+  for (uint8_t i = 0; i < CompactDiscovery::WORD_COUNT; i++) {
+    uint8_t buf[4];
+    EXPECT_EQ(LoRaFrame::encodeCompactName(CompactDiscovery::Words[i], buf,
+                                           sizeof(buf)),
+              2);
+    EXPECT_EQ(buf[0], CompactDiscovery::WORD_FLAG | i);
+  }
+}
+
+TEST(LoRaFrame_test, discovery_batch_shall_match_node) {
+  DiscoveryEntityT entities[2]{};
+  entities[0].entityId = 3;
+  entities[0].componentType = 2;
+  entities[0].unit = 12;
+  entities[0].isSigned = 1;
+  entities[0].sizeCode = 1;
+  entities[0].precision = 1;
+  entities[0].minValue = static_cast<uint32_t>(-400);
+  entities[0].maxValue = 850;
+  entities[0].name = carPresenceName;
+  entities[1].entityId = 4;
+  entities[1].name = mixedName;
+
+  uint8_t buf[LORA_MAX_PAYLOAD_LENGTH];
+  size_t n = 6;
+  uint32_t hash = CompactDiscovery::FNV_OFFSET_BASIS;
+  for (const DiscoveryEntityT& entity : entities) {
+    n += CompactDiscovery::entityToByteArray(entity, &buf[n], sizeof(buf) - n);
+    hash = CompactDiscovery::hashEntity(hash, entity);
+  }
+  *(reinterpret_cast<uint32_t*>(&buf[0])) = hton(hash);
+  buf[4] = 14;
+  buf[5] = 2;
+
+  LoRaFrame::DiscoveryBatchMsg msg;
+  ASSERT_EQ(msg.decode(Span(buf, n)), n);
+  EXPECT_EQ(msg.hash, hash);
+  EXPECT_EQ(msg.totalCount, 14);
+  EXPECT_EQ(msg.count, 2);
+
+  size_t offset = 0;
+  uint32_t gatewayHash = LoRaFrame::FNV_OFFSET_BASIS;
+  for (const DiscoveryEntityT& entity : entities) {
+    LoRaFrame::DiscoveryEntity e;
+    ASSERT_TRUE(msg.nextEntity(offset, e));
+    EXPECT_EQ(e.entityId, entity.entityId);
+    EXPECT_EQ(e.unit, entity.unit);
+    EXPECT_EQ(e.isSigned(), entity.isSigned);
+    EXPECT_EQ(e.getSizeCode(), entity.sizeCode);
+    EXPECT_EQ(e.getPrecision(), entity.precision);
+    EXPECT_EQ(e.minValue, entity.minValue);
+    EXPECT_EQ(e.maxValue, entity.maxValue);
+
+    char name[LoRaFrame::DiscoveryEntity::MAX_NAME_SIZE];
+    EXPECT_EQ(e.getName(name, sizeof(name)), strlen(entity.name));
+    EXPECT_STREQ(name, entity.name);
+    gatewayHash = e.hash(gatewayHash);
+  }
+  EXPECT_EQ(offset, n - 6);
+  EXPECT_EQ(gatewayHash, hash);
+
+  LoRaFrame::DiscoveryEntity e;
+  EXPECT_FALSE(msg.nextEntity(offset, e));
+}
+
+TEST(LoRaFrame_test, plain_discovery_shall_match_node) {
+  DiscoveryEntityT entity{};
+  entity.entityId = 9;
+  entity.name = mixedName;
+  uint8_t buf[LORA_MAX_PAYLOAD_LENGTH];
+  const size_t n = entity.toByteArray(buf, sizeof(buf));
+
+  LoRaFrame::DiscoveryEntity e;
+  ASSERT_EQ(e.decode(Span(buf, n), false), n);
+  char name[32];
+  e.getName(name, sizeof(name));
+  EXPECT_STREQ(name, mixedName);
+
+  uint8_t out[LORA_MAX_PAYLOAD_LENGTH];
+  ASSERT_EQ(e.encode(out, sizeof(out)), n);
+  EXPECT_EQ(memcmp(out, buf, n), 0);
+
+  EXPECT_EQ(e.decode(Span(buf, n - 1), false), 0);  // No terminator
+}
+
+TEST(LoRaFrame_test, requests_shall_match_node) {
+  uint8_t buf[8];
+
+  LoRaFrame::ValueSetReq valueSet;
+  valueSet.entityId = 5;
+  valueSet.value = 280;
+  size_t n = valueSet.encode(buf, sizeof(buf));
+  ValueItemT item;
+  EXPECT_EQ(item.fromByteArray(buf, n), n);
+  EXPECT_EQ(item, ValueItemT(5, 280));
+
+  LoRaFrame::ServiceReq service;
+  service.entityId = 0;
+  service.service = 2;
+  n = service.encode(buf, sizeof(buf));
+  LoRaServiceItemT serviceItem;
+  EXPECT_NE(serviceItem.fromByteArray(buf, n), 0);
+  EXPECT_EQ(serviceItem.entityId, 0);
+  EXPECT_EQ(serviceItem.service, 2);
+
+  LoRaFrame::DiscoveryReq discovery;
+  discovery.hasHash = true;
+  discovery.hash = 0x199FBCE9;
+  EXPECT_EQ(discovery.encode(buf, sizeof(buf)), 5);
+  EXPECT_EQ(buf[0], LoRaFrame::ALL_ENTITIES);
+  EXPECT_EQ(ntoh(*reinterpret_cast<uint32_t*>(&buf[1])), 0x199FBCE9);
+  EXPECT_EQ(discovery.encode(buf, 4), 0);
+}
+
+TEST(LoRaFrame_test, announce_and_ping) {
+  const uint8_t announce[] = {0x19, 0x9F, 0xBC, 0xE9, 14, 0x01, 0x2C};
+  LoRaFrame::AnnounceMsg msg;
+  EXPECT_EQ(msg.decode(Span(announce, sizeof(announce))), 7);
+  EXPECT_EQ(msg.hash, 0x199FBCE9);
+  EXPECT_EQ(msg.entityCount, 14);
+  EXPECT_EQ(msg.rxPeriod_s, 300);
+  EXPECT_EQ(msg.decode(Span(announce, 5)), 5);  // Without RX windows
+  EXPECT_EQ(msg.rxPeriod_s, 0);
+  EXPECT_EQ(msg.decode(Span(announce, 4)), 0);
+
+  const uint8_t ping[] = {0xFF, 0xA6};
+  LoRaFrame::PingMsg pingMsg;
+  EXPECT_EQ(pingMsg.decode(Span(ping, sizeof(ping))), 2);
+  EXPECT_EQ(pingMsg.rssi, -90);
+}
@@ -4,14 +4,17 @@
 #include <CTR.h>
 #include <gtest/gtest.h>
 
+#include <vector>
+
 #include "Arduino.h"
 #include "BufferSerial.h"
+#include "Device.h"
 #include "LoRa.h"
 #include "Types.h"
 
 // Include source implementation
+#include "../../src/Log.cpp"
 #include "../../src/Util.cpp"
-#include "../../src/AirTime.cpp"
 #include "../../src/LoRaHandler.cpp"
 
 #define LoRa (*LoRaHandler_test::pLoRaMock)
@@ -19,30 +22,16 @@
 #define LORA_MY_ADDRESS 2
 
 using ::testing::_;
+using ::testing::AnyNumber;
 using ::testing::DoAll;
 using ::testing::HasSubstr;
 using ::testing::Invoke;
 using ::testing::IsSupersetOf;
 using ::testing::Return;
+using ::testing::ReturnPointee;
 using ::testing::SaveArg;
 
 static LoRaTxMessageT loraTxMsg;
-typedef struct {
-  uint8_t buf[LORA_MAX_MESSAGE_LENGTH] = {};
-  size_t length{};
-} LoRaBufT;
-
-static LoRaBufT loraTxBuf;
-
-struct EncryptedMsg {
-  EncryptedMsg() {}
-
-  uint8_t mockLoRaRead() { return buffer.buf[i++]; }
-
-  size_t i{};
-  LoRaBufT buffer;
-};
-
 static void loraReadBuf(const uint8_t* buf, size_t size) {
   uint8_t n = loraTxMsg.header.fromByteArray(&buf[0]);
   EXPECT_GE(size, n);
@@ -50,10 +39,13 @@ static void loraReadBuf(const uint8_t* buf, size_t size) {
   memcpy(loraTxMsg.payload, &buf[n], loraTxMsg.payload_length);
 }
 
-static void loraReadRawBuf(const uint8_t* buf, size_t size) {
-  EXPECT_LE(size, LORA_MAX_MESSAGE_LENGTH);
-  memcpy(loraTxBuf.buf, buf, size);
-  loraTxBuf.length = size;
+// Lowest stack address seen in LoRa.write()
+static uintptr_t stackAtWrite = UINTPTR_MAX;
+
+static void recordStack(const uint8_t*, size_t) {
+  volatile uint8_t marker = 0;
+  const uintptr_t sp = reinterpret_cast<uintptr_t>(&marker);
+  stackAtWrite = sp < stackAtWrite ? sp : stackAtWrite;
 }
 
 bool FakeCallbackFunc_called;
@@ -64,13 +56,6 @@ void FakeCallbackFunc(uint8_t entityId) {
   FakeCallbackFunc_entityId = entityId;
 }
 
-ConfigValuePayloadT FakeCallbackFunc_config;
-
-void FakeConfigCallbackFunc(const ConfigValuePayloadT& item) {
-  FakeCallbackFunc_called = true;
-  memcpy(&FakeCallbackFunc_config, &item, sizeof(FakeCallbackFunc_config));
-}
-
 LoRaServiceItemT FakeCallbackFunc_service;
 
 void FakeServiceCallbackFunc(const LoRaServiceItemT& item) {
@@ -80,6 +65,23 @@ void FakeServiceCallbackFunc(const LoRaServiceItemT& item) {
 
 void FakeValueReqCallbackFunc(void) { FakeCallbackFunc_called = true; }
 
+static LoRaHandler* pValueReqHandler;
+
+// Queues a value of every component, like main.cpp does on a value request.
+void FakeValueReqQueueAllFunc(void) {
+  FakeCallbackFunc_called = true;
+  for (uint8_t i = 0; i < DEVICE_MAX_COMPONENTS; i++) {
+    EXPECT_TRUE(pValueReqHandler->queueValueItem(ValueItemT(i, i)));
+  }
+}
+
+ValueItemT FakeCallbackFunc_valueItem;
+
+void FakeValueSetCallbackFunc(const ValueItemT& item) {
+  FakeCallbackFunc_called = true;
+  FakeCallbackFunc_valueItem = item;
+}
+
 class LoRaHandler_test : public ::testing::Test {
  protected:
   void SetUp() override {
@@ -90,8 +92,8 @@ class LoRaHandler_test : public ::testing::Test {
     Serial.flush();
     FakeCallbackFunc_called = false;
     FakeCallbackFunc_entityId = 0;
-    memset(&FakeCallbackFunc_config, 0, sizeof(FakeCallbackFunc_config));
     memset(&FakeCallbackFunc_service, 0, sizeof(FakeCallbackFunc_service));
+    FakeCallbackFunc_valueItem = ValueItemT();
   }
 
   void TearDown() override {
@@ -107,7 +109,9 @@ class LoRaHandler_test : public ::testing::Test {
       if (c < 0) {
         break;
       }
-      strBuf[i++] = static_cast<char>(c);
+      if (i < sizeof(strBuf) - 1) {
+        strBuf[i++] = static_cast<char>(c);
+      }
     }
     strBuf[i] = '\0';
   }
@@ -140,75 +144,35 @@ TEST_F(LoRaHandler_test, begin) {
   pLH->begin();
 }
 
-TEST_F(LoRaHandler_test, configsValueMsg) {
-  const uint8_t entityId = 55;
-  const ConfigItemValueT items[2] = {{1, 0x11}, {2, 0x11223344}};
-  const size_t payloadSize = sizeof(ConfigValuePayloadT::entityId) +
-                             sizeof(ConfigValuePayloadT::numberOfConfigs) +
-                             items[0].size() * 2;
-  const size_t expectedMsgSize = LORA_HEADER_LENGTH + payloadSize;
-  const uint8_t expectedPayload[] = {55,   2, 1,    0x00, 0x00, 0x00,
-                                     0x11, 2, 0x11, 0x22, 0x33, 0x44};
-  size_t writeSize;
-  EXPECT_CALL(*pLoRaMock, beginPacket(false)).WillOnce(Return(1));
-  EXPECT_CALL(*pLoRaMock, write(_, expectedMsgSize))
-      .WillOnce(DoAll(SaveArg<1>(&writeSize), Invoke(loraReadBuf),
-                      Return(expectedMsgSize)));
-  EXPECT_CALL(*pLoRaMock, endPacket(false)).WillOnce(Return(1));
-  EXPECT_CALL(*pArduinoMock, millis())
-      .WillOnce(Return(61500))         // Print
-      .WillOnce(Return(61501))         // AirTime update
-      .WillOnce(Return(61502))         // Send start
-      .WillRepeatedly(Return(61602));  // Send end and debug print of AirTime
-
-  pLH->beginConfigsValueMsg(entityId);
-  pLH->addConfigItemValues(items, 2);
-  pLH->endMsg();
-
-  bufSerReadStr();
-  // clang-format off
-  EXPECT_STREQ(strBuf,
-    "\n[61500] LoRaTx: H: 01 02 01 47 P: 37 02 01 00 00 00 11 02 11 22 33 44\n[61602] AirTime: 100 ms, 28 ppm");
-  // clang-format on
-
-  EXPECT_EQ(writeSize, expectedMsgSize);
-
-  EXPECT_EQ(loraTxMsg.header.dst, 1);
-  EXPECT_EQ(loraTxMsg.header.src, 2);
-  EXPECT_EQ(loraTxMsg.header.id, 1);
-  EXPECT_TRUE(loraTxMsg.header.flags.ack_request);
-  EXPECT_EQ(loraTxMsg.header.flags.msgType, LoRaMsgType::config_msg);
-
-  EXPECT_THAT(loraTxMsg.payload, IsSupersetOf(expectedPayload));
-}
-
 TEST_F(LoRaHandler_test, discoveryMsg) {
-  const DiscoveryItemT item = {{123, 1, 2, 3, 3, 2, 1, 0},
-                               2,
-                               {{6, 16, 3, 2, 1, 0, 123456, 654321},
-                                {7, 17, 2, 1, 0, 0, 123456, 654321}}};
+  static const char name[] PROGMEM = "Car";
+  const DiscoveryEntityT item = {123, 1, 2, 3, 3, 2, 1, 0, 0, 123456, 654321,
+                                 name};
   const size_t payloadSize = item.size();
   const size_t expectedMsgSize = LORA_HEADER_LENGTH + payloadSize;
+  const uint8_t expectedPayload[] = {123,  1,    2,    3,    3,    0x06,
+                                     0x00, 0x01, 0xE2, 0x40, 0x00, 0x09,
+                                     0xFB, 0xF1, 'C',  'a',  'r',  0};
   size_t writeSize;
   EXPECT_CALL(*pLoRaMock, beginPacket(false)).WillOnce(Return(1));
   EXPECT_CALL(*pLoRaMock, write(_, expectedMsgSize))
       .WillOnce(DoAll(SaveArg<1>(&writeSize), Invoke(loraReadBuf),
                       Return(expectedMsgSize)));
-  EXPECT_CALL(*pLoRaMock, endPacket(false)).WillOnce(Return(1));
-  EXPECT_CALL(*pArduinoMock, millis())
-      .WillOnce(Return(100))         // Print
-      .WillOnce(Return(101))         // AirTime update
-      .WillOnce(Return(102))         // Send start
-      .WillRepeatedly(Return(202));  // Send end and debug print of AirTime
+  EXPECT_CALL(*pLoRaMock, endPacket(true)).WillOnce(Return(1));
+  uint32_t now = 100;
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(ReturnPointee(&now));
 
   pLH->beginDiscoveryMsg();
-  pLH->addDiscoveryItem(item);
+  pLH->addDiscoveryEntity(item);
   pLH->endMsg();
+  now = 200;
+  pLH->handleTxDoneIrq();
+  pLH->updateTx();
 
   bufSerReadStr();
   // clang-format off
   EXPECT_STREQ(strBuf,
-    "\n[100] LoRaTx: H: 01 02 01 43 P: 7B 01 02 03 1B 02 06 10 1B 00 01 E2 40 00 09 FB F1 07 11 06 00 01 E2 40 00 09 FB F1\n[202] AirTime: 100 ms, 28 ppm");
+    "[100] LoRaTx: H: 01 02 01 43 P: 7B 01 02 03 03 06 00 01 E2 40 00 09 FB F1 43 61 72 00\r\n[200] AirTime: 100 ms, 28 ppm\r\n");
   // clang-format on
 
   EXPECT_EQ(writeSize, expectedMsgSize);
@@ -219,13 +183,8 @@ TEST_F(LoRaHandler_test, discoveryMsg) {
   EXPECT_TRUE(loraTxMsg.header.flags.ack_request);
   EXPECT_EQ(loraTxMsg.header.flags.msgType, LoRaMsgType::discovery_msg);
 
-  DiscoveryItemT di = DiscoveryItemT();
-  EXPECT_EQ(di.fromByteArray(loraTxMsg.payload, writeSize), payloadSize);
-  EXPECT_EQ(di, item);
-  EXPECT_EQ(di.entity, item.entity);
-  EXPECT_EQ(di.numberOfConfigItems, item.numberOfConfigItems);
-  EXPECT_EQ(di.configItems[0], item.configItems[0]);
-  EXPECT_EQ(di.configItems[1], item.configItems[1]);
+  EXPECT_EQ(loraTxMsg.payload_length, payloadSize);
+  EXPECT_EQ(memcmp(loraTxMsg.payload, expectedPayload, payloadSize), 0);
 }
 
 TEST_F(LoRaHandler_test, loraRx_no_packet_shall_do_nothing) {
@@ -236,7 +195,7 @@ TEST_F(LoRaHandler_test, loraRx_no_packet_shall_do_nothing) {
 
 TEST_F(LoRaHandler_test, loraRx_other_dst_shall_do_nothing) {
   EXPECT_CALL(*pLoRaMock, parsePacket(0)).WillOnce(Return(LORA_HEADER_LENGTH));
-  EXPECT_CALL(*pArduinoMock, millis()).WillOnce(Return(100));  // Print
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(Return(100));
   EXPECT_CALL(*pLoRaMock, read())
       .WillOnce(Return(LORA_MY_ADDRESS + 1))  // dst
       .WillOnce(Return(LORA_GATEWAY))         // src
@@ -250,9 +209,77 @@ TEST_F(LoRaHandler_test, loraRx_other_dst_shall_do_nothing) {
   EXPECT_THAT(strBuf, HasSubstr("not for me, drop msg"));
 }
 
+TEST_F(LoRaHandler_test, loraRx_frame_longer_than_downlink_shall_be_dropped) {
+  EXPECT_CALL(*pLoRaMock, parsePacket(0))
+      .WillOnce(Return(LORA_MAX_RX_MESSAGE_LENGTH + 1));
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(Return(100));
+  EXPECT_CALL(*pLoRaMock, read()).Times(0);
+
+  EXPECT_EQ(pLH->loraRx(), 0);
+
+  bufSerReadStr();
+  EXPECT_STREQ(strBuf,
+               "[100] LoRaRx: Dropped frame of 11 bytes, longer than any "
+               "downlink\r\n");
+}
+
+TEST_F(LoRaHandler_test, rxIrq_frame_longer_than_downlink_shall_be_dropped) {
+  EXPECT_CALL(*pLoRaMock, onReceive(_));
+  EXPECT_CALL(*pLoRaMock, receive(_));
+  EXPECT_CALL(*pLoRaMock, read()).Times(0);
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(Return(100));
+  pLH->enableRxInterrupt();
+
+  pLH->handleRxIrq(LORA_MAX_RX_MESSAGE_LENGTH + 1);
+
+  EXPECT_EQ(pLH->getRxDropCount(), 1);
+
+  // Logged once, outside of the interrupt.
+  EXPECT_EQ(pLH->loraRx(), 0);
+  EXPECT_EQ(pLH->loraRx(), 0);
+  bufSerReadStr();
+  EXPECT_STREQ(strBuf,
+               "[100] LoRaRx: Dropped 1 frames, too long or RX queue full\r\n");
+}
+
+TEST_F(LoRaHandler_test, rxIrq_service_req_from_gateway_shall_fit) {
+  // A service request as the gateway sends it, with a 6 byte payload.
+  const uint8_t frame[] = {LORA_MY_ADDRESS,
+                           LORA_GATEWAY,
+                           0x0D,
+                           static_cast<uint8_t>(LoRaMsgType::service_req),
+                           56,
+                           1,
+                           0x70,
+                           0x74,
+                           0x88,
+                           0x77};
+  static_assert(sizeof(frame) <= LORA_MAX_RX_MESSAGE_LENGTH,
+                "Service request longer than an RX slot");
+  EXPECT_CALL(*pLoRaMock, begin(_)).WillOnce(Return(1));
+  EXPECT_CALL(*pLoRaMock, onReceive(_));
+  EXPECT_CALL(*pLoRaMock, receive(_));
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(Return(100));
+  auto& read = EXPECT_CALL(*pLoRaMock, read());
+  for (uint8_t b : frame) {
+    read.WillOnce(Return(b));
+  }
+  EXPECT_CALL(*pLoRaMock, packetRssi()).WillOnce(Return(-47));
+
+  pLH->begin(nullptr, nullptr, nullptr, FakeServiceCallbackFunc);
+  pLH->enableRxInterrupt();
+  pLH->handleRxIrq(sizeof(frame));
+
+  EXPECT_EQ(pLH->getRxDropCount(), 0);
+  EXPECT_EQ(pLH->loraRx(), sizeof(frame));
+  EXPECT_TRUE(FakeCallbackFunc_called);
+  EXPECT_EQ(FakeCallbackFunc_service.entityId, 56);
+  EXPECT_EQ(FakeCallbackFunc_service.service, 1);
+}
+
 TEST_F(LoRaHandler_test, loraRx_unknown_msgType_shall_do_nothing) {
   EXPECT_CALL(*pLoRaMock, parsePacket(0)).WillOnce(Return(LORA_HEADER_LENGTH));
-  EXPECT_CALL(*pArduinoMock, millis()).WillOnce(Return(100));  // Print
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(Return(100));
   EXPECT_CALL(*pLoRaMock, read())
       .WillOnce(Return(LORA_MY_ADDRESS))  // dst
       .WillOnce(Return(LORA_GATEWAY))     // src
@@ -284,24 +311,21 @@ TEST_F(LoRaHandler_test, loraRx_ping_req_no_ack_shall_send_ping_msg) {
   EXPECT_CALL(*pLoRaMock, beginPacket(0)).WillOnce(Return(1));
   EXPECT_CALL(*pLoRaMock, write(_, expectedMsgSize))
       .WillOnce(DoAll(Invoke(loraReadBuf), Return(expectedMsgSize)));
-  EXPECT_CALL(*pLoRaMock, endPacket(false)).WillOnce(Return(1));
+  EXPECT_CALL(*pLoRaMock, endPacket(true)).WillOnce(Return(1));
 
-  // calls to millis()
-  EXPECT_CALL(*pArduinoMock, millis())
-      .WillOnce(Return(100))         // Debug print of RX msg
-      .WillOnce(Return(101))         // Debug print of TX msg
-      .WillOnce(Return(102))         // AirTime update
-      .WillOnce(Return(103))         // Send start
-      .WillOnce(Return(203))         // Send end
-      .WillRepeatedly(Return(204));  // Debug print of AirTime
+  uint32_t now = 100;
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(ReturnPointee(&now));
 
-  // Receive msg
+  // Receive msg, the ping message is sent when the radio is done
   EXPECT_EQ(pLH->loraRx(), LORA_HEADER_LENGTH);
+  now = 200;
+  pLH->handleTxDoneIrq();
+  pLH->updateTx();
 
   bufSerReadStr();
   EXPECT_THAT(strBuf,
-              HasSubstr("\n[101] LoRaTx: H: 01 02 01 41 P: FF 7E\n[204] "
-                        "AirTime: 100 ms, 28 ppm"));
+              HasSubstr("[100] LoRaTx: H: 01 02 01 41 P: FF 7E\r\n[200] "
+                        "AirTime: 100 ms, 28 ppm\r\n"));
 
   // Check TX header
   EXPECT_EQ(loraTxMsg.header.dst, LORA_GATEWAY);
@@ -325,7 +349,7 @@ TEST_F(LoRaHandler_test,
 
   // RX
   EXPECT_CALL(*pLoRaMock, parsePacket(0)).WillOnce(Return(rxMsgSize));
-  EXPECT_CALL(*pArduinoMock, millis()).WillOnce(Return(100));  // Print
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(Return(100));
   EXPECT_CALL(*pLoRaMock, read())
       // Header
       .WillOnce(Return(LORA_MY_ADDRESS))  // dst
@@ -339,7 +363,7 @@ TEST_F(LoRaHandler_test,
   EXPECT_CALL(*pLoRaMock, packetRssi()).WillOnce(Return(rssi));
 
   // Begin and receive msg
-  pLH->begin(FakeCallbackFunc, nullptr, nullptr, nullptr, nullptr);
+  pLH->begin(FakeCallbackFunc, nullptr, nullptr, nullptr);
   EXPECT_EQ(pLH->loraRx(), rxMsgSize);
 
   // Check callback function
@@ -347,6 +371,50 @@ TEST_F(LoRaHandler_test,
   EXPECT_EQ(FakeCallbackFunc_entityId, entityId);
 }
 
+TEST_F(LoRaHandler_test,
+       loraRx_discovery_req_with_cached_hash_shall_not_call_callback) {
+  const uint8_t rxMsgSize = LORA_HEADER_LENGTH + 5;
+
+  EXPECT_CALL(*pLoRaMock, begin(_)).WillOnce(Return(1));
+  EXPECT_CALL(*pLoRaMock, parsePacket(0)).WillOnce(Return(rxMsgSize));
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(Return(100));
+  EXPECT_CALL(*pLoRaMock, read())
+      .WillOnce(Return(LORA_MY_ADDRESS))
+      .WillOnce(Return(LORA_GATEWAY))
+      .WillOnce(Return(0))
+      .WillOnce(Return(static_cast<uint8_t>(LoRaMsgType::discovery_req)))
+      .WillOnce(Return(255))
+      .WillOnce(Return(0x11))
+      .WillOnce(Return(0x22))
+      .WillOnce(Return(0x33))
+      .WillOnce(Return(0x44));
+  EXPECT_CALL(*pLoRaMock, packetRssi()).WillOnce(Return(-111));
+
+  pLH->begin(FakeCallbackFunc, nullptr, nullptr, nullptr);
+  pLH->setDiscoverySchema(0x11223344, 11);
+  EXPECT_EQ(pLH->loraRx(), rxMsgSize);
+  bufSerReadStr();
+
+  EXPECT_FALSE(FakeCallbackFunc_called);
+}
+
+TEST_F(LoRaHandler_test, announceMsg) {
+  EXPECT_CALL(*pLoRaMock, beginPacket(false)).WillOnce(Return(1));
+  EXPECT_CALL(*pLoRaMock, write(_, LORA_HEADER_LENGTH + 7))
+      .WillOnce(DoAll(Invoke(loraReadBuf), Return(LORA_HEADER_LENGTH + 7)));
+  EXPECT_CALL(*pLoRaMock, endPacket(true)).WillOnce(Return(1));
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(Return(61500));
+
+  pLH->setDiscoverySchema(0x11223344, 11);
+  pLH->sendAnnounceMsg();
+  bufSerReadStr();
+
+  const uint8_t expectedPayload[] = {0x11, 0x22, 0x33, 0x44, 11, 0, 0};
+  EXPECT_EQ(loraTxMsg.header.flags.msgType, LoRaMsgType::announce_msg);
+  EXPECT_TRUE(loraTxMsg.header.flags.ack_request);
+  EXPECT_EQ(memcmp(loraTxMsg.payload, expectedPayload, 7), 0);
+}
+
 TEST_F(
     LoRaHandler_test,
     loraRx_discovery_req_with_ack_shall_send_ack_and_call_OnDiscoveryReqMsgFunc) {
@@ -378,23 +446,21 @@ TEST_F(
   EXPECT_CALL(*pLoRaMock, beginPacket(0)).WillOnce(Return(1));
   EXPECT_CALL(*pLoRaMock, write(_, expectedMsgSize))
       .WillOnce(DoAll(Invoke(loraReadBuf), Return(expectedMsgSize)));
-  EXPECT_CALL(*pLoRaMock, endPacket(false)).WillOnce(Return(1));
+  EXPECT_CALL(*pLoRaMock, endPacket(true)).WillOnce(Return(1));
 
-  // Calls to millis()
-  EXPECT_CALL(*pArduinoMock, millis())
-      .WillOnce(Return(100))         // Print
-      .WillOnce(Return(101))         // Print
-      .WillOnce(Return(102))         // AirTime update
-      .WillOnce(Return(103))         // Send start
-      .WillRepeatedly(Return(203));  // Send end and debug print of AirTime
+  uint32_t now = 100;
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(ReturnPointee(&now));
 
-  // Begin and receive msg
-  pLH->begin(FakeCallbackFunc, nullptr, nullptr, nullptr, nullptr);
+  // Begin and receive msg, the ACK is sent when the radio is done
+  pLH->begin(FakeCallbackFunc, nullptr, nullptr, nullptr);
   EXPECT_EQ(pLH->loraRx(), rxMsgSize);
+  now = 200;
+  pLH->handleTxDoneIrq();
+  pLH->updateTx();
 
   bufSerReadStr();
-  EXPECT_THAT(strBuf, HasSubstr("\n[101] LoRaTx: H: 01 02 00 82 P: 21\n[203] "
-                                "AirTime: 100 ms, 28 ppm"));
+  EXPECT_THAT(strBuf, HasSubstr("[100] LoRaTx: H: 01 02 00 82 P: 21\r\n"));
+  EXPECT_THAT(strBuf, HasSubstr("[200] AirTime: 100 ms, 28 ppm\r\n"));
 
   // Check TX header
   EXPECT_EQ(loraTxMsg.header.dst, LORA_GATEWAY);
@@ -420,7 +486,7 @@ TEST_F(LoRaHandler_test, loraRx_value_req_no_ack_shall_call_OnValueReqMsgFunc) {
 
   // RX
   EXPECT_CALL(*pLoRaMock, parsePacket(0)).WillOnce(Return(rxMsgSize));
-  EXPECT_CALL(*pArduinoMock, millis()).WillOnce(Return(100));  // Print
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(Return(100));
   EXPECT_CALL(*pLoRaMock, read())
       // Header
       .WillOnce(Return(LORA_MY_ADDRESS))                                // dst
@@ -431,49 +497,38 @@ TEST_F(LoRaHandler_test, loraRx_value_req_no_ack_shall_call_OnValueReqMsgFunc) {
   EXPECT_CALL(*pLoRaMock, packetRssi()).WillOnce(Return(rssi));
 
   // Begin and receive msg
-  pLH->begin(nullptr, FakeValueReqCallbackFunc, nullptr, nullptr, nullptr);
+  pLH->begin(nullptr, FakeValueReqCallbackFunc, nullptr, nullptr);
   EXPECT_EQ(pLH->loraRx(), rxMsgSize);
 
   // Check callback function
   EXPECT_TRUE(FakeCallbackFunc_called);
 }
 
-TEST_F(LoRaHandler_test,
-       loraRx_config_req_no_ack_shall_call_OnConfigReqMsgFunc) {
-  const uint8_t rxMsgSize = LORA_HEADER_LENGTH + 1;
-  const int16_t rssi = -111;
-  const uint8_t entityId = 56;
-
-  // Begin
+TEST_F(LoRaHandler_test, loraRx_value_req_shall_queue_all_components) {
   EXPECT_CALL(*pLoRaMock, begin(_)).WillOnce(Return(1));
-
-  // RX
-  EXPECT_CALL(*pLoRaMock, parsePacket(0)).WillOnce(Return(rxMsgSize));
-  EXPECT_CALL(*pArduinoMock, millis()).WillOnce(Return(100));  // Print
+  EXPECT_CALL(*pLoRaMock, parsePacket(0)).WillOnce(Return(LORA_HEADER_LENGTH));
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(Return(100));
   EXPECT_CALL(*pLoRaMock, read())
-      // Header
-      .WillOnce(Return(LORA_MY_ADDRESS))                                // dst
-      .WillOnce(Return(LORA_GATEWAY))                                   // src
-      .WillOnce(Return(0))                                              // id
-      .WillOnce(Return(static_cast<uint8_t>(LoRaMsgType::config_req)))  // flags
-      // Payload
-      .WillOnce(Return(entityId));
-  // RX-RSSI
-  EXPECT_CALL(*pLoRaMock, packetRssi()).WillOnce(Return(rssi));
+      .WillOnce(Return(LORA_MY_ADDRESS))
+      .WillOnce(Return(LORA_GATEWAY))
+      .WillOnce(Return(0))
+      .WillOnce(Return(static_cast<uint8_t>(LoRaMsgType::value_req)));
+  EXPECT_CALL(*pLoRaMock, packetRssi()).WillOnce(Return(-111));
 
-  // Begin and receive msg
-  pLH->begin(nullptr, nullptr, FakeCallbackFunc, nullptr, nullptr);
-  EXPECT_EQ(pLH->loraRx(), rxMsgSize);
+  pValueReqHandler = pLH;
+  pLH->begin(nullptr, FakeValueReqQueueAllFunc, nullptr, nullptr);
+  EXPECT_EQ(pLH->loraRx(), LORA_HEADER_LENGTH);
 
-  // Check callback function
   EXPECT_TRUE(FakeCallbackFunc_called);
-  EXPECT_EQ(FakeCallbackFunc_entityId, entityId);
+  EXPECT_EQ(pLH->getValueQueueSize(), DEVICE_MAX_COMPONENTS);
+  bufSerReadStr();
+  EXPECT_THAT(strBuf, ::testing::Not(HasSubstr("Value queue full")));
 }
 
 TEST_F(LoRaHandler_test,
-       loraRx_configSet_req_no_ack_shall_call_OnConfigSetReqMsgFunc) {
-  const ConfigValuePayloadT item = {56, 1, {{2, 0x11223344}}};
-  const uint8_t rxMsgSize = LORA_HEADER_LENGTH + 7;
+       loraRx_valueSet_req_no_ack_shall_call_OnValueSetReqMsgFunc) {
+  const ValueItemT item = ValueItemT(56, 0x11223344);
+  const uint8_t rxMsgSize = LORA_HEADER_LENGTH + ValueItemT::size();
   const int16_t rssi = -111;
 
   // Begin
@@ -481,18 +536,16 @@ TEST_F(LoRaHandler_test,
 
   // RX
   EXPECT_CALL(*pLoRaMock, parsePacket(0)).WillOnce(Return(rxMsgSize));
-  EXPECT_CALL(*pArduinoMock, millis()).WillOnce(Return(100));  // Print
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(Return(100));
   EXPECT_CALL(*pLoRaMock, read())
       // Header
       .WillOnce(Return(LORA_MY_ADDRESS))  // dst
       .WillOnce(Return(LORA_GATEWAY))     // src
       .WillOnce(Return(0))                // id
       .WillOnce(
-          Return(static_cast<uint8_t>(LoRaMsgType::configSet_req)))  // flags
+          Return(static_cast<uint8_t>(LoRaMsgType::valueSet_req)))  // flags
       // Payload
       .WillOnce(Return(item.entityId))
-      .WillOnce(Return(item.numberOfConfigs))
-      .WillOnce(Return(item.configValues[0].configId))
       .WillOnce(Return(0x11))
       .WillOnce(Return(0x22))
       .WillOnce(Return(0x33))
@@ -501,17 +554,12 @@ TEST_F(LoRaHandler_test,
   EXPECT_CALL(*pLoRaMock, packetRssi()).WillOnce(Return(rssi));
 
   // Begin and receive msg
-  pLH->begin(nullptr, nullptr, nullptr, FakeConfigCallbackFunc, nullptr);
+  pLH->begin(nullptr, nullptr, FakeValueSetCallbackFunc, nullptr);
   EXPECT_EQ(pLH->loraRx(), rxMsgSize);
 
   // Check callback function
   EXPECT_TRUE(FakeCallbackFunc_called);
-  EXPECT_EQ(FakeCallbackFunc_config.entityId, item.entityId);
-  EXPECT_EQ(FakeCallbackFunc_config.numberOfConfigs, item.numberOfConfigs);
-  EXPECT_EQ(FakeCallbackFunc_config.configValues[0].configId,
-            item.configValues[0].configId);
-  EXPECT_EQ(FakeCallbackFunc_config.configValues[0].value,
-            item.configValues[0].value);
+  EXPECT_EQ(FakeCallbackFunc_valueItem, item);
 }
 
 TEST_F(LoRaHandler_test,
@@ -525,7 +573,7 @@ TEST_F(LoRaHandler_test,
 
   // RX
   EXPECT_CALL(*pLoRaMock, parsePacket(0)).WillOnce(Return(rxMsgSize));
-  EXPECT_CALL(*pArduinoMock, millis()).WillOnce(Return(100));  // Print
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(Return(100));
   EXPECT_CALL(*pLoRaMock, read())
       // Header
       .WillOnce(Return(LORA_MY_ADDRESS))  // dst
@@ -540,7 +588,7 @@ TEST_F(LoRaHandler_test,
   EXPECT_CALL(*pLoRaMock, packetRssi()).WillOnce(Return(rssi));
 
   // Begin and receive msg
-  pLH->begin(nullptr, nullptr, nullptr, nullptr, FakeServiceCallbackFunc);
+  pLH->begin(nullptr, nullptr, nullptr, FakeServiceCallbackFunc);
   EXPECT_EQ(pLH->loraRx(), rxMsgSize);
 
   // Check callback function
@@ -576,24 +624,25 @@ TEST_F(LoRaHandler_test, valueMsg) {
   EXPECT_CALL(*pLoRaMock, write(_, expectedMsgSize))
       .WillOnce(DoAll(SaveArg<1>(&writeSize), Invoke(loraReadBuf),
                       Return(expectedMsgSize)));
-  EXPECT_CALL(*pLoRaMock, endPacket(false)).WillOnce(Return(1));
-  EXPECT_CALL(*pArduinoMock, millis())
-      .WillOnce(Return(61500))         // Print
-      .WillOnce(Return(61501))         // AirTime update
-      .WillOnce(Return(61502))         // Send start
-      .WillRepeatedly(Return(61602));  // Send end and debug print of AirTime
+  EXPECT_CALL(*pLoRaMock, endPacket(true)).WillOnce(Return(1));
+  uint32_t now = 61500;
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(ReturnPointee(&now));
 
   pLH->beginValueMsg();
   pLH->addValueItem(item1);
   pLH->addValueItem(item2);
+  bufSerReadStr();
   pLH->endMsg();
+  now = 61600;
+  pLH->handleTxDoneIrq();
+  pLH->updateTx();
 
   bufSerReadStr();
   // clang-format off
   EXPECT_STREQ(
       strBuf,
-      "\n[61500] LoRaTx: H: 01 02 01 45 P: 02 7B 00 00 00 01 7C 11 22 33 44\n[61602] AirTime: 100 ms, 28 ppm");
-  // clang-format off
+      "[61500] LoRaTx: H: 01 02 01 45 P: 02 7B 00 00 00 01 7C 11 22 33 44\r\n[61600] AirTime: 100 ms, 28 ppm\r\n");
+  // clang-format on
 
   EXPECT_EQ(writeSize, expectedMsgSize);
 
@@ -606,7 +655,392 @@ TEST_F(LoRaHandler_test, valueMsg) {
   EXPECT_THAT(loraTxMsg.payload, IsSupersetOf(expectedPayload));
 }
 
+TEST(LoRaValuePayload_test, bitmap_round_trip) {
+  LoRaValuePayloadT payload;
+  payload.numberOfEntities = 3;
+  payload.valueItems[0] = ValueItemT(2, 0x01);
+  payload.valueItems[1] = ValueItemT(4, 0x11223344);
+  payload.valueItems[2] = ValueItemT(11, 0xFFFFFFFF);
+  const uint8_t expected[] = {2,    2,    0x05, 0x02, 0x00, 0x00, 0x00,
+                              0x01, 0x11, 0x22, 0x33, 0x44, 0xFF, 0xFF,
+                              0xFF, 0xFF};
+  uint8_t buf[LORA_MAX_PAYLOAD_LENGTH];
+
+  ASSERT_EQ(payload.toByteArray(buf, sizeof(buf), true), sizeof(expected));
+  EXPECT_EQ(memcmp(buf, expected, sizeof(expected)), 0);
+
+  LoRaValuePayloadT parsed;
+  EXPECT_EQ(parsed.fromByteArray(buf, sizeof(expected), true),
+            sizeof(expected));
+  ASSERT_EQ(parsed.numberOfEntities, 3);
+  for (uint8_t i = 0; i < 3; i++) {
+    EXPECT_EQ(parsed.valueItems[i], payload.valueItems[i]);
+  }
+}
+
+TEST(LoRaValuePayload_test, bitmap_shall_need_ascending_entity_ids) {
+  LoRaValuePayloadT payload;
+  payload.numberOfEntities = 2;
+  payload.valueItems[0] = ValueItemT(4, 1);
+  payload.valueItems[1] = ValueItemT(2, 2);
+  uint8_t buf[LORA_MAX_PAYLOAD_LENGTH];
+
+  EXPECT_EQ(payload.toByteArray(buf, sizeof(buf), true), 0);
+}
+
+TEST(LoRaValuePayload_test, truncated_bitmap_shall_fail) {
+  const uint8_t buf[] = {0, 1, 0x03, 0x00, 0x00, 0x00, 0x01, 0x00};
+  LoRaValuePayloadT payload;
+
+  EXPECT_EQ(payload.fromByteArray(buf, sizeof(buf), true), 0);
+}
+
+TEST_F(LoRaHandler_test, radioState_shall_be_set_when_idle) {
+  EXPECT_CALL(*pLoRaMock, sleep()).Times(1);
+
+  pLH->setRadioState(LoRaRadioState::sleep);
+  EXPECT_EQ(pLH->getRadioState(), LoRaRadioState::sleep);
+  EXPECT_FALSE(pLH->isBusy());
+}
+
+TEST_F(LoRaHandler_test, radioState_shall_be_set_after_transmission) {
+  EXPECT_CALL(*pLoRaMock, beginPacket(false)).WillOnce(Return(1));
+  EXPECT_CALL(*pLoRaMock, write(_, LORA_HEADER_LENGTH + 7))
+      .WillOnce(Return(LORA_HEADER_LENGTH + 7));
+  EXPECT_CALL(*pLoRaMock, endPacket(true)).WillOnce(Return(1));
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(Return(61500));
+
+  pLH->sendAnnounceMsg();
+  EXPECT_TRUE(pLH->isBusy());
+
+  EXPECT_CALL(*pLoRaMock, sleep()).Times(0);
+  pLH->setRadioState(LoRaRadioState::sleep);
+
+  EXPECT_CALL(*pLoRaMock, sleep()).Times(1);
+  pLH->handleTxDoneIrq();
+  pLH->updateTx();
+  bufSerReadStr();
+  EXPECT_FALSE(pLH->isBusy());
+}
+
+TEST_F(LoRaHandler_test, rxWindow_shall_open_after_uplink_and_each_period) {
+  uint32_t now = 10000;
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(ReturnPointee(&now));
+  EXPECT_CALL(*pLoRaMock, sleep()).Times(1);
+  pLH->setRxPeriod(60);
+  EXPECT_EQ(pLH->getTimeToNextRxEvent(now), 60000);
+
+  EXPECT_CALL(*pLoRaMock, beginPacket(false)).WillOnce(Return(1));
+  EXPECT_CALL(*pLoRaMock, write(_, LORA_HEADER_LENGTH + 7))
+      .WillOnce(DoAll(Invoke(loraReadBuf), Return(LORA_HEADER_LENGTH + 7)));
+  EXPECT_CALL(*pLoRaMock, endPacket(true)).WillOnce(Return(1));
+  pLH->sendAnnounceMsg();
+  EXPECT_EQ(loraTxMsg.payload[5], 0);
+  EXPECT_EQ(loraTxMsg.payload[6], 60);
+
+  // Window after the uplink
+  now = 10050;
+  EXPECT_CALL(*pLoRaMock, receive(0)).Times(1);
+  pLH->handleTxDoneIrq();
+  pLH->updateTx();
+  bufSerReadStr();
+  EXPECT_TRUE(pLH->isRxWindowOpen());
+  EXPECT_EQ(pLH->getTimeToNextRxEvent(now), LORA_RX_WINDOW_MS);
+
+  now += LORA_RX_WINDOW_MS;
+  EXPECT_CALL(*pLoRaMock, sleep()).Times(1);
+  pLH->updateRxWindow();
+  EXPECT_FALSE(pLH->isRxWindowOpen());
+  EXPECT_EQ(pLH->getTimeToNextRxEvent(now), 60000 - LORA_RX_WINDOW_MS);
+
+  // Periodic window, counted from the end of the uplink
+  now = 10050 + 60000;
+  EXPECT_CALL(*pLoRaMock, receive(0)).Times(1);
+  pLH->updateRxWindow();
+  EXPECT_TRUE(pLH->isRxWindowOpen());
+  EXPECT_EQ(pLH->getTimeToNextRxEvent(now), LORA_RX_WINDOW_MS);
+}
+
+TEST_F(LoRaHandler_test, registerValueEntity_shall_fit_all_components) {
+  DiscoveryEntityT entity = {};
+
+  for (uint8_t i = 0; i < DEVICE_MAX_COMPONENTS; i++) {
+    entity.entityId = i;
+    EXPECT_TRUE(pLH->registerValueEntity(entity));
+  }
+  entity.entityId = DEVICE_MAX_COMPONENTS;
+  EXPECT_FALSE(pLH->registerValueEntity(entity));
+}
+
+TEST_F(LoRaHandler_test, bitmapValueMsg) {
+  EXPECT_CALL(*pLoRaMock, beginPacket(false)).WillOnce(Return(1));
+  EXPECT_CALL(*pLoRaMock, write(_, LORA_HEADER_LENGTH + 3 + 2 * 4))
+      .WillOnce(DoAll(Invoke(loraReadBuf), Return(LORA_HEADER_LENGTH + 11)));
+  EXPECT_CALL(*pLoRaMock, endPacket(true)).WillOnce(Return(1));
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(Return(61500));
+
+  // Range is trimmed to the added values when the message is sent.
+  pLH->beginBitmapValueMsg(0, 20);
+  EXPECT_TRUE(pLH->addValueItem(ValueItemT(1, 0x01)));
+  EXPECT_FALSE(pLH->addValueItem(ValueItemT(1, 0x02)));
+  EXPECT_TRUE(pLH->addValueItem(ValueItemT(3, 0x11223344)));
+  pLH->endMsg();
+  bufSerReadStr();
+
+  EXPECT_TRUE(loraTxMsg.header.flags.bitmap_values);
+  EXPECT_EQ(loraTxMsg.header.flags.msgType, LoRaMsgType::value_msg);
+
+  LoRaValuePayloadT payload;
+  EXPECT_EQ(payload.fromByteArray(loraTxMsg.payload, loraTxMsg.payload_length,
+                                  true),
+            loraTxMsg.payload_length);
+  ASSERT_EQ(payload.numberOfEntities, 2);
+  EXPECT_EQ(payload.valueItems[0], ValueItemT(1, 0x01));
+  EXPECT_EQ(payload.valueItems[1], ValueItemT(3, 0x11223344));
+}
+
+TEST_F(LoRaHandler_test, discoveryBatchMsg) {
+  static const char name[] PROGMEM = "Car Presence";
+  DiscoveryEntityT entity{};
+  entity.name = name;
+  const size_t entitySize = DiscoveryEntityT::HEADER_SIZE + 3;
+
+  EXPECT_CALL(*pLoRaMock, beginPacket(false)).WillOnce(Return(1));
+  EXPECT_CALL(*pLoRaMock, write(_, _))
+      .WillOnce(DoAll(Invoke(loraReadBuf), Return(1)));
+  EXPECT_CALL(*pLoRaMock, endPacket(true)).WillOnce(Return(1));
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(Return(61500));
+
+  pLH->setDiscoverySchema(0x11223344, 11);
+  pLH->beginDiscoveryBatchMsg();
+  uint8_t count = 0;
+  while (pLH->addDiscoveryBatchEntity(entity)) {
+    entity.entityId = ++count;
+  }
+  pLH->endMsg();
+  bufSerReadStr();
+
+  EXPECT_EQ(count, (LORA_MAX_PAYLOAD_LENGTH - 6) / entitySize);
+  EXPECT_EQ(loraTxMsg.header.flags.msgType, LoRaMsgType::discovery_batch_msg);
+  EXPECT_EQ(loraTxMsg.payload_length, 6 + count * entitySize);
+  EXPECT_EQ(loraTxMsg.payload[0], 0x11);
+  EXPECT_EQ(loraTxMsg.payload[3], 0x44);
+  EXPECT_EQ(loraTxMsg.payload[4], 11);
+  EXPECT_EQ(loraTxMsg.payload[5], count);
+}
+
+TEST_F(LoRaHandler_test, endMsg_without_airtime_left_shall_drop_frame) {
+  static const char name[] PROGMEM = "Car Presence";
+  DiscoveryEntityT entity{};
+  entity.name = name;
+  uint32_t now = 0;
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(ReturnPointee(&now));
+  EXPECT_CALL(*pLoRaMock, beginPacket(false)).WillRepeatedly(Return(1));
+  EXPECT_CALL(*pLoRaMock, write(_, _)).WillRepeatedly(Return(1));
+  EXPECT_CALL(*pLoRaMock, endPacket(true)).WillRepeatedly(Return(1));
+
+  // Full frames until the airtime budget of the hour is used up.
+  uint16_t sent = 0;
+  for (;;) {
+    pLH->beginDiscoveryBatchMsg();
+    while (pLH->addDiscoveryBatchEntity(entity)) {
+    }
+    if (!pLH->isRoomForMsg()) {
+      break;
+    }
+    EXPECT_TRUE(pLH->endMsg());
+    now += LoRaHandler::getTimeOnAir_ms(LORA_MAX_MESSAGE_LENGTH);
+    pLH->handleTxDoneIrq();
+    pLH->updateTx();
+    bufSerReadStr();  // Drain the log
+    ASSERT_LT(++sent, 1000);
+  }
+
+  EXPECT_GT(sent, 0);
+  EXPECT_FALSE(pLH->endMsg());
+  EXPECT_EQ(pLH->getTxState(), LoRaTxState::idle);
+  EXPECT_FALSE(pLH->isBusy());
+}
+
+TEST_F(LoRaHandler_test, frame_waiting_for_radio_shall_be_sent_first) {
+  uint32_t now = 1000;
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(ReturnPointee(&now));
+  // The radio is done with a frame each time flushTx() yields.
+  EXPECT_CALL(*pArduinoMock, yield()).WillRepeatedly(Invoke([this, &now]() {
+    now += 10;
+    pLH->handleTxDoneIrq();
+  }));
+  EXPECT_CALL(*pLoRaMock, beginPacket(false)).WillRepeatedly(Return(1));
+  EXPECT_CALL(*pLoRaMock, endPacket(true)).WillRepeatedly(Return(1));
+  EXPECT_CALL(*pLoRaMock, idle()).Times(AnyNumber());
+
+  std::vector<LoRaMsgType> sent;
+  EXPECT_CALL(*pLoRaMock, write(_, _))
+      .WillRepeatedly(Invoke([&sent](const uint8_t* buf, size_t size) {
+        loraReadBuf(buf, size);
+        sent.push_back(loraTxMsg.header.flags.msgType);
+        return size;
+      }));
+
+  // The announce message goes to the radio, the value message waits in the
+  // frame buffer.
+  pLH->setDiscoverySchema(0x11223344, 11);
+  pLH->sendAnnounceMsg();
+  bufSerReadStr();
+  pLH->beginValueMsg();
+  EXPECT_TRUE(pLH->addValueItem(ValueItemT(1, 0x01)));
+  bufSerReadStr();
+  pLH->endMsg();
+  bufSerReadStr();
+  EXPECT_EQ(sent.size(), 1);
+  EXPECT_TRUE(pLH->isBusy());
+
+  // Building the next frame sends the waiting one first.
+  pLH->beginValueMsg();
+  bufSerReadStr();
+  EXPECT_EQ(sent.size(), 2);
+  EXPECT_EQ(loraTxMsg.payload[1], 1);
+  EXPECT_TRUE(pLH->addValueItem(ValueItemT(2, 0x02)));
+  bufSerReadStr();
+  pLH->endMsg();
+  bufSerReadStr();
+  pLH->flushTx();
+  bufSerReadStr();
+
+  ASSERT_EQ(sent.size(), 3);
+  EXPECT_EQ(sent[0], LoRaMsgType::announce_msg);
+  EXPECT_EQ(sent[1], LoRaMsgType::value_msg);
+  EXPECT_EQ(sent[2], LoRaMsgType::value_msg);
+  EXPECT_EQ(loraTxMsg.payload[1], 2);
+}
+
+TEST_F(LoRaHandler_test, tx_without_txDone_irq_shall_time_out_to_idle) {
+  uint32_t now = 1000;
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(ReturnPointee(&now));
+  EXPECT_CALL(*pLoRaMock, beginPacket(false)).WillOnce(Return(1));
+  EXPECT_CALL(*pLoRaMock, write(_, LORA_HEADER_LENGTH + 7))
+      .WillOnce(Return(LORA_HEADER_LENGTH + 7));
+  EXPECT_CALL(*pLoRaMock, endPacket(true)).WillOnce(Return(1));
+
+  pLH->sendAnnounceMsg();
+  bufSerReadStr();
+  EXPECT_EQ(pLH->getTxState(), LoRaTxState::transmitting);
+
+  // No TX done interrupt, wait for the radio until the timeout.
+  now = 1000 + LORA_TX_TIMEOUT_MS - 1;
+  pLH->updateTx();
+  bufSerReadStr();
+  EXPECT_EQ(pLH->getTxState(), LoRaTxState::transmitting);
+  EXPECT_TRUE(pLH->isBusy());
+
+  now = 1000 + LORA_TX_TIMEOUT_MS;
+  pLH->updateTx();
+  bufSerReadStr();
+  EXPECT_THAT(strBuf, HasSubstr("LoRaTx: No TX done interrupt"));
+  EXPECT_EQ(pLH->getTxState(), LoRaTxState::idle);
+  EXPECT_FALSE(pLH->isBusy());
+}
+
+TEST_F(LoRaHandler_test, beginFrame_shall_block_until_waiting_frame_is_sent) {
+  uint32_t now = 1000;
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(ReturnPointee(&now));
+  // The radio never signals TX done, only the timeout ends each frame.
+  EXPECT_CALL(*pArduinoMock, yield()).WillRepeatedly(Invoke([&now]() {
+    now += 100;
+  }));
+  EXPECT_CALL(*pLoRaMock, beginPacket(false)).WillRepeatedly(Return(1));
+  EXPECT_CALL(*pLoRaMock, endPacket(true)).WillRepeatedly(Return(1));
+
+  uint8_t sent = 0;
+  EXPECT_CALL(*pLoRaMock, write(_, _))
+      .WillRepeatedly(Invoke([&sent](const uint8_t* buf, size_t size) {
+        loraReadBuf(buf, size);
+        sent++;
+        return size;
+      }));
+
+  // The announce message goes to the radio, the value message waits in the
+  // frame buffer.
+  pLH->sendAnnounceMsg();
+  bufSerReadStr();
+  pLH->beginValueMsg();
+  EXPECT_TRUE(pLH->addValueItem(ValueItemT(1, 0x01)));
+  bufSerReadStr();
+  EXPECT_TRUE(pLH->endMsg());
+  bufSerReadStr();
+  EXPECT_EQ(sent, 1);
+
+  // Building the next frame blocks until the waiting one is on air and done.
+  pLH->beginValueMsg();
+  bufSerReadStr();
+  EXPECT_EQ(sent, 2);
+  EXPECT_EQ(loraTxMsg.header.flags.msgType, LoRaMsgType::value_msg);
+  EXPECT_EQ(loraTxMsg.payload[1], 1);
+  EXPECT_GE(now, 1000 + 2 * LORA_TX_TIMEOUT_MS);
+  EXPECT_EQ(pLH->getTxState(), LoRaTxState::idle);
+}
+
+TEST_F(LoRaHandler_test, ack_shall_be_built_in_place) {
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(Return(100));
+  EXPECT_CALL(*pLoRaMock, beginPacket(false)).WillRepeatedly(Return(1));
+  EXPECT_CALL(*pLoRaMock, endPacket(true)).WillRepeatedly(Return(1));
+  EXPECT_CALL(*pLoRaMock, write(_, _))
+      .WillRepeatedly(DoAll(Invoke(recordStack), Return(1)));
+
+  // Stack used by the mock itself, called from here.
+  const uintptr_t top =
+      reinterpret_cast<uintptr_t>(__builtin_frame_address(0));
+  stackAtWrite = UINTPTR_MAX;
+  pLoRaMock->write(nullptr, 0);
+  const uintptr_t mockDepth = top - stackAtWrite;
+
+  // Value request with ACK request, the ACK is sent from loraRx().
+  EXPECT_CALL(*pLoRaMock, parsePacket(0)).WillOnce(Return(LORA_HEADER_LENGTH));
+  EXPECT_CALL(*pLoRaMock, read())
+      .WillOnce(Return(LORA_MY_ADDRESS))  // dst
+      .WillOnce(Return(LORA_GATEWAY))     // src
+      .WillOnce(Return(7))                // id
+      .WillOnce(Return(FLAGS_REQ_ACK_MASK |
+                       static_cast<uint8_t>(LoRaMsgType::value_req)));
+  EXPECT_CALL(*pLoRaMock, packetRssi()).WillOnce(Return(-80));
+
+  stackAtWrite = UINTPTR_MAX;
+  EXPECT_EQ(pLH->loraRx(), LORA_HEADER_LENGTH);
+  bufSerReadStr();
+  const uintptr_t depth = top - stackAtWrite - mockDepth;
+
+  // Seven calls from loraRx() down to LoRa.write(), none of them with a frame
+  // buffer on the stack.
+  printf("Stack from loraRx() to LoRa.write(): %u bytes\n",
+         static_cast<unsigned>(depth));
+  printf("sizeof(LoRaHandler): %u bytes\n",
+         static_cast<unsigned>(sizeof(LoRaHandler)));
+  EXPECT_LT(depth, 7 * 64);
+}
+
 #if 0 // Encrypted messages are not yet enabled in LoRaHandler
+typedef struct {
+  uint8_t buf[LORA_MAX_MESSAGE_LENGTH] = {};
+  size_t length{};
+} LoRaBufT;
+
+static LoRaBufT loraTxBuf;
+
+struct EncryptedMsg {
+  EncryptedMsg() {}
+
+  uint8_t mockLoRaRead() { return buffer.buf[i++]; }
+
+  size_t i{};
+  LoRaBufT buffer;
+};
+
+static void loraReadRawBuf(const uint8_t* buf, size_t size) {
+  EXPECT_LE(size, LORA_MAX_MESSAGE_LENGTH);
+  memcpy(loraTxBuf.buf, buf, size);
+  loraTxBuf.length = size;
+}
+
 TEST_F(LoRaHandler_test, encrypted_msg) {
   const int16_t rssi = -111;
   const byte AES_KEY[16] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05,
@@ -649,7 +1083,7 @@ TEST_F(LoRaHandler_test, encrypted_msg) {
   EXPECT_CALL(*pLoRaMock, beginPacket(0)).WillOnce(Return(1));
   EXPECT_CALL(*pLoRaMock, write(_, expectedMsgSize))
       .WillOnce(DoAll(Invoke(loraReadRawBuf), Return(expectedMsgSize)));
-  EXPECT_CALL(*pLoRaMock, endPacket(false)).WillOnce(Return(1));
+  EXPECT_CALL(*pLoRaMock, endPacket(true)).WillOnce(Return(1));
   EXPECT_CALL(*pArduinoMock, millis())
       .WillRepeatedly(Return(0));
 
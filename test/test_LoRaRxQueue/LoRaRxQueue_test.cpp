@@ -0,0 +1,88 @@
+#include "LoRaRxQueue.h"
+
+#include <gtest/gtest.h>
+#include <string.h>
+
+TEST(LoRaRxQueue_test, construct_capacity_4) {
+  LoRaRxQueue<4, 8> q;
+
+  EXPECT_EQ(q.capacity(), 4);
+}
+
+TEST(LoRaRxQueue_test, new_shall_be_empty) {
+  LoRaRxQueue<4, 8> q;
+
+  EXPECT_TRUE(q.isEmpty());
+  EXPECT_FALSE(q.isFull());
+  EXPECT_EQ(q.size(), 0);
+  EXPECT_EQ(q.getReadSlot(), nullptr);
+}
+
+TEST(LoRaRxQueue_test, write_slot_is_not_readable_until_committed) {
+  LoRaRxQueue<4, 8> q;
+
+  auto* slot = q.getWriteSlot();
+  ASSERT_NE(slot, nullptr);
+  slot->length = 1;
+
+  EXPECT_TRUE(q.isEmpty());
+  EXPECT_EQ(q.getReadSlot(), nullptr);
+
+  q.commit();
+
+  EXPECT_FALSE(q.isEmpty());
+  EXPECT_EQ(q.size(), 1);
+  EXPECT_EQ(q.getReadSlot(), slot);
+}
+
+TEST(LoRaRxQueue_test, committed_frame_shall_be_read_back_unchanged) {
+  LoRaRxQueue<2, 8> q;
+  const uint8_t frame[] = {1, 2, 3, 4, 5};
+
+  auto* wSlot = q.getWriteSlot();
+  memcpy(wSlot->buf, frame, sizeof(frame));
+  wSlot->length = sizeof(frame);
+  wSlot->rssi = -42;
+  q.commit();
+
+  auto* rSlot = q.getReadSlot();
+  ASSERT_NE(rSlot, nullptr);
+  EXPECT_EQ(rSlot->length, sizeof(frame));
+  EXPECT_EQ(rSlot->rssi, -42);
+  EXPECT_EQ(memcmp(rSlot->buf, frame, sizeof(frame)), 0);
+
+  q.release();
+  EXPECT_TRUE(q.isEmpty());
+}
+
+TEST(LoRaRxQueue_test, full_queue_shall_not_give_a_write_slot) {
+  LoRaRxQueue<2, 8> q;
+
+  q.getWriteSlot()->length = 1;
+  q.commit();
+  q.getWriteSlot()->length = 2;
+  q.commit();
+
+  EXPECT_TRUE(q.isFull());
+  EXPECT_EQ(q.getWriteSlot(), nullptr);
+
+  q.release();
+  EXPECT_FALSE(q.isFull());
+  EXPECT_NE(q.getWriteSlot(), nullptr);
+}
+
+TEST(LoRaRxQueue_test, frames_shall_be_read_in_order_across_wrap_around) {
+  LoRaRxQueue<2, 8> q;
+
+  for (uint16_t i = 0; i < 600; i++) {
+    q.getWriteSlot()->length = static_cast<uint8_t>(i);
+    q.commit();
+    if (i % 2 == 1) {
+      EXPECT_EQ(q.getReadSlot()->length, static_cast<uint8_t>(i - 1));
+      q.release();
+      EXPECT_EQ(q.getReadSlot()->length, static_cast<uint8_t>(i));
+      q.release();
+      EXPECT_TRUE(q.isEmpty());
+    }
+  }
+}
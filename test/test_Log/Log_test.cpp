@@ -0,0 +1,87 @@
+#define LOG_NON_BLOCKING
+
+#include "Log.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+// Include source implementation
+#include "../../src/Log.cpp"
+
+// Serial with a TX buffer that only the test drains.
+class TxBufferPrint : public Print {
+ public:
+  size_t write(uint8_t c) override {
+    if (room == 0) {
+      // Serial would wait here.
+      ADD_FAILURE() << "Blocking write";
+      return 0;
+    }
+    room--;
+    str += static_cast<char>(c);
+    return 1;
+  }
+
+  int availableForWrite() override { return room; }
+
+  int room{64};
+  std::string str;
+};
+
+class Log_test : public ::testing::Test {
+ protected:
+  TxBufferPrint out;
+  Logger logger{out};
+};
+
+TEST_F(Log_test, lines_that_fit_shall_be_written) {
+  size_t n = logger.println("Hello");
+
+  EXPECT_EQ(n, 7);
+  EXPECT_EQ(out.str, "Hello\r\n");
+  EXPECT_EQ(logger.getDropCount(), 0);
+}
+
+TEST_F(Log_test, full_buffer_shall_drop_rest_of_line) {
+  out.room = 3;
+
+  size_t n = logger.println("Hello");
+
+  EXPECT_EQ(n, 7);
+  EXPECT_EQ(out.str, "Hel");
+  EXPECT_EQ(logger.getDropCount(), 1);
+}
+
+TEST_F(Log_test, line_cut_short_shall_be_ended_with_marker) {
+  out.room = 3;
+  logger.println("Hello");
+  out.room = 64;
+
+  logger.println("World");
+
+  EXPECT_EQ(out.str, "Hel~\r\nWorld\r\n");
+}
+
+TEST_F(Log_test, next_line_shall_be_dropped_until_marker_fits) {
+  out.room = 3;
+  logger.println("Hello");
+  out.room = 3;
+
+  logger.println("World");
+
+  EXPECT_EQ(out.str, "Hel");
+  EXPECT_EQ(logger.getDropCount(), 2);
+
+  out.room = 64;
+  logger.print("!");
+
+  EXPECT_EQ(out.str, "Hel~\r\n!");
+}
+
+TEST(LogLevel_test, default_level_shall_enable_all_levels) {
+  EXPECT_TRUE(LOG_ENABLED(LORA, DEBUG));
+  EXPECT_TRUE(LOG_ENABLED(MAIN, DEBUG));
+  EXPECT_TRUE(LOG_ENABLED(MAIN, ERROR));
+  EXPECT_FALSE(LOG_LEVEL_NONE >= LOG_LEVEL_ERROR);
+}
@@ -0,0 +1,60 @@
+#include "MemoryMonitor.h"
+
+#include <gtest/gtest.h>
+
+// Include source implementation
+#include "../../src/MemoryMonitor.cpp"
+
+class MemoryMonitor_test : public ::testing::Test {
+ protected:
+  void SetUp() override { mm.begin(ram, ram + sizeof(ram)); }
+
+  // Stack use down to depth bytes from the top of the region.
+  void useStack(uint16_t depth) {
+    for (uint16_t i = 0; i < depth; i++) {
+      ram[sizeof(ram) - 1 - i] = static_cast<uint8_t>(i);
+    }
+  }
+
+  uint8_t ram[256];
+  MemoryMonitor mm;
+};
+
+TEST_F(MemoryMonitor_test, begin_shall_paint_region) {
+  for (uint8_t b : ram) {
+    EXPECT_EQ(b, MemoryMonitor::PAINT);
+  }
+  EXPECT_EQ(mm.getMinFreeRam(), sizeof(ram));
+  EXPECT_EQ(mm.getFreeRam(), sizeof(ram));
+}
+
+TEST_F(MemoryMonitor_test, min_free_ram_shall_follow_deepest_stack_use) {
+  useStack(40);
+  EXPECT_EQ(mm.getMinFreeRam(), sizeof(ram) - 40);
+
+  useStack(100);
+  EXPECT_EQ(mm.getMinFreeRam(), sizeof(ram) - 100);
+
+  // Shallower use later doesn't give the bytes back.
+  useStack(10);
+  EXPECT_EQ(mm.getMinFreeRam(), sizeof(ram) - 100);
+}
+
+TEST_F(MemoryMonitor_test, repainted_bytes_shall_still_count_as_used) {
+  useStack(100);
+  EXPECT_EQ(mm.getMinFreeRam(), sizeof(ram) - 100);
+
+  for (uint16_t i = 0; i < sizeof(ram); i++) {
+    ram[i] = MemoryMonitor::PAINT;
+  }
+  EXPECT_EQ(mm.getMinFreeRam(), sizeof(ram) - 100);
+}
+
+TEST(MemoryMonitor_empty_test, empty_region_shall_have_no_free_ram) {
+  uint8_t ram[4];
+  MemoryMonitor mm;
+
+  mm.begin(ram + 4, ram);
+  EXPECT_EQ(mm.getMinFreeRam(), 0);
+  EXPECT_EQ(mm.getFreeRam(), 0);
+}
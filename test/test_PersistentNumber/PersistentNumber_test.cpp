@@ -5,6 +5,42 @@
 #include "Arduino.h"
 #include "BufferSerial.h"
 
+static const char testName[] = "Test";
+
+// Metadata of the numbers, in flash on target.
+static const DiscoveryEntityT fullEntity = Number<uint16_t>::makeEntity(
+    100, "Test Number", NumberDeviceClass::DISTANCE, Unit::Type::m, 1,
+    BaseComponent::Category::CONFIG, 0, 1000);
+static const DiscoveryEntityT minimalEntity =
+    Number<uint16_t>::makeEntity(101, testName);
+static const DiscoveryEntityT testEntity = Number<uint16_t>::makeEntity(
+    1, testName, NumberDeviceClass::NONE, Unit::Type::none, 0,
+    BaseComponent::Category::NONE, 0, 1000);
+static const DiscoveryEntityT uint8Entity = Number<uint8_t>::makeEntity(
+    1, testName, NumberDeviceClass::NONE, Unit::Type::none, 0,
+    BaseComponent::Category::NONE, 0, 255);
+static const DiscoveryEntityT int16Entity = Number<int16_t>::makeEntity(
+    1, testName, NumberDeviceClass::NONE, Unit::Type::none, 0,
+    BaseComponent::Category::NONE, -32768, 32767);
+static const DiscoveryEntityT uint32Entity = Number<uint32_t>::makeEntity(
+    1, testName, NumberDeviceClass::NONE, Unit::Type::none, 0,
+    BaseComponent::Category::NONE, 0, UINT32_MAX);
+static const DiscoveryEntityT config1Entity = Number<uint16_t>::makeEntity(
+    1, "Config1", NumberDeviceClass::NONE, Unit::Type::none, 0,
+    BaseComponent::Category::CONFIG, 0, 1000);
+static const DiscoveryEntityT config2Entity = Number<uint16_t>::makeEntity(
+    2, "Config2", NumberDeviceClass::NONE, Unit::Type::none, 0,
+    BaseComponent::Category::CONFIG, 0, 1000);
+static const DiscoveryEntityT clampEntity = Number<int16_t>::makeEntity(
+    1, testName, NumberDeviceClass::NONE, Unit::Type::none, 0,
+    BaseComponent::Category::NONE, -100, 100);
+static const DiscoveryEntityT clampUint16Entity = Number<uint16_t>::makeEntity(
+    1, testName, NumberDeviceClass::NONE, Unit::Type::none, 0,
+    BaseComponent::Category::NONE, 100, 500);
+static const DiscoveryEntityT temperatureEntity = Number<int16_t>::makeEntity(
+    1, testName, NumberDeviceClass::TEMPERATURE, Unit::Type::C, 1,
+    BaseComponent::Category::CONFIG, -1000, 2000);
+
 class PersistentNumber_test : public ::testing::Test {
  protected:
   void SetUp() override {
@@ -37,16 +73,7 @@ class PersistentNumber_test : public ::testing::Test {
 // ============================================================================
 
 TEST_F(PersistentNumber_test, construct_with_full_parameters) {
-  PersistentNumber<uint16_t> pn{0x00,
-                                100,
-                                "Test Number",
-                                NumberDeviceClass::DISTANCE,
-                                Unit::Type::m,
-                                1,
-                                BaseComponent::Category::CONFIG,
-                                500,
-                                0,
-                                1000};
+  PersistentNumber<uint16_t> pn{0x00, fullEntity, 500};
 
   EXPECT_EQ(pn.getEntityId(), 100);
   EXPECT_EQ(pn.getValue(), 500);
@@ -54,9 +81,10 @@ TEST_F(PersistentNumber_test, construct_with_full_parameters) {
 }
 
 TEST_F(PersistentNumber_test, construct_with_minimal_parameters) {
-  PersistentNumber<uint16_t> pn{0x10, 101};
+  PersistentNumber<uint16_t> pn{0x10, minimalEntity};
 
   EXPECT_EQ(pn.getEntityId(), 101);
+  EXPECT_EQ(pn.getValue(), 0);
   EXPECT_EQ(pn.getComponentType(), BaseComponent::Type::NUMBER);
 }
 
@@ -64,29 +92,25 @@ TEST_F(PersistentNumber_test, construct_with_minimal_parameters) {
 TEST_F(PersistentNumber_test, construct_with_float_shall_fail) {
   // This should fail at compile time, but we can't test that directly in
   // runtime The static_assert will prevent compilation if uncommented:
-  // PersistentNumber<float> pn{0x00, 1};  // ← Compilation error!
+  // PersistentNumber<float> pn{0x00, fullEntity};  // ← Compilation error!
   SUCCEED();  // Placeholder for compile-time validation
 }
 
 TEST_F(PersistentNumber_test, construct_with_int64_shall_fail) {
   // This should fail at compile time:
-  // PersistentNumber<int64_t> pn{0x00, 1};  // ← Compilation error!
+  // PersistentNumber<int64_t> pn{0x00, fullEntity};  // ← Compilation error!
   SUCCEED();  // Placeholder for compile-time validation
 }
 #endif
 
-// ============================================================================
-// Tests: EEPROM Loading
-// ============================================================================
-
 // ============================================================================
 // Tests: LoadStatus Return Values
 // ============================================================================
 
 TEST_F(PersistentNumber_test, loadFromEeprom_empty_returns_crc_failed) {
   // Empty EEPROM will fail CRC validation, not address check
-  PersistentNumber<uint16_t> pn{0x00, 1, "Test"};
-  Ee::LoadStatus status = pn.loadFromEeprom(512);
+  PersistentNumber<uint16_t> pn{0x00, testEntity, 512};
+  Ee::LoadStatus status = pn.loadFromEeprom();
 
   EXPECT_EQ(status, Ee::LoadStatus::CRC_FAILED);
   EXPECT_FALSE(pn.wasLastLoadSuccessful());
@@ -95,9 +119,9 @@ TEST_F(PersistentNumber_test, loadFromEeprom_empty_returns_crc_failed) {
 TEST_F(PersistentNumber_test,
        loadFromEeprom_oob_address_returns_address_out_of_range) {
   uint16_t oobAddr = EEPROM.length() - 2;  // Not enough space for 5 bytes
-  PersistentNumber<uint16_t> pn{oobAddr, 2, "Test"};
+  PersistentNumber<uint16_t> pn{oobAddr, testEntity, 789};
 
-  Ee::LoadStatus status = pn.loadFromEeprom(789);
+  Ee::LoadStatus status = pn.loadFromEeprom();
 
   EXPECT_EQ(status, Ee::LoadStatus::ADDRESS_OUT_OF_RANGE);
   EXPECT_EQ(pn.getValue(), 789);
@@ -106,33 +130,15 @@ TEST_F(PersistentNumber_test,
 
 TEST_F(PersistentNumber_test, loadFromEeprom_corrupted_crc_returns_crc_failed) {
   // Pre-write valid data
-  PersistentNumber<uint16_t> pn1{0x00,
-                                 1,
-                                 "Test1",
-                                 NumberDeviceClass::NONE,
-                                 Unit::Type::none,
-                                 0,
-                                 BaseComponent::Category::NONE,
-                                 0,
-                                 0,
-                                 1000};
+  PersistentNumber<uint16_t> pn1{0x00, testEntity};
   pn1.setValue(456);
 
   // Corrupt the CRC byte
   EEPROM.write(0x00 + Ee::VALUE_SIZE, 0x00);
 
   // Load with corrupted CRC
-  PersistentNumber<uint16_t> pn2{0x00,
-                                 1,
-                                 "Test1",
-                                 NumberDeviceClass::NONE,
-                                 Unit::Type::none,
-                                 0,
-                                 BaseComponent::Category::NONE,
-                                 0,
-                                 0,
-                                 1000};
-  Ee::LoadStatus status = pn2.loadFromEeprom(999);
+  PersistentNumber<uint16_t> pn2{0x00, testEntity, 999};
+  Ee::LoadStatus status = pn2.loadFromEeprom();
 
   EXPECT_EQ(status, Ee::LoadStatus::CRC_FAILED);
   EXPECT_EQ(pn2.getValue(), 999);  // Should use default
@@ -140,29 +146,11 @@ TEST_F(PersistentNumber_test, loadFromEeprom_corrupted_crc_returns_crc_failed) {
 }
 
 TEST_F(PersistentNumber_test, loadFromEeprom_success_returns_success_status) {
-  PersistentNumber<uint16_t> pn1{0x00,
-                                 1,
-                                 "Test",
-                                 NumberDeviceClass::NONE,
-                                 Unit::Type::none,
-                                 0,
-                                 BaseComponent::Category::NONE,
-                                 0,
-                                 0,
-                                 1000};
+  PersistentNumber<uint16_t> pn1{0x00, testEntity};
   pn1.setValue(789);
 
-  PersistentNumber<uint16_t> pn2{0x00,
-                                 1,
-                                 "Test",
-                                 NumberDeviceClass::NONE,
-                                 Unit::Type::none,
-                                 0,
-                                 BaseComponent::Category::NONE,
-                                 0,
-                                 0,
-                                 1000};
-  Ee::LoadStatus status = pn2.loadFromEeprom(999);
+  PersistentNumber<uint16_t> pn2{0x00, testEntity, 999};
+  Ee::LoadStatus status = pn2.loadFromEeprom();
 
   EXPECT_EQ(status, Ee::LoadStatus::SUCCESS);
   EXPECT_EQ(pn2.getValue(), 789);
@@ -170,40 +158,45 @@ TEST_F(PersistentNumber_test, loadFromEeprom_success_returns_success_status) {
 }
 
 TEST_F(PersistentNumber_test, getLastLoadStatus_tracks_multiple_loads) {
-  PersistentNumber<uint16_t> pn{0x00,
-                                1,
-                                "Test",
-                                NumberDeviceClass::NONE,
-                                Unit::Type::none,
-                                0,
-                                BaseComponent::Category::NONE,
-                                0,
-                                0,
-                                1000};
-
-  // First load: empty EEPROM -> CRC_FAILED
-  Ee::LoadStatus status1 = pn.loadFromEeprom(100);
+  PersistentNumber<uint16_t> pn{0x00, testEntity, 100};
+
+  // First load: empty EEPROM -> CRC_FAILED, default is saved
+  Ee::LoadStatus status1 = pn.loadFromEeprom();
   EXPECT_EQ(status1, Ee::LoadStatus::CRC_FAILED);
   EXPECT_EQ(pn.getLastLoadStatus(), Ee::LoadStatus::CRC_FAILED);
 
   // Second load: now has value -> SUCCESS
-  Ee::LoadStatus status2 = pn.loadFromEeprom(200);
+  Ee::LoadStatus status2 = pn.loadFromEeprom();
   EXPECT_EQ(status2, Ee::LoadStatus::SUCCESS);
   EXPECT_EQ(pn.getLastLoadStatus(), Ee::LoadStatus::SUCCESS);
+  EXPECT_EQ(pn.getValue(), 100);
 }
 
+// ============================================================================
+// Tests: EEPROM Loading
+// ============================================================================
+
 TEST_F(PersistentNumber_test, loadFromEeprom_empty_eeprom_uses_default) {
-  PersistentNumber<uint16_t> pn{0x00, 1, "Test"};
-  pn.loadFromEeprom(512);
+  PersistentNumber<uint16_t> pn{0x00, testEntity, 512};
+  pn.loadFromEeprom();
 
   EXPECT_EQ(pn.getValue(), 512);
 }
 
+TEST_F(PersistentNumber_test, loadFromEeprom_empty_eeprom_saves_default) {
+  PersistentNumber<uint16_t> pn{0x00, testEntity, 512};
+  pn.loadFromEeprom();
+
+  uint32_t stored = 0;
+  EXPECT_TRUE(Ee::load(0x00, stored));
+  EXPECT_EQ(stored, 512u);
+}
+
 TEST_F(PersistentNumber_test, loadFromEeprom_oob_address_uses_default) {
   uint16_t oobAddr = EEPROM.length() - 2;  // Not enough space for 5 bytes
-  PersistentNumber<uint16_t> pn{oobAddr, 2, "Test"};
+  PersistentNumber<uint16_t> pn{oobAddr, testEntity, 789};
 
-  pn.loadFromEeprom(789);
+  pn.loadFromEeprom();
 
   // Should use default when address is out of bounds
   EXPECT_EQ(pn.getValue(), 789);
@@ -211,69 +204,53 @@ TEST_F(PersistentNumber_test, loadFromEeprom_oob_address_uses_default) {
 
 TEST_F(PersistentNumber_test, loadFromEeprom_corrupted_crc_uses_default) {
   // Pre-write valid data
-  PersistentNumber<uint16_t> pn1{0x00,
-                                 1,
-                                 "Test1",
-                                 NumberDeviceClass::NONE,
-                                 Unit::Type::none,
-                                 0,
-                                 BaseComponent::Category::NONE,
-                                 0,
-                                 0,
-                                 1000};
+  PersistentNumber<uint16_t> pn1{0x00, testEntity};
   pn1.setValue(456);  // Auto-saves
 
   // Corrupt the CRC byte
   EEPROM.write(0x00 + Ee::VALUE_SIZE, 0x00);
 
   // Load with corrupted CRC
-  PersistentNumber<uint16_t> pn2{0x00,
-                                 1,
-                                 "Test1",
-                                 NumberDeviceClass::NONE,
-                                 Unit::Type::none,
-                                 0,
-                                 BaseComponent::Category::NONE,
-                                 0,
-                                 0,
-                                 1000};
-  pn2.loadFromEeprom(999);
+  PersistentNumber<uint16_t> pn2{0x00, testEntity, 999};
+  pn2.loadFromEeprom();
 
   // Should use default when CRC fails
   EXPECT_EQ(pn2.getValue(), 999);
 }
 
+TEST_F(PersistentNumber_test, loadFromEeprom_truncated_value_uses_default) {
+  EXPECT_TRUE(Ee::save(0x10, 0x1234u));  // Does not fit in uint8_t
+
+  PersistentNumber<uint8_t> pn{0x10, uint8Entity, 12};
+  Ee::LoadStatus status = pn.loadFromEeprom();
+
+  EXPECT_EQ(status, Ee::LoadStatus::CAST_TRUNCATED);
+  EXPECT_EQ(pn.getValue(), 12);
+}
+
+TEST_F(PersistentNumber_test, loadFromEeprom_clamps_to_max) {
+  EXPECT_TRUE(Ee::save(0x00, 2000u));  // Above max of 1000
+
+  PersistentNumber<uint16_t> pn{0x00, testEntity, 999};
+  Ee::LoadStatus status = pn.loadFromEeprom();
+
+  EXPECT_EQ(status, Ee::LoadStatus::SUCCESS);
+  EXPECT_EQ(pn.getValue(), 1000);
+}
+
 // ============================================================================
 // Tests: EEPROM Saving & Roundtrip
 // ============================================================================
 
 TEST_F(PersistentNumber_test, setValue_auto_saves_to_eeprom) {
-  PersistentNumber<uint16_t> pn1{0x00,
-                                 1,
-                                 "Test",
-                                 NumberDeviceClass::NONE,
-                                 Unit::Type::none,
-                                 0,
-                                 BaseComponent::Category::NONE,
-                                 0,
-                                 0,
-                                 1000};
+  PersistentNumber<uint16_t> pn1{0x00, testEntity};
 
   pn1.setValue(789);
   EXPECT_EQ(pn1.getValue(), 789);
 
   // Create new instance at same EEPROM address
-  PersistentNumber<uint16_t> pn2{0x00,
-                                 1,
-                                 "Test",
-                                 NumberDeviceClass::NONE,
-                                 Unit::Type::none,
-                                 0,
-                                 BaseComponent::Category::NONE,
-                                 0,
-                                 0,
-                                 1000};
-  pn2.loadFromEeprom(999);
+  PersistentNumber<uint16_t> pn2{0x00, testEntity, 999};
+  pn2.loadFromEeprom();
 
   // Should load the previously saved value
   EXPECT_EQ(pn2.getValue(), 789);
@@ -282,29 +259,11 @@ TEST_F(PersistentNumber_test, setValue_auto_saves_to_eeprom) {
 TEST_F(PersistentNumber_test, roundtrip_uint8) {
   const uint8_t testValue = 123;
 
-  PersistentNumber<uint8_t> pn1{0x10,
-                                1,
-                                "Test",
-                                NumberDeviceClass::NONE,
-                                Unit::Type::none,
-                                0,
-                                BaseComponent::Category::NONE,
-                                0,
-                                0,
-                                255};
+  PersistentNumber<uint8_t> pn1{0x10, uint8Entity};
   pn1.setValue(testValue);
 
-  PersistentNumber<uint8_t> pn2{0x10,
-                                1,
-                                "Test",
-                                NumberDeviceClass::NONE,
-                                Unit::Type::none,
-                                0,
-                                BaseComponent::Category::NONE,
-                                0,
-                                0,
-                                255};
-  pn2.loadFromEeprom(0);
+  PersistentNumber<uint8_t> pn2{0x10, uint8Entity};
+  pn2.loadFromEeprom();
 
   EXPECT_EQ(pn2.getValue(), testValue);
 }
@@ -312,29 +271,11 @@ TEST_F(PersistentNumber_test, roundtrip_uint8) {
 TEST_F(PersistentNumber_test, roundtrip_int16) {
   const int16_t testValue = -1234;
 
-  PersistentNumber<int16_t> pn1{0x20,
-                                1,
-                                "Test",
-                                NumberDeviceClass::NONE,
-                                Unit::Type::none,
-                                0,
-                                BaseComponent::Category::NONE,
-                                0,
-                                -32768,
-                                32767};
+  PersistentNumber<int16_t> pn1{0x20, int16Entity};
   pn1.setValue(testValue);
 
-  PersistentNumber<int16_t> pn2{0x20,
-                                1,
-                                "Test",
-                                NumberDeviceClass::NONE,
-                                Unit::Type::none,
-                                0,
-                                BaseComponent::Category::NONE,
-                                0,
-                                -32768,
-                                32767};
-  pn2.loadFromEeprom(0);
+  PersistentNumber<int16_t> pn2{0x20, int16Entity};
+  pn2.loadFromEeprom();
 
   EXPECT_EQ(pn2.getValue(), testValue);
 }
@@ -342,29 +283,11 @@ TEST_F(PersistentNumber_test, roundtrip_int16) {
 TEST_F(PersistentNumber_test, roundtrip_uint32) {
   const uint32_t testValue = 0xDEADBEEFul;
 
-  PersistentNumber<uint32_t> pn1{0x30,
-                                 1,
-                                 "Test",
-                                 NumberDeviceClass::NONE,
-                                 Unit::Type::none,
-                                 0,
-                                 BaseComponent::Category::NONE,
-                                 0,
-                                 0,
-                                 UINT32_MAX};
+  PersistentNumber<uint32_t> pn1{0x30, uint32Entity};
   pn1.setValue(testValue);
 
-  PersistentNumber<uint32_t> pn2{0x30,
-                                 1,
-                                 "Test",
-                                 NumberDeviceClass::NONE,
-                                 Unit::Type::none,
-                                 0,
-                                 BaseComponent::Category::NONE,
-                                 0,
-                                 0,
-                                 UINT32_MAX};
-  pn2.loadFromEeprom(0);
+  PersistentNumber<uint32_t> pn2{0x30, uint32Entity};
+  pn2.loadFromEeprom();
 
   EXPECT_EQ(pn2.getValue(), testValue);
 }
@@ -374,55 +297,18 @@ TEST_F(PersistentNumber_test, roundtrip_uint32) {
 // ============================================================================
 
 TEST_F(PersistentNumber_test, multiple_instances_different_addresses) {
-  PersistentNumber<uint16_t> pn1{0x00,
-                                 1,
-                                 "Config1",
-                                 NumberDeviceClass::NONE,
-                                 Unit::Type::none,
-                                 0,
-                                 BaseComponent::Category::CONFIG,
-                                 100,
-                                 0,
-                                 1000};
-
-  PersistentNumber<uint16_t> pn2{0x10,
-                                 2,
-                                 "Config2",
-                                 NumberDeviceClass::NONE,
-                                 Unit::Type::none,
-                                 0,
-                                 BaseComponent::Category::CONFIG,
-                                 200,
-                                 0,
-                                 1000};
+  PersistentNumber<uint16_t> pn1{0x00, config1Entity, 100};
+  PersistentNumber<uint16_t> pn2{0x10, config2Entity, 200};
 
   pn1.setValue(111);
   pn2.setValue(222);
 
-  PersistentNumber<uint16_t> pn1_verify{0x00,
-                                        1,
-                                        "Config1",
-                                        NumberDeviceClass::NONE,
-                                        Unit::Type::none,
-                                        0,
-                                        BaseComponent::Category::CONFIG,
-                                        0,
-                                        0,
-                                        1000};
-  pn1_verify.loadFromEeprom(999);
+  PersistentNumber<uint16_t> pn1_verify{0x00, config1Entity, 999};
+  pn1_verify.loadFromEeprom();
   EXPECT_EQ(pn1_verify.getValue(), 111);
 
-  PersistentNumber<uint16_t> pn2_verify{0x10,
-                                        2,
-                                        "Config2",
-                                        NumberDeviceClass::NONE,
-                                        Unit::Type::none,
-                                        0,
-                                        BaseComponent::Category::CONFIG,
-                                        0,
-                                        0,
-                                        1000};
-  pn2_verify.loadFromEeprom(999);
+  PersistentNumber<uint16_t> pn2_verify{0x10, config2Entity, 999};
+  pn2_verify.loadFromEeprom();
   EXPECT_EQ(pn2_verify.getValue(), 222);
 }
 
@@ -431,63 +317,38 @@ TEST_F(PersistentNumber_test, multiple_instances_different_addresses) {
 // ============================================================================
 
 TEST_F(PersistentNumber_test, setValue_clamps_to_min) {
-  PersistentNumber<int16_t> pn{0x40,
-                               1,
-                               "Test",
-                               NumberDeviceClass::NONE,
-                               Unit::Type::none,
-                               0,
-                               BaseComponent::Category::NONE,
-                               0,
-                               -100,
-                               100};
+  PersistentNumber<int16_t> pn{0x40, clampEntity};
 
   pn.setValue(-500);               // Try to set below min
   EXPECT_EQ(pn.getValue(), -100);  // Clamped to min
 }
 
 TEST_F(PersistentNumber_test, setValue_clamps_to_max) {
-  PersistentNumber<int16_t> pn{0x50,
-                               1,
-                               "Test",
-                               NumberDeviceClass::NONE,
-                               Unit::Type::none,
-                               0,
-                               BaseComponent::Category::NONE,
-                               0,
-                               -100,
-                               100};
+  PersistentNumber<int16_t> pn{0x50, clampEntity};
 
   pn.setValue(500);               // Try to set above max
   EXPECT_EQ(pn.getValue(), 100);  // Clamped to max
 }
 
+TEST_F(PersistentNumber_test, setValueItem_clamps_and_saves) {
+  PersistentNumber<int16_t> pn{0x50, clampEntity};
+
+  pn.setValueItem({1, static_cast<uint32_t>(-500)});
+  EXPECT_EQ(pn.getValue(), -100);
+
+  PersistentNumber<int16_t> pn_verify{0x50, clampEntity, 50};
+  pn_verify.loadFromEeprom();
+  EXPECT_EQ(pn_verify.getValue(), -100);
+}
+
 TEST_F(PersistentNumber_test, roundtrip_preserves_clamped_value) {
-  PersistentNumber<uint16_t> pn1{0x60,
-                                 1,
-                                 "Test",
-                                 NumberDeviceClass::NONE,
-                                 Unit::Type::none,
-                                 0,
-                                 BaseComponent::Category::NONE,
-                                 0,
-                                 100,
-                                 500};
+  PersistentNumber<uint16_t> pn1{0x60, clampUint16Entity, 100};
 
   pn1.setValue(50);  // Below min, will be clamped to 100
   EXPECT_EQ(pn1.getValue(), 100);
 
-  PersistentNumber<uint16_t> pn2{0x60,
-                                 1,
-                                 "Test",
-                                 NumberDeviceClass::NONE,
-                                 Unit::Type::none,
-                                 0,
-                                 BaseComponent::Category::NONE,
-                                 0,
-                                 100,
-                                 500};
-  pn2.loadFromEeprom(999);
+  PersistentNumber<uint16_t> pn2{0x60, clampUint16Entity, 500};
+  pn2.loadFromEeprom();
 
   // Should recover the clamped value (100), not the original attempt (50)
   EXPECT_EQ(pn2.getValue(), 100);
@@ -501,29 +362,11 @@ TEST_F(PersistentNumber_test, saveToEeprom_at_boundary_address) {
   // Save at address that fits exactly (5 bytes: addr to addr+4)
   uint16_t boundaryAddr = EEPROM.length() - Ee::TOTAL_SIZE;
 
-  PersistentNumber<uint16_t> pn1{boundaryAddr,
-                                 1,
-                                 "Boundary",
-                                 NumberDeviceClass::NONE,
-                                 Unit::Type::none,
-                                 0,
-                                 BaseComponent::Category::NONE,
-                                 0,
-                                 0,
-                                 1000};
+  PersistentNumber<uint16_t> pn1{boundaryAddr, testEntity};
   pn1.setValue(777);
 
-  PersistentNumber<uint16_t> pn2{boundaryAddr,
-                                 1,
-                                 "Boundary",
-                                 NumberDeviceClass::NONE,
-                                 Unit::Type::none,
-                                 0,
-                                 BaseComponent::Category::NONE,
-                                 0,
-                                 0,
-                                 1000};
-  pn2.loadFromEeprom(999);
+  PersistentNumber<uint16_t> pn2{boundaryAddr, testEntity, 999};
+  pn2.loadFromEeprom();
 
   EXPECT_EQ(pn2.getValue(), 777);
 }
@@ -532,31 +375,14 @@ TEST_F(PersistentNumber_test, saveToEeprom_past_boundary_fails_gracefully) {
   // Try to save at address that goes past EEPROM end
   uint16_t pastBoundaryAddr = EEPROM.length() - 2;  // Only 2 bytes left
 
-  PersistentNumber<uint16_t> pn{pastBoundaryAddr,
-                                1,
-                                "PastBoundary",
-                                NumberDeviceClass::NONE,
-                                Unit::Type::none,
-                                0,
-                                BaseComponent::Category::NONE,
-                                0,
-                                0,
-                                1000};
+  PersistentNumber<uint16_t> pn{pastBoundaryAddr, testEntity};
 
   pn.setValue(888);  // Attempt save
+  EXPECT_EQ(pn.getValue(), 888);
 
   // Load attempt should use default due to address being OOB
-  PersistentNumber<uint16_t> pn_verify{pastBoundaryAddr,
-                                       1,
-                                       "PastBoundary",
-                                       NumberDeviceClass::NONE,
-                                       Unit::Type::none,
-                                       0,
-                                       BaseComponent::Category::NONE,
-                                       0,
-                                       0,
-                                       1000};
-  pn_verify.loadFromEeprom(555);
+  PersistentNumber<uint16_t> pn_verify{pastBoundaryAddr, testEntity, 555};
+  pn_verify.loadFromEeprom();
 
   // Should not have persisted (address was invalid)
   EXPECT_EQ(pn_verify.getValue(), 555);
@@ -567,56 +393,77 @@ TEST_F(PersistentNumber_test, saveToEeprom_past_boundary_fails_gracefully) {
 // ============================================================================
 
 TEST_F(PersistentNumber_test, getComponentType) {
-  PersistentNumber<uint16_t> pn{0x70, 1, "Test"};
+  PersistentNumber<uint16_t> pn{0x70, testEntity};
 
   EXPECT_EQ(pn.getComponentType(), BaseComponent::Type::NUMBER);
 }
 
 TEST_F(PersistentNumber_test, getDeviceClass) {
-  PersistentNumber<uint16_t> pn{0x80, 1, "Test", NumberDeviceClass::TEMPERATURE,
-                                Unit::Type::C};
+  PersistentNumber<int16_t> pn{0x80, temperatureEntity};
 
   EXPECT_EQ(pn.getDeviceClass(), NumberDeviceClass::TEMPERATURE);
 }
 
 TEST_F(PersistentNumber_test, getUnitType) {
-  PersistentNumber<uint16_t> pn{0x90, 1, "Test", NumberDeviceClass::DISTANCE,
-                                Unit::Type::m};
+  PersistentNumber<uint16_t> pn{0x90, fullEntity};
 
   EXPECT_EQ(pn.getUnitType(), Unit::Type::m);
 }
 
+TEST_F(PersistentNumber_test, getDiscoveryEntity) {
+  PersistentNumber<int16_t> pn{0x80, temperatureEntity};
+  DiscoveryEntityT item{};
+
+  pn.getDiscoveryEntity(item);
+
+  EXPECT_EQ(item.entityId, 1);
+  EXPECT_EQ(item.componentType,
+            static_cast<uint8_t>(BaseComponent::Type::NUMBER));
+  EXPECT_EQ(item.deviceClass,
+            static_cast<uint8_t>(NumberDeviceClass::TEMPERATURE));
+  EXPECT_EQ(item.category,
+            static_cast<uint8_t>(BaseComponent::Category::CONFIG));
+  EXPECT_EQ(item.unit, static_cast<uint8_t>(Unit::Type::C));
+  EXPECT_EQ(item.precision, 1);
+  EXPECT_EQ(item.sizeCode, sizeof(int16_t) / 2);
+  EXPECT_TRUE(item.isSigned);
+  EXPECT_EQ(static_cast<int32_t>(item.minValue), -1000);
+  EXPECT_EQ(static_cast<int32_t>(item.maxValue), 2000);
+  EXPECT_STREQ(item.name, testName);
+}
+
+TEST_F(PersistentNumber_test, getValueItem) {
+  PersistentNumber<uint32_t> pn{0x30, uint32Entity, 0xDEADBEEF};
+  ValueItemT item;
+
+  pn.getValueItem(item);
+
+  EXPECT_EQ(item.entityId, 1);
+  EXPECT_EQ(item.value, 0xDEADBEEF);
+}
+
+TEST_F(PersistentNumber_test, printTo) {
+  PersistentNumber<int16_t> pn{0x80, temperatureEntity, -15};
+
+  pn.printTo(Serial);
+
+  bufSerReadStr();
+  EXPECT_STREQ(strBuf, "Test=-1.5°C");
+}
+
 // ============================================================================
 // Tests: Direct Access to Wrapped Number
 // ============================================================================
 
 TEST_F(PersistentNumber_test, getNumber_returns_wrapped_instance) {
-  PersistentNumber<uint16_t> pn{0xA0,
-                                1,
-                                "Test",
-                                NumberDeviceClass::NONE,
-                                Unit::Type::none,
-                                0,
-                                BaseComponent::Category::NONE,
-                                100,
-                                0,
-                                1000};
+  PersistentNumber<uint16_t> pn{0xA0, testEntity, 100};
 
   Number<uint16_t>& num = pn.getNumber();
   EXPECT_EQ(num.getValue(), 100);
 }
 
 TEST_F(PersistentNumber_test, getNumber_const_access) {
-  PersistentNumber<uint16_t> pn{0xB0,
-                                1,
-                                "Test",
-                                NumberDeviceClass::NONE,
-                                Unit::Type::none,
-                                0,
-                                BaseComponent::Category::NONE,
-                                200,
-                                0,
-                                1000};
+  PersistentNumber<uint16_t> pn{0xB0, testEntity, 200};
 
   const PersistentNumber<uint16_t>& pn_const = pn;
   const Number<uint16_t>& num = pn_const.getNumber();
@@ -0,0 +1,107 @@
+#include "PowerManager.h"
+
+#include <gtest/gtest.h>
+
+#include "avr/sleep.h"
+
+// Include source implementation
+#include "../../src/PowerManager.cpp"
+
+using ::testing::_;
+using ::testing::AnyNumber;
+using ::testing::Invoke;
+using ::testing::Return;
+
+class PowerManager_test : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    pArduinoMock = arduinoMockInstance();
+    pArduinoMock->setMillisRaw(1000);
+
+    // Simulated clock, it only runs while awake or in idle.
+    ON_CALL(*pArduinoMock, millis()).WillByDefault(Invoke([this]() {
+      return pArduinoMock->getMillis();
+    }));
+    EXPECT_CALL(*pArduinoMock, millis()).Times(AnyNumber());
+    ON_CALL(*pArduinoMock, sleepCpu(SLEEP_MODE_IDLE))
+        .WillByDefault(Invoke([this](uint8_t) {
+          pArduinoMock->addMillisRaw(1);  // Timer tick
+        }));
+
+    // Power-down moves the simulated clock by the time asleep.
+    PowerManager::setAddMillisFunc(
+        [](uint32_t ms) { arduinoMockInstance()->addMillisRaw(ms); });
+
+    pm.begin(pins, sizeof(pins));
+  }
+
+  void TearDown() override {
+    PowerManager::setAddMillisFunc(nullptr);
+    releaseArduinoMock();
+  }
+
+  ArduinoMock* pArduinoMock;
+  const uint8_t pins[2] = {8, 9};
+  PowerManager pm;
+};
+
+TEST_F(PowerManager_test, idle_shall_sleep_until_next_interrupt) {
+  EXPECT_CALL(*pArduinoMock, sleepCpu(SLEEP_MODE_IDLE)).Times(1);
+
+  EXPECT_FALSE(pm.sleep(5000, PowerState::idle));
+  EXPECT_EQ(pArduinoMock->getMillis(), 1001);
+}
+
+TEST_F(PowerManager_test, power_down_shall_sleep_in_watchdog_steps) {
+  // 8192 + 1024 + 512 + 256 + 16 ms, the rest is less than a step.
+  EXPECT_CALL(*pArduinoMock, sleepCpu(SLEEP_MODE_PWR_DOWN)).Times(5);
+
+  EXPECT_FALSE(pm.sleep(10010, PowerState::powerDown));
+  EXPECT_EQ(pArduinoMock->getMillis(), 1000 + 10000);
+}
+
+TEST_F(PowerManager_test, short_power_down_shall_idle) {
+  EXPECT_CALL(*pArduinoMock, sleepCpu(SLEEP_MODE_IDLE)).Times(1);
+  EXPECT_CALL(*pArduinoMock, sleepCpu(SLEEP_MODE_PWR_DOWN)).Times(0);
+
+  EXPECT_FALSE(pm.sleep(PowerManager::MIN_POWER_DOWN_MS - 1,
+                        PowerState::powerDown));
+}
+
+TEST_F(PowerManager_test, active_shall_not_sleep) {
+  EXPECT_CALL(*pArduinoMock, sleepCpu(_)).Times(0);
+
+  EXPECT_FALSE(pm.sleep(5000, PowerState::active));
+}
+
+TEST_F(PowerManager_test, wake_pin_shall_end_power_down) {
+  EXPECT_CALL(*pArduinoMock, sleepCpu(SLEEP_MODE_PWR_DOWN))
+      .WillOnce(Return())
+      .WillOnce(Invoke([](uint8_t) { PowerManager::onWakePinIsr(); }));
+
+  EXPECT_TRUE(pm.sleep(10000, PowerState::powerDown));
+  EXPECT_EQ(pArduinoMock->getMillis(), 1000 + 8192);  // Second step is lost
+}
+
+TEST_F(PowerManager_test, wake_pin_while_active_shall_not_sleep) {
+  EXPECT_CALL(*pArduinoMock, sleepCpu(_)).Times(0);
+
+  PowerManager::onWakePinIsr();
+  EXPECT_TRUE(pm.sleep(10000, PowerState::powerDown));
+  EXPECT_CALL(*pArduinoMock, sleepCpu(SLEEP_MODE_IDLE)).Times(1);
+  EXPECT_FALSE(pm.sleep(10000, PowerState::idle));
+}
+
+TEST_F(PowerManager_test, time_in_each_state_shall_be_accounted) {
+  EXPECT_CALL(*pArduinoMock, sleepCpu(_)).Times(AnyNumber());
+
+  for (uint16_t i = 0; i < 1000; i++) {
+    pArduinoMock->addMillisRaw(3);  // Busy
+    pm.sleep(1, PowerState::idle);
+  }
+  pm.sleep(60000, PowerState::powerDown);
+
+  EXPECT_EQ(pm.getTime_s(PowerState::active), 3);
+  EXPECT_EQ(pm.getTime_s(PowerState::idle), 1);
+  EXPECT_EQ(pm.getTime_s(PowerState::powerDown), 60);
+}
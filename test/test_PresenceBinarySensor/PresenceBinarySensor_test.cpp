@@ -2,36 +2,74 @@
 
 #include <gtest/gtest.h>
 
-#include "Sensor.h"
-#include "Unit.h"
 #include "BufferSerial.h"
 #include "EEPROM.h"
+#include "NewPing.h"
+#include "Unit.h"
+#include "Util.h"
 
 // Include source implementation
 #include "../../src/BinarySensor.cpp"
+#include "../../src/DistanceSensor.cpp"
+#include "../../src/HeightSensor.cpp"
 #include "../../src/PresenceBinarySensor.cpp"
 
-using ::testing::Return;
+using ::testing::ReturnPointee;
 
 using HeightT = int16_t;  // cm
 
+static const char presenceSensorName[] = "PresenceBinarySensor";
+
+static const HeightT LOW_LIMIT = 180;
+static const HeightT HIGH_LIMIT = 200;
+static const uint16_t MIN_STABLE_TIME = 10000;
+
+// Metadata of the sensors, numbers and report config, in flash on target.
+static const DiscoveryEntityT distanceEntity =
+    DistanceSensor::makeEntity(3, "Distance");
+static const DiscoveryEntityT stableTimeEntity = Number<uint16_t>::makeEntity(
+    4, "Height Stable Time", NumberDeviceClass::DURATION, Unit::Type::ms, 0,
+    BaseComponent::Category::CONFIG, 0, Util::MS_PER_MINUTE);
+static const DiscoveryEntityT zeroValueEntity = Number<HeightT>::makeEntity(
+    5, "Height Zero Value", NumberDeviceClass::DISTANCE, Unit::Type::cm, 0,
+    BaseComponent::Category::CONFIG, -MAX_SENSOR_DISTANCE, MAX_SENSOR_DISTANCE);
+static const DiscoveryEntityT heightEntity =
+    HeightSensor::makeEntity(6, "Height");
+static const DiscoveryEntityT lowLimitEntity = Number<HeightT>::makeEntity(
+    7, "Low Limit", NumberDeviceClass::DISTANCE, Unit::Type::cm, 0,
+    BaseComponent::Category::CONFIG, 0, MAX_SENSOR_DISTANCE);
+static const DiscoveryEntityT highLimitEntity = Number<HeightT>::makeEntity(
+    8, "High Limit", NumberDeviceClass::DISTANCE, Unit::Type::cm, 0,
+    BaseComponent::Category::CONFIG, 0, MAX_SENSOR_DISTANCE);
+static const DiscoveryEntityT minStableTimeEntity =
+    Number<uint16_t>::makeEntity(9, "Min Stable Time",
+                                 NumberDeviceClass::DURATION, Unit::Type::ms,
+                                 0, BaseComponent::Category::CONFIG, 0,
+                                 Util::MS_PER_MINUTE);
+static const DiscoveryEntityT presenceEntity =
+    PresenceBinarySensor::makeEntity(10, presenceSensorName);
+
+static const DiscoveryEntityT reportEntities[] = {
+    ReportConfig::makeHysteresisEntity(23, "Height Hysteresis",
+                                       NumberDeviceClass::DISTANCE,
+                                       Unit::Type::cm, 0, MAX_SENSOR_DISTANCE),
+    ReportConfig::makeMinIntervalEntity(19, "Height Min Interval"),
+    ReportConfig::makeMaxIntervalEntity(31, "Height Max Interval"),
+    ReportConfig::makeBurstEntity(35, "Height Burst"),
+    ReportConfig::makeRefillTimeEntity(39, "Height Refill Time"),
+    ReportConfig::makeHysteresisPctEntity(27, "Height Relative Hysteresis"),
+};
+
 class PresenceBinarySensor_test : public ::testing::Test {
  protected:
   void SetUp() override {
-    strBuf[0] = '\0';
     pArduinoMock = arduinoMockInstance();
+    EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(ReturnPointee(&now));
     eeprom_clear();
-
-    pHeightSensor = new Sensor<HeightT>(
-        99, "Height", SensorDeviceClass::distance, Unit::Type::cm);
-    pPbs = new PresenceBinarySensor(89, "PresenceBinarySensor", *pHeightSensor);
+    strBuf[0] = '\0';
   }
 
-  void TearDown() override {
-    delete pPbs;
-    delete pHeightSensor;
-    releaseArduinoMock();
-  }
+  void TearDown() override { releaseArduinoMock(); }
 
   void bufSerReadStr() {
     size_t i = 0;
@@ -45,320 +83,215 @@ class PresenceBinarySensor_test : public ::testing::Test {
     strBuf[i] = '\0';
   }
 
+  void setHeight(HeightT height) { heightSensor.getSensor().setValue(height); }
+
+  ReportConfig config{0x00, reportEntities, {10, 0, 0, 300, 0, 60}};
+
+  uint32_t now{};
   char strBuf[256];
   ArduinoMock* pArduinoMock;
-  Sensor<HeightT>* pHeightSensor;
-  PresenceBinarySensor* pPbs;
+  NewPingMock sonarMock;
+
+  DistanceSensor distanceSensor =
+      DistanceSensor(distanceEntity, sonarMock, config);
+
+  PersistentNumber<uint16_t> configStableTime =
+      PersistentNumber<uint16_t>(0x10, stableTimeEntity, 5000);
+  PersistentNumber<HeightT> configZeroValue =
+      PersistentNumber<HeightT>(0x20, zeroValueEntity, 200);
+  PersistentNumberComponent<uint16_t> stableTime =
+      PersistentNumberComponent<uint16_t>(configStableTime);
+  PersistentNumberComponent<HeightT> zeroValue =
+      PersistentNumberComponent<HeightT>(configZeroValue);
+
+  HeightSensor heightSensor =
+      HeightSensor(heightEntity, distanceSensor, stableTime, zeroValue, config);
+
+  PersistentNumber<HeightT> configLowLimit =
+      PersistentNumber<HeightT>(0x30, lowLimitEntity, LOW_LIMIT);
+  PersistentNumber<HeightT> configHighLimit =
+      PersistentNumber<HeightT>(0x40, highLimitEntity, HIGH_LIMIT);
+  PersistentNumber<uint16_t> configMinStableTime =
+      PersistentNumber<uint16_t>(0x50, minStableTimeEntity, MIN_STABLE_TIME);
+  PersistentNumberComponent<HeightT> lowLimit =
+      PersistentNumberComponent<HeightT>(configLowLimit);
+  PersistentNumberComponent<HeightT> highLimit =
+      PersistentNumberComponent<HeightT>(configHighLimit);
+  PersistentNumberComponent<uint16_t> minStableTime =
+      PersistentNumberComponent<uint16_t>(configMinStableTime);
+
+  PresenceBinarySensor pbs =
+      PresenceBinarySensor(presenceEntity, heightSensor, lowLimit, highLimit,
+                           minStableTime);
 };
 
 TEST_F(PresenceBinarySensor_test, callService_shall_do_nothing) {
-  pPbs->callService(0);
+  pbs.callService(0);
 }
 
-TEST_F(PresenceBinarySensor_test, getConfigItemValues) {
-  ConfigItemValueT items[4];
-
-  EXPECT_EQ(pPbs->getConfigItemValues(items, sizeof(items) / sizeof(items[0])),
-            4);
-
-  EXPECT_EQ(items[0].configId, 0);
-  EXPECT_EQ(items[0].value,
-            PresenceBinarySensorConstants::CONFIG_LOW_LIMIT_DEFAULT);
-
-  EXPECT_EQ(items[1].configId, 1);
-  EXPECT_EQ(items[1].value,
-            PresenceBinarySensorConstants::CONFIG_HIGH_LIMIT_DEFAULT);
-
-  EXPECT_EQ(items[2].configId, 2);
-  EXPECT_EQ(items[2].value,
-            PresenceBinarySensorConstants::CONFIG_MIN_STABLE_TIME_DEFAULT);
-
-  EXPECT_EQ(items[3].configId, 3);
-  EXPECT_EQ(items[3].value,
-            PresenceBinarySensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT);
+TEST_F(PresenceBinarySensor_test, getDiscoveryEntity) {
+  DiscoveryEntityT item;
+
+  EXPECT_TRUE(pbs.getDiscoveryEntity(item));
+
+  EXPECT_EQ(item.entityId, 10);
+  EXPECT_EQ(item.componentType,
+            static_cast<uint8_t>(BaseComponent::Type::BINARY_SENSOR));
+  EXPECT_EQ(item.deviceClass,
+            static_cast<uint8_t>(BinarySensorDeviceClass::PRESENCE));
+  EXPECT_EQ(item.unit, static_cast<uint8_t>(Unit::Type::none));
+  EXPECT_FALSE(item.isSigned);
+  EXPECT_EQ(item.sizeCode, 0);
+  EXPECT_EQ(item.precision, 0);
+  EXPECT_EQ(item.minValue, 0);
+  EXPECT_EQ(item.maxValue, 1);
+  EXPECT_STREQ(item.name, presenceSensorName);
 }
 
-TEST_F(PresenceBinarySensor_test, getDiscoveryItem) {
-  DiscoveryItemT item;
-
-  pPbs->getDiscoveryItem(&item);
-
-  EXPECT_EQ(item.entity.entityId, 89);
-  EXPECT_EQ(item.entity.componentType,
-            static_cast<uint8_t>(BaseComponent::Type::binarySensor));
-  EXPECT_EQ(item.entity.deviceClass,
-            static_cast<uint8_t>(BinarySensorDeviceClass::presence));
-  EXPECT_EQ(item.entity.unit, static_cast<uint8_t>(Unit::Type::none));
-  EXPECT_FALSE(item.entity.isSigned);
-  EXPECT_EQ(item.entity.sizeCode, 0);
-  EXPECT_EQ(item.entity.precision, 0);
-
-  EXPECT_EQ(item.numberOfConfigItems, 4);
-
-  EXPECT_EQ(item.configItems[0].configId, 0);
-  EXPECT_EQ(item.configItems[0].unit, static_cast<uint8_t>(Unit::Type::cm));
-  EXPECT_EQ(item.configItems[0].sizeCode, sizeof(HeightT) / 2);
-  EXPECT_TRUE(item.configItems[0].isSigned);
-  EXPECT_EQ(item.configItems[0].precision, 0);
-
-  EXPECT_EQ(item.configItems[1].configId, 1);
-  EXPECT_EQ(item.configItems[1].unit, static_cast<uint8_t>(Unit::Type::cm));
-  EXPECT_TRUE(item.configItems[1].isSigned);
-  EXPECT_EQ(item.configItems[1].sizeCode, sizeof(HeightT) / 2);
-  EXPECT_EQ(item.configItems[1].precision, 0);
-
-  EXPECT_EQ(item.configItems[2].configId, 2);
-  EXPECT_EQ(item.configItems[2].unit, static_cast<uint8_t>(Unit::Type::ms));
-  EXPECT_FALSE(item.configItems[2].isSigned);
-  EXPECT_EQ(item.configItems[2].sizeCode, sizeof(uint16_t) / 2);
-  EXPECT_EQ(item.configItems[2].precision, 0);
-
-  EXPECT_EQ(item.configItems[3].configId, 3);
-  EXPECT_EQ(item.configItems[3].unit, static_cast<uint8_t>(Unit::Type::s));
-  EXPECT_FALSE(item.configItems[3].isSigned);
-  EXPECT_EQ(item.configItems[3].sizeCode, sizeof(uint16_t) / 2);
-  EXPECT_EQ(item.configItems[3].precision, 0);
+TEST_F(PresenceBinarySensor_test, getEntityId) {
+  EXPECT_EQ(pbs.getEntityId(), 10);
 }
 
-TEST_F(PresenceBinarySensor_test, getEntityId) {
-  EXPECT_EQ(pPbs->getEntityId(), 89);
+TEST_F(PresenceBinarySensor_test, getUpstream) {
+  EXPECT_EQ(pbs.getUpstream(0), &heightSensor);
+  EXPECT_EQ(pbs.getUpstream(1), &lowLimit);
+  EXPECT_EQ(pbs.getUpstream(2), &highLimit);
+  EXPECT_EQ(pbs.getUpstream(3), &minStableTime);
+  EXPECT_EQ(pbs.getUpstream(4), nullptr);
 }
 
 TEST_F(PresenceBinarySensor_test, getValueItem) {
   ValueItemT item;
 
-  pPbs->getValueItem(&item);
+  pbs.getValueItem(item);
 
-  EXPECT_EQ(item.entityId, 89);
+  EXPECT_EQ(item.entityId, 10);
   EXPECT_EQ(item.value, 0);
 }
 
+TEST_F(PresenceBinarySensor_test,
+       setValueItem_of_own_entity_shall_return_false) {
+  EXPECT_FALSE(pbs.setValueItem({10, 1}));
+}
+
 TEST_F(PresenceBinarySensor_test, print) {
   const char* expectStr = "PresenceBinarySensor=away";
-  Sensor<HeightT> hs = Sensor<HeightT>(
-      99, "Height", SensorDeviceClass::distance, Unit::Type::cm);
-  PresenceBinarySensor pbs =
-      PresenceBinarySensor(89, "PresenceBinarySensor", hs);
 
-  size_t len = pbs.printTo(Serial);
-  bufSerReadStr();
+  EXPECT_EQ(pbs.printTo(Serial), strlen(expectStr));
 
+  bufSerReadStr();
   EXPECT_STREQ(strBuf, expectStr);
-  EXPECT_EQ(len, strlen(expectStr));
 }
 
 TEST_F(PresenceBinarySensor_test, print_service_shall_do_nothing) {
-  Sensor<HeightT> hs = Sensor<HeightT>(
-      99, "Height", SensorDeviceClass::distance, Unit::Type::cm);
-  PresenceBinarySensor pbs =
-      PresenceBinarySensor(89, "PresenceBinarySensor", hs);
   EXPECT_EQ(pbs.printTo(Serial, 0), 0);
 }
 
-TEST_F(PresenceBinarySensor_test, setConfigs_all_in_order) {
-  ConfigItemValueT inItems[4] = {{0, 100}, {1, 101}, {2, 102}, {3, 103}};
-  EXPECT_TRUE(pPbs->setConfigItemValues(inItems, 4));
-
-  ConfigItemValueT items[4];
-  EXPECT_EQ(pPbs->getConfigItemValues(items, sizeof(items) / sizeof(items[0])),
-            4);
-  EXPECT_EQ(items[0].value, 100);
-  EXPECT_EQ(items[1].value, 101);
-  EXPECT_EQ(items[2].value, 102);
-  EXPECT_EQ(items[3].value, 103);
-}
+TEST_F(PresenceBinarySensor_test,
+       update_belowLowLimit_belowMinStableTime_shall_return_false) {
+  setHeight(LOW_LIMIT - 1);
+  now = MIN_STABLE_TIME - 1;
 
-TEST_F(PresenceBinarySensor_test, setConfigs_all_out_of_order) {
-  ConfigItemValueT inItems[4] = {{3, 203}, {2, 202}, {1, 201}, {0, 200}};
-  EXPECT_TRUE(pPbs->setConfigItemValues(inItems, 4));
-
-  ConfigItemValueT items[4];
-  EXPECT_EQ(pPbs->getConfigItemValues(items, sizeof(items) / sizeof(items[0])),
-            4);
-  EXPECT_EQ(items[0].value, 200);
-  EXPECT_EQ(items[1].value, 201);
-  EXPECT_EQ(items[2].value, 202);
-  EXPECT_EQ(items[3].value, 203);
+  EXPECT_FALSE(pbs.update());
+  EXPECT_FALSE(pbs.isReportDue());
 }
 
-TEST_F(PresenceBinarySensor_test, setConfigs_one) {
-  ConfigItemValueT inItems[1] = {{2, 3002}};
-  EXPECT_TRUE(pPbs->setConfigItemValues(inItems, 1));
-
-  ConfigItemValueT items[4];
-  EXPECT_EQ(pPbs->getConfigItemValues(items, sizeof(items) / sizeof(items[0])),
-            4);
-  EXPECT_EQ(items[0].value,
-            PresenceBinarySensorConstants::CONFIG_LOW_LIMIT_DEFAULT);
-  EXPECT_EQ(items[1].value,
-            PresenceBinarySensorConstants::CONFIG_HIGH_LIMIT_DEFAULT);
-  EXPECT_EQ(items[2].value, 3002);
-  EXPECT_EQ(items[3].value,
-            PresenceBinarySensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT);
-}
+TEST_F(PresenceBinarySensor_test,
+       update_belowLowLimit_aboveMinStableTime_shall_return_true) {
+  setHeight(LOW_LIMIT - 1);
+  now = MIN_STABLE_TIME;
 
-TEST_F(PresenceBinarySensor_test, setConfigs_too_many) {
-  ConfigItemValueT inItems[5] = {
-      {0, 1000}, {1, 1001}, {2, 1002}, {3, 1003}, {4, 1004}};
-  EXPECT_FALSE(pPbs->setConfigItemValues(inItems, 5));
+  EXPECT_TRUE(pbs.update());
+  EXPECT_FALSE(pbs.update());
 }
 
-TEST_F(PresenceBinarySensor_test, setConfigs_out_of_range) {
-  ConfigItemValueT inItems[1] = {{4, 3004}};
-  EXPECT_FALSE(pPbs->setConfigItemValues(inItems, 1));
-}
+TEST_F(PresenceBinarySensor_test,
+       update_withinLimits_belowMinStableTime_shall_return_false) {
+  pbs.update();
+  now = 1000;
+  setHeight(LOW_LIMIT);
 
-TEST_F(PresenceBinarySensor_test, setReported) {
-  EXPECT_CALL(*pArduinoMock, millis()).Times(1);
-  pPbs->setReported();
-}
+  EXPECT_FALSE(pbs.update());
 
-TEST_F(
-    PresenceBinarySensor_test,
-    update_belowLowLimit_belowMinStableTime_aboveLastReportedTimeLimit_zeroMinReportTime_shall_return_false) {
-  pHeightSensor->setValue(
-      PresenceBinarySensorConstants::CONFIG_LOW_LIMIT_DEFAULT - 1);
-  EXPECT_CALL(*pArduinoMock, millis())
-      .WillOnce(Return(
-          PresenceBinarySensorConstants::CONFIG_MIN_STABLE_TIME_DEFAULT - 1));
-  ConfigItemValueT inItems[1] = {{3, 0}};
-  EXPECT_TRUE(pPbs->setConfigItemValues(inItems, 1));
-  EXPECT_FALSE(pPbs->update());
+  now = 1000 + MIN_STABLE_TIME - 1;
+  EXPECT_FALSE(pbs.update());
 }
 
-TEST_F(
-    PresenceBinarySensor_test,
-    update_belowLowLimit_belowMinStableTime_belowLastReportedTimeLimit_shall_return_false) {
-  pHeightSensor->setValue(
-      PresenceBinarySensorConstants::CONFIG_LOW_LIMIT_DEFAULT - 1);
-  EXPECT_CALL(*pArduinoMock, millis())
-      .WillOnce(Return(
-          PresenceBinarySensorConstants::CONFIG_MIN_STABLE_TIME_DEFAULT - 1))
-      .WillOnce(Return(
-          PresenceBinarySensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT * 1000 -
-          1));
-  EXPECT_FALSE(pPbs->update());
-}
+TEST_F(PresenceBinarySensor_test,
+       update_withinLimits_aboveMinStableTime_shall_return_true) {
+  pbs.update();
+  now = 1000;
+  setHeight(HIGH_LIMIT);
+  pbs.update();
 
-TEST_F(
-    PresenceBinarySensor_test,
-    update_aboveLowLimit_belowMinStableTime_belowLastReportedTimeLimit_shall_return_false) {
-  pHeightSensor->setValue(
-      PresenceBinarySensorConstants::CONFIG_LOW_LIMIT_DEFAULT);
-  EXPECT_CALL(*pArduinoMock, millis())
-      .WillOnce(Return(
-          PresenceBinarySensorConstants::CONFIG_MIN_STABLE_TIME_DEFAULT - 1))
-      .WillOnce(Return(
-          PresenceBinarySensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT * 1000 -
-          1));
-  EXPECT_FALSE(pPbs->update());
-}
+  now = 1000 + MIN_STABLE_TIME;
+  EXPECT_TRUE(pbs.update());
 
-TEST_F(
-    PresenceBinarySensor_test,
-    update_belowHighLimit_belowMinStableTime_belowLastReportedTimeLimit_shall_return_false) {
-  pHeightSensor->setValue(
-      PresenceBinarySensorConstants::CONFIG_HIGH_LIMIT_DEFAULT);
-  EXPECT_CALL(*pArduinoMock, millis())
-      .WillOnce(Return(
-          PresenceBinarySensorConstants::CONFIG_MIN_STABLE_TIME_DEFAULT - 1))
-      .WillOnce(Return(
-          PresenceBinarySensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT * 1000 -
-          1));
-  EXPECT_FALSE(pPbs->update());
+  ValueItemT item;
+  pbs.getValueItem(item);
+  EXPECT_EQ(item.value, 1);
 }
 
-TEST_F(
-    PresenceBinarySensor_test,
-    update_aboveHighLimit_belowMinStableTime_belowLastReportedTimeLimit_shall_return_false) {
-  pHeightSensor->setValue(
-      PresenceBinarySensorConstants::CONFIG_HIGH_LIMIT_DEFAULT + 1);
-  EXPECT_CALL(*pArduinoMock, millis())
-      .WillOnce(Return(
-          PresenceBinarySensorConstants::CONFIG_MIN_STABLE_TIME_DEFAULT - 1))
-      .WillOnce(Return(
-          PresenceBinarySensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT * 1000 -
-          1));
-  EXPECT_FALSE(pPbs->update());
-}
+TEST_F(PresenceBinarySensor_test, update_aboveHighLimit_shall_be_away) {
+  pbs.update();
+  now = 1000;
+  setHeight(HIGH_LIMIT + 1);
 
-TEST_F(
-    PresenceBinarySensor_test,
-    update_belowLowLimit_aboveMinStableTime_belowLastReportedTimeLimit_shall_return_true) {
-  pHeightSensor->setValue(
-      PresenceBinarySensorConstants::CONFIG_LOW_LIMIT_DEFAULT - 1);
-  EXPECT_CALL(*pArduinoMock, millis())
-      .WillOnce(
-          Return(PresenceBinarySensorConstants::CONFIG_MIN_STABLE_TIME_DEFAULT))
-      .WillOnce(Return(
-          PresenceBinarySensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT * 1000 -
-          1));
-  EXPECT_TRUE(pPbs->update());
-}
+  EXPECT_FALSE(pbs.update());
 
-TEST_F(
-    PresenceBinarySensor_test,
-    update_aboveLowLimit_aboveMinStableTime_belowLastReportedTimeLimit_shall_return_false) {
-  pHeightSensor->setValue(
-      PresenceBinarySensorConstants::CONFIG_LOW_LIMIT_DEFAULT);
-  EXPECT_CALL(*pArduinoMock, millis())
-      .WillOnce(
-          Return(PresenceBinarySensorConstants::CONFIG_MIN_STABLE_TIME_DEFAULT))
-      .WillOnce(Return(
-          PresenceBinarySensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT * 1000 -
-          1));
-  EXPECT_FALSE(pPbs->update());
+  now = 1000 + MIN_STABLE_TIME;
+  pbs.update();
+
+  ValueItemT item;
+  pbs.getValueItem(item);
+  EXPECT_EQ(item.value, 0);
 }
 
-TEST_F(
-    PresenceBinarySensor_test,
-    update_belowHighLimit_aboveMinStableTime_belowLastReportedTimeLimit_shall_return_false) {
-  pHeightSensor->setValue(
-      PresenceBinarySensorConstants::CONFIG_HIGH_LIMIT_DEFAULT);
-  EXPECT_CALL(*pArduinoMock, millis())
-      .WillOnce(
-          Return(PresenceBinarySensorConstants::CONFIG_MIN_STABLE_TIME_DEFAULT))
-      .WillOnce(Return(
-          PresenceBinarySensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT * 1000 -
-          1));
-  EXPECT_FALSE(pPbs->update());
+TEST_F(PresenceBinarySensor_test, update_shall_follow_changed_limits) {
+  setHeight(LOW_LIMIT - 1);
+  lowLimit.setValue(LOW_LIMIT - 10);
+  pbs.update();
+
+  now = MIN_STABLE_TIME;
+  EXPECT_TRUE(pbs.update());
+
+  ValueItemT item;
+  pbs.getValueItem(item);
+  EXPECT_EQ(item.value, 1);
 }
 
-TEST_F(
-    PresenceBinarySensor_test,
-    update_aboveHighLimit_aboveMinStableTime_belowLastReportedTimeLimit_shall_return_true) {
-  pHeightSensor->setValue(
-      PresenceBinarySensorConstants::CONFIG_HIGH_LIMIT_DEFAULT + 1);
-  EXPECT_CALL(*pArduinoMock, millis())
-      .WillOnce(
-          Return(PresenceBinarySensorConstants::CONFIG_MIN_STABLE_TIME_DEFAULT))
-      .WillOnce(Return(
-          PresenceBinarySensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT * 1000 -
-          1));
-  EXPECT_TRUE(pPbs->update());
+TEST_F(PresenceBinarySensor_test,
+       update_unchanged_aboveReportInterval_shall_return_true) {
+  now = MIN_STABLE_TIME;
+  pbs.update();
+  pbs.setReported(ReportReason::due);
+
+  now = MIN_STABLE_TIME +
+        PresenceBinarySensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT * 1000 -
+        1;
+  EXPECT_FALSE(pbs.update());
+
+  now += 1;
+  EXPECT_TRUE(pbs.update());
 }
 
-TEST_F(
-    PresenceBinarySensor_test,
-    update_belowLowLimit_belowMinStableTime_aboveLastReportedTimeLimit_shall_return_true) {
-  pHeightSensor->setValue(
-      PresenceBinarySensorConstants::CONFIG_LOW_LIMIT_DEFAULT - 1);
-  EXPECT_CALL(*pArduinoMock, millis())
-      .WillOnce(Return(
-          PresenceBinarySensorConstants::CONFIG_MIN_STABLE_TIME_DEFAULT - 1))
-      .WillOnce(
-          Return(PresenceBinarySensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT *
-                 1000));
-  EXPECT_TRUE(pPbs->update());
+TEST_F(PresenceBinarySensor_test, getUpdateInterval) {
+  // Polled while waiting for a stable state
+  EXPECT_EQ(pbs.getUpdateInterval(), IComponent::UPDATE_INTERVAL_DEFAULT_MS);
+
+  now = MIN_STABLE_TIME;
+  pbs.update();
+
+  EXPECT_EQ(pbs.getUpdateInterval(),
+            PresenceBinarySensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT *
+                1000UL);
 }
 
 TEST_F(PresenceBinarySensor_test, isReportDue) {
-  EXPECT_CALL(*pArduinoMock, millis()).WillOnce(Return(0));
-
   // Newly constructed shall be true
-  EXPECT_TRUE(pPbs->isReportDue());
+  EXPECT_TRUE(pbs.isReportDue());
 
   // Shall be set to false when setReported() is called
-  pPbs->setReported();
-  EXPECT_FALSE(pPbs->isReportDue());
+  pbs.setReported(ReportReason::due);
+  EXPECT_FALSE(pbs.isReportDue());
 }
@@ -0,0 +1,118 @@
+#define PROFILER_ENABLED
+
+#include "Profiler.h"
+
+#include <gtest/gtest.h>
+
+#include "BufferSerial.h"
+
+// Include source implementation
+#include "../../src/Profiler.cpp"
+
+using ::testing::Return;
+
+class Profiler_test : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    pArduinoMock = arduinoMockInstance();
+    Profiler::reset();
+    strBuf[0] = '\0';
+  }
+
+  void TearDown() override { releaseArduinoMock(); }
+
+  void bufSerReadStr() {
+    size_t i = 0;
+    while (Serial.available()) {
+      int c = Serial.read();
+      if (c < 0) {
+        break;
+      }
+      strBuf[i++] = static_cast<char>(c);
+    }
+    strBuf[i] = '\0';
+  }
+
+  // A scope that starts at start_us and ends at end_us.
+  void timeScope(ProfileSection section, uint32_t start_us, uint32_t end_us) {
+    EXPECT_CALL(*pArduinoMock, micros())
+        .WillOnce(Return(start_us))
+        .WillOnce(Return(end_us));
+    PROFILE_SCOPE(section);
+  }
+
+  ArduinoMock* pArduinoMock;
+  char strBuf[256];
+};
+
+TEST_F(Profiler_test, stats_shall_be_empty_after_reset) {
+  const ProfileStatsT& s = Profiler::getStats(ProfileSection::loop);
+
+  EXPECT_EQ(s.count, 0);
+  EXPECT_EQ(s.total_us, 0);
+  EXPECT_EQ(s.getMean_us(), 0);
+}
+
+TEST_F(Profiler_test, scope_shall_add_min_mean_max) {
+  timeScope(ProfileSection::loraRx, 100, 140);
+  timeScope(ProfileSection::loraRx, 200, 210);
+  timeScope(ProfileSection::loraRx, 300, 370);
+
+  const ProfileStatsT& s = Profiler::getStats(ProfileSection::loraRx);
+  EXPECT_EQ(s.count, 3);
+  EXPECT_EQ(s.min_us, 10);
+  EXPECT_EQ(s.max_us, 70);
+  EXPECT_EQ(s.getMean_us(), 40);
+  EXPECT_EQ(Profiler::getStats(ProfileSection::loop).count, 0);
+}
+
+TEST_F(Profiler_test, scope_shall_handle_micros_wrap) {
+  timeScope(ProfileSection::sendMsg, UINT32_MAX - 9, 20);
+
+  EXPECT_EQ(Profiler::getStats(ProfileSection::sendMsg).max_us, 30);
+}
+
+TEST_F(Profiler_test, overflow_shall_halve_sum_and_count) {
+  for (uint16_t i = 0; i < 5000; i++) {
+    Profiler::add(ProfileSection::loop, 1000000);
+  }
+
+  const ProfileStatsT& s = Profiler::getStats(ProfileSection::loop);
+  EXPECT_LT(s.count, 5000);
+  EXPECT_EQ(s.getMean_us(), 1000000);
+
+  for (uint32_t i = 0; i < UINT16_MAX; i++) {
+    Profiler::add(ProfileSection::decrypt, 4);
+  }
+  Profiler::add(ProfileSection::decrypt, 4);
+
+  EXPECT_EQ(Profiler::getStats(ProfileSection::decrypt).count, 32768);
+  EXPECT_EQ(Profiler::getStats(ProfileSection::decrypt).getMean_us(), 4);
+}
+
+TEST_F(Profiler_test, components_shall_have_own_sections) {
+  Profiler::add(Profiler::component(0), 5);
+  Profiler::add(Profiler::component(PROFILER_MAX_COMPONENTS - 1), 7);
+  Profiler::add(Profiler::component(PROFILER_MAX_COMPONENTS), 9);  // Ignored
+
+  EXPECT_EQ(Profiler::getStats(Profiler::component(0)).max_us, 5);
+  EXPECT_EQ(
+      Profiler::getStats(Profiler::component(PROFILER_MAX_COMPONENTS - 1))
+          .max_us,
+      7);
+}
+
+TEST_F(Profiler_test, printTo_shall_print_sections_that_have_run) {
+  Profiler::add(ProfileSection::loop, 100);
+  Profiler::add(ProfileSection::loop, 300);
+  Profiler::add(Profiler::component(3), 24);
+
+  size_t n = Profiler::printTo(Serial);
+
+  bufSerReadStr();
+  EXPECT_STREQ(strBuf,
+               "Profile, min/mean/max us (count)\r\n"
+               "  loop: 100/200/300 (2)\r\n"
+               "  component3: 24/24/24 (1)\r\n");
+  EXPECT_EQ(n, strlen(strBuf));
+}
@@ -0,0 +1,324 @@
+#include "ReportPolicy.h"
+
+#include <gtest/gtest.h>
+
+#include "Arduino.h"
+#include "BufferSerial.h"
+#include "Sensor.h"
+
+using ::testing::Return;
+
+static const DiscoveryEntityT reportEntities[] = {
+    ReportConfig::makeHysteresisEntity(20, "Temperature Hysteresis",
+                                       NumberDeviceClass::TEMPERATURE_DELTA,
+                                       Unit::Type::C, 1, 100),
+    ReportConfig::makeMinIntervalEntity(16, "Temperature Min Interval"),
+    ReportConfig::makeMaxIntervalEntity(28, "Temperature Max Interval"),
+    ReportConfig::makeBurstEntity(32, "Temperature Burst"),
+    ReportConfig::makeRefillTimeEntity(36, "Temperature Refill Time"),
+    ReportConfig::makeHysteresisPctEntity(24,
+                                          "Temperature Relative Hysteresis"),
+};
+
+static const DiscoveryEntityT sensorEntity = Sensor<int16_t>::makeEntity(
+    1, "Temperature", SensorDeviceClass::TEMPERATURE, Unit::Type::C, 1);
+
+class ReportPolicy_test : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    pArduinoMock = arduinoMockInstance();
+    EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(Return(0));
+  }
+
+  void TearDown() override { releaseArduinoMock(); }
+
+  void reportChange() {
+    EXPECT_TRUE(policy.isReportDue(110, 100, 1000, millis()));
+    policy.setReported(ReportReason::due, 1000);
+  }
+
+  // Without a rate limit, the bucket is tested separately.
+  ReportConfig config{0x00, reportEntities, {10, 0, 0, 300, 0, 60}};
+
+  ReportPolicy<int16_t> policy = ReportPolicy<int16_t>(config);
+
+  ArduinoMock* pArduinoMock;
+};
+
+TEST_F(ReportPolicy_test, config) {
+  EXPECT_EQ(config.getHysteresis(), 10);
+  EXPECT_EQ(config.getHysteresisPct(), 0);
+  EXPECT_EQ(config.getMinInterval(), 0);
+  EXPECT_EQ(config.getMaxInterval(), 300000);
+  EXPECT_EQ(config.getBurst(), 0);
+  EXPECT_EQ(config.getRefillTime(), 60000);
+}
+
+TEST_F(ReportPolicy_test, config_entities) {
+  EXPECT_EQ(config.hysteresis.getEntityId(), 20);
+  EXPECT_EQ(config.minInterval.getEntityId(), 16);
+  EXPECT_EQ(config.maxInterval.getEntityId(), 28);
+  EXPECT_EQ(config.burst.getEntityId(), 32);
+  EXPECT_EQ(config.refillTime.getEntityId(), 36);
+  EXPECT_EQ(config.hysteresisPct.getEntityId(), 24);
+}
+
+TEST_F(ReportPolicy_test, no_change_is_not_due) {
+  EXPECT_FALSE(policy.isReportDue(100, 100, 1000, 1000));
+}
+
+TEST_F(ReportPolicy_test, change_below_hysteresis_is_not_due) {
+  EXPECT_FALSE(policy.isReportDue(109, 100, 1000, 1000));
+  EXPECT_FALSE(policy.isReportDue(91, 100, 1000, 1000));
+}
+
+TEST_F(ReportPolicy_test, change_at_hysteresis_is_due) {
+  EXPECT_TRUE(policy.isReportDue(110, 100, 1000, 1000));
+  EXPECT_TRUE(policy.isReportDue(90, 100, 1000, 1000));
+  EXPECT_TRUE(policy.isReportDue(-5, 5, 1000, 1000));
+}
+
+TEST_F(ReportPolicy_test, any_change_is_due_with_zero_hysteresis) {
+  config.hysteresis.setValue(0);
+
+  EXPECT_FALSE(policy.isReportDue(100, 100, 1000, 1000));
+  EXPECT_TRUE(policy.isReportDue(101, 100, 1000, 1000));
+}
+
+TEST_F(ReportPolicy_test, relative_hysteresis_applies_when_larger) {
+  config.hysteresisPct.setValue(10);
+
+  // 10% of 200 is 20
+  EXPECT_FALSE(policy.isReportDue(219, 200, 1000, 1000));
+  EXPECT_TRUE(policy.isReportDue(220, 200, 1000, 1000));
+  EXPECT_TRUE(policy.isReportDue(-180, -200, 1000, 1000));
+
+  // 10% of 50 is 5, the absolute 10 applies
+  EXPECT_FALSE(policy.isReportDue(59, 50, 1000, 1000));
+  EXPECT_TRUE(policy.isReportDue(60, 50, 1000, 1000));
+}
+
+TEST_F(ReportPolicy_test, relative_hysteresis_alone) {
+  config.hysteresis.setValue(0);
+  config.hysteresisPct.setValue(5);
+
+  // 5% of 1000 is 50
+  EXPECT_FALSE(policy.isReportDue(1049, 1000, 1000, 1000));
+  EXPECT_TRUE(policy.isReportDue(1050, 1000, 1000, 1000));
+
+  // Any change from 0
+  EXPECT_FALSE(policy.isReportDue(0, 0, 1000, 1000));
+  EXPECT_TRUE(policy.isReportDue(1, 0, 1000, 1000));
+}
+
+TEST_F(ReportPolicy_test, changed_hysteresis_applies_at_once) {
+  config.hysteresis.setValue(20);
+
+  EXPECT_FALSE(policy.isReportDue(119, 100, 1000, 1000));
+  EXPECT_TRUE(policy.isReportDue(120, 100, 1000, 1000));
+}
+
+TEST_F(ReportPolicy_test, unsigned_value) {
+  ReportPolicy<uint8_t> unsignedPolicy =
+      ReportPolicy<uint8_t>(config);
+
+  EXPECT_FALSE(unsignedPolicy.isReportDue(91, 100, 1000, 1000));
+  EXPECT_TRUE(unsignedPolicy.isReportDue(90, 100, 1000, 1000));
+  EXPECT_TRUE(unsignedPolicy.isReportDue(255, 0, 1000, 1000));
+}
+
+TEST_F(ReportPolicy_test, max_interval_is_due_without_change) {
+  EXPECT_FALSE(policy.isReportDue(100, 100, 299999, 299999));
+  EXPECT_TRUE(policy.isReportDue(100, 100, 300000, 300000));
+}
+
+TEST_F(ReportPolicy_test, max_interval_zero_is_no_periodic_report) {
+  config.maxInterval.setValue(0);
+
+  EXPECT_FALSE(policy.isReportDue(100, 100, UINT32_MAX, UINT32_MAX));
+  EXPECT_TRUE(policy.isReportDue(110, 100, 1000, 1000));
+}
+
+TEST_F(ReportPolicy_test, min_interval_holds_back_all_reports) {
+  config.minInterval.setValue(30);
+
+  EXPECT_FALSE(policy.isReportDue(200, 100, 29999, 29999));
+  EXPECT_TRUE(policy.isReportDue(200, 100, 30000, 30000));
+
+  config.minInterval.setValue(600);  // Above the max interval
+  EXPECT_FALSE(policy.isReportDue(100, 100, 300000, 300000));
+  EXPECT_TRUE(policy.isReportDue(100, 100, 600000, 600000));
+}
+
+TEST_F(ReportPolicy_test, held_back_time_is_left_of_min_interval) {
+  config.minInterval.setValue(30);
+
+  EXPECT_FALSE(policy.isReportDue(105, 100, 10000, 10000));
+  EXPECT_EQ(policy.getHeldBackTime(), 0);  // No large change
+
+  EXPECT_FALSE(policy.isReportDue(110, 100, 10000, 10000));
+  EXPECT_EQ(policy.getHeldBackTime(), 20000);
+
+  EXPECT_TRUE(policy.isReportDue(110, 100, 30000, 30000));
+  EXPECT_EQ(policy.getHeldBackTime(), 0);
+}
+
+TEST_F(ReportPolicy_test, held_back_time_is_left_to_next_token) {
+  config.burst.setValue(1);
+  reportChange();
+
+  EXPECT_FALSE(policy.isReportDue(110, 100, 1000, 20000));
+  EXPECT_EQ(policy.getHeldBackTime(), 40000);
+}
+
+TEST_F(ReportPolicy_test, rate_limit_allows_burst_then_one_per_refill_time) {
+  config.burst.setValue(2);
+
+  EXPECT_TRUE(policy.isReportDue(110, 100, 1000, 1000));
+  EXPECT_EQ(policy.getTokens(), 2);
+  policy.setReported(ReportReason::due, 1000);
+  EXPECT_TRUE(policy.isReportDue(120, 110, 0, 0));
+  policy.setReported(ReportReason::due, 0);
+  EXPECT_EQ(policy.getTokens(), 0);
+
+  // Empty, one token per 60 s
+  EXPECT_FALSE(policy.isReportDue(130, 120, 59999, 59999));
+  EXPECT_TRUE(policy.isReportDue(130, 120, 60000, 60000));
+  EXPECT_EQ(policy.getTokens(), 1);
+
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(Return(60000));
+  policy.setReported(ReportReason::due, 60000);
+  EXPECT_EQ(policy.getTokens(), 0);
+  EXPECT_FALSE(policy.isReportDue(140, 130, 1000, 61000));
+
+  // Refilled to burst, not more
+  EXPECT_TRUE(policy.isReportDue(140, 130, 1000, 660000));
+  EXPECT_EQ(policy.getTokens(), 2);
+}
+
+TEST_F(ReportPolicy_test, rate_limit_keeps_part_of_next_token) {
+  config.burst.setValue(3);
+  reportChange();
+  reportChange();
+  reportChange();
+  EXPECT_EQ(policy.getTokens(), 0);
+
+  EXPECT_TRUE(policy.isReportDue(110, 100, 90000, 90000));
+  EXPECT_EQ(policy.getTokens(), 1);
+
+  // The 30 s past the first token count, the next one is at 120 s
+  EXPECT_TRUE(policy.isReportDue(110, 100, 119999, 119999));
+  EXPECT_EQ(policy.getTokens(), 1);
+  EXPECT_TRUE(policy.isReportDue(110, 100, 120000, 120000));
+  EXPECT_EQ(policy.getTokens(), 2);
+}
+
+TEST_F(ReportPolicy_test, rate_limit_does_not_hold_back_periodic_report) {
+  config.burst.setValue(1);
+  reportChange();
+  EXPECT_EQ(policy.getTokens(), 0);
+
+  EXPECT_FALSE(policy.isReportDue(110, 100, 1000, 1000));
+  EXPECT_TRUE(policy.isReportDue(110, 100, 300000, 30000));
+}
+
+TEST_F(ReportPolicy_test, periodic_report_takes_no_token) {
+  config.burst.setValue(1);
+
+  EXPECT_TRUE(policy.isReportDue(110, 100, 300000, 300000));
+  policy.setReported(ReportReason::due, 300000);
+
+  EXPECT_TRUE(policy.isReportDue(110, 100, 1000, 301000));
+  EXPECT_EQ(policy.getTokens(), 1);
+}
+
+TEST_F(ReportPolicy_test, report_on_request_takes_no_token) {
+  config.burst.setValue(1);
+
+  // Not due, reported anyway, e.g. on a value request
+  EXPECT_FALSE(policy.isReportDue(105, 100, 1000, 1000));
+  policy.setReported(ReportReason::request, 1000);
+  EXPECT_TRUE(policy.isReportDue(110, 100, 1000, 2000));
+  EXPECT_EQ(policy.getTokens(), 1);
+}
+
+TEST_F(ReportPolicy_test, request_while_change_is_due_takes_no_token) {
+  config.burst.setValue(1);
+
+  // Due on change, answered by a value request before it is reported
+  EXPECT_TRUE(policy.isReportDue(110, 100, 1000, 1000));
+  policy.setReported(ReportReason::request, 1000);
+
+  EXPECT_TRUE(policy.isReportDue(120, 110, 1000, 2000));
+  EXPECT_EQ(policy.getTokens(), 1);
+}
+
+TEST_F(ReportPolicy_test, change_report_takes_token) {
+  config.burst.setValue(2);
+
+  // Due on change, reported after a periodic check that was not due
+  EXPECT_FALSE(policy.isReportDue(100, 100, 1000, 1000));
+  EXPECT_TRUE(policy.isReportDue(110, 100, 2000, 2000));
+  policy.setReported(ReportReason::due, 2000);
+  EXPECT_EQ(policy.getTokens(), 1);
+
+  // A request in between does not make the next one free
+  policy.setReported(ReportReason::request, 1000);
+  EXPECT_TRUE(policy.isReportDue(120, 110, 1000, 3000));
+  policy.setReported(ReportReason::due, 1000);
+  EXPECT_EQ(policy.getTokens(), 0);
+  EXPECT_FALSE(policy.isReportDue(130, 120, 1000, 4000));
+}
+
+TEST_F(ReportPolicy_test, rate_limit_zero_refill_time_is_always_full) {
+  config.burst.setValue(1);
+  config.refillTime.setValue(0);
+  reportChange();
+
+  EXPECT_TRUE(policy.isReportDue(110, 100, 1000, 1000));
+  EXPECT_EQ(policy.getTokens(), 1);
+}
+
+TEST_F(ReportPolicy_test, rate_limit_lowered_burst_drops_tokens) {
+  config.burst.setValue(5);
+  reportChange();
+  EXPECT_EQ(policy.getTokens(), 4);
+
+  config.burst.setValue(2);
+  EXPECT_TRUE(policy.isReportDue(110, 100, 1000, 1000));
+  EXPECT_EQ(policy.getTokens(), 2);
+}
+
+TEST_F(ReportPolicy_test, sensor_updateIsReportDue) {
+  Sensor<int16_t> sensor = Sensor<int16_t>(sensorEntity);
+
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(Return(1000));
+  sensor.setReported();  // Reported 0 at 1 s
+
+  sensor.setValue(5);
+  EXPECT_FALSE(sensor.updateIsReportDue(policy));
+  EXPECT_FALSE(sensor.isReportDue());
+
+  sensor.setValue(10);
+  EXPECT_TRUE(sensor.updateIsReportDue(policy));
+  EXPECT_TRUE(sensor.isReportDue());
+
+  sensor.setReported();
+  EXPECT_FALSE(sensor.updateIsReportDue(policy));
+
+  EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(Return(301000));
+  EXPECT_TRUE(sensor.updateIsReportDue(policy));
+}
+
+TEST_F(ReportPolicy_test, config_is_per_sensor) {
+  ReportConfig otherConfig{0x20, reportEntities, {10, 0, 0, 300, 0, 60}};
+  ReportPolicy<int16_t> otherPolicy = ReportPolicy<int16_t>(otherConfig);
+
+  otherConfig.minInterval.setValue(30);
+  otherConfig.hysteresis.setValue(50);
+
+  EXPECT_TRUE(policy.isReportDue(110, 100, 1000, 1000));
+  EXPECT_FALSE(otherPolicy.isReportDue(110, 100, 1000, 1000));
+  EXPECT_FALSE(otherPolicy.isReportDue(150, 100, 1000, 1000));
+  EXPECT_TRUE(otherPolicy.isReportDue(150, 100, 30000, 30000));
+}
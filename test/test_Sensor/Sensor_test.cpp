@@ -9,6 +9,37 @@
 
 using ::testing::Return;
 
+static const char sensor8Name[] = "Sensor8";
+static const char sensor16Name[] = "Sensor16";
+static const char sensor32Name[] = "Sensor32";
+
+// Metadata of the sensors, in flash on target.
+static const DiscoveryEntityT int8Entity =
+    Sensor<int8_t>::makeEntity(108, sensor8Name);
+static const DiscoveryEntityT uint16Entity =
+    Sensor<uint16_t>::makeEntity(116, sensor16Name);
+static const DiscoveryEntityT int32Entity =
+    Sensor<int32_t>::makeEntity(132, sensor32Name);
+static const DiscoveryEntityT int8BatteryEntity = Sensor<int8_t>::makeEntity(
+    108, sensor8Name, SensorDeviceClass::BATTERY, Unit::Type::percent);
+static const DiscoveryEntityT uint16BatteryEntity =
+    Sensor<uint16_t>::makeEntity(116, sensor16Name, SensorDeviceClass::BATTERY,
+                                 Unit::Type::percent);
+static const DiscoveryEntityT int32BatteryEntity = Sensor<int32_t>::makeEntity(
+    132, sensor32Name, SensorDeviceClass::BATTERY, Unit::Type::percent);
+
+template <uint8_t precision>
+static constexpr DiscoveryEntityT int32PrecisionEntity() {
+  return Sensor<int32_t>::makeEntity(132, sensor32Name,
+                                     SensorDeviceClass::BATTERY,
+                                     Unit::Type::none, precision);
+}
+
+static const DiscoveryEntityT int32Precision0Entity = int32PrecisionEntity<0>();
+static const DiscoveryEntityT int32Precision1Entity = int32PrecisionEntity<1>();
+static const DiscoveryEntityT int32Precision2Entity = int32PrecisionEntity<2>();
+static const DiscoveryEntityT int32Precision3Entity = int32PrecisionEntity<3>();
+
 class SensorPrint_test : public ::testing::Test {
  protected:
   void SetUp() override { strBuf[0] = '\0'; }
@@ -32,35 +63,32 @@ class SensorPrint_test : public ::testing::Test {
 
 class SensorInt8_test : public ::testing::Test {
  protected:
-  Sensor<int8_t> sc = Sensor<int8_t>(108, "Sensor8");
+  Sensor<int8_t> sc = Sensor<int8_t>(int8Entity);
 };
 
 class SensorUInt16_test : public ::testing::Test {
  protected:
-  Sensor<uint16_t> sc = Sensor<uint16_t>(116, "Sensor16");
+  Sensor<uint16_t> sc = Sensor<uint16_t>(uint16Entity);
 };
 
 class SensorInt32_test : public ::testing::Test {
  protected:
-  Sensor<int32_t> sc = Sensor<int32_t>(132, "Sensor32");
+  Sensor<int32_t> sc = Sensor<int32_t>(int32Entity);
 };
 
 class SensorInt8BatteryPercent_test : public ::testing::Test {
  protected:
-  Sensor<int8_t> sc = Sensor<int8_t>(108, "Sensor8", SensorDeviceClass::battery,
-                                     Unit::Type::percent);
+  Sensor<int8_t> sc = Sensor<int8_t>(int8BatteryEntity);
 };
 
 class SensorUInt16BatteryPercent_test : public ::testing::Test {
  protected:
-  Sensor<uint16_t> sc = Sensor<uint16_t>(
-      116, "Sensor16", SensorDeviceClass::battery, Unit::Type::percent);
+  Sensor<uint16_t> sc = Sensor<uint16_t>(uint16BatteryEntity);
 };
 
 class SensorInt32BatteryPercent_test : public ::testing::Test {
  protected:
-  Sensor<int32_t> sc = Sensor<int32_t>(
-      132, "Sensor32", SensorDeviceClass::battery, Unit::Type::percent);
+  Sensor<int32_t> sc = Sensor<int32_t>(int32BatteryEntity);
 };
 
 TEST_F(SensorInt8_test, getValue) {
@@ -82,27 +110,27 @@ TEST_F(SensorInt32_test, getValue) {
 }
 
 TEST_F(SensorInt8_test, getComponentType) {
-  EXPECT_EQ(sc.getComponentType(), BaseComponent::Type::sensor);
+  EXPECT_EQ(sc.getComponentType(), BaseComponent::Type::SENSOR);
 }
 
 TEST_F(SensorUInt16_test, getComponentType) {
-  EXPECT_EQ(sc.getComponentType(), BaseComponent::Type::sensor);
+  EXPECT_EQ(sc.getComponentType(), BaseComponent::Type::SENSOR);
 }
 
 TEST_F(SensorInt32_test, getComponentType) {
-  EXPECT_EQ(sc.getComponentType(), BaseComponent::Type::sensor);
+  EXPECT_EQ(sc.getComponentType(), BaseComponent::Type::SENSOR);
 }
 
 TEST_F(SensorInt8_test, getDeviceClass) {
-  EXPECT_EQ(sc.getDeviceClass(), SensorDeviceClass::none);
+  EXPECT_EQ(sc.getDeviceClass(), SensorDeviceClass::NONE);
 }
 
 TEST_F(SensorUInt16_test, getDeviceClass) {
-  EXPECT_EQ(sc.getDeviceClass(), SensorDeviceClass::none);
+  EXPECT_EQ(sc.getDeviceClass(), SensorDeviceClass::NONE);
 }
 
 TEST_F(SensorInt32_test, getDeviceClass) {
-  EXPECT_EQ(sc.getDeviceClass(), SensorDeviceClass::none);
+  EXPECT_EQ(sc.getDeviceClass(), SensorDeviceClass::NONE);
 }
 
 TEST_F(SensorInt8_test, getUnitType_default) {
@@ -136,8 +164,8 @@ TEST_F(SensorInt8_test, getDiscoveryEntity) {
 
   EXPECT_EQ(item.entityId, 108);
   EXPECT_EQ(item.componentType,
-            static_cast<uint8_t>(BaseComponent::Type::sensor));
-  EXPECT_EQ(item.deviceClass, static_cast<uint8_t>(SensorDeviceClass::none));
+            static_cast<uint8_t>(BaseComponent::Type::SENSOR));
+  EXPECT_EQ(item.deviceClass, static_cast<uint8_t>(SensorDeviceClass::NONE));
   EXPECT_EQ(item.unit, static_cast<uint8_t>(Unit::Type::none));
   EXPECT_TRUE(item.isSigned);
   EXPECT_EQ(item.sizeCode, 0);
@@ -151,8 +179,8 @@ TEST_F(SensorUInt16_test, getDiscoveryEntity) {
 
   EXPECT_EQ(item.entityId, 116);
   EXPECT_EQ(item.componentType,
-            static_cast<uint8_t>(BaseComponent::Type::sensor));
-  EXPECT_EQ(item.deviceClass, static_cast<uint8_t>(SensorDeviceClass::none));
+            static_cast<uint8_t>(BaseComponent::Type::SENSOR));
+  EXPECT_EQ(item.deviceClass, static_cast<uint8_t>(SensorDeviceClass::NONE));
   EXPECT_EQ(item.unit, static_cast<uint8_t>(Unit::Type::none));
   EXPECT_FALSE(item.isSigned);
   EXPECT_EQ(item.sizeCode, 1);
@@ -166,8 +194,8 @@ TEST_F(SensorInt32_test, getDiscoveryEntity) {
 
   EXPECT_EQ(item.entityId, 132);
   EXPECT_EQ(item.componentType,
-            static_cast<uint8_t>(BaseComponent::Type::sensor));
-  EXPECT_EQ(item.deviceClass, static_cast<uint8_t>(SensorDeviceClass::none));
+            static_cast<uint8_t>(BaseComponent::Type::SENSOR));
+  EXPECT_EQ(item.deviceClass, static_cast<uint8_t>(SensorDeviceClass::NONE));
   EXPECT_EQ(item.unit, static_cast<uint8_t>(Unit::Type::none));
   EXPECT_TRUE(item.isSigned);
   EXPECT_EQ(item.sizeCode, 2);
@@ -175,16 +203,15 @@ TEST_F(SensorInt32_test, getDiscoveryEntity) {
 }
 
 TEST_F(SensorInt32_test, getDiscoveryEntity_precision0) {
-  Sensor<int32_t> sc2 = Sensor<int32_t>(
-      132, "Sensor32", SensorDeviceClass::battery, Unit::Type::none, 0);
+  Sensor<int32_t> sc2 = Sensor<int32_t>(int32Precision0Entity);
   DiscoveryEntityT item;
 
   sc2.getDiscoveryEntity(item);
 
   EXPECT_EQ(item.entityId, 132);
   EXPECT_EQ(item.componentType,
-            static_cast<uint8_t>(BaseComponent::Type::sensor));
-  EXPECT_EQ(item.deviceClass, static_cast<uint8_t>(SensorDeviceClass::battery));
+            static_cast<uint8_t>(BaseComponent::Type::SENSOR));
+  EXPECT_EQ(item.deviceClass, static_cast<uint8_t>(SensorDeviceClass::BATTERY));
   EXPECT_EQ(item.unit, static_cast<uint8_t>(Unit::Type::none));
   EXPECT_TRUE(item.isSigned);
   EXPECT_EQ(item.sizeCode, 2);
@@ -192,16 +219,15 @@ TEST_F(SensorInt32_test, getDiscoveryEntity_precision0) {
 }
 
 TEST_F(SensorInt32_test, getDiscoveryEntity_precision1) {
-  Sensor<int32_t> sc2 = Sensor<int32_t>(
-      132, "Sensor32", SensorDeviceClass::battery, Unit::Type::none, 1);
+  Sensor<int32_t> sc2 = Sensor<int32_t>(int32Precision1Entity);
   DiscoveryEntityT item;
 
   sc2.getDiscoveryEntity(item);
 
   EXPECT_EQ(item.entityId, 132);
   EXPECT_EQ(item.componentType,
-            static_cast<uint8_t>(BaseComponent::Type::sensor));
-  EXPECT_EQ(item.deviceClass, static_cast<uint8_t>(SensorDeviceClass::battery));
+            static_cast<uint8_t>(BaseComponent::Type::SENSOR));
+  EXPECT_EQ(item.deviceClass, static_cast<uint8_t>(SensorDeviceClass::BATTERY));
   EXPECT_EQ(item.unit, static_cast<uint8_t>(Unit::Type::none));
   EXPECT_TRUE(item.isSigned);
   EXPECT_EQ(item.sizeCode, 2);
@@ -209,16 +235,15 @@ TEST_F(SensorInt32_test, getDiscoveryEntity_precision1) {
 }
 
 TEST_F(SensorInt32_test, getDiscoveryEntity_precision2) {
-  Sensor<int32_t> sc2 = Sensor<int32_t>(
-      132, "Sensor32", SensorDeviceClass::battery, Unit::Type::none, 2);
+  Sensor<int32_t> sc2 = Sensor<int32_t>(int32Precision2Entity);
   DiscoveryEntityT item;
 
   sc2.getDiscoveryEntity(item);
 
   EXPECT_EQ(item.entityId, 132);
   EXPECT_EQ(item.componentType,
-            static_cast<uint8_t>(BaseComponent::Type::sensor));
-  EXPECT_EQ(item.deviceClass, static_cast<uint8_t>(SensorDeviceClass::battery));
+            static_cast<uint8_t>(BaseComponent::Type::SENSOR));
+  EXPECT_EQ(item.deviceClass, static_cast<uint8_t>(SensorDeviceClass::BATTERY));
   EXPECT_EQ(item.unit, static_cast<uint8_t>(Unit::Type::none));
   EXPECT_TRUE(item.isSigned);
   EXPECT_EQ(item.sizeCode, 2);
@@ -226,16 +251,15 @@ TEST_F(SensorInt32_test, getDiscoveryEntity_precision2) {
 }
 
 TEST_F(SensorInt32_test, getDiscoveryEntity_precision3) {
-  Sensor<int32_t> sc2 = Sensor<int32_t>(
-      132, "Sensor32", SensorDeviceClass::battery, Unit::Type::none, 3);
+  Sensor<int32_t> sc2 = Sensor<int32_t>(int32Precision3Entity);
   DiscoveryEntityT item;
 
   sc2.getDiscoveryEntity(item);
 
   EXPECT_EQ(item.entityId, 132);
   EXPECT_EQ(item.componentType,
-            static_cast<uint8_t>(BaseComponent::Type::sensor));
-  EXPECT_EQ(item.deviceClass, static_cast<uint8_t>(SensorDeviceClass::battery));
+            static_cast<uint8_t>(BaseComponent::Type::SENSOR));
+  EXPECT_EQ(item.deviceClass, static_cast<uint8_t>(SensorDeviceClass::BATTERY));
   EXPECT_EQ(item.unit, static_cast<uint8_t>(Unit::Type::none));
   EXPECT_TRUE(item.isSigned);
   EXPECT_EQ(item.sizeCode, 2);
@@ -245,14 +269,14 @@ TEST_F(SensorInt32_test, getDiscoveryEntity_precision3) {
 TEST_F(SensorInt8_test, getValueItem) {
   ValueItemT item;
 
-  sc.getValueItem(&item);
+  sc.getValueItem(item);
 
   EXPECT_EQ(item.entityId, 108);
   EXPECT_EQ(item.value, 0);
 
   sc.setValue(-15);
 
-  sc.getValueItem(&item);
+  sc.getValueItem(item);
 
   EXPECT_EQ(item.entityId, 108);
   EXPECT_EQ(item.value, uint32_t(-15));
@@ -262,7 +286,7 @@ TEST_F(SensorUInt16_test, getValueItem) {
   sc.setValue(1555);
   ValueItemT item;
 
-  sc.getValueItem(&item);
+  sc.getValueItem(item);
 
   EXPECT_EQ(item.entityId, 116);
   EXPECT_EQ(item.value, 1555);
@@ -272,7 +296,7 @@ TEST_F(SensorInt32_test, getValueItem) {
   sc.setValue(-150000000l);
   ValueItemT item;
 
-  sc.getValueItem(&item);
+  sc.getValueItem(item);
 
   EXPECT_EQ(item.entityId, 132);
   EXPECT_EQ(item.value, uint32_t(-150000000l));
@@ -297,7 +321,8 @@ TEST_F(SensorInt8_test, setReported) {
 
 TEST_F(SensorPrint_test, print_simple_constructed_sensor) {
   const char* expectStr = "=0";
-  Sensor<int8_t> sc = Sensor<int8_t>(108);
+  const DiscoveryEntityT entity = Sensor<int8_t>::makeEntity(108, nullptr);
+  Sensor<int8_t> sc = Sensor<int8_t>(entity);
 
   size_t len = sc.printTo(Serial);
 
@@ -308,7 +333,7 @@ TEST_F(SensorPrint_test, print_simple_constructed_sensor) {
 
 TEST_F(SensorPrint_test, print_negative_value_scale_factor_1_unit_none) {
   const char* expectStr = "Sensor8=-123";
-  Sensor<int8_t> sc = Sensor<int8_t>(108, "Sensor8");
+  Sensor<int8_t> sc = Sensor<int8_t>(int8Entity);
   sc.setValue(-123);
 
   size_t len = sc.printTo(Serial);
@@ -320,8 +345,9 @@ TEST_F(SensorPrint_test, print_negative_value_scale_factor_1_unit_none) {
 
 TEST_F(SensorPrint_test, print_positive_value_scale_factor_1000_unit_percent) {
   const char* expectStr = "Sensor8=0.001%";
-  Sensor<int8_t> sc = Sensor<int8_t>(
-      108, "Sensor8", SensorDeviceClass::humidity, Unit::Type::percent, 3);
+  const DiscoveryEntityT entity = Sensor<int8_t>::makeEntity(
+      108, sensor8Name, SensorDeviceClass::HUMIDITY, Unit::Type::percent, 3);
+  Sensor<int8_t> sc = Sensor<int8_t>(entity);
   sc.setValue(1);
 
   size_t len = sc.printTo(Serial);
@@ -333,8 +359,9 @@ TEST_F(SensorPrint_test, print_positive_value_scale_factor_1000_unit_percent) {
 
 TEST_F(SensorPrint_test, print_negative_value_scale_factor_10_unit_mm) {
   const char* expectStr = "Sensor16=1234.5mm";
-  Sensor<uint16_t> sc = Sensor<uint16_t>(
-      116, "Sensor16", SensorDeviceClass::distance, Unit::Type::mm, 1);
+  const DiscoveryEntityT entity = Sensor<uint16_t>::makeEntity(
+      116, sensor16Name, SensorDeviceClass::DISTANCE, Unit::Type::mm, 1);
+  Sensor<uint16_t> sc = Sensor<uint16_t>(entity);
   sc.setValue(12345);
 
   size_t len = sc.printTo(Serial);
@@ -346,8 +373,9 @@ TEST_F(SensorPrint_test, print_negative_value_scale_factor_10_unit_mm) {
 
 TEST_F(SensorPrint_test, print_negative_value_scale_factor_1000_unit_um) {
   const char* expectStr = "Sensor32=-2147483.648μm";
-  Sensor<int32_t> sc = Sensor<int32_t>(
-      116, "Sensor32", SensorDeviceClass::distance, Unit::Type::um, 3);
+  const DiscoveryEntityT entity = Sensor<int32_t>::makeEntity(
+      116, sensor32Name, SensorDeviceClass::DISTANCE, Unit::Type::um, 3);
+  Sensor<int32_t> sc = Sensor<int32_t>(entity);
   sc.setValue(INT32_MIN);
 
   size_t len = sc.printTo(Serial);
@@ -376,3 +404,29 @@ TEST_F(SensorInt8_test, isReportDue) {
 
   releaseArduinoMock();
 }
+
+TEST_F(SensorInt8_test, getDiscoveryEntity_min_max) {
+  DiscoveryEntityT item;
+
+  sc.getDiscoveryEntity(item);
+
+  EXPECT_EQ(static_cast<int32_t>(item.minValue), INT8_MIN);
+  EXPECT_EQ(static_cast<int32_t>(item.maxValue), INT8_MAX);
+  EXPECT_STREQ(item.name, sensor8Name);
+}
+
+TEST(SensorInt16_test, setValue_shall_clamp_to_min_and_max) {
+  const DiscoveryEntityT entity = Sensor<int16_t>::makeEntity(
+      116, sensor16Name, SensorDeviceClass::TEMPERATURE, Unit::Type::C, 1,
+      -400, 850);
+  Sensor<int16_t> sc = Sensor<int16_t>(entity);
+
+  sc.setValue(-401);
+  EXPECT_EQ(sc.getValue(), -400);
+
+  sc.setValue(851);
+  EXPECT_EQ(sc.getValue(), 850);
+
+  sc.setValue(850);
+  EXPECT_EQ(sc.getValue(), 850);
+}
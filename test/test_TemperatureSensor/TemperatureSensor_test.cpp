@@ -2,33 +2,58 @@
 
 #include <gtest/gtest.h>
 
-#include "Unit.h"
+#include "Adafruit_I2CDevice.h"
 #include "BufferSerial.h"
-#include "DHT.h"
 #include "EEPROM.h"
+#include "Unit.h"
 
 // Include source implementation
-#include "../../src/Util.cpp"
+#include "../../src/AHT20.cpp"
+#include "../../src/AHTReader.cpp"
 #include "../../src/TemperatureSensor.cpp"
 
+using ::testing::_;
+using ::testing::DoAll;
 using ::testing::Return;
+using ::testing::ReturnPointee;
+using ::testing::SetArgPointee;
+using ::testing::SetArrayArgument;
 
 using TemperatureT = int16_t;  // Degree C
 
+static const char temperatureSensorName[] = "TemperatureSensor";
+
+// Metadata of the sensor and its report config, in flash on target.
+static const DiscoveryEntityT entity =
+    TemperatureSensor::makeEntity(1, temperatureSensorName);
+
+static const DiscoveryEntityT reportEntities[] = {
+    ReportConfig::makeHysteresisEntity(20, "Temperature Hysteresis",
+                                       NumberDeviceClass::TEMPERATURE_DELTA,
+                                       Unit::Type::C, 1, 100),
+    ReportConfig::makeMinIntervalEntity(16, "Temperature Min Interval"),
+    ReportConfig::makeMaxIntervalEntity(28, "Temperature Max Interval"),
+    ReportConfig::makeBurstEntity(32, "Temperature Burst"),
+    ReportConfig::makeRefillTimeEntity(36, "Temperature Refill Time"),
+    ReportConfig::makeHysteresisPctEntity(24,
+                                          "Temperature Relative Hysteresis"),
+};
+
 class TemperatureSensor_test : public ::testing::Test {
  protected:
   void SetUp() override {
     strBuf[0] = '\0';
     pArduinoMock = arduinoMockInstance();
-    pDhtMock = new DHTMock();
+    EXPECT_CALL(*pArduinoMock, millis()).WillRepeatedly(ReturnPointee(&now));
+    pI2cMock = i2cDeviceMockInstance();
     eeprom_clear();
 
-    pTs = new TemperatureSensor(15, "TemperatureSensor", *pDhtMock);
+    pTs = new TemperatureSensor(entity, ahtReader, config);
   }
 
   void TearDown() override {
     delete pTs;
-    delete pDhtMock;
+    releaseI2CDeviceMock();
     releaseArduinoMock();
   }
 
@@ -44,9 +69,34 @@ class TemperatureSensor_test : public ::testing::Test {
     strBuf[i] = '\0';
   }
 
+  // The AHT20 shall answer a measurement with the temperature in degree C.
+  void expectMeasurement(float temperature) {
+    const uint32_t t = (temperature + 50) * 0x100000 / 200;
+    measurement[0] = 0;  // Status, not busy
+    measurement[1] = 0;
+    measurement[2] = 0;
+    measurement[3] = (t >> 16) & 0x0F;
+    measurement[4] = t >> 8;
+    measurement[5] = t;
+
+    EXPECT_CALL(*pI2cMock, write(_, 3, _, _, _)).WillOnce(Return(true));
+    EXPECT_CALL(*pI2cMock, read(_, 1, _))
+        .WillOnce(DoAll(SetArgPointee<0>(0), Return(true)));
+    EXPECT_CALL(*pI2cMock, read(_, 6, _))
+        .WillOnce(DoAll(SetArrayArgument<0>(measurement, measurement + 6),
+                        Return(true)));
+  }
+
+  // Without a rate limit: hysteresis 5.0 degree C and max interval 300 s.
+  ReportConfig config{0x00, reportEntities, {50, 0, 0, 300, 0, 60}};
+
+  uint32_t now{};
+  uint8_t measurement[6]{};
   char strBuf[256];
   ArduinoMock *pArduinoMock;
-  DHTMock *pDhtMock;
+  Adafruit_I2CDeviceMock *pI2cMock;
+  AHT20 aht;
+  AHTReader ahtReader = AHTReader(aht);
   TemperatureSensor *pTs;
 };
 
@@ -54,89 +104,46 @@ TEST_F(TemperatureSensor_test, callService_shall_do_nothing) {
   pTs->callService(0);
 }
 
-TEST_F(TemperatureSensor_test, getConfigItemValues) {
-  ConfigItemValueT items[4];
-
-  EXPECT_EQ(pTs->getConfigItemValues(items, sizeof(items) / sizeof(items[0])),
-            4);
-
-  EXPECT_EQ(items[0].configId, 0);
-  EXPECT_EQ(items[0].value,
-            TemperatureSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT);
+TEST_F(TemperatureSensor_test, getDiscoveryEntity) {
+  DiscoveryEntityT item;
 
-  EXPECT_EQ(items[1].configId, 1);
-  EXPECT_EQ(items[1].value,
-            TemperatureSensorConstants::CONFIG_MEASURE_INTERVAL_DEFAULT);
+  EXPECT_TRUE(pTs->getDiscoveryEntity(item));
 
-  EXPECT_EQ(items[2].configId, 2);
-  EXPECT_EQ(items[2].value,
-            TemperatureSensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT);
-
-  EXPECT_EQ(items[3].configId, 3);
-  EXPECT_EQ(items[3].value,
-            TemperatureSensorConstants::CONFIG_COMPENSATION_DEFAULT);
-}
-
-TEST_F(TemperatureSensor_test, getDiscoveryItem) {
-  DiscoveryItemT item;
-
-  pTs->getDiscoveryItem(&item);
-
-  EXPECT_EQ(item.entity.entityId, 15);
-  EXPECT_EQ(item.entity.componentType,
-            static_cast<uint8_t>(BaseComponent::Type::sensor));
-  EXPECT_EQ(item.entity.deviceClass,
-            static_cast<uint8_t>(SensorDeviceClass::temperature));
-  EXPECT_EQ(item.entity.unit, static_cast<uint8_t>(Unit::Type::C));
-  EXPECT_TRUE(item.entity.isSigned);
-  EXPECT_EQ(item.entity.sizeCode, sizeof(TemperatureT) / 2);
-  EXPECT_EQ(item.entity.precision, 1);
-
-  EXPECT_EQ(item.numberOfConfigItems, 4);
-
-  EXPECT_EQ(item.configItems[0].configId, 0);
-  EXPECT_EQ(item.configItems[0].unit, static_cast<uint8_t>(Unit::Type::C));
-  EXPECT_TRUE(item.configItems[0].isSigned);
-  EXPECT_EQ(item.configItems[0].sizeCode, sizeof(TemperatureT) / 2);
-  EXPECT_EQ(item.configItems[0].precision, 1);
-
-  EXPECT_EQ(item.configItems[1].configId, 1);
-  EXPECT_EQ(item.configItems[1].unit, static_cast<uint8_t>(Unit::Type::s));
-  EXPECT_FALSE(item.configItems[1].isSigned);
-  EXPECT_EQ(item.configItems[1].sizeCode, sizeof(uint16_t) / 2);
-  EXPECT_EQ(item.configItems[1].precision, 0);
-
-  EXPECT_EQ(item.configItems[2].configId, 2);
-  EXPECT_EQ(item.configItems[2].unit, static_cast<uint8_t>(Unit::Type::s));
-  EXPECT_FALSE(item.configItems[2].isSigned);
-  EXPECT_EQ(item.configItems[2].sizeCode, sizeof(uint16_t) / 2);
-  EXPECT_EQ(item.configItems[2].precision, 0);
-
-  EXPECT_EQ(item.configItems[3].configId, 3);
-  EXPECT_EQ(item.configItems[3].unit, static_cast<uint8_t>(Unit::Type::C));
-  EXPECT_TRUE(item.configItems[3].isSigned);
-  EXPECT_EQ(item.configItems[3].sizeCode, sizeof(TemperatureT) / 2);
-  EXPECT_EQ(item.configItems[3].precision, 1);
+  EXPECT_EQ(item.entityId, 1);
+  EXPECT_EQ(item.componentType,
+            static_cast<uint8_t>(BaseComponent::Type::SENSOR));
+  EXPECT_EQ(item.deviceClass,
+            static_cast<uint8_t>(SensorDeviceClass::TEMPERATURE));
+  EXPECT_EQ(item.unit, static_cast<uint8_t>(Unit::Type::C));
+  EXPECT_TRUE(item.isSigned);
+  EXPECT_EQ(item.sizeCode, sizeof(TemperatureT) / 2);
+  EXPECT_EQ(item.precision, 1);
+  EXPECT_EQ(static_cast<int32_t>(item.minValue), INT16_MIN);
+  EXPECT_EQ(static_cast<int32_t>(item.maxValue), INT16_MAX);
+  EXPECT_STREQ(item.name, temperatureSensorName);
 }
 
 TEST_F(TemperatureSensor_test, getEntityId) {
-  EXPECT_EQ(pTs->getEntityId(), 15);
+  EXPECT_EQ(pTs->getEntityId(), 1);
 }
 
 TEST_F(TemperatureSensor_test, getValueItem) {
   ValueItemT item;
 
-  pTs->getValueItem(&item);
+  pTs->getValueItem(item);
 
-  EXPECT_EQ(item.entityId, 15);
+  EXPECT_EQ(item.entityId, 1);
   EXPECT_EQ(item.value, 0);
 }
 
+TEST_F(TemperatureSensor_test, setValueItem_shall_not_set_value) {
+  EXPECT_FALSE(pTs->setValueItem({1, 123}));
+}
+
 TEST_F(TemperatureSensor_test, print) {
   const char *expectStr = "TemperatureSensor=0.0°C";
-  TemperatureSensor ts = TemperatureSensor(15, "TemperatureSensor", *pDhtMock);
 
-  size_t len = ts.printTo(Serial);
+  size_t len = pTs->printTo(Serial);
   bufSerReadStr();
 
   EXPECT_STREQ(strBuf, expectStr);
@@ -144,208 +151,74 @@ TEST_F(TemperatureSensor_test, print) {
 }
 
 TEST_F(TemperatureSensor_test, print_service_shall_do_nothing) {
-  TemperatureSensor ts = TemperatureSensor(15, "TemperatureSensor", *pDhtMock);
-  EXPECT_EQ(ts.printTo(Serial, 0), 0);
+  EXPECT_EQ(pTs->printTo(Serial, 0), 0);
 }
 
-TEST_F(TemperatureSensor_test, setConfigs_all_in_order) {
-  ConfigItemValueT inItems[4] = {{0, 10}, {1, 11}, {2, 12}, {3, 13}};
-  EXPECT_TRUE(pTs->setConfigItemValues(inItems, 4));
-
-  ConfigItemValueT items[4];
-  EXPECT_EQ(pTs->getConfigItemValues(items, sizeof(items) / sizeof(items[0])),
-            4);
-  EXPECT_EQ(items[0].value, 10);
-  EXPECT_EQ(items[1].value, 11);
-  EXPECT_EQ(items[2].value, 12);
-  EXPECT_EQ(items[3].value, 13);
-}
+TEST_F(TemperatureSensor_test, update_shall_set_value_in_tenths_of_degree) {
+  expectMeasurement(21.5f);
 
-TEST_F(TemperatureSensor_test, setConfigs_all_out_of_order) {
-  ConfigItemValueT inItems[4] = {{3, 23}, {2, 22}, {1, 21}, {0, 20}};
-  EXPECT_TRUE(pTs->setConfigItemValues(inItems, 4));
-
-  ConfigItemValueT items[4];
-  EXPECT_EQ(pTs->getConfigItemValues(items, sizeof(items) / sizeof(items[0])),
-            4);
-  EXPECT_EQ(items[0].value, 20);
-  EXPECT_EQ(items[1].value, 21);
-  EXPECT_EQ(items[2].value, 22);
-  EXPECT_EQ(items[3].value, 23);
-}
+  pTs->update();
 
-TEST_F(TemperatureSensor_test, setConfigs_one) {
-  ConfigItemValueT inItems[1] = {{3, 33}};
-  EXPECT_TRUE(pTs->setConfigItemValues(inItems, 1));
-
-  ConfigItemValueT items[4];
-  EXPECT_EQ(pTs->getConfigItemValues(items, sizeof(items) / sizeof(items[0])),
-            4);
-  EXPECT_EQ(items[0].value,
-            TemperatureSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT);
-  EXPECT_EQ(items[1].value,
-            TemperatureSensorConstants::CONFIG_MEASURE_INTERVAL_DEFAULT);
-  EXPECT_EQ(items[2].value,
-            TemperatureSensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT);
-  EXPECT_EQ(items[3].value, 33);
+  ValueItemT item;
+  pTs->getValueItem(item);
+  EXPECT_EQ(static_cast<TemperatureT>(item.value), 215);
 }
 
-TEST_F(TemperatureSensor_test, setConfigs_too_many) {
-  ConfigItemValueT inItems[5] = {{0, 10}, {1, 11}, {2, 12}, {3, 13}, {4, 14}};
-  EXPECT_FALSE(pTs->setConfigItemValues(inItems, 5));
-}
+TEST_F(TemperatureSensor_test, update_negative_temperature) {
+  expectMeasurement(-12.3f);
 
-TEST_F(TemperatureSensor_test, setConfigs_out_of_range) {
-  ConfigItemValueT inItems[1] = {{4, 3004}};
-  EXPECT_FALSE(pTs->setConfigItemValues(inItems, 1));
-}
+  pTs->update();
 
-TEST_F(TemperatureSensor_test,
-       update_largeValueDiff_largeTimeDiff_withConfigsZero_shall_return_false) {
-  EXPECT_CALL(*pDhtMock, read(false)).WillOnce(Return(true));
-  EXPECT_CALL(*pDhtMock, readTemperature(false, false)).WillOnce(Return(0.950));
-  EXPECT_CALL(*pArduinoMock, millis()).Times(0);
-  ConfigItemValueT inItems[4] = {{0, 0}, {1, 0}, {2, 0}, {3, 0}};
-  EXPECT_TRUE(pTs->setConfigItemValues(inItems, 4));
-  EXPECT_FALSE(pTs->update());
+  ValueItemT item;
+  pTs->getValueItem(item);
+  EXPECT_EQ(static_cast<TemperatureT>(item.value), -123);
 }
 
-TEST_F(TemperatureSensor_test, setReported) {
-  EXPECT_CALL(*pArduinoMock, millis()).Times(1);
-  pTs->setReported();
+TEST_F(TemperatureSensor_test, update_read_failed_shall_keep_value) {
+  expectMeasurement(21.5f);
+  pTs->update();
+
+  now = 2000;
+  EXPECT_CALL(*pI2cMock, write(_, 3, _, _, _)).WillOnce(Return(false));
+  pTs->update();
+
+  ValueItemT item;
+  pTs->getValueItem(item);
+  EXPECT_EQ(static_cast<TemperatureT>(item.value), 215);
 }
 
 TEST_F(TemperatureSensor_test,
        update_smallValueDiff_smallTimeDiff_shall_return_false) {
-  EXPECT_CALL(*pDhtMock, read(false)).WillOnce(Return(true));
-  EXPECT_CALL(*pDhtMock, readTemperature(false, false))
-      .WillOnce(Return(
-          (TemperatureSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT - 1) /
-          10.0f));
-  EXPECT_CALL(*pArduinoMock, millis())
-      .WillOnce(Return(
-          TemperatureSensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT * 1000 -
-          1));
+  pTs->setReported(ReportReason::due);
+  now = 300000 - 1;
+  expectMeasurement(0.45f);
+
   EXPECT_FALSE(pTs->update());
 }
 
 TEST_F(TemperatureSensor_test,
        update_smallValueDiff_largeTimeDiff_shall_return_true) {
-  EXPECT_CALL(*pDhtMock, read(false)).WillOnce(Return(true));
-  EXPECT_CALL(*pDhtMock, readTemperature(false, false))
-      .WillOnce(Return(
-          (TemperatureSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT - 1) /
-          10.0f));
-  EXPECT_CALL(*pArduinoMock, millis())
-      .WillOnce(Return(
-          TemperatureSensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT * 1000));
+  pTs->setReported(ReportReason::due);
+  now = 300000;
+  expectMeasurement(0.45f);
+
   EXPECT_TRUE(pTs->update());
 }
 
 TEST_F(TemperatureSensor_test,
        update_largeValueDiff_smallTimeDiff_shall_return_true) {
-  EXPECT_CALL(*pDhtMock, read(false)).WillOnce(Return(true));
-  EXPECT_CALL(*pDhtMock, readTemperature(false, false))
-      .WillOnce(
-          Return(TemperatureSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT /
-                 10.0f));
-  EXPECT_CALL(*pArduinoMock, millis())
-      .WillOnce(Return(
-          TemperatureSensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT * 1000 -
-          1));
-  EXPECT_TRUE(pTs->update());
-}
+  pTs->setReported(ReportReason::due);
+  now = 300000 - 1;
+  expectMeasurement(5.05f);
 
-TEST_F(TemperatureSensor_test,
-       update_largeValueDiff_largeTimeDiff_shall_return_true) {
-  EXPECT_CALL(*pDhtMock, read(false)).WillOnce(Return(true));
-  EXPECT_CALL(*pDhtMock, readTemperature(false, false))
-      .WillOnce(
-          Return(TemperatureSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT /
-                 10.0f));
-  EXPECT_CALL(*pArduinoMock, millis())
-      .WillOnce(Return(
-          TemperatureSensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT * 1000));
   EXPECT_TRUE(pTs->update());
 }
 
 TEST_F(TemperatureSensor_test, isReportDue) {
-  EXPECT_CALL(*pArduinoMock, millis()).WillOnce(Return(0));
-
   // Newly constructed shall be true
   EXPECT_TRUE(pTs->isReportDue());
 
   // Shall be set to false when setReported() is called
-  pTs->setReported();
+  pTs->setReported(ReportReason::due);
   EXPECT_FALSE(pTs->isReportDue());
 }
-
-TEST_F(TemperatureSensor_test, loadConfigValues_crc_fail_shall_load_defaults) {
-  pTs->loadConfigValues();
-
-  ConfigItemValueT items[4];
-  EXPECT_EQ(pTs->getConfigItemValues(items, arrayLength(items)), 4);
-  EXPECT_EQ(items[0].value,
-            TemperatureSensorConstants::CONFIG_REPORT_HYSTERESIS_DEFAULT);
-  EXPECT_EQ(items[1].value,
-            TemperatureSensorConstants::CONFIG_MEASURE_INTERVAL_DEFAULT);
-  EXPECT_EQ(items[2].value,
-            TemperatureSensorConstants::CONFIG_REPORT_INTERVAL_DEFAULT);
-  EXPECT_EQ(items[3].value,
-            TemperatureSensorConstants::CONFIG_COMPENSATION_DEFAULT);
-}
-
-TEST_F(TemperatureSensor_test,
-       DISABLED_loadConfigValues_crc_ok_shall_load_stored_values) {
-  CRC8 crc;
-  int eeAddr = 0;
-
-  const TemperatureT expectedConfig0 = 44;
-  crc.restart();
-  crc.add(lowByte(expectedConfig0));
-  crc.add(highByte(expectedConfig0));
-  const uint8_t expectedCrc0 = crc.calc();
-  eeAddr = EE_ADDRESS_CONFIG_TEMPERATURE_SENSOR_0;
-  eeprom_write_byte(eeAddr++, lowByte(expectedConfig0));
-  eeprom_write_byte(eeAddr++, highByte(expectedConfig0));
-  eeprom_write_byte(eeAddr++, expectedCrc0);
-
-  const uint16_t expectedConfig1 = 1001;
-  crc.restart();
-  crc.add(lowByte(expectedConfig1));
-  crc.add(highByte(expectedConfig1));
-  const uint8_t expectedCrc1 = crc.calc();
-  eeAddr = EE_ADDRESS_CONFIG_TEMPERATURE_SENSOR_1;
-  eeprom_write_byte(eeAddr++, lowByte(expectedConfig1));
-  eeprom_write_byte(eeAddr++, highByte(expectedConfig1));
-  eeprom_write_byte(eeAddr++, expectedCrc1);
-
-  const uint16_t expectedConfig2 = 1002;
-  crc.restart();
-  crc.add(lowByte(expectedConfig2));
-  crc.add(highByte(expectedConfig2));
-  const uint8_t expectedCrc2 = crc.calc();
-  eeAddr = EE_ADDRESS_CONFIG_TEMPERATURE_SENSOR_2;
-  eeprom_write_byte(eeAddr++, lowByte(expectedConfig2));
-  eeprom_write_byte(eeAddr++, highByte(expectedConfig2));
-  eeprom_write_byte(eeAddr++, expectedCrc2);
-
-  const TemperatureT expectedConfig3 = -103;
-  crc.restart();
-  crc.add(lowByte(expectedConfig3));
-  crc.add(highByte(expectedConfig3));
-  const uint8_t expectedCrc3 = crc.calc();
-  eeAddr = EE_ADDRESS_CONFIG_TEMPERATURE_SENSOR_3;
-  eeprom_write_byte(eeAddr++, lowByte(expectedConfig3));
-  eeprom_write_byte(eeAddr++, highByte(expectedConfig3));
-  eeprom_write_byte(eeAddr++, expectedCrc3);
-
-  pTs->loadConfigValues();
-
-  ConfigItemValueT items[4];
-  EXPECT_EQ(pTs->getConfigItemValues(items, arrayLength(items)), 4);
-  EXPECT_EQ(items[0].value, expectedConfig0);
-  EXPECT_EQ(items[1].value, expectedConfig1);
-  EXPECT_EQ(items[2].value, expectedConfig2);
-  EXPECT_EQ(items[3].value, -100);  // Min value limited by config
-}
@@ -0,0 +1,61 @@
+#include "TimeOnAir.h"
+
+#include <gtest/gtest.h>
+
+// Reference values from the Semtech LoRa calculator.
+
+static_assert(TimeOnAir::getTime_us(10, 7, 125000, 5) == 41216,
+              "Time on air shall be calculated at compile time");
+
+TEST(TimeOnAir_test, symbol_time) {
+  EXPECT_EQ(TimeOnAir::getSymbolTime_us(7, 125000), 1024);
+  EXPECT_EQ(TimeOnAir::getSymbolTime_us(9, 250000), 2048);
+  EXPECT_EQ(TimeOnAir::getSymbolTime_us(12, 125000), 32768);
+}
+
+TEST(TimeOnAir_test, low_data_rate_optimization_above_16ms_symbol_time) {
+  EXPECT_FALSE(TimeOnAir::isLowDataRateOptimized(10, 125000));
+  EXPECT_TRUE(TimeOnAir::isLowDataRateOptimized(11, 125000));
+  EXPECT_TRUE(TimeOnAir::isLowDataRateOptimized(12, 125000));
+  EXPECT_FALSE(TimeOnAir::isLowDataRateOptimized(12, 500000));
+}
+
+TEST(TimeOnAir_test, sf7_bw125_cr45_10_bytes) {
+  EXPECT_EQ(TimeOnAir::getPayloadSymbols(10, 7, 125000, 5), 28);
+  EXPECT_EQ(TimeOnAir::getTime_us(10, 7, 125000, 5), 41216);
+}
+
+TEST(TimeOnAir_test, sf7_bw125_cr45_no_crc) {
+  EXPECT_EQ(TimeOnAir::getTime_us(10, 7, 125000, 5, 8, false), 36096);
+}
+
+TEST(TimeOnAir_test, sf9_bw250_cr46_20_bytes) {
+  EXPECT_EQ(TimeOnAir::getTime_us(20, 9, 250000, 6), 102912);
+}
+
+TEST(TimeOnAir_test, sf12_bw125_cr45_10_bytes_low_data_rate_optimized) {
+  EXPECT_EQ(TimeOnAir::getPayloadSymbols(10, 12, 125000, 5), 18);
+  EXPECT_EQ(TimeOnAir::getTime_us(10, 12, 125000, 5), 991232);
+}
+
+TEST(TimeOnAir_test, empty_implicit_header_frame_shall_have_8_symbols) {
+  EXPECT_EQ(TimeOnAir::getPayloadSymbols(0, 12, 125000, 5, false, true), 8);
+  EXPECT_EQ(TimeOnAir::getTime_us(0, 12, 125000, 5, 8, false, true), 663552);
+}
+
+TEST(TimeOnAir_test, time_shall_grow_with_length) {
+  uint32_t last = 0;
+  for (uint16_t length = 0; length <= 255; length++) {
+    uint32_t t = TimeOnAir::getTime_us(static_cast<uint8_t>(length), 7,
+                                       125000, 5);
+    EXPECT_GE(t, last);
+    last = t;
+  }
+}
+
+TEST(TimeOnAir_test, to_ms_shall_round_up) {
+  EXPECT_EQ(TimeOnAir::toMs(0), 0);
+  EXPECT_EQ(TimeOnAir::toMs(1), 1);
+  EXPECT_EQ(TimeOnAir::toMs(1000), 1);
+  EXPECT_EQ(TimeOnAir::toMs(41216), 42);
+}
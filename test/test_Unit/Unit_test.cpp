@@ -174,3 +174,25 @@ TEST_F(Unit_test, print_unit_ms) {
   EXPECT_STREQ(strBuf, expectStr);
   EXPECT_EQ(printedChars, strlen(expectStr));
 }
+
+TEST_F(Unit_test, print_unit_B) {
+  const char* expectStr = "B";
+  Unit unit = Unit(Unit::Type::B);
+
+  size_t printedChars = unit.print(Serial);
+
+  bufSerReadStr();
+  EXPECT_STREQ(strBuf, expectStr);
+  EXPECT_EQ(printedChars, strlen(expectStr));
+}
+
+TEST_F(Unit_test, print_unit_us) {
+  const char* expectStr = "μs";
+  Unit unit = Unit(Unit::Type::us);
+
+  size_t printedChars = unit.print(Serial);
+
+  bufSerReadStr();
+  EXPECT_STREQ(strBuf, expectStr);
+  EXPECT_EQ(printedChars, strlen(expectStr));
+}
@@ -2,9 +2,21 @@
 
 #include <gtest/gtest.h>
 
-#include "Unit.h"
 #include "Arduino.h"
+#include "BaseComponent.h"
 #include "BufferSerial.h"
+#include "Unit.h"
+
+// Metadata of a value item, in flash on target.
+template <class T>
+static constexpr DiscoveryEntityT entity(Unit::Type unitType = Unit::Type::none,
+                                         uint8_t precision = 0,
+                                         T min_value = MIN_OF(T),
+                                         T max_value = MAX_OF(T)) {
+  return BaseComponent::makeEntity<T>(0, "", BaseComponent::Type::SENSOR, 0,
+                                      BaseComponent::Category::NONE, unitType,
+                                      precision, min_value, max_value);
+}
 
 class ValueItem_test : public ::testing::Test {
  protected:
@@ -84,7 +96,8 @@ TEST_F(ValueItem_test, MAX_OF) {
 }
 
 TEST_F(ValueItem_test, construct_default_uint8) {
-  auto v = ValueItem<uint8_t>();
+  const DiscoveryEntityT e = entity<uint8_t>();
+  auto v = ValueItem<uint8_t>(e);
 
   EXPECT_EQ(v.getValue(), 0);
   EXPECT_EQ(v.getValueSize(), 1);
@@ -97,7 +110,8 @@ TEST_F(ValueItem_test, construct_default_uint8) {
 }
 
 TEST_F(ValueItem_test, construct_default_int32) {
-  auto v = ValueItem<int32_t>();
+  const DiscoveryEntityT e = entity<int32_t>();
+  auto v = ValueItem<int32_t>(e);
 
   EXPECT_EQ(v.getValue(), 0);
   EXPECT_EQ(v.getValueSize(), 4);
@@ -110,7 +124,8 @@ TEST_F(ValueItem_test, construct_default_int32) {
 }
 
 TEST_F(ValueItem_test, construct_with_args_uint8) {
-  auto v = ValueItem<uint8_t>(Unit::Type::C, 3, 12, 10, 15);
+  const DiscoveryEntityT e = entity<uint8_t>(Unit::Type::C, 3, 10, 15);
+  auto v = ValueItem<uint8_t>(e, 12);
 
   EXPECT_EQ(v.getValue(), 12);
   EXPECT_EQ(v.getValueSize(), 1);
@@ -122,8 +137,19 @@ TEST_F(ValueItem_test, construct_with_args_uint8) {
   EXPECT_EQ(v.getMaxValue(), 15);
 }
 
+TEST_F(ValueItem_test, getPrecision_shall_ignore_size_and_sign_bits) {
+  const DiscoveryEntityT e = entity<int32_t>(Unit::Type::C, 1);
+  auto v = ValueItem<int32_t>(e);
+
+  EXPECT_TRUE(e.isSigned);
+  EXPECT_NE(e.sizeCode, 0);
+  EXPECT_EQ(v.getPrecision(), 1);
+  EXPECT_EQ(v.getScaleFactor(), 10);
+}
+
 TEST_F(ValueItem_test, construct_with_args_int32) {
-  auto v = ValueItem<int32_t>(Unit::Type::F, 3, -123, -200, 100);
+  const DiscoveryEntityT e = entity<int32_t>(Unit::Type::F, 3, -200, 100);
+  auto v = ValueItem<int32_t>(e, -123);
 
   EXPECT_EQ(v.getValue(), -123);
   EXPECT_EQ(v.getValueSize(), 4);
@@ -137,18 +163,21 @@ TEST_F(ValueItem_test, construct_with_args_int32) {
 
 #ifndef SKIP_DEATH_TESTS
 TEST_F(ValueItem_deathTest, construct_with_value_less_than_min_uint8) {
-  EXPECT_DEATH({ ValueItem<uint8_t>(Unit::Type::C, 3, 9, 10, 15); },
-               "Assertion `mValue >= mMin' failed.");
+  const DiscoveryEntityT e = entity<uint8_t>(Unit::Type::C, 3, 10, 15);
+  EXPECT_DEATH({ ValueItem<uint8_t>(e, 9); },
+               "Assertion `mValue >= getMinValue\\(\\)' failed.");
 }
 
 TEST_F(ValueItem_deathTest, construct_with_value_greater_than_max_uint8) {
-  EXPECT_DEATH({ ValueItem<uint8_t>(Unit::Type::C, 3, 16, 10, 15); },
-               "Assertion `mValue <= mMax' failed.");
+  const DiscoveryEntityT e = entity<uint8_t>(Unit::Type::C, 3, 10, 15);
+  EXPECT_DEATH({ ValueItem<uint8_t>(e, 16); },
+               "Assertion `mValue <= getMaxValue\\(\\)' failed.");
 }
 #endif
 
 TEST_F(ValueItem_test, setValue) {
-  auto v = ValueItem<int16_t>();
+  const DiscoveryEntityT e = entity<int16_t>();
+  auto v = ValueItem<int16_t>(e);
   EXPECT_EQ(v.getValue(), 0);
 
   v.setValue(INT16_MIN);
@@ -165,7 +194,9 @@ TEST_F(ValueItem_test, setValue_outside_range) {
   const int16_t MIN_VAL = -100;
   const int16_t MAX_VAL = 100;
 
-  auto v = ValueItem<int16_t>(Unit::Type::C, 2, 0, MIN_VAL, MAX_VAL);
+  const DiscoveryEntityT e =
+      entity<int16_t>(Unit::Type::C, 2, MIN_VAL, MAX_VAL);
+  auto v = ValueItem<int16_t>(e, 0);
   EXPECT_EQ(v.getValue(), 0);
 
   v.setValue(MIN_VAL - 1);
@@ -177,7 +208,8 @@ TEST_F(ValueItem_test, setValue_outside_range) {
 
 TEST_F(ValueItem_test, print_uint32_max_val_precision_0_no_unit) {
   const char* expectStr = "4294967295";
-  auto v = ValueItem<uint32_t>(Unit::Type::none, 0, UINT32_MAX);
+  const DiscoveryEntityT e = entity<uint32_t>(Unit::Type::none, 0);
+  auto v = ValueItem<uint32_t>(e, UINT32_MAX);
 
   size_t printedChars = v.printTo(Serial);
 
@@ -188,7 +220,8 @@ TEST_F(ValueItem_test, print_uint32_max_val_precision_0_no_unit) {
 
 TEST_F(ValueItem_test, print_uint32_max_val_precision_3_unit_C) {
   const char* expectStr = "4294967.295°C";
-  auto v = ValueItem<uint32_t>(Unit::Type::C, 3, UINT32_MAX);
+  const DiscoveryEntityT e = entity<uint32_t>(Unit::Type::C, 3);
+  auto v = ValueItem<uint32_t>(e, UINT32_MAX);
 
   size_t printedChars = v.printTo(Serial);
 
@@ -199,7 +232,8 @@ TEST_F(ValueItem_test, print_uint32_max_val_precision_3_unit_C) {
 
 TEST_F(ValueItem_test, print_int32_min_val_precision_2_unit_F) {
   const char* expectStr = "-21474836.48°F";
-  auto v = ValueItem<int32_t>(Unit::Type::F, 2, INT32_MIN);
+  const DiscoveryEntityT e = entity<int32_t>(Unit::Type::F, 2);
+  auto v = ValueItem<int32_t>(e, INT32_MIN);
 
   size_t printedChars = v.printTo(Serial);
 
@@ -210,7 +244,8 @@ TEST_F(ValueItem_test, print_int32_min_val_precision_2_unit_F) {
 
 TEST_F(ValueItem_test, print_int8_val_minus_1_precision_3_unit_km) {
   const char* expectStr = "-0.001km";
-  auto v = ValueItem<int8_t>(Unit::Type::km, 3, -1);
+  const DiscoveryEntityT e = entity<int8_t>(Unit::Type::km, 3);
+  auto v = ValueItem<int8_t>(e, -1);
 
   size_t printedChars = v.printTo(Serial);
 
@@ -221,7 +256,8 @@ TEST_F(ValueItem_test, print_int8_val_minus_1_precision_3_unit_km) {
 
 TEST_F(ValueItem_test, print_uint8_val_0_precision_3_unit_none) {
   const char* expectStr = "0.000";
-  auto v = ValueItem<uint8_t>(Unit::Type::none, 3, 0);
+  const DiscoveryEntityT e = entity<uint8_t>(Unit::Type::none, 3);
+  auto v = ValueItem<uint8_t>(e, 0);
 
   size_t printedChars = v.printTo(Serial);
 
@@ -0,0 +1,103 @@
+#include "ValueItemQueue.h"
+
+#include <gtest/gtest.h>
+
+TEST(ValueItemQueue_test, construct_capacity_4) {
+  ValueItemQueue<4> q;
+
+  EXPECT_EQ(q.capacity(), 4);
+}
+
+TEST(ValueItemQueue_test, new_shall_be_empty) {
+  ValueItemQueue<4> q;
+
+  EXPECT_TRUE(q.isEmpty());
+  EXPECT_FALSE(q.isFull());
+  EXPECT_EQ(q.size(), 0);
+}
+
+TEST(ValueItemQueue_test, items_shall_be_kept_in_insertion_order) {
+  ValueItemQueue<4> q;
+
+  EXPECT_TRUE(q.push(ValueItemT(3, 30)));
+  EXPECT_TRUE(q.push(ValueItemT(1, 10)));
+  EXPECT_TRUE(q.push(ValueItemT(2, 20)));
+
+  ASSERT_EQ(q.size(), 3);
+  EXPECT_EQ(q[0], ValueItemT(3, 30));
+  EXPECT_EQ(q[1], ValueItemT(1, 10));
+  EXPECT_EQ(q[2], ValueItemT(2, 20));
+}
+
+TEST(ValueItemQueue_test, same_entity_shall_replace_value_in_place) {
+  ValueItemQueue<4> q;
+
+  q.push(ValueItemT(3, 30));
+  q.push(ValueItemT(1, 10));
+  EXPECT_TRUE(q.push(ValueItemT(3, 31)));
+
+  ASSERT_EQ(q.size(), 2);
+  EXPECT_EQ(q[0], ValueItemT(3, 31));
+  EXPECT_EQ(q[1], ValueItemT(1, 10));
+}
+
+TEST(ValueItemQueue_test, full_queue_shall_drop_new_entity_but_replace_queued) {
+  ValueItemQueue<2> q;
+
+  q.push(ValueItemT(1, 10));
+  q.push(ValueItemT(2, 20));
+
+  EXPECT_TRUE(q.isFull());
+  EXPECT_FALSE(q.push(ValueItemT(3, 30)));
+  EXPECT_TRUE(q.push(ValueItemT(2, 21)));
+
+  ASSERT_EQ(q.size(), 2);
+  EXPECT_EQ(q[0], ValueItemT(1, 10));
+  EXPECT_EQ(q[1], ValueItemT(2, 21));
+}
+
+TEST(ValueItemQueue_test, pop_shall_remove_oldest_items) {
+  ValueItemQueue<4> q;
+
+  q.push(ValueItemT(1, 10));
+  q.push(ValueItemT(2, 20));
+  q.push(ValueItemT(3, 30));
+
+  q.pop(2);
+
+  ASSERT_EQ(q.size(), 1);
+  EXPECT_EQ(q[0], ValueItemT(3, 30));
+
+  q.pop(5);
+  EXPECT_TRUE(q.isEmpty());
+}
+
+TEST(ValueItemQueue_test, clear_shall_empty_queue) {
+  ValueItemQueue<4> q;
+
+  q.push(ValueItemT(1, 10));
+  q.push(ValueItemT(2, 20));
+
+  q.clear();
+
+  EXPECT_TRUE(q.isEmpty());
+  EXPECT_TRUE(q.push(ValueItemT(1, 11)));
+  EXPECT_EQ(q[0], ValueItemT(1, 11));
+}
+
+TEST(ValueItemQueue_test, sort_shall_order_by_entity_id) {
+  ValueItemQueue<4> q;
+
+  q.push(ValueItemT(7, 70));
+  q.push(ValueItemT(2, 20));
+  q.push(ValueItemT(9, 90));
+  q.push(ValueItemT(0, 0));
+
+  q.sortByEntityId();
+
+  ASSERT_EQ(q.size(), 4);
+  EXPECT_EQ(q[0], ValueItemT(0, 0));
+  EXPECT_EQ(q[1], ValueItemT(2, 20));
+  EXPECT_EQ(q[2], ValueItemT(7, 70));
+  EXPECT_EQ(q[3], ValueItemT(9, 90));
+}